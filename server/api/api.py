@@ -1,17 +1,48 @@
+import asyncio
+from contextlib import asynccontextmanager
+from datetime import datetime
+from datetime import timedelta
+from datetime import timezone
+from typing import Any
+from typing import Dict
 from typing import List
-
+from typing import Tuple
+from typing import Union
+
+from api.codecs import decode_sensor_data_batch
+from api.codecs import decode_sensor_data_columns
+from api.compression import DecompressingRoute
+from api.schemas import DEFAULT_QUERY_PAGE_READINGS
+from api.schemas import MAX_QUERY_BUCKETS
+from api.schemas import MAX_QUERY_PAGE_READINGS
 from api.schemas import SensorData
+from api.schemas import SensorDataBatch
+from api.schemas import VehicleSerialList
+from api.schemas import VehicleStatusBatch
 from api.schemas import VehicleStatusData
+from api.status_events import StatusEventBroadcaster
+from api.status_events import VehicleStatusCache
+from api.status_events import etag_matches
 from conflog import logger
 from database.datatypes import SensorType
+from database.ingest import SensorDataWriter
+from database.ingest import WriteQueueFull
+from database.models import create_missing_indexes
 from database.monitoring import VehicleDataManager
+from database.repository import ProcessedRequestRepository
 from database.repository import SensorRepository
 from database.repository import VehicleStatusRepository
 from database.session import DatabaseSession
 from fastapi import Depends
 from fastapi import FastAPI
+from fastapi import Header
 from fastapi import HTTPException
+from fastapi import Query
+from fastapi import Request
+from fastapi import Response
 from fastapi.responses import RedirectResponse
+from fastapi.responses import StreamingResponse
+from pydantic import ValidationError
 from sqlalchemy.orm import Session
 
 
@@ -25,32 +56,171 @@ logger = logger.getChild("API-Endpoints")
 """
 
 
+# One engine per process, its connection pool is shared by all requests
+database = DatabaseSession("sqlite:///server/vehicle_data.db")
+
+
 # Dependency for database session
 def get_session():
     """Dependency injection to provide a database session for FastAPI endpoints.
 
     Yields:
-        Session: A SQLAlchemy session connected to the SQLite database.
+        Session: A pooled SQLAlchemy session connected to the SQLite database.
+    """
+    yield from database.get_session()
+
+
+# Dependency for sensor data batch bodies
+async def sensor_data_batch_from_request(request: Request) -> SensorDataBatch:
+    """Decodes a sensor data batch sent as JSON, CBOR or MessagePack.
+
+    Args:
+        request (Request): The incoming request; its Content-Type selects the decoder.
+
+    Returns:
+        SensorDataBatch: The validated batch.
+
+    Raises:
+        HTTPException: 400 if the body cannot be decoded, 422 if it fails validation.
     """
-    db = DatabaseSession("sqlite:///server/vehicle_data.db")
-    session = next(db.get_session())
+    body = await request.body()
     try:
-        yield session
-    finally:
-        session.close()
+        return SensorDataBatch.model_validate(
+            decode_sensor_data_batch(body, request.headers.get("content-type", "application/json"))
+        )
+    except ValidationError as e:
+        raise HTTPException(status_code=422, detail=e.errors(include_url=False))
+    except ValueError as e:
+        raise HTTPException(status_code=400, detail=str(e))
+
+
+# Dependency for columnar sensor data bodies
+async def sensor_data_columns_from_request(
+    request: Request,
+) -> Tuple[str, List[Tuple[SensorType, List[datetime], List[float]]]]:
+    """Decodes a columnar sensor data batch (`application/x-sensor-columns`).
+
+    Args:
+        request (Request): The incoming request.
+
+    Returns:
+        Tuple[str, List[Tuple[SensorType, List[datetime], List[float]]]]: The vehicle serial and its columns.
+
+    Raises:
+        HTTPException: 400 if the body is malformed or names an unknown sensor type.
+    """
+    body = await request.body()
+    try:
+        vehicle_serial, columns = decode_sensor_data_columns(body)
+        return vehicle_serial, [(SensorType(name), timestamps, values) for name, timestamps, values in columns]
+    except ValueError as e:
+        raise HTTPException(status_code=400, detail=str(e))
+
+
+# Sensor data queries report timestamps as microseconds since the Unix epoch, like the binary upload formats
+EPOCH = datetime(1970, 1, 1, tzinfo=timezone.utc)
+
+
+def epoch_micros(timestamp: datetime) -> int:
+    """Converts a stored timestamp, naive UTC, to microseconds since the Unix epoch."""
+    if timestamp.tzinfo is None:
+        timestamp = timestamp.replace(tzinfo=timezone.utc)
+    return (timestamp - EPOCH) // timedelta(microseconds=1)
 
 
+def encode_query_cursor(timestamp: datetime, row_id: int) -> str:
+    """Builds the cursor of the page that follows a reading, `<microseconds>-<id>`."""
+    return f"{epoch_micros(timestamp)}-{row_id}"
+
+
+def decode_query_cursor(cursor: str) -> Tuple[datetime, int]:
+    """Reads a cursor built by encode_query_cursor.
+
+    Raises:
+        HTTPException: 400 if the cursor is malformed.
+    """
+    try:
+        micros, row_id = (int(part) for part in cursor.split("-"))
+        return EPOCH + timedelta(microseconds=micros), row_id
+    except ValueError:
+        raise HTTPException(status_code=400, detail=f"Malformed cursor {cursor!r}")
+
+
+# Clients may resend a sensor upload after a timeout; a repeated key is acknowledged without recording it again
+IdempotencyKey = Header(default=None, alias="Idempotency-Key", max_length=128)
+
+ALREADY_RECORDED = {"status": "success", "content": "Sensor data already recorded."}
+
+# Seconds a client is asked to wait when the write queue is full
+WRITE_QUEUE_RETRY_AFTER_SECONDS = 1
+
 # Create repositories and VehicleDataManager instance
 sensor_data_repository = SensorRepository()
 vehicle_status_repository = VehicleStatusRepository()
-vehicle_data_manager = VehicleDataManager(sensor_data_repository, vehicle_status_repository)
+processed_request_repository = ProcessedRequestRepository()
+vehicle_data_manager = VehicleDataManager(
+    sensor_data_repository, vehicle_status_repository, processed_request_repository
+)
+
+# Sensor uploads of concurrent requests are recorded together, one transaction per group
+sensor_data_writer = SensorDataWriter(
+    database.SessionLocal, sensor_data_repository, vehicle_status_repository, processed_request_repository
+)
+
+
+async def record_sensor_rows(
+    vehicle_serial: str, rows: List[Dict[str, Any]], idempotency_key: Union[str, None]
+) -> Union[int, None]:
+    """Records the rows of one sensor upload through the group-commit writer.
+
+    Args:
+        vehicle_serial (str): The unique identifier for the vehicle.
+        rows (List[Dict[str, Any]]): Rows as built by SensorRepository.sensor_data_rows.
+        idempotency_key (str or None): The key sent with the upload.
+
+    Returns:
+        int or None: The number of recorded readings, or None if the upload was recorded before.
+
+    Raises:
+        HTTPException: 503 if the write queue is full, 400 if the upload was rejected.
+    """
+    try:
+        return await sensor_data_writer.record(vehicle_serial, rows, idempotency_key)
+    except WriteQueueFull as e:
+        raise HTTPException(
+            status_code=503, detail=str(e), headers={"Retry-After": str(WRITE_QUEUE_RETRY_AFTER_SECONDS)}
+        )
+    except ValueError as e:
+        raise HTTPException(status_code=400, detail=str(e))
+
+
+# Status reads are served from memory and status changes are pushed to subscribed clients
+vehicle_status_cache = VehicleStatusCache()
+status_event_broadcaster = StatusEventBroadcaster()
 
 """
 **********************************
 *** Create FastAPI App
 **********************************
 """
+
+
+@asynccontextmanager
+async def lifespan(app: FastAPI):
+    """Adds missing indexes and runs the sensor data writer while the app serves requests.
+
+    Queued uploads are recorded before shutdown.
+    """
+    await asyncio.to_thread(create_missing_indexes, database.engine)
+    sensor_data_writer.start()
+    try:
+        yield
+    finally:
+        await asyncio.to_thread(sensor_data_writer.stop)
+
+
 app = FastAPI(
+    lifespan=lifespan,
     title="RESTful Infrastructure Backend API",
     description="""
     This RESTful API serves as a backend for managing vehicle sensor and status data. It enables the registration of vehicles, updates to their statuses, and the recording and retrieval of sensor data associated with those vehicles.
@@ -78,6 +248,9 @@ app = FastAPI(
     },
 )
 
+# Request bodies sent with Content-Encoding gzip or zstd are decompressed before parsing
+app.router.route_class = DecompressingRoute
+
 
 @app.get("/")
 def home():
@@ -117,6 +290,8 @@ def update_vehicle_status(data: VehicleStatusData, session: Session = Depends(ge
     logger.debug(f"Updating status for vehicle {data.vehicle_serial}")
     try:
         vehicle_data_manager.update_vehicle_status_by_serial_number(data.vehicle_serial, data.vehicle_status, session)
+        etag = vehicle_status_cache.put(data.vehicle_serial, data.vehicle_status.value)
+        status_event_broadcaster.publish(data.vehicle_serial, data.vehicle_status.value, etag)
         logger.debug(f"Status updated for vehicle {data.vehicle_serial} to {data.vehicle_status}")
         return {
             "status": "success",
@@ -129,19 +304,106 @@ def update_vehicle_status(data: VehicleStatusData, session: Session = Depends(ge
         raise HTTPException(status_code=400, detail=str(e))
 
 
-@app.post("/add-sensor-data/", tags=["Sensor Data Management"])
-def record_sensor_data_for_vehicle(data: SensorData, session: Session = Depends(get_session)):
-    """Record sensor data for a specific vehicle."""
-    logger.debug(f"Recording sensor data for vehicle {data.vehicle_serial}")
+@app.post("/update-vehicle-statuses/", tags=["Vehicle Management"])
+def update_vehicle_statuses(data: VehicleStatusBatch, session: Session = Depends(get_session)):
+    """Update the statuses of many vehicles in one transaction.
+
+    Unregistered vehicles are skipped and listed in `unknown_vehicles`; all other updates are applied.
+    """
+    logger.debug(f"Updating statuses of {len(data.updates)} vehicles")
     try:
-        vehicle_data_manager.record_sensor_data_for_vehicle(
-            data.vehicle_serial, data.sensor_type, data.sensor_data, data.timestamp, session
-        )
-        return {"status": "success", "content": "Sensor data recorded."}
+        updates = [(update.vehicle_serial, update.vehicle_status) for update in data.updates]
+        unknown = vehicle_data_manager.update_vehicle_statuses(updates, session)
     except Exception as e:
+        logger.error(f"Failed to update statuses: {e}")
         session.rollback()
         raise HTTPException(status_code=400, detail=str(e))
 
+    skipped = set(unknown)
+    for vehicle_serial, vehicle_status in updates:
+        if vehicle_serial not in skipped:
+            etag = vehicle_status_cache.put(vehicle_serial, vehicle_status.value)
+            status_event_broadcaster.publish(vehicle_serial, vehicle_status.value, etag)
+    return {
+        "status": "success",
+        "content": f"{len(updates) - len(skipped)} vehicle statuses updated.",
+        "unknown_vehicles": unknown,
+    }
+
+
+@app.post("/get-vehicle-statuses/", tags=["Vehicle Management"])
+def retrieve_vehicle_statuses(data: VehicleSerialList, session: Session = Depends(get_session)) -> Dict[str, str]:
+    """Get the statuses of many vehicles at once.
+
+    A POST, so thousands of serials fit in the body. Cached statuses are used as they are; the rest are read with
+    a single query. Unregistered vehicles are left out of the result.
+    """
+    logger.debug(f"Fetching statuses for {len(data.vehicle_serials)} vehicles")
+    statuses = {}
+    missed = []
+    for vehicle_serial in data.vehicle_serials:
+        cached = vehicle_status_cache.get(vehicle_serial)
+        if cached:
+            statuses[vehicle_serial] = cached[0]
+        else:
+            missed.append(vehicle_serial)
+
+    if missed:
+        try:
+            token = vehicle_status_cache.begin_fill()
+            for vehicle_serial, status in vehicle_data_manager.retrieve_vehicle_statuses(missed, session).items():
+                statuses[vehicle_serial] = status.value
+                vehicle_status_cache.fill(vehicle_serial, status.value, token)
+        except Exception as e:
+            logger.error(f"Failed to fetch vehicle statuses: {e}")
+            session.rollback()
+            raise HTTPException(status_code=400, detail=str(e))
+    return statuses
+
+
+@app.post("/add-sensor-data/", tags=["Sensor Data Management"])
+async def record_sensor_data_for_vehicle(data: SensorData, idempotency_key: Union[str, None] = IdempotencyKey):
+    """Record sensor data for a specific vehicle."""
+    logger.debug(f"Recording sensor data for vehicle {data.vehicle_serial}")
+    reading = (data.sensor_type, data.sensor_data, data.timestamp)
+    rows = SensorRepository.sensor_data_rows(data.vehicle_serial, [reading])
+    if await record_sensor_rows(data.vehicle_serial, rows, idempotency_key) is None:
+        return ALREADY_RECORDED
+    return {"status": "success", "content": "Sensor data recorded."}
+
+
+@app.post("/add-sensor-data-batch/", tags=["Sensor Data Management"])
+async def record_sensor_data_batch_for_vehicle(
+    data: SensorDataBatch = Depends(sensor_data_batch_from_request),
+    idempotency_key: Union[str, None] = IdempotencyKey,
+):
+    """Record a batch of sensor data for a specific vehicle in one transaction.
+
+    Accepts `application/json`, `application/cbor` and `application/msgpack` bodies. Batches of concurrent
+    requests are committed together; the response is sent once the readings are stored.
+    """
+    logger.debug(f"Recording {len(data.readings)} sensor data entries for vehicle {data.vehicle_serial}")
+    readings = [(reading.sensor_type, reading.sensor_data, reading.timestamp) for reading in data.readings]
+    rows = SensorRepository.sensor_data_rows(data.vehicle_serial, readings)
+    if await record_sensor_rows(data.vehicle_serial, rows, idempotency_key) is None:
+        return ALREADY_RECORDED
+    return {"status": "success", "content": f"{len(data.readings)} sensor data entries recorded."}
+
+
+@app.post("/add-sensor-data-columnar/", tags=["Sensor Data Management"])
+async def record_sensor_data_columns_for_vehicle(
+    data: Tuple[str, List[Tuple[SensorType, List[datetime], List[float]]]] = Depends(sensor_data_columns_from_request),
+    idempotency_key: Union[str, None] = IdempotencyKey,
+):
+    """Record a columnar, delta-encoded batch of sensor data for a vehicle with one bulk insert."""
+    vehicle_serial, columns = data
+    logger.debug(f"Recording {len(columns)} sensor data columns for vehicle {vehicle_serial}")
+    rows = SensorRepository.sensor_data_rows_from_columns(vehicle_serial, columns)
+    recorded = await record_sensor_rows(vehicle_serial, rows, idempotency_key)
+    if recorded is None:
+        return ALREADY_RECORDED
+    return {"status": "success", "content": f"{recorded} sensor data entries recorded."}
+
 
 """
 **********************************
@@ -166,20 +428,54 @@ def retrieve_all_vehicle_serial_numbers(session: Session = Depends(get_session))
 
 
 @app.get("/get-vehicle-status/", tags=["Vehicle Management"])
-def retrieve_vehicle_status(vehicle_serial: str, session: Session = Depends(get_session)):
-    """Get the status of a specific vehicle."""
+def retrieve_vehicle_status(
+    vehicle_serial: str,
+    response: Response,
+    session: Session = Depends(get_session),
+    if_none_match: Union[str, None] = Header(default=None),
+):
+    """Get the status of a specific vehicle.
+
+    The response carries an ETag. A request whose If-None-Match header matches it gets an empty 304 response.
+    """
     logger.debug(f"Fetching status for vehicle {vehicle_serial}")
 
     try:
-        vehicle_status = vehicle_data_manager.retrieve_vehicle_status(vehicle_serial, session)
+        cached = vehicle_status_cache.get(vehicle_serial)
+        if cached:
+            status, etag = cached
+        else:
+            token = vehicle_status_cache.begin_fill()
+            status = vehicle_data_manager.retrieve_vehicle_status(vehicle_serial, session).status.value
+            etag = vehicle_status_cache.fill(vehicle_serial, status, token)
         logger.debug(f"Fetched status for vehicle {vehicle_serial}")
-        return vehicle_status.status
 
     except Exception as e:
         logger.error(f"Failed to fetch vehicle status: {e}")
         session.rollback()
         raise HTTPException(status_code=400, detail=str(e))
 
+    # Clients must revalidate, so a status change is never served stale from an intermediate cache
+    headers = {"ETag": etag, "Cache-Control": "no-cache"}
+    if etag_matches(if_none_match, etag):
+        return Response(status_code=304, headers=headers)
+    response.headers.update(headers)
+    return status
+
+
+@app.get("/vehicle-status-events/", tags=["Vehicle Management"])
+async def stream_vehicle_status_events(vehicle_serial: List[str] = Query(default=[])):
+    """Stream status changes as Server-Sent Events, for all vehicles or only the given ones.
+
+    Clients that keep the stream open can answer status queries from their own cache instead of polling.
+    """
+    logger.debug(f"Opening status event stream for {len(vehicle_serial) or 'all'} vehicles")
+    return StreamingResponse(
+        status_event_broadcaster.stream(set(vehicle_serial)),
+        media_type="text/event-stream",
+        headers={"Cache-Control": "no-cache"},
+    )
+
 
 @app.get("/get-sensor-data/{vehicle_serial}", tags=["Sensor Data Management"])
 def get_all_sensor_data(vehicle_serial: str, session: Session = Depends(get_session)):
@@ -205,3 +501,80 @@ def get_particular_sensor_data(vehicle_serial: str, sensor_type: SensorType, ses
     except Exception as e:
         logger.error(f"Failed to fetch sensor data: {e}")
         raise HTTPException(status_code=404, detail=str(e))
+
+
+@app.get("/query-sensor-data/{vehicle_serial}/{sensor_type}", tags=["Sensor Data Management"])
+def query_sensor_data(
+    vehicle_serial: str,
+    sensor_type: SensorType,
+    session: Session = Depends(get_session),
+    start: Union[datetime, None] = None,
+    end: Union[datetime, None] = None,
+    limit: int = Query(default=DEFAULT_QUERY_PAGE_READINGS, ge=1, le=MAX_QUERY_PAGE_READINGS),
+    cursor: Union[str, None] = None,
+):
+    """Retrieve one page of a sensor's readings in a time range, oldest first.
+
+    `start` is included and `end` excluded, both optional. Timestamps are returned as microseconds since the Unix
+    epoch. While `next_cursor` is not null, pass it as `cursor` with the same range to get the next page.
+    """
+    logger.debug(f"Querying {sensor_type} sensor data for vehicle {vehicle_serial}")
+    after = decode_query_cursor(cursor) if cursor else None
+    try:
+        rows = vehicle_data_manager.query_sensor_data_for_vehicle(
+            vehicle_serial, sensor_type, start, end, after, limit, session
+        )
+    except Exception as e:
+        logger.error(f"Failed to query sensor data: {e}")
+        raise HTTPException(status_code=404, detail=str(e))
+
+    return {
+        "vehicle_serial": vehicle_serial,
+        "sensor_type": sensor_type.value,
+        "timestamps": [epoch_micros(timestamp) for _, timestamp, _ in rows],
+        "values": [value for _, _, value in rows],
+        "next_cursor": encode_query_cursor(rows[-1][1], rows[-1][0]) if len(rows) == limit else None,
+    }
+
+
+@app.get("/query-sensor-data/{vehicle_serial}/{sensor_type}/buckets", tags=["Sensor Data Management"])
+def query_downsampled_sensor_data(
+    vehicle_serial: str,
+    sensor_type: SensorType,
+    start: datetime,
+    end: datetime,
+    bucket_seconds: int = Query(ge=1),
+    session: Session = Depends(get_session),
+):
+    """Retrieve a sensor's readings in a time range aggregated into buckets of `bucket_seconds`.
+
+    Each bucket that has readings reports its start (microseconds since the Unix epoch), count, minimum, maximum
+    and average; buckets are counted from `start`, cut to whole seconds. The aggregation runs in the database, so
+    the response stays small however many readings the range holds.
+    """
+    logger.debug(f"Downsampling {sensor_type} sensor data for vehicle {vehicle_serial} to {bucket_seconds}s buckets")
+    start_second = epoch_micros(start) // 1_000_000
+    span_seconds = -(-epoch_micros(end) // 1_000_000) - start_second
+    if span_seconds <= 0:
+        raise HTTPException(status_code=400, detail="end must be after start")
+    if -(-span_seconds // bucket_seconds) > MAX_QUERY_BUCKETS:
+        raise HTTPException(status_code=400, detail=f"More than {MAX_QUERY_BUCKETS} buckets requested")
+
+    try:
+        buckets = vehicle_data_manager.downsample_sensor_data_for_vehicle(
+            vehicle_serial, sensor_type, start, end, bucket_seconds, session
+        )
+    except Exception as e:
+        logger.error(f"Failed to downsample sensor data: {e}")
+        raise HTTPException(status_code=404, detail=str(e))
+
+    return {
+        "vehicle_serial": vehicle_serial,
+        "sensor_type": sensor_type.value,
+        "bucket_seconds": bucket_seconds,
+        "starts": [(start_second + number * bucket_seconds) * 1_000_000 for number, _, _, _, _ in buckets],
+        "counts": [count for _, count, _, _, _ in buckets],
+        "minimum": [minimum for _, _, minimum, _, _ in buckets],
+        "maximum": [maximum for _, _, _, maximum, _ in buckets],
+        "average": [average for _, _, _, _, average in buckets],
+    }
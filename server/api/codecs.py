@@ -0,0 +1,226 @@
+import json
+import struct
+from datetime import datetime
+from datetime import timedelta
+from datetime import timezone
+from typing import Any
+from typing import Dict
+from typing import List
+from typing import Tuple
+
+import cbor2
+import msgpack
+
+JSON_CONTENT_TYPE = "application/json"
+CBOR_CONTENT_TYPE = "application/cbor"
+MSGPACK_CONTENT_TYPES = ("application/msgpack", "application/x-msgpack")
+COLUMNAR_CONTENT_TYPE = "application/x-sensor-columns"
+
+_COLUMNAR_MAGIC = b"VSC"
+_COLUMNAR_VERSION = 1
+_RAW_VALUES = 0
+_XOR_VALUES = 1
+
+_EPOCH = datetime(1970, 1, 1, tzinfo=timezone.utc)
+
+
+def _media_type(content_type: str) -> str:
+    """Strips parameters such as charset from a Content-Type header value."""
+    return content_type.split(";", 1)[0].strip().lower()
+
+
+def _timestamps_from_micros(payload: Dict[str, Any]) -> Dict[str, Any]:
+    """Converts the integer microsecond timestamps of binary batches to datetimes.
+
+    Args:
+        payload (Dict[str, Any]): Decoded batch with `readings[*].timestamp` in microseconds since the epoch.
+
+    Returns:
+        Dict[str, Any]: The same payload with timezone-aware UTC datetimes.
+    """
+    readings = payload.get("readings", []) if isinstance(payload, dict) else []
+    for reading in readings if isinstance(readings, list) else []:
+        timestamp = reading.get("timestamp") if isinstance(reading, dict) else None
+        if isinstance(timestamp, int) and not isinstance(timestamp, bool):
+            reading["timestamp"] = _EPOCH + timedelta(microseconds=timestamp)
+    return payload
+
+
+def decode_sensor_data_batch(body: bytes, content_type: str) -> Dict[str, Any]:
+    """Decodes a sensor data batch body according to its Content-Type.
+
+    JSON bodies carry ISO 8601 timestamps, CBOR and MessagePack bodies carry the same keys
+    with timestamps as unsigned microseconds since the Unix epoch.
+
+    Args:
+        body (bytes): The raw request body.
+        content_type (str): The request's Content-Type header value.
+
+    Returns:
+        Dict[str, Any]: The decoded batch, ready for `SensorDataBatch` validation.
+
+    Raises:
+        ValueError: If the media type is unsupported or the body cannot be decoded.
+    """
+    media_type = _media_type(content_type or JSON_CONTENT_TYPE)
+
+    try:
+        if media_type == JSON_CONTENT_TYPE:
+            return json.loads(body)
+        if media_type == CBOR_CONTENT_TYPE:
+            return _timestamps_from_micros(cbor2.loads(body))
+        if media_type in MSGPACK_CONTENT_TYPES:
+            return _timestamps_from_micros(msgpack.unpackb(body, raw=False))
+    except (cbor2.CBORDecodeError, msgpack.UnpackException, ValueError, TypeError) as e:
+        raise ValueError(f"Failed to decode {media_type} body: {e}")
+
+    raise ValueError(f"Unsupported content type: {media_type}")
+
+
+class _ColumnReader:
+    """Sequential reader over a columnar batch body, see `decode_sensor_data_columns`."""
+
+    def __init__(self, body: bytes) -> None:
+        self.body = body
+        self.offset = 0
+        self.bit = 0
+
+    def byte(self) -> int:
+        if self.offset >= len(self.body):
+            raise ValueError("Columnar body is truncated.")
+        value = self.body[self.offset]
+        self.offset += 1
+        return value
+
+    def raw(self, length: int) -> bytes:
+        if self.offset + length > len(self.body):
+            raise ValueError("Columnar body is truncated.")
+        value = self.body[self.offset : self.offset + length]
+        self.offset += length
+        return value
+
+    def varint(self) -> int:
+        value = 0
+        shift = 0
+        while True:
+            byte = self.byte()
+            value |= (byte & 0x7F) << shift
+            if byte < 0x80:
+                return value
+            shift += 7
+            if shift > 63:
+                raise ValueError("Columnar body contains an overlong varint.")
+
+    def zigzag(self) -> int:
+        value = self.varint()
+        return (value >> 1) ^ -(value & 1)
+
+    def text(self) -> str:
+        return self.raw(self.varint()).decode("utf-8")
+
+    def bits(self, count: int) -> int:
+        """Reads `count` bits most significant first, continuing inside the current byte."""
+        value = 0
+        while count > 0:
+            if self.offset >= len(self.body):
+                raise ValueError("Columnar body is truncated.")
+            available = 8 - self.bit
+            take = min(count, available)
+            chunk = (self.body[self.offset] >> (available - take)) & ((1 << take) - 1)
+            value = (value << take) | chunk
+            count -= take
+            self.bit += take
+            if self.bit == 8:
+                self.bit = 0
+                self.offset += 1
+        return value
+
+    def align(self) -> None:
+        """Skips the zero padding at the end of a bitstream."""
+        if self.bit:
+            self.bit = 0
+            self.offset += 1
+
+
+def _read_xor_values(reader: _ColumnReader, count: int) -> List[float]:
+    """Decodes a Gorilla XOR bitstream of 32-bit floats."""
+    previous = reader.bits(32)
+    words = [previous]
+    leading = -1
+    trailing = 0
+
+    for _ in range(count - 1):
+        if reader.bits(1) == 0:
+            words.append(previous)
+            continue
+        if reader.bits(1) == 0:
+            if leading < 0:
+                raise ValueError("Columnar body reuses an undefined XOR window.")
+            meaningful = 32 - leading - trailing
+        else:
+            leading = reader.bits(5)
+            meaningful = reader.bits(5) + 1
+            trailing = 32 - leading - meaningful
+            if trailing < 0:
+                raise ValueError("Columnar body contains an invalid XOR window.")
+        previous ^= reader.bits(meaningful) << trailing
+        words.append(previous)
+
+    reader.align()
+    return list(struct.unpack(f"<{count}f", struct.pack(f"<{count}I", *words)))
+
+
+def decode_sensor_data_columns(body: bytes) -> Tuple[str, List[Tuple[str, List[datetime], List[float]]]]:
+    """Decodes a columnar sensor data batch (`application/x-sensor-columns`).
+
+    The body holds one vehicle serial and one column per sensor type. A column stores its base
+    timestamp and the zigzag varint delta-of-deltas of the following timestamps (microseconds since
+    the Unix epoch), then its values as packed little-endian float32 or as a Gorilla XOR bitstream.
+
+    Args:
+        body (bytes): The raw request body.
+
+    Returns:
+        Tuple[str, List[Tuple[str, List[datetime], List[float]]]]: The vehicle serial and, per column,
+            the sensor type value, the timestamps and the values.
+
+    Raises:
+        ValueError: If the body is not a valid columnar batch.
+    """
+    reader = _ColumnReader(body)
+    if reader.raw(len(_COLUMNAR_MAGIC)) != _COLUMNAR_MAGIC or reader.byte() != _COLUMNAR_VERSION:
+        raise ValueError("Unsupported columnar body version.")
+
+    try:
+        vehicle_serial = reader.text()
+        columns = []
+        for _ in range(reader.varint()):
+            sensor_type = reader.text()
+            count = reader.varint()
+            encoding = reader.byte()
+            if count == 0:
+                raise ValueError("Columnar body contains an empty column.")
+
+            timestamp = reader.varint()
+            delta = 0
+            micros = [timestamp]
+            for _ in range(count - 1):
+                delta += reader.zigzag()
+                timestamp += delta
+                micros.append(timestamp)
+
+            if encoding == _RAW_VALUES:
+                values = list(struct.unpack(f"<{count}f", reader.raw(4 * count)))
+            elif encoding == _XOR_VALUES:
+                values = _read_xor_values(reader, count)
+            else:
+                raise ValueError(f"Unsupported columnar value encoding: {encoding}")
+
+            timestamps = [_EPOCH + timedelta(microseconds=value) for value in micros]
+            columns.append((sensor_type, timestamps, values))
+    except OverflowError as e:
+        raise ValueError(f"Failed to decode columnar body: {e}")
+
+    if reader.offset != len(body):
+        raise ValueError("Columnar body has trailing bytes.")
+    return vehicle_serial, columns
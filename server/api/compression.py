@@ -0,0 +1,101 @@
+import os
+import zlib
+from typing import Callable
+from typing import Union
+
+import zstandard
+from fastapi import HTTPException
+from fastapi import Request
+from fastapi import Response
+from fastapi.routing import APIRoute
+
+# Upper bound for decompressed request bodies, guards against decompression bombs
+MAX_DECOMPRESSED_BYTES = 64 * 1024 * 1024
+
+# Dictionary the vehicle clients compress zstd bodies with, see train_zstd_dictionary.py
+ZSTD_DICTIONARY_PATH = os.environ.get("ZSTD_DICTIONARY_PATH", "server/zstd_sensor_data.dict")
+
+
+def _load_zstd_decompressor() -> zstandard.ZstdDecompressor:
+    """Creates the zstd decompressor, using the shared dictionary if it exists.
+
+    Returns:
+        zstandard.ZstdDecompressor: A decompressor for client request bodies.
+    """
+    if os.path.isfile(ZSTD_DICTIONARY_PATH):
+        with open(ZSTD_DICTIONARY_PATH, "rb") as dictionary_file:
+            return zstandard.ZstdDecompressor(dict_data=zstandard.ZstdCompressionDict(dictionary_file.read()))
+    return zstandard.ZstdDecompressor()
+
+
+_zstd_decompressor = _load_zstd_decompressor()
+
+
+def _gunzip(body: bytes) -> bytes:
+    decompressor = zlib.decompressobj(wbits=zlib.MAX_WBITS | 16)
+    data = decompressor.decompress(body, MAX_DECOMPRESSED_BYTES)
+    if decompressor.unconsumed_tail:
+        raise ValueError("Decompressed body is too large.")
+    if not decompressor.eof:
+        raise ValueError("Gzip body is truncated.")
+    return data
+
+
+def _unzstd(body: bytes) -> bytes:
+    content_size = zstandard.frame_content_size(body)
+    if content_size > MAX_DECOMPRESSED_BYTES:
+        raise ValueError("Decompressed body is too large.")
+    return _zstd_decompressor.decompress(body, max_output_size=MAX_DECOMPRESSED_BYTES)
+
+
+def decompress_body(body: bytes, content_encoding: Union[str, None]) -> bytes:
+    """Undoes the Content-Encoding of a request body.
+
+    Args:
+        body (bytes): The raw request body.
+        content_encoding (str or None): The request's Content-Encoding header value.
+
+    Returns:
+        bytes: The decoded body.
+
+    Raises:
+        ValueError: If the encoding is unsupported or the body cannot be decompressed.
+    """
+    encoding = (content_encoding or "identity").strip().lower()
+
+    try:
+        if encoding == "identity":
+            return body
+        if encoding == "gzip":
+            return _gunzip(body)
+        if encoding == "zstd":
+            return _unzstd(body)
+    except (zlib.error, zstandard.ZstdError) as e:
+        raise ValueError(f"Failed to decompress {encoding} body: {e}")
+
+    raise ValueError(f"Unsupported content encoding: {encoding}")
+
+
+class DecompressingRequest(Request):
+    """Request whose body is transparently decompressed according to its Content-Encoding."""
+
+    async def body(self) -> bytes:
+        if not hasattr(self, "_body"):
+            body = await super().body()
+            try:
+                self._body = decompress_body(body, self.headers.get("content-encoding"))
+            except ValueError as e:
+                raise HTTPException(status_code=400, detail=str(e))
+        return self._body
+
+
+class DecompressingRoute(APIRoute):
+    """Route class that hands every endpoint a `DecompressingRequest`."""
+
+    def get_route_handler(self) -> Callable:
+        original_route_handler = super().get_route_handler()
+
+        async def decompressing_route_handler(request: Request) -> Response:
+            return await original_route_handler(DecompressingRequest(request.scope, request.receive))
+
+        return decompressing_route_handler
@@ -1,8 +1,10 @@
 from datetime import datetime
+from typing import List
 
 from database.datatypes import SensorType
 from database.datatypes import VehicleStatus
 from pydantic import BaseModel
+from pydantic import Field
 
 
 class SensorData(BaseModel):
@@ -12,6 +14,37 @@ class SensorData(BaseModel):
     vehicle_serial: str
 
 
+class SensorReading(BaseModel):
+    sensor_type: SensorType
+    timestamp: datetime
+    sensor_data: float
+
+
+class SensorDataBatch(BaseModel):
+    vehicle_serial: str
+    readings: List[SensorReading]
+
+
 class VehicleStatusData(BaseModel):
     vehicle_serial: str
     vehicle_status: VehicleStatus
+
+
+# Bounds a bulk request well below SQLite's limit on bound parameters per statement
+MAX_BULK_VEHICLES = 10000
+
+
+class VehicleSerialList(BaseModel):
+    vehicle_serials: List[str] = Field(max_length=MAX_BULK_VEHICLES)
+
+
+class VehicleStatusBatch(BaseModel):
+    updates: List[VehicleStatusData] = Field(max_length=MAX_BULK_VEHICLES)
+
+
+# Readings per page of a sensor data query, by default and at most
+DEFAULT_QUERY_PAGE_READINGS = 1000
+MAX_QUERY_PAGE_READINGS = 10000
+
+# Buckets a downsampled sensor data query may return
+MAX_QUERY_BUCKETS = 10000
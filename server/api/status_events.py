@@ -0,0 +1,190 @@
+import asyncio
+import hashlib
+import json
+import threading
+from typing import AsyncIterator
+from typing import Dict
+from typing import Set
+from typing import Tuple
+from typing import Union
+
+# Seconds between keep-alive comments, lets clients tell an idle stream from a dead one
+KEEPALIVE_INTERVAL_SECONDS = 15.0
+
+# Events buffered per subscriber; one that falls further behind is disconnected and has to resync
+SUBSCRIBER_QUEUE_SIZE = 1024
+
+
+def status_etag(status: str) -> str:
+    """Computes the ETag of a vehicle status response.
+
+    The tag only depends on the status value, so it is the same in every server process and after restarts.
+
+    Args:
+        status (str): The status value, e.g. "active".
+
+    Returns:
+        str: A quoted strong ETag.
+    """
+    return '"' + hashlib.blake2b(status.encode(), digest_size=8).hexdigest() + '"'
+
+
+def etag_matches(if_none_match: Union[str, None], etag: str) -> bool:
+    """Checks an If-None-Match request header against the current ETag.
+
+    Args:
+        if_none_match (str or None): The header value, a comma separated list of tags or "*".
+        etag (str): The current ETag of the resource.
+
+    Returns:
+        bool: True if the client's copy is current and a 304 can be sent.
+    """
+    if not if_none_match:
+        return False
+    tags = [tag.strip() for tag in if_none_match.split(",")]
+    return "*" in tags or etag in tags or f"W/{etag}" in tags
+
+
+class VehicleStatusCache:
+    """In-process read-through cache of the latest status of each vehicle.
+
+    Status updates write the new value through, so reads only reach the database on a miss. A miss that races with
+    an update is not cached, which keeps an older database read from overwriting the newer status.
+    """
+
+    def __init__(self):
+        """Initializes an empty cache."""
+        self._lock = threading.Lock()
+        self._entries: Dict[str, Tuple[str, str]] = {}
+        self._updates = 0
+
+    def get(self, vehicle_serial: str) -> Union[Tuple[str, str], None]:
+        """Looks up the cached status of a vehicle.
+
+        Args:
+            vehicle_serial (str): The unique identifier for the vehicle.
+
+        Returns:
+            Tuple[str, str] or None: The status value and its ETag, or None on a miss.
+        """
+        with self._lock:
+            return self._entries.get(vehicle_serial)
+
+    def begin_fill(self) -> int:
+        """Returns a token to pass to fill() after reading a missed status from the database."""
+        with self._lock:
+            return self._updates
+
+    def fill(self, vehicle_serial: str, status: str, token: int) -> str:
+        """Caches a status read from the database, unless an update happened since begin_fill().
+
+        Args:
+            vehicle_serial (str): The unique identifier for the vehicle.
+            status (str): The status value read from the database.
+            token (int): The value begin_fill() returned before the read.
+
+        Returns:
+            str: The ETag of the status.
+        """
+        etag = status_etag(status)
+        with self._lock:
+            if self._updates == token:
+                self._entries[vehicle_serial] = (status, etag)
+        return etag
+
+    def put(self, vehicle_serial: str, status: str) -> str:
+        """Stores a status that was just committed to the database.
+
+        Args:
+            vehicle_serial (str): The unique identifier for the vehicle.
+            status (str): The new status value.
+
+        Returns:
+            str: The ETag of the new status.
+        """
+        etag = status_etag(status)
+        with self._lock:
+            self._updates += 1
+            self._entries[vehicle_serial] = (status, etag)
+        return etag
+
+
+class _Subscriber:
+    """One open event stream, fed from any thread through its event loop."""
+
+    def __init__(self, loop: asyncio.AbstractEventLoop, vehicle_serials: Set[str]):
+        self.loop = loop
+        self.vehicle_serials = vehicle_serials
+        self.queue: asyncio.Queue = asyncio.Queue(maxsize=SUBSCRIBER_QUEUE_SIZE)
+        self.lagged = False
+
+    def wants(self, vehicle_serial: str) -> bool:
+        return not self.vehicle_serials or vehicle_serial in self.vehicle_serials
+
+    def offer(self, event: str):
+        # Runs on the subscriber's loop; a full queue means the client cannot keep up
+        try:
+            self.queue.put_nowait(event)
+        except asyncio.QueueFull:
+            self.lagged = True
+
+
+class StatusEventBroadcaster:
+    """Fans vehicle status changes out to Server-Sent Events streams.
+
+    Every stream starts with a `ready` event. After it, each committed status change of a watched vehicle is sent
+    as a `status` event whose data is `{"vehicle_serial": ..., "vehicle_status": ..., "etag": ...}`. Clients that
+    fall behind are disconnected; they have to revalidate their cached statuses when they reconnect.
+    """
+
+    def __init__(self):
+        """Initializes a broadcaster without subscribers."""
+        self._lock = threading.Lock()
+        self._subscribers: Set[_Subscriber] = set()
+
+    def publish(self, vehicle_serial: str, status: str, etag: str):
+        """Sends a status change to every stream watching the vehicle. Safe to call from any thread.
+
+        Args:
+            vehicle_serial (str): The unique identifier for the vehicle.
+            status (str): The new status value.
+            etag (str): The ETag of the new status.
+        """
+        event = _format_event(
+            "status", json.dumps({"vehicle_serial": vehicle_serial, "vehicle_status": status, "etag": etag})
+        )
+        with self._lock:
+            subscribers = [subscriber for subscriber in self._subscribers if subscriber.wants(vehicle_serial)]
+        for subscriber in subscribers:
+            try:
+                subscriber.loop.call_soon_threadsafe(subscriber.offer, event)
+            except RuntimeError:
+                # The subscriber's loop has already shut down
+                pass
+
+    async def stream(self, vehicle_serials: Set[str]) -> AsyncIterator[str]:
+        """Yields the events of one subscriber until it disconnects or falls behind.
+
+        Args:
+            vehicle_serials (Set[str]): The vehicles to watch, all vehicles if empty.
+
+        Yields:
+            str: Server-Sent Events frames.
+        """
+        subscriber = _Subscriber(asyncio.get_running_loop(), vehicle_serials)
+        with self._lock:
+            self._subscribers.add(subscriber)
+        try:
+            yield _format_event("ready", "{}")
+            while not subscriber.lagged:
+                try:
+                    yield await asyncio.wait_for(subscriber.queue.get(), timeout=KEEPALIVE_INTERVAL_SECONDS)
+                except asyncio.TimeoutError:
+                    yield ": keep-alive\n\n"
+        finally:
+            with self._lock:
+                self._subscribers.discard(subscriber)
+
+
+def _format_event(name: str, data: str) -> str:
+    return f"event: {name}\ndata: {data}\n\n"
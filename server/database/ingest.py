@@ -0,0 +1,238 @@
+import asyncio
+import queue
+import threading
+from concurrent.futures import Future
+from dataclasses import dataclass
+from dataclasses import field
+from typing import Any
+from typing import Callable
+from typing import Dict
+from typing import List
+from typing import Union
+
+from conflog import logger
+from database.repository import ProcessedRequestRepository
+from database.repository import SensorRepository
+from database.repository import VehicleStatusRepository
+from sqlalchemy.orm import Session
+
+# Uploads waiting for the writer; when the queue is full, submit() refuses new ones until it has caught up
+WRITE_QUEUE_SIZE = 4096
+
+# Readings at which the writer stops adding uploads to a group and commits it
+GROUP_COMMIT_MAX_ROWS = 50_000
+
+
+class WriteQueueFull(Exception):
+    """Raised by SensorDataWriter.submit() when the write queue has no room; the upload can be retried later."""
+
+
+@dataclass
+class SensorUpload:
+    """One sensor upload waiting in the write queue.
+
+    The future resolves to the number of recorded readings, to None if an upload with the same idempotency key
+    was recorded before, or to the ValueError that rejected the upload.
+    """
+
+    vehicle_serial: str
+    rows: List[Dict[str, Any]]
+    idempotency_key: Union[str, None]
+    future: Future = field(default_factory=Future)
+
+
+class SensorDataWriter:
+    """Write-behind queue that records the sensor uploads of many requests in one transaction.
+
+    Request handlers hand their rows to submit() and wait for the returned future. A single writer thread takes
+    everything that queued up while the previous transaction was committing and records it as one group: one query
+    checks the vehicles, one query the idempotency keys, one executemany inserts the rows and one commit makes
+    them durable. Futures resolve only after that commit, so an acknowledged upload is never lost. If a group
+    fails, its uploads are retried one by one, so a bad upload cannot fail the others. Uploads whose future was
+    cancelled before the writer took them, e.g. because the request was abandoned, are skipped.
+    """
+
+    def __init__(
+        self,
+        session_factory: Callable[[], Session],
+        sensor_repository: SensorRepository,
+        vehicle_status_repository: VehicleStatusRepository,
+        processed_request_repository: ProcessedRequestRepository,
+        queue_size: int = WRITE_QUEUE_SIZE,
+        max_group_rows: int = GROUP_COMMIT_MAX_ROWS,
+    ):
+        """Initializes a stopped writer.
+
+        Args:
+            session_factory (Callable[[], Session]): Creates the sessions the writer thread commits with.
+            sensor_repository (SensorRepository): The repository for sensor data.
+            vehicle_status_repository (VehicleStatusRepository): The repository for vehicle status data.
+            processed_request_repository (ProcessedRequestRepository): The repository for idempotency keys.
+            queue_size (int): Uploads that may wait for the writer.
+            max_group_rows (int): Readings at which a group is committed even if more uploads are waiting.
+        """
+        self.session_factory = session_factory
+        self.sensor_repository = sensor_repository
+        self.vehicle_status_repository = vehicle_status_repository
+        self.processed_request_repository = processed_request_repository
+        self.max_group_rows = max_group_rows
+        self.logger = logger.getChild(self.__class__.__name__)
+
+        self._queue: queue.Queue = queue.Queue(maxsize=queue_size)
+        self._lock = threading.Lock()
+        self._thread: Union[threading.Thread, None] = None
+        self._stopped = False
+        self.groups_committed = 0
+
+    def start(self):
+        """Starts the writer thread. Uploads submitted before are recorded first, as one group."""
+        with self._lock:
+            if self._thread is not None or self._stopped:
+                return
+            self._thread = threading.Thread(target=self._run, name="sensor-data-writer", daemon=True)
+            self._thread.start()
+
+    def stop(self):
+        """Stops accepting uploads and returns once every queued upload has been recorded."""
+        with self._lock:
+            thread, self._thread = self._thread, None
+            self._stopped = True
+        if thread is not None:
+            self._queue.put(None)
+            thread.join()
+
+    def submit(self, vehicle_serial: str, rows: List[Dict[str, Any]], idempotency_key: Union[str, None]) -> Future:
+        """Queues the rows of one upload.
+
+        Args:
+            vehicle_serial (str): The unique identifier for the vehicle.
+            rows (List[Dict[str, Any]]): Rows as built by SensorRepository.sensor_data_rows.
+            idempotency_key (str or None): The key sent with the upload.
+
+        Returns:
+            Future: Resolves to the number of recorded readings, or to None if the upload was recorded before.
+
+        Raises:
+            WriteQueueFull: If the queue has no room or the writer was stopped.
+        """
+        upload = SensorUpload(vehicle_serial, rows, idempotency_key)
+        with self._lock:
+            if self._stopped:
+                raise WriteQueueFull("Sensor data writer was stopped")
+            try:
+                self._queue.put_nowait(upload)
+            except queue.Full:
+                raise WriteQueueFull("Sensor data write queue is full")
+        return upload.future
+
+    async def record(
+        self, vehicle_serial: str, rows: List[Dict[str, Any]], idempotency_key: Union[str, None]
+    ) -> Union[int, None]:
+        """Queues the rows of one upload and waits until they are committed, without blocking the event loop.
+
+        Args:
+            vehicle_serial (str): The unique identifier for the vehicle.
+            rows (List[Dict[str, Any]]): Rows as built by SensorRepository.sensor_data_rows.
+            idempotency_key (str or None): The key sent with the upload.
+
+        Returns:
+            int or None: The number of recorded readings, or None if the upload was recorded before.
+
+        Raises:
+            WriteQueueFull: If the queue has no room.
+            ValueError: If the vehicle is not registered or the rows could not be stored.
+        """
+        return await asyncio.wrap_future(self.submit(vehicle_serial, rows, idempotency_key))
+
+    def _run(self):
+        stopping = False
+        while not stopping:
+            group = []
+            upload = self._queue.get()
+            group_rows = 0
+            # Everything that arrived during the last commit goes into this one
+            while True:
+                if upload is None:
+                    stopping = True
+                    break
+                # Once running, the future can no longer be cancelled, so resolving it cannot fail
+                if upload.future.set_running_or_notify_cancel():
+                    group.append(upload)
+                    group_rows += len(upload.rows)
+                    if group_rows >= self.max_group_rows:
+                        break
+                try:
+                    upload = self._queue.get_nowait()
+                except queue.Empty:
+                    break
+            if group:
+                self._write_safely(group)
+
+    def _write_safely(self, group: List[SensorUpload]):
+        # An error escaping here would end the thread, and every later upload would wait forever
+        try:
+            self._write(group)
+        except Exception as e:
+            self.logger.error(f"Failed to record a group of {len(group)} uploads: {e}")
+            for upload in group:
+                if not upload.future.done():
+                    upload.future.set_exception(ValueError("Failed to add sensor data."))
+
+    def _write(self, group: List[SensorUpload]):
+        try:
+            outcomes = self._commit(group)
+        except Exception as e:
+            if len(group) > 1:
+                self.logger.warning(f"Group commit of {len(group)} uploads failed, recording them one by one: {e}")
+                for upload in group:
+                    self._write([upload])
+                return
+            self.logger.error(f"Failed to record sensor data of vehicle {group[0].vehicle_serial}: {e}")
+            outcomes = [ValueError("Failed to add sensor data.")]
+
+        for upload, outcome in zip(group, outcomes):
+            if isinstance(outcome, Exception):
+                upload.future.set_exception(outcome)
+            else:
+                upload.future.set_result(outcome)
+
+    def _commit(self, group: List[SensorUpload]) -> List[Union[int, None, ValueError]]:
+        session = self.session_factory()
+        try:
+            registered = self.vehicle_status_repository.get_statuses_of_vehicles(
+                list({upload.vehicle_serial for upload in group}), session
+            )
+            processed = self.processed_request_repository.get_processed_keys(
+                list({upload.idempotency_key for upload in group if upload.idempotency_key}), session
+            )
+
+            rows = []
+            outcomes: List[Union[int, None, ValueError]] = []
+            for upload in group:
+                if upload.vehicle_serial not in registered:
+                    outcomes.append(
+                        ValueError(f"Cannot get vehicle status: Vehicle {upload.vehicle_serial} not registered")
+                    )
+                    continue
+                if upload.idempotency_key:
+                    # A resend can share the group with the upload it repeats
+                    if upload.idempotency_key in processed:
+                        outcomes.append(None)
+                        continue
+                    processed.add(upload.idempotency_key)
+                    self.processed_request_repository.mark_processed(
+                        upload.idempotency_key, upload.vehicle_serial, session
+                    )
+                rows.extend(upload.rows)
+                outcomes.append(len(upload.rows))
+
+            self.sensor_repository.insert_sensor_data_rows(rows, session)
+            session.commit()
+            self.groups_committed += 1
+            self.logger.debug(f"Committed {len(rows)} sensor data entries of {len(group)} uploads")
+            return outcomes
+        except Exception:
+            session.rollback()
+            raise
+        finally:
+            session.close()
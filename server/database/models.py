@@ -6,8 +6,10 @@ from sqlalchemy import create_engine
 from sqlalchemy import DateTime
 from sqlalchemy import Enum
 from sqlalchemy import Float
+from sqlalchemy import Index
 from sqlalchemy import Integer
 from sqlalchemy import String
+from sqlalchemy.engine import Engine
 from sqlalchemy.orm import declarative_base
 
 Base = declarative_base()
@@ -26,6 +28,8 @@ class SensorData(Base):
     """
 
     __tablename__ = "sensor_data"
+    # Serves time-range queries of one sensor of a vehicle, in timestamp order, without a table scan
+    __table_args__ = (Index("ix_sensor_data_vehicle_sensor_time", "vehicle_serial", "sensor_type", "timestamp"),)
     id = Column(Integer, primary_key=True)
     vehicle_serial = Column(String, nullable=False)
     sensor_type = Column(Enum(SensorType), nullable=False)
@@ -51,6 +55,21 @@ class VehicleStatusData(Base):
     timestamp = Column(DateTime, default=pendulum.now("UTC"), onupdate=pendulum.now("UTC"))
 
 
+class ProcessedRequest(Base):
+    """Remembers recorded sensor uploads by their idempotency key, so a resent copy is not recorded twice.
+
+    Attributes:
+        idempotency_key (str): The key sent by the client in the `Idempotency-Key` header.
+        vehicle_serial (str): Unique identifier of the vehicle that sent the upload.
+        timestamp (datetime): Time the upload was recorded.
+    """
+
+    __tablename__ = "processed_requests"
+    idempotency_key = Column(String, primary_key=True)
+    vehicle_serial = Column(String, nullable=False)
+    timestamp = Column(DateTime)
+
+
 def create_database(database_name: str = "vehicle_data"):
     """Creates the SQLite database for storing vehicle and sensor data.
 
@@ -63,3 +82,17 @@ def create_database(database_name: str = "vehicle_data"):
     """
     engine = create_engine(f"sqlite:///{database_name}.db")
     Base.metadata.create_all(engine)
+    create_missing_indexes(engine)
+
+
+def create_missing_indexes(engine: Engine):
+    """Creates indexes that were added to the models after their tables were created.
+
+    `create_all` only creates the indexes of new tables, so databases created before an index existed get it here.
+
+    Args:
+        engine (Engine): The engine of the database.
+    """
+    for table in Base.metadata.sorted_tables:
+        for index in table.indexes:
+            index.create(engine, checkfirst=True)
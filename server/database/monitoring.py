@@ -2,12 +2,15 @@ from datetime import datetime
 from typing import Any
 from typing import Dict
 from typing import List
+from typing import Tuple
+from typing import Union
 
 from conflog import logger
 from database.datatypes import SensorType
 from database.datatypes import VehicleStatus
 from database.models import SensorData
 from database.models import VehicleStatusData
+from database.repository import ProcessedRequestRepository
 from database.repository import SensorRepository
 from database.repository import VehicleStatusRepository
 from sqlalchemy.orm import Session
@@ -16,15 +19,22 @@ from sqlalchemy.orm import Session
 class VehicleDataManager:
     """Manages vehicle data in the relevent databases for vehicle registration, status updates, and sensor data records."""
 
-    def __init__(self, sensor_data_repository: SensorRepository, vehicle_status_repository: VehicleStatusRepository):
-        """Initializes VehicleDataManager with repositories for sensor data and vehicle status.
+    def __init__(
+        self,
+        sensor_data_repository: SensorRepository,
+        vehicle_status_repository: VehicleStatusRepository,
+        processed_request_repository: ProcessedRequestRepository,
+    ):
+        """Initializes VehicleDataManager with repositories for sensor data, vehicle status and processed uploads.
 
         Args:
             sensor_data_repository (SensorRepository): The repository for sensor data.
             vehicle_status_repository (VehicleStatusRepository): The repository for vehicle status data.
+            processed_request_repository (ProcessedRequestRepository): The repository for idempotency keys.
         """
         self.sensor_data_repository = sensor_data_repository
         self.vehicle_status_repository = vehicle_status_repository
+        self.processed_request_repository = processed_request_repository
         self.logger = logger.getChild(self.__class__.__name__)
 
     def register_new_vehicle_and_initialize_status(self, vehicle_serial: str, session: Session) -> bool:
@@ -52,6 +62,39 @@ class VehicleDataManager:
         """
         return self.vehicle_status_repository.update_status_of_particular_vehicle(vehicle_serial, new_status, session)
 
+    def update_vehicle_statuses(self, updates: List[Tuple[str, VehicleStatus]], session: Session) -> List[str]:
+        """Updates the statuses of many vehicles in one transaction.
+
+        Args:
+            updates (List[Tuple[str, VehicleStatus]]): Pairs of vehicle serial number and new status.
+            session (Session): SQLAlchemy session for database transactions.
+
+        Returns:
+            List[str]: The serials that are not registered and were skipped.
+        """
+        unknown = self.vehicle_status_repository.update_statuses_of_vehicles(updates, session)
+        self.logger.debug(f"Applied {len(updates)} status updates, {len(unknown)} vehicles not registered")
+        return unknown
+
+    def claim_idempotency_key(self, idempotency_key: str, vehicle_serial: str, session: Session) -> bool:
+        """Claims the idempotency key of a sensor upload before its data is recorded.
+
+        The claim is committed together with the sensor data, so a failed upload can be resent with the same key.
+
+        Args:
+            idempotency_key (str): The key sent with the upload.
+            vehicle_serial (str): The unique identifier for the vehicle.
+            session (Session): SQLAlchemy session for database transactions.
+
+        Returns:
+            bool: False if an upload with this key was already recorded and must be skipped, True otherwise.
+        """
+        if self.processed_request_repository.is_processed(idempotency_key, session):
+            self.logger.debug(f"Skipping resent upload {idempotency_key} of vehicle {vehicle_serial}")
+            return False
+        self.processed_request_repository.mark_processed(idempotency_key, vehicle_serial, session)
+        return True
+
     def record_sensor_data_for_vehicle(
         self, vehicle_serial: str, sensor_type: SensorType, value: float, timestamp: datetime, session: Session
     ) -> SensorData:
@@ -75,6 +118,49 @@ class VehicleDataManager:
 
         return self.sensor_data_repository.insert_sensor_data_entry(sensor_data, session)
 
+    def record_sensor_data_batch_for_vehicle(
+        self, vehicle_serial: str, readings: List[Tuple[SensorType, float, datetime]], session: Session
+    ) -> List[SensorData]:
+        """Records a batch of sensor data for a specific vehicle in a single transaction.
+
+        Args:
+            vehicle_serial (str): The unique identifier for the vehicle.
+            readings (List[Tuple[SensorType, float, datetime]]): Sensor type, value and timestamp of each reading.
+            session (Session): SQLAlchemy session for database transactions.
+
+        Returns:
+            List[SensorData]: The recorded sensor data entries.
+        """
+        self.logger.debug(f"Recording {len(readings)} sensor data entries for vehicle {vehicle_serial}")
+        # First check if vehicle exists
+        self.vehicle_status_repository.get_vehicle_status(vehicle_serial, session)
+        sensor_data = [
+            SensorData(vehicle_serial=vehicle_serial, sensor_type=sensor_type, value=value, timestamp=timestamp)
+            for sensor_type, value, timestamp in readings
+        ]
+
+        return self.sensor_data_repository.insert_sensor_data_entries(sensor_data, session)
+
+    def record_sensor_data_columns_for_vehicle(
+        self, vehicle_serial: str, columns: List[Tuple[SensorType, List[datetime], List[float]]], session: Session
+    ) -> int:
+        """Records columnar sensor data for a specific vehicle with a single bulk insert.
+
+        Args:
+            vehicle_serial (str): The unique identifier for the vehicle.
+            columns (List[Tuple[SensorType, List[datetime], List[float]]]): Sensor type, timestamps and values
+                of each column.
+            session (Session): SQLAlchemy session for database transactions.
+
+        Returns:
+            int: The number of recorded sensor data entries.
+        """
+        self.logger.debug(f"Recording {len(columns)} sensor data columns for vehicle {vehicle_serial}")
+        # First check if vehicle exists
+        self.vehicle_status_repository.get_vehicle_status(vehicle_serial, session)
+
+        return self.sensor_data_repository.insert_sensor_data_columns(vehicle_serial, columns, session)
+
     def fetch_specific_sensor_data_for_vehicle(
         self, vehicle_serial: str, sensor_type: SensorType, session: Session
     ) -> Dict[str, Any]:
@@ -91,6 +177,67 @@ class VehicleDataManager:
         self.logger.debug(f"Fetching {sensor_type} sensor data for vehicle {vehicle_serial}")
         return self.sensor_data_repository.fetch_specific_sensor_data_for_vehicle(vehicle_serial, sensor_type, session)
 
+    def query_sensor_data_for_vehicle(
+        self,
+        vehicle_serial: str,
+        sensor_type: SensorType,
+        start: Union[datetime, None],
+        end: Union[datetime, None],
+        after: Union[Tuple[datetime, int], None],
+        limit: int,
+        session: Session,
+    ) -> List[Tuple[int, datetime, float]]:
+        """Fetches one page of a vehicle's sensor readings in a time range, oldest first.
+
+        Args:
+            vehicle_serial (str): The unique identifier for the vehicle.
+            sensor_type (SensorType): The type of sensor to retrieve data for.
+            start (datetime or None): First timestamp included, unbounded if None.
+            end (datetime or None): First timestamp excluded, unbounded if None.
+            after (Tuple[datetime, int] or None): Timestamp and id of the last reading of the previous page.
+            limit (int): The most readings to return.
+            session (Session): SQLAlchemy session for database transactions.
+
+        Returns:
+            List[Tuple[int, datetime, float]]: Id, timestamp and value of each reading.
+        """
+        self.logger.debug(f"Querying {sensor_type} sensor data for vehicle {vehicle_serial}, up to {limit} readings")
+        # First check if vehicle exists, so an unknown serial is not mistaken for an empty range
+        self.vehicle_status_repository.get_vehicle_status(vehicle_serial, session)
+        return self.sensor_data_repository.query_sensor_data_page(
+            vehicle_serial, sensor_type, start, end, after, limit, session
+        )
+
+    def downsample_sensor_data_for_vehicle(
+        self,
+        vehicle_serial: str,
+        sensor_type: SensorType,
+        start: datetime,
+        end: datetime,
+        bucket_seconds: int,
+        session: Session,
+    ) -> List[Tuple[int, int, float, float, float]]:
+        """Aggregates a vehicle's sensor readings in a time range into buckets of minimum, maximum and average.
+
+        Args:
+            vehicle_serial (str): The unique identifier for the vehicle.
+            sensor_type (SensorType): The type of sensor to aggregate.
+            start (datetime): First timestamp included.
+            end (datetime): First timestamp excluded.
+            bucket_seconds (int): Width of a bucket in seconds.
+            session (Session): SQLAlchemy session for database transactions.
+
+        Returns:
+            List[Tuple[int, int, float, float, float]]: Bucket number, count, minimum, maximum and average of each
+                bucket with readings.
+        """
+        self.logger.debug(f"Downsampling {sensor_type} sensor data for vehicle {vehicle_serial} to {bucket_seconds}s")
+        # First check if vehicle exists
+        self.vehicle_status_repository.get_vehicle_status(vehicle_serial, session)
+        return self.sensor_data_repository.downsample_sensor_data(
+            vehicle_serial, sensor_type, start, end, bucket_seconds, session
+        )
+
     def fetch_all_sensor_data_for_vehicle(self, vehicle_serial: str, session: Session):
         """Fetches all sensor data for a specific vehicle.
 
@@ -119,6 +266,19 @@ class VehicleDataManager:
         self.logger.debug(f"Retrieving status for vehicle {vehicle_serial}")
         return self.vehicle_status_repository.get_vehicle_status(vehicle_serial, session)
 
+    def retrieve_vehicle_statuses(self, vehicle_serials: List[str], session: Session) -> Dict[str, VehicleStatus]:
+        """Retrieves the current statuses of many vehicles with a single query.
+
+        Args:
+            vehicle_serials (List[str]): The unique identifiers of the vehicles.
+            session (Session): SQLAlchemy session for database transactions.
+
+        Returns:
+            Dict[str, VehicleStatus]: The status of each registered vehicle; unregistered serials are left out.
+        """
+        self.logger.debug(f"Retrieving statuses for {len(vehicle_serials)} vehicles")
+        return self.vehicle_status_repository.get_statuses_of_vehicles(vehicle_serials, session)
+
     def retrieve_all_vehicle_serial_numbers(self, session: Session) -> List[str]:
         """Retrieves a list of all vehicle serial numbers in the database.
 
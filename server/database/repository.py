@@ -1,18 +1,36 @@
+from datetime import datetime
+from datetime import timedelta
+from datetime import timezone
 from typing import Any
 from typing import Dict
 from typing import List
+from typing import Set
+from typing import Tuple
 from typing import Union
 
 import pendulum
 from conflog import logger
 from database.datatypes import SensorType
 from database.datatypes import VehicleStatus
+from database.models import ProcessedRequest
 from database.models import SensorData
 from database.models import VehicleStatusData
+from sqlalchemy import and_
+from sqlalchemy import bindparam
+from sqlalchemy import cast
+from sqlalchemy import extract
+from sqlalchemy import func
+from sqlalchemy import insert
+from sqlalchemy import Integer
+from sqlalchemy import or_
+from sqlalchemy import select
+from sqlalchemy import update
 from sqlalchemy.exc import NoResultFound
 from sqlalchemy.exc import SQLAlchemyError
 from sqlalchemy.orm import Session
 
+EPOCH = datetime(1970, 1, 1, tzinfo=timezone.utc)
+
 
 class SensorRepository:
     """Repository for managing SensorData entries in the database."""
@@ -38,6 +56,106 @@ class SensorRepository:
             session.rollback()
             raise ValueError("Failed to add sensor data.")
 
+    def insert_sensor_data_entries(self, items: List[SensorData], session: Session) -> List[SensorData]:
+        """Adds several SensorData entries to the database in a single commit.
+
+        Args:
+            items (List[SensorData]): The sensor data entries to add.
+            session (Session): The SQLAlchemy session object.
+
+        Returns:
+            List[SensorData]: The added sensor data entries.
+        """
+        try:
+            session.add_all(items)
+            session.commit()
+            return items
+        except SQLAlchemyError:
+            session.rollback()
+            raise ValueError("Failed to add sensor data batch.")
+
+    def insert_sensor_data_columns(
+        self, vehicle_serial: str, columns: List[Tuple[SensorType, List[datetime], List[float]]], session: Session
+    ) -> int:
+        """Bulk-inserts columnar sensor data of one vehicle in a single executemany and commit.
+
+        Rows are inserted without building ORM objects, which keeps large high-rate batches cheap.
+
+        Args:
+            vehicle_serial (str): The serial number of the vehicle.
+            columns (List[Tuple[SensorType, List[datetime], List[float]]]): Sensor type, timestamps and values
+                of each column.
+            session (Session): The SQLAlchemy session object.
+
+        Returns:
+            int: The number of inserted entries.
+        """
+        rows = self.sensor_data_rows_from_columns(vehicle_serial, columns)
+        if not rows:
+            return 0
+
+        try:
+            self.insert_sensor_data_rows(rows, session)
+            session.commit()
+            return len(rows)
+        except SQLAlchemyError:
+            session.rollback()
+            raise ValueError("Failed to add sensor data columns.")
+
+    def insert_sensor_data_rows(self, rows: List[Dict[str, Any]], session: Session) -> int:
+        """Bulk-inserts sensor data rows with a single executemany, without committing.
+
+        The caller commits, so rows of many uploads can share one transaction.
+
+        Args:
+            rows (List[Dict[str, Any]]): Rows with `vehicle_serial`, `sensor_type`, `value` and `timestamp` keys.
+            session (Session): The SQLAlchemy session object.
+
+        Returns:
+            int: The number of inserted entries.
+        """
+        if rows:
+            session.execute(insert(SensorData), rows)
+        return len(rows)
+
+    @staticmethod
+    def sensor_data_rows(
+        vehicle_serial: str, readings: List[Tuple[SensorType, float, datetime]]
+    ) -> List[Dict[str, Any]]:
+        """Builds insert rows from sensor readings of one vehicle.
+
+        Args:
+            vehicle_serial (str): The serial number of the vehicle.
+            readings (List[Tuple[SensorType, float, datetime]]): Sensor type, value and timestamp of each reading.
+
+        Returns:
+            List[Dict[str, Any]]: Rows for insert_sensor_data_rows.
+        """
+        return [
+            {"vehicle_serial": vehicle_serial, "sensor_type": sensor_type, "value": value, "timestamp": timestamp}
+            for sensor_type, value, timestamp in readings
+        ]
+
+    @staticmethod
+    def sensor_data_rows_from_columns(
+        vehicle_serial: str, columns: List[Tuple[SensorType, List[datetime], List[float]]]
+    ) -> List[Dict[str, Any]]:
+        """Builds insert rows from columnar sensor data of one vehicle.
+
+        Args:
+            vehicle_serial (str): The serial number of the vehicle.
+            columns (List[Tuple[SensorType, List[datetime], List[float]]]): Sensor type, timestamps and values
+                of each column.
+
+        Returns:
+            List[Dict[str, Any]]: Rows for insert_sensor_data_rows.
+        """
+        return [
+            {"vehicle_serial": vehicle_serial, "sensor_type": sensor_type, "value": value, "timestamp": timestamp}
+            for sensor_type, timestamps, values in columns
+            for timestamp, value in zip(timestamps, values)
+        ]
+
     def fetch_specific_sensor_data_for_vehicle(
         self, vehicle_serial: str, sensor_type: SensorType, session: Session
     ) -> Dict[str, Any]:
@@ -83,6 +201,113 @@ class SensorRepository:
         """
         return session.query(VehicleStatusData).filter_by(vehicle_serial=vehicle_serial).first() is not None
 
+    def query_sensor_data_page(
+        self,
+        vehicle_serial: str,
+        sensor_type: SensorType,
+        start: Union[datetime, None],
+        end: Union[datetime, None],
+        after: Union[Tuple[datetime, int], None],
+        limit: int,
+        session: Session,
+    ) -> List[Tuple[int, datetime, float]]:
+        """Fetches one page of a sensor's readings in a time range, oldest first.
+
+        Pages are cut by keyset: the next page starts after the timestamp and id of the last row, so each page is
+        one range scan of the `(vehicle_serial, sensor_type, timestamp)` index however deep into the data it is.
+
+        Args:
+            vehicle_serial (str): The serial number of the vehicle.
+            sensor_type (SensorType): The type of sensor data to retrieve.
+            start (datetime or None): First timestamp included, unbounded if None.
+            end (datetime or None): First timestamp excluded, unbounded if None.
+            after (Tuple[datetime, int] or None): Timestamp and id of the last row of the previous page.
+            limit (int): The most rows to return.
+            session (Session): The SQLAlchemy session object.
+
+        Returns:
+            List[Tuple[int, datetime, float]]: Id, timestamp and value of each reading.
+        """
+        query = select(SensorData.id, SensorData.timestamp, SensorData.value).where(
+            SensorData.vehicle_serial == vehicle_serial,
+            SensorData.sensor_type == sensor_type,
+            SensorData.timestamp.is_not(None),
+        )
+        if start is not None:
+            query = query.where(SensorData.timestamp >= self._as_stored_timestamp(start))
+        if end is not None:
+            query = query.where(SensorData.timestamp < self._as_stored_timestamp(end))
+        if after is not None:
+            after_timestamp = self._as_stored_timestamp(after[0])
+            query = query.where(
+                or_(
+                    SensorData.timestamp > after_timestamp,
+                    and_(SensorData.timestamp == after_timestamp, SensorData.id > after[1]),
+                )
+            )
+        rows = session.execute(query.order_by(SensorData.timestamp, SensorData.id).limit(limit)).all()
+        return [(row_id, timestamp, value) for row_id, timestamp, value in rows]
+
+    def downsample_sensor_data(
+        self,
+        vehicle_serial: str,
+        sensor_type: SensorType,
+        start: datetime,
+        end: datetime,
+        bucket_seconds: int,
+        session: Session,
+    ) -> List[Tuple[int, int, float, float, float]]:
+        """Aggregates a sensor's readings in a time range into fixed-width buckets inside the database.
+
+        Buckets are counted from `start`, cut to whole seconds. Buckets without readings are left out.
+
+        Args:
+            vehicle_serial (str): The serial number of the vehicle.
+            sensor_type (SensorType): The type of sensor data to aggregate.
+            start (datetime): First timestamp included.
+            end (datetime): First timestamp excluded.
+            bucket_seconds (int): Width of a bucket in seconds.
+            session (Session): The SQLAlchemy session object.
+
+        Returns:
+            List[Tuple[int, int, float, float, float]]: Bucket number, count, minimum, maximum and average of each
+                bucket with readings, in bucket order.
+        """
+        start = self._as_stored_timestamp(start)
+        start_second = (start.replace(tzinfo=timezone.utc) - EPOCH) // timedelta(seconds=1)
+        elapsed = self._epoch_seconds(SensorData.timestamp, session) - start_second
+        bucket = (elapsed // bucket_seconds).label("bucket")
+        value = SensorData.value
+        rows = session.execute(
+            select(bucket, func.count(), func.min(value), func.max(value), func.avg(value))
+            .where(
+                SensorData.vehicle_serial == vehicle_serial,
+                SensorData.sensor_type == sensor_type,
+                SensorData.timestamp >= start,
+                SensorData.timestamp < self._as_stored_timestamp(end),
+            )
+            .group_by(bucket)
+            .order_by(bucket)
+        ).all()
+        return [
+            (int(number), count, minimum, maximum, float(average))
+            for number, count, minimum, maximum, average in rows
+        ]
+
+    @staticmethod
+    def _as_stored_timestamp(timestamp: datetime) -> datetime:
+        """Converts a timestamp to naive UTC, the form readings are stored in and compared as."""
+        if timestamp.tzinfo is None:
+            return timestamp
+        return timestamp.astimezone(timezone.utc).replace(tzinfo=None)
+
+    @staticmethod
+    def _epoch_seconds(column, session: Session):
+        """Returns an SQL expression for the whole seconds since the Unix epoch of a timestamp column."""
+        if session.get_bind().dialect.name == "sqlite":
+            return cast(func.strftime("%s", column), Integer)
+        return cast(func.floor(extract("epoch", column)), Integer)
+
     def fetch_all_sensor_data_for_vehicle(self, vehicle_serial: str, session: Session) -> Dict[str, Any]:
         """Fetches all sensor data for a vehicle.
 
@@ -257,6 +482,60 @@ class VehicleStatusRepository:
         except NoResultFound:
             raise ValueError(f"Vehicle with serial number {vehicle_serial} not found!")
 
+    def get_statuses_of_vehicles(self, vehicle_serials: List[str], session: Session) -> Dict[str, VehicleStatus]:
+        """Retrieves the statuses of many vehicles with a single query.
+
+        Args:
+            vehicle_serials (List[str]): The serial numbers of the vehicles.
+            session (Session): The SQLAlchemy session object.
+
+        Returns:
+            Dict[str, VehicleStatus]: The status of each registered vehicle; unregistered serials are left out.
+        """
+        rows = (
+            session.query(VehicleStatusData.vehicle_serial, VehicleStatusData.status)
+            .filter(VehicleStatusData.vehicle_serial.in_(vehicle_serials))
+            .all()
+        )
+        return {vehicle_serial: status for vehicle_serial, status in rows}
+
+    def update_statuses_of_vehicles(self, updates: List[Tuple[str, VehicleStatus]], session: Session) -> List[str]:
+        """Updates the statuses of many vehicles in one transaction.
+
+        The registered vehicles are looked up with one query and updated with one executemany statement. If a
+        serial appears more than once, its last status wins.
+
+        Args:
+            updates (List[Tuple[str, VehicleStatus]]): Pairs of vehicle serial number and new status.
+            session (Session): The SQLAlchemy session object.
+
+        Returns:
+            List[str]: The serials that are not registered and were not updated.
+        """
+        registered = set(self.get_statuses_of_vehicles([vehicle_serial for vehicle_serial, _ in updates], session))
+        now = pendulum.now("UTC")
+        parameters = [
+            {"serial": vehicle_serial, "new_status": new_status, "updated_at": now}
+            for vehicle_serial, new_status in updates
+            if vehicle_serial in registered
+        ]
+
+        try:
+            if parameters:
+                table = VehicleStatusData.__table__
+                session.execute(
+                    update(table)
+                    .where(table.c.vehicle_serial == bindparam("serial"))
+                    .values(status=bindparam("new_status"), timestamp=bindparam("updated_at")),
+                    parameters,
+                )
+            session.commit()
+        except SQLAlchemyError:
+            session.rollback()
+            raise ValueError("Failed to update vehicle statuses.")
+
+        return list(dict.fromkeys(vehicle_serial for vehicle_serial, _ in updates if vehicle_serial not in registered))
+
     def get_all_vehicles(self, session: Session) -> List[str]:
         vehicles = session.query(VehicleStatusData).all()
         vehicles = self._format_all_vehicle_serial_number(vehicles)
@@ -265,3 +544,56 @@ class VehicleStatusRepository:
     @staticmethod
     def _format_all_vehicle_serial_number(vehicles: List[VehicleStatusData]) -> List[str]:
         return [str(vehicle.vehicle_serial) for vehicle in vehicles]
+
+
+class ProcessedRequestRepository:
+    """Repository for managing ProcessedRequest entries in the database."""
+
+    def __init__(self) -> None:
+        self.logger = logger.getChild(self.__class__.__name__)
+
+    def is_processed(self, idempotency_key: str, session: Session) -> bool:
+        """Checks if an upload with this idempotency key was already recorded.
+
+        Args:
+            idempotency_key (str): The key sent with the upload.
+            session (Session): The SQLAlchemy session object.
+
+        Returns:
+            bool: True if the key is known, False otherwise.
+        """
+        return session.get(ProcessedRequest, idempotency_key) is not None
+
+    def get_processed_keys(self, idempotency_keys: List[str], session: Session) -> Set[str]:
+        """Looks up which of many idempotency keys were already recorded, with a single query.
+
+        Args:
+            idempotency_keys (List[str]): The keys sent with the uploads.
+            session (Session): The SQLAlchemy session object.
+
+        Returns:
+            Set[str]: The known keys.
+        """
+        if not idempotency_keys:
+            return set()
+        rows = (
+            session.query(ProcessedRequest.idempotency_key)
+            .filter(ProcessedRequest.idempotency_key.in_(idempotency_keys))
+            .all()
+        )
+        return {idempotency_key for idempotency_key, in rows}
+
+    def mark_processed(self, idempotency_key: str, vehicle_serial: str, session: Session) -> None:
+        """Adds the key of an upload to the session without committing.
+
+        The entry is committed together with the recorded sensor data, so either both are stored or neither is.
+
+        Args:
+            idempotency_key (str): The key sent with the upload.
+            vehicle_serial (str): The serial number of the vehicle.
+            session (Session): The SQLAlchemy session object.
+        """
+        processed_request = ProcessedRequest(
+            idempotency_key=idempotency_key, vehicle_serial=vehicle_serial, timestamp=pendulum.now("UTC")
+        )
+        session.add(processed_request)
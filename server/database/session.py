@@ -1,10 +1,35 @@
 from sqlalchemy import create_engine
+from sqlalchemy import event
+from sqlalchemy.engine import make_url
 from sqlalchemy.orm import sessionmaker
 
+# Connections kept open per engine, and how many more may be opened under load; together they cover the
+# threads FastAPI runs synchronous endpoints on
+POOL_SIZE = 10
+POOL_MAX_OVERFLOW = 30
+
+# Milliseconds a SQLite connection waits for another one's write lock before it fails
+SQLITE_BUSY_TIMEOUT_MS = 5000
+
+
+def _configure_sqlite_connection(dbapi_connection, connection_record):
+    """Switches a new SQLite connection to write-ahead logging.
+
+    With WAL, readers do not block the writer and a commit appends to the log instead of rewriting pages.
+    `synchronous` stays at its default, so acknowledged uploads survive a power loss; the group commit of the
+    sensor data writer keeps the number of syncs low.
+    """
+    cursor = dbapi_connection.cursor()
+    cursor.execute("PRAGMA journal_mode=WAL")
+    cursor.execute(f"PRAGMA busy_timeout={SQLITE_BUSY_TIMEOUT_MS}")
+    cursor.close()
+
 
 class DatabaseSession:
     """Manages database connections and provides session instances.
 
+    The engine keeps a pool of connections, so a single DatabaseSession should be created per process and shared.
+
     Attributes:
         engine (Engine): SQLAlchemy engine connected to the database.
         SessionLocal (sessionmaker): Factory for creating new SQLAlchemy sessions.
@@ -16,10 +41,24 @@ class DatabaseSession:
     def __init__(self, connection_string: str):
         """Initializes DatabaseSession with a database connection string.
 
+        File-based SQLite databases are opened in WAL mode and their connections are shared between threads.
+
         Args:
             connection_string (str): The database URI for connecting to the database.
         """
-        self.engine = create_engine(connection_string)
+        url = make_url(connection_string)
+        options = {}
+        sqlite_file = url.get_backend_name() == "sqlite" and url.database not in (None, "", ":memory:")
+        if sqlite_file:
+            options["connect_args"] = {"check_same_thread": False}
+        if sqlite_file or url.get_backend_name() != "sqlite":
+            options["pool_size"] = POOL_SIZE
+            options["max_overflow"] = POOL_MAX_OVERFLOW
+            options["pool_pre_ping"] = True
+
+        self.engine = create_engine(connection_string, **options)
+        if sqlite_file:
+            event.listen(self.engine, "connect", _configure_sqlite_connection)
         self.SessionLocal = sessionmaker(bind=self.engine)
 
     def get_session(self):
@@ -3,6 +3,7 @@ from typing import Generator
 
 import pytest
 from database.models import Base
+from database.repository import ProcessedRequestRepository
 from database.repository import SensorRepository
 from database.repository import VehicleStatusRepository
 from sqlalchemy import create_engine
@@ -36,3 +37,9 @@ def sensor_repo() -> SensorRepository:
 def vehicle_status_repo() -> VehicleStatusRepository:
     """Provides a fresh VehicleStatusRepository instance for each test."""
     return VehicleStatusRepository()
+
+
+@pytest.fixture(scope="function")
+def processed_request_repo() -> ProcessedRequestRepository:
+    """Provides a fresh ProcessedRequestRepository instance for each test."""
+    return ProcessedRequestRepository()
@@ -2,10 +2,15 @@ import pendulum
 import pytest
 from database.datatypes import SensorType
 from database.datatypes import VehicleStatus
+from database.ingest import SensorDataWriter
+from database.models import Base
 from database.models import SensorData
 from database.models import VehicleStatusData
+from database.repository import ProcessedRequestRepository
 from database.repository import SensorRepository
 from database.repository import VehicleStatusRepository
+from database.session import DatabaseSession
+from sqlalchemy import inspect
 from sqlalchemy.orm import Session
 
 
@@ -25,6 +30,153 @@ def test_insert_sensor_data_entry(sensor_repo: SensorRepository, database_sessio
     assert str(saved_data.vehicle_serial) == "V123"
 
 
+def test_insert_sensor_data_entries(sensor_repo: SensorRepository, database_session: Session):
+    """Tests that a batch of sensor data is inserted and persisted in a single call."""
+    timestamp = pendulum.now("UTC")
+    entries = [
+        SensorData(vehicle_serial="V123", sensor_type=SensorType.TEMPERATURE, value=20.0 + i, timestamp=timestamp)
+        for i in range(5)
+    ]
+    result = sensor_repo.insert_sensor_data_entries(entries, database_session)
+
+    assert len(result) == 5
+    saved_values = [row.value for row in database_session.query(SensorData).order_by(SensorData.id).all()]
+    assert saved_values == [20.0, 21.0, 22.0, 23.0, 24.0]
+
+
+def test_insert_sensor_data_columns(sensor_repo: SensorRepository, database_session: Session):
+    """Tests that columnar sensor data is bulk-inserted as one row per timestamp and value."""
+    timestamp = pendulum.now("UTC")
+    columns = [
+        (SensorType.TEMPERATURE, [timestamp.add(seconds=i) for i in range(3)], [20.0, 20.5, 21.0]),
+        (SensorType.FUEL, [timestamp], [75.0]),
+    ]
+    result = sensor_repo.insert_sensor_data_columns("V123", columns, database_session)
+
+    assert result == 4
+    saved = database_session.query(SensorData).order_by(SensorData.id).all()
+    assert [row.sensor_type for row in saved] == [SensorType.TEMPERATURE] * 3 + [SensorType.FUEL]
+    assert [row.value for row in saved] == [20.0, 20.5, 21.0, 75.0]
+    assert all(row.vehicle_serial == "V123" for row in saved)
+
+
+def test_processed_request_committed_with_sensor_data(
+    processed_request_repo: ProcessedRequestRepository, sensor_repo: SensorRepository, database_session: Session
+):
+    """Tests that an idempotency key is only stored once the upload it belongs to is committed."""
+    assert processed_request_repo.is_processed("key-1", database_session) is False
+
+    processed_request_repo.mark_processed("key-1", "V123", database_session)
+    database_session.rollback()
+    assert processed_request_repo.is_processed("key-1", database_session) is False
+
+    processed_request_repo.mark_processed("key-1", "V123", database_session)
+    sensor_data = SensorData(
+        vehicle_serial="V123", sensor_type=SensorType.FUEL, value=50.0, timestamp=pendulum.now("UTC")
+    )
+    sensor_repo.insert_sensor_data_entry(sensor_data, database_session)
+    assert processed_request_repo.is_processed("key-1", database_session) is True
+    assert processed_request_repo.is_processed("key-2", database_session) is False
+
+
+def test_insert_sensor_data_rows(sensor_repo: SensorRepository, database_session: Session):
+    """Tests that bulk-inserted rows are only stored once the caller commits."""
+    timestamp = pendulum.now("UTC")
+    rows = sensor_repo.sensor_data_rows("V123", [(SensorType.FUEL, 50.0 + i, timestamp) for i in range(3)])
+
+    assert sensor_repo.insert_sensor_data_rows(rows, database_session) == 3
+    database_session.rollback()
+    assert database_session.query(SensorData).count() == 0
+
+    sensor_repo.insert_sensor_data_rows(rows, database_session)
+    database_session.commit()
+    assert [row.value for row in database_session.query(SensorData).order_by(SensorData.id).all()] == [
+        50.0,
+        51.0,
+        52.0,
+    ]
+
+
+def test_get_processed_keys(processed_request_repo: ProcessedRequestRepository, database_session: Session):
+    """Tests that the recorded keys among many are found with one lookup."""
+    processed_request_repo.mark_processed("key-1", "V123", database_session)
+    processed_request_repo.mark_processed("key-2", "V123", database_session)
+    database_session.commit()
+
+    assert processed_request_repo.get_processed_keys(["key-1", "key-3", "key-2"], database_session) == {
+        "key-1",
+        "key-2",
+    }
+    assert processed_request_repo.get_processed_keys([], database_session) == set()
+
+
+def test_sensor_data_writer_group_commit(
+    sensor_repo: SensorRepository,
+    vehicle_status_repo: VehicleStatusRepository,
+    processed_request_repo: ProcessedRequestRepository,
+    tmp_path,
+):
+    """Tests that queued uploads are recorded in one transaction, resends are skipped and unknown vehicles fail.
+
+    The uploads are submitted before the writer starts, so they all land in its first group.
+    """
+    database = DatabaseSession(f"sqlite:///{tmp_path / 'vehicle_data.db'}")
+    Base.metadata.create_all(database.engine)
+    session = database.SessionLocal()
+    vehicle_status_repo.create_vehicle("V123", session)
+
+    writer = SensorDataWriter(database.SessionLocal, sensor_repo, vehicle_status_repo, processed_request_repo)
+    timestamp = pendulum.now("UTC")
+    first = writer.submit("V123", sensor_repo.sensor_data_rows("V123", [(SensorType.FUEL, 1.0, timestamp)]), "key-1")
+    resent = writer.submit("V123", sensor_repo.sensor_data_rows("V123", [(SensorType.FUEL, 1.0, timestamp)]), "key-1")
+    unknown = writer.submit("V999", sensor_repo.sensor_data_rows("V999", [(SensorType.FUEL, 2.0, timestamp)]), None)
+    columns = [(SensorType.TEMPERATURE, [timestamp, timestamp.add(seconds=1)], [20.0, 21.0])]
+    second = writer.submit("V123", sensor_repo.sensor_data_rows_from_columns("V123", columns), None)
+    writer.start()
+    writer.stop()
+
+    assert first.result() == 1
+    assert resent.result() is None
+    assert second.result() == 2
+    with pytest.raises(ValueError, match="not registered"):
+        unknown.result()
+    assert writer.groups_committed == 1
+
+    session.expire_all()
+    assert [row.value for row in session.query(SensorData).order_by(SensorData.id).all()] == [1.0, 20.0, 21.0]
+    assert processed_request_repo.is_processed("key-1", session) is True
+    session.close()
+    database.engine.dispose()
+
+
+def test_sensor_data_writer_skips_cancelled_upload(
+    sensor_repo: SensorRepository,
+    vehicle_status_repo: VehicleStatusRepository,
+    processed_request_repo: ProcessedRequestRepository,
+    tmp_path,
+):
+    """Tests that an upload cancelled while queued is not recorded and does not stop the writer."""
+    database = DatabaseSession(f"sqlite:///{tmp_path / 'vehicle_data.db'}")
+    Base.metadata.create_all(database.engine)
+    session = database.SessionLocal()
+    vehicle_status_repo.create_vehicle("V123", session)
+
+    writer = SensorDataWriter(database.SessionLocal, sensor_repo, vehicle_status_repo, processed_request_repo)
+    timestamp = pendulum.now("UTC")
+    cancelled = writer.submit("V123", sensor_repo.sensor_data_rows("V123", [(SensorType.FUEL, 1.0, timestamp)]), None)
+    assert cancelled.cancel()
+    writer.start()
+    after = writer.submit("V123", sensor_repo.sensor_data_rows("V123", [(SensorType.FUEL, 2.0, timestamp)]), None)
+    assert after.result(timeout=10) == 1
+    writer.stop()
+
+    assert cancelled.cancelled()
+    session.expire_all()
+    assert [row.value for row in session.query(SensorData).all()] == [2.0]
+    session.close()
+    database.engine.dispose()
+
+
 def test_fetch_specific_sensor_data_for_vehicle(sensor_repo: SensorRepository, database_session: Session):
     """Tests retrieval of specific sensor type data for a given vehicle."""
     timestamp = pendulum.now("UTC")
@@ -41,6 +193,53 @@ def test_fetch_specific_sensor_data_for_vehicle(sensor_repo: SensorRepository, d
     assert result["TEMPERATURE"][1][0] == 23.5
 
 
+def test_query_sensor_data_page(sensor_repo: SensorRepository, database_session: Session):
+    """Tests that a time range is read in keyset pages, oldest first, even across equal timestamps."""
+    start = pendulum.datetime(2024, 1, 1, tz="UTC")
+    readings = [(SensorType.FUEL, float(i), start.add(seconds=i // 2)) for i in range(10)]
+    readings.append((SensorType.TEMPERATURE, 99.0, start))
+    sensor_repo.insert_sensor_data_rows(sensor_repo.sensor_data_rows("V123", readings), database_session)
+    database_session.commit()
+
+    values = []
+    after = None
+    while True:
+        page = sensor_repo.query_sensor_data_page(
+            "V123", SensorType.FUEL, start.add(seconds=1), start.add(seconds=4), after, 3, database_session
+        )
+        values.extend(value for _, _, value in page)
+        if len(page) < 3:
+            break
+        after = (page[-1][1], page[-1][0])
+    assert values == [2.0, 3.0, 4.0, 5.0, 6.0, 7.0]
+
+    unbounded = sensor_repo.query_sensor_data_page("V123", SensorType.FUEL, None, None, None, 100, database_session)
+    assert len(unbounded) == 10
+
+
+def test_downsample_sensor_data(sensor_repo: SensorRepository, database_session: Session):
+    """Tests that readings are aggregated per bucket and empty buckets are left out."""
+    start = pendulum.datetime(2024, 1, 1, tz="UTC")
+    samples = [(0, 1.0), (5, 3.0), (9, 2.0), (25, 10.0), (40, 99.0)]
+    readings = [(SensorType.TEMPERATURE, value, start.add(seconds=second)) for second, value in samples]
+    sensor_repo.insert_sensor_data_rows(sensor_repo.sensor_data_rows("V123", readings), database_session)
+    database_session.commit()
+
+    buckets = sensor_repo.downsample_sensor_data(
+        "V123", SensorType.TEMPERATURE, start, start.add(seconds=30), 10, database_session
+    )
+    assert buckets == [(0, 3, 1.0, 3.0, 2.0), (2, 1, 10.0, 10.0, 10.0)]
+
+
+def test_sensor_data_time_index(database_session: Session):
+    """Tests that the composite index for time-range queries exists."""
+    indexes = {
+        index["name"]: index["column_names"]
+        for index in inspect(database_session.get_bind()).get_indexes("sensor_data")
+    }
+    assert indexes["ix_sensor_data_vehicle_sensor_time"] == ["vehicle_serial", "sensor_type", "timestamp"]
+
+
 def test_check_vehicle_existence(vehicle_status_repo: VehicleStatusRepository, database_session: Session):
     """Tests the vehicle existence check functionality for both existing and non-existing vehicles."""
     vehicle_status = VehicleStatusData(
@@ -69,6 +268,45 @@ def test_update_status_of_particular_vehicle(vehicle_status_repo: VehicleStatusR
     assert str(updated_vehicle.status) == VehicleStatus.ACTIVE.value
 
 
+def test_get_statuses_of_vehicles(vehicle_status_repo: VehicleStatusRepository, database_session: Session):
+    """Tests that a bulk status query returns registered vehicles and leaves unknown serials out."""
+    database_session.add_all(
+        [
+            VehicleStatusData(vehicle_serial="V1", status=VehicleStatus.ACTIVE, timestamp=pendulum.now("UTC")),
+            VehicleStatusData(vehicle_serial="V2", status=VehicleStatus.ERROR, timestamp=pendulum.now("UTC")),
+        ]
+    )
+    database_session.commit()
+
+    statuses = vehicle_status_repo.get_statuses_of_vehicles(["V1", "V2", "NON_EXISTENT"], database_session)
+    assert statuses == {"V1": VehicleStatus.ACTIVE, "V2": VehicleStatus.ERROR}
+
+
+def test_update_statuses_of_vehicles(vehicle_status_repo: VehicleStatusRepository, database_session: Session):
+    """Tests that a bulk status update applies every known vehicle's last status and reports unknown serials."""
+    database_session.add_all(
+        [
+            VehicleStatusData(vehicle_serial="V1", status=VehicleStatus.INACTIVE, timestamp=pendulum.now("UTC")),
+            VehicleStatusData(vehicle_serial="V2", status=VehicleStatus.INACTIVE, timestamp=pendulum.now("UTC")),
+        ]
+    )
+    database_session.commit()
+
+    unknown = vehicle_status_repo.update_statuses_of_vehicles(
+        [
+            ("V1", VehicleStatus.ACTIVE),
+            ("NON_EXISTENT", VehicleStatus.ACTIVE),
+            ("V2", VehicleStatus.ACTIVE),
+            ("V2", VehicleStatus.MAINTENANCE),
+        ],
+        database_session,
+    )
+    assert unknown == ["NON_EXISTENT"]
+
+    statuses = vehicle_status_repo.get_statuses_of_vehicles(["V1", "V2"], database_session)
+    assert statuses == {"V1": VehicleStatus.ACTIVE, "V2": VehicleStatus.MAINTENANCE}
+
+
 def test_fetch_all_sensor_data_for_vehicle(sensor_repo: SensorRepository, database_session: Session):
     """Tests retrieval of all sensor data types for a specific vehicle."""
     sensor_data1 = SensorData(
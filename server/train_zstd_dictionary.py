@@ -0,0 +1,54 @@
+import argparse
+import json
+from itertools import groupby
+from typing import List
+
+import zstandard
+from api.compression import ZSTD_DICTIONARY_PATH
+from database.models import SensorData
+from database.session import DatabaseSession
+
+
+def build_samples(connection_string: str, readings_per_sample: int) -> List[bytes]:
+    """Builds batch request bodies from recorded sensor data, laid out like the vehicle client sends them.
+
+    Args:
+        connection_string (str): The database URI to read sensor data from.
+        readings_per_sample (int): Number of readings per sample body.
+
+    Returns:
+        List[bytes]: Compact JSON `SensorDataBatch` bodies.
+    """
+    session = next(DatabaseSession(connection_string).get_session())
+    rows = session.query(SensorData).order_by(SensorData.vehicle_serial, SensorData.timestamp).all()
+
+    samples = []
+    for vehicle_serial, vehicle_rows in groupby(rows, key=lambda row: row.vehicle_serial):
+        vehicle_rows = list(vehicle_rows)
+        for start in range(0, len(vehicle_rows), readings_per_sample):
+            readings = [
+                {
+                    "sensor_type": row.sensor_type.value,
+                    "timestamp": row.timestamp.strftime("%Y-%m-%dT%H:%M:%S.%fZ"),
+                    "sensor_data": row.value,
+                }
+                for row in vehicle_rows[start : start + readings_per_sample]
+            ]
+            body = {"vehicle_serial": vehicle_serial, "readings": readings}
+            samples.append(json.dumps(body, separators=(",", ":")).encode())
+    return samples
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Train the zstd dictionary shared by vehicle clients and the API.")
+    parser.add_argument("--database", default="sqlite:///server/vehicle_data.db", help="Database URI to sample.")
+    parser.add_argument("--output", default=ZSTD_DICTIONARY_PATH, help="Where to write the dictionary.")
+    parser.add_argument("--size", type=int, default=16 * 1024, help="Dictionary size in bytes.")
+    parser.add_argument("--readings", type=int, default=64, help="Readings per training sample.")
+    args = parser.parse_args()
+
+    samples = build_samples(args.database, args.readings)
+    dictionary = zstandard.train_dictionary(args.size, samples)
+    with open(args.output, "wb") as dictionary_file:
+        dictionary_file.write(dictionary.as_bytes())
+    print(f"Trained a {len(dictionary.as_bytes())} byte dictionary from {len(samples)} samples into {args.output}")
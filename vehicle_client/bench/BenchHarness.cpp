@@ -0,0 +1,108 @@
+#include "BenchHarness.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+struct Benchmark
+{
+    const char* name;
+    BenchFunction function;
+};
+
+// Upper bound of the calibration, so a body that ignores keepRunning() cannot loop forever
+constexpr std::uint64_t kMaxIterations = 1ULL << 32;
+
+std::vector<Benchmark>& registry()
+{
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+double runOnce(BenchFunction function, std::uint64_t iterations, std::size_t& bytes)
+{
+    BenchState state(iterations);
+    auto started = std::chrono::steady_clock::now();
+    function(state);
+    auto elapsed = std::chrono::steady_clock::now() - started;
+    bytes = state.bytes();
+    return std::chrono::duration<double, std::nano>(elapsed).count();
+}
+
+}  // unnamed namespace
+
+bool registerBenchmark(const char* name, BenchFunction function)
+{
+    registry().push_back({name, function});
+    return true;
+}
+
+int benchMain(int argc, char** argv)
+{
+    std::string_view filter;
+    double minTimeNs = 200e6;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("--filter="))
+        {
+            filter = arg.substr(std::strlen("--filter="));
+        }
+        else if (arg.starts_with("--min-time="))
+        {
+            minTimeNs = std::stod(std::string(arg.substr(std::strlen("--min-time=")))) * 1e6;
+        }
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--filter=<substring>] [--min-time=<ms>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+#ifndef __OPTIMIZE__
+    std::printf("Built without optimizations, configure with -DCMAKE_BUILD_TYPE=Release\n");
+#endif
+    std::printf("%-40s %14s %14s %12s\n", "benchmark", "ns/op", "iterations", "MB/s");
+    for (const Benchmark& benchmark : registry())
+    {
+        if (std::string_view(benchmark.name).find(filter) == std::string_view::npos)
+        {
+            continue;
+        }
+
+        // Warm caches and lazily initialised state before calibrating
+        std::size_t bytes = 0;
+        runOnce(benchmark.function, 1, bytes);
+
+        std::uint64_t iterations = 1;
+        double elapsedNs = runOnce(benchmark.function, iterations, bytes);
+        while (elapsedNs < minTimeNs && iterations < kMaxIterations)
+        {
+            // Aim slightly past the minimum time so the last run usually suffices
+            double perIteration = elapsedNs > 0 ? elapsedNs / iterations : 1.0;
+            auto target = static_cast<std::uint64_t>(minTimeNs * 1.2 / perIteration);
+            iterations = std::min(std::max(target, iterations * 2), kMaxIterations);
+            elapsedNs = runOnce(benchmark.function, iterations, bytes);
+        }
+
+        double nsPerOp = elapsedNs / iterations;
+        if (bytes > 0)
+        {
+            double megabytesPerSecond = bytes * 1e3 / nsPerOp;
+            std::printf("%-40s %14.1f %14llu %12.1f\n", benchmark.name, nsPerOp,
+                        static_cast<unsigned long long>(iterations), megabytesPerSecond);
+        }
+        else
+        {
+            std::printf("%-40s %14.1f %14llu %12s\n", benchmark.name, nsPerOp,
+                        static_cast<unsigned long long>(iterations), "-");
+        }
+    }
+    return 0;
+}
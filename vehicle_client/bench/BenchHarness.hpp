@@ -0,0 +1,99 @@
+#ifndef BENCH_HARNESS_HPP
+#define BENCH_HARNESS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class BenchState
+ * @brief Iteration control handed to a benchmark body.
+ *
+ * The body runs its operation once per call of keepRunning(), e.g.
+ * `while (state.keepRunning()) { ... }`. Setup before the loop is not timed.
+ * The harness calls a body repeatedly with a growing iteration count until
+ * one run takes at least the minimum time, and reports the time per iteration
+ * of that run.
+ */
+class BenchState
+{
+   public:
+    explicit BenchState(std::uint64_t iterations) : remaining(iterations)
+    {
+    }
+
+    /**
+     * @brief Returns true while iterations remain.
+     */
+    bool keepRunning()
+    {
+        if (remaining == 0)
+        {
+            return false;
+        }
+        --remaining;
+        return true;
+    }
+
+    /**
+     * @brief Records the bytes processed by one iteration, reported as throughput.
+     */
+    void setBytesPerIteration(std::size_t bytes)
+    {
+        bytesPerIteration = bytes;
+    }
+
+    std::size_t bytes() const
+    {
+        return bytesPerIteration;
+    }
+
+   private:
+    std::uint64_t remaining;            ///< Iterations left in this run.
+    std::size_t bytesPerIteration = 0;  ///< 0 if the benchmark reports no throughput.
+};
+
+using BenchFunction = void (*)(BenchState& state);
+
+/**
+ * @brief Adds a benchmark to the registry run by benchMain().
+ *
+ * @return Always true, so registration can initialise a namespace-scope constant.
+ */
+bool registerBenchmark(const char* name, BenchFunction function);
+
+/**
+ * @brief Keeps the compiler from discarding a value that is otherwise unused.
+ */
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief Keeps the compiler from caching memory across this point.
+ */
+inline void clobberMemory()
+{
+    asm volatile("" : : : "memory");
+}
+
+/**
+ * @brief Runs the registered benchmarks and prints one line per benchmark.
+ *
+ * Options: `--filter=<substring>` runs only benchmarks whose name contains it,
+ * `--min-time=<ms>` sets the minimum duration of the measured run (default 200).
+ *
+ * @return The process exit code.
+ */
+int benchMain(int argc, char** argv);
+
+#define VEHICLE_CLIENT_BENCH_CONCAT_(a, b) a##b
+#define VEHICLE_CLIENT_BENCH_CONCAT(a, b) VEHICLE_CLIENT_BENCH_CONCAT_(a, b)
+
+/// Registers a function `void name(BenchState&)` as a benchmark.
+#define VEHICLE_CLIENT_BENCHMARK(name)                                          \
+    static const bool VEHICLE_CLIENT_BENCH_CONCAT(name##Registered, __LINE__) = \
+        registerBenchmark(#name, name)
+
+#endif  // BENCH_HARNESS_HPP
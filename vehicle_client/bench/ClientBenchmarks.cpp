@@ -0,0 +1,267 @@
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "BenchHarness.hpp"
+#include "DataTypes.hpp"
+#include "PayloadSerializer.hpp"
+#include "ResponseClassifier.hpp"
+#include "RingBuffer.hpp"
+#include "SimdKernels.hpp"
+#include "TimestampFormatter.hpp"
+#include "WorkStealingDeque.hpp"
+
+namespace
+{
+// A full upload batch of SensorUploader's default size
+constexpr std::size_t kBatchReadings = 256;
+
+constexpr std::string_view kSerial = "enginius1";
+
+// Readings one millisecond apart with a slowly drifting value, like a real sensor stream
+std::vector<SensorReading> makeReadings(std::size_t count)
+{
+    std::mt19937 gen(42);
+    std::normal_distribution<float> noise(0.0f, 0.2f);
+    std::vector<SensorReading> readings;
+    std::uint64_t timestampUs = 1700000000000000ULL;
+    float value = 60.0f;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        value += noise(gen);
+        readings.push_back({static_cast<SensorType>(i % kSensorTypeCount), value, timestampUs});
+        timestampUs += 1000;
+    }
+    return readings;
+}
+
+void serializeSingleReading(BenchState& state)
+{
+    PayloadSerializer serializer;
+    SensorReading reading{SensorType::TEMPERATURE, 64.5f, currentTimeMicros()};
+    std::string_view body;
+    while (state.keepRunning())
+    {
+        body = serializer.sensorData(reading, kSerial);
+        doNotOptimize(body.data());
+    }
+    state.setBytesPerIteration(body.size());
+}
+VEHICLE_CLIENT_BENCHMARK(serializeSingleReading);
+
+void serializeBatch(BenchState& state, WireFormat format)
+{
+    PayloadSerializer serializer;
+    std::vector<SensorReading> readings = makeReadings(kBatchReadings);
+    std::string_view body;
+    while (state.keepRunning())
+    {
+        body = serializer.batch(readings, kSerial, format);
+        doNotOptimize(body.data());
+    }
+    state.setBytesPerIteration(body.size());
+}
+
+void serializeBatchJson(BenchState& state)
+{
+    serializeBatch(state, WireFormat::JSON);
+}
+VEHICLE_CLIENT_BENCHMARK(serializeBatchJson);
+
+void serializeBatchCbor(BenchState& state)
+{
+    serializeBatch(state, WireFormat::CBOR);
+}
+VEHICLE_CLIENT_BENCHMARK(serializeBatchCbor);
+
+void serializeBatchMsgpack(BenchState& state)
+{
+    serializeBatch(state, WireFormat::MSGPACK);
+}
+VEHICLE_CLIENT_BENCHMARK(serializeBatchMsgpack);
+
+void serializeBatchColumnar(BenchState& state)
+{
+    serializeBatch(state, WireFormat::COLUMNAR);
+}
+VEHICLE_CLIENT_BENCHMARK(serializeBatchColumnar);
+
+void serializeStatusUpdate(BenchState& state)
+{
+    PayloadSerializer serializer;
+    while (state.keepRunning())
+    {
+        doNotOptimize(serializer.status(kSerial, VehicleStatus::MAINTENANCE).data());
+    }
+}
+VEHICLE_CLIENT_BENCHMARK(serializeStatusUpdate);
+
+void readClock(BenchState& state)
+{
+    while (state.keepRunning())
+    {
+        doNotOptimize(currentTimeMicros());
+    }
+}
+VEHICLE_CLIENT_BENCHMARK(readClock);
+
+// Consecutive samples within one second only rewrite the microsecond digits
+void formatTimestampSameSecond(BenchState& state)
+{
+    TimestampFormatter formatter;
+    char out[TimestampFormatter::kLength];
+    std::uint64_t timestampUs = 1700000000000000ULL;
+    while (state.keepRunning())
+    {
+        doNotOptimize(formatter.format(timestampUs, out));
+        timestampUs = (timestampUs + 1) % 1000000 + 1700000000000000ULL;
+    }
+}
+VEHICLE_CLIENT_BENCHMARK(formatTimestampSameSecond);
+
+// Every sample falls in a new second, so the cached prefix is rebuilt each time
+void formatTimestampNewSecond(BenchState& state)
+{
+    TimestampFormatter formatter;
+    char out[TimestampFormatter::kLength];
+    std::uint64_t timestampUs = 1700000000000000ULL;
+    while (state.keepRunning())
+    {
+        doNotOptimize(formatter.format(timestampUs, out));
+        timestampUs += 1000001;
+    }
+}
+VEHICLE_CLIENT_BENCHMARK(formatTimestampNewSecond);
+
+void sensorTypeName(BenchState& state)
+{
+    std::size_t i = 0;
+    while (state.keepRunning())
+    {
+        doNotOptimize(sensorTypeToString(static_cast<SensorType>(i++ % kSensorTypeCount)).data());
+    }
+}
+VEHICLE_CLIENT_BENCHMARK(sensorTypeName);
+
+void parseSensorTypeName(BenchState& state)
+{
+    std::size_t i = 0;
+    SensorType type{};
+    while (state.keepRunning())
+    {
+        doNotOptimize(parseSensorType(kSensorTypeNames[i++ % kSensorTypeCount], type));
+        doNotOptimize(type);
+    }
+}
+VEHICLE_CLIENT_BENCHMARK(parseSensorTypeName);
+
+void parseVehicleStatusName(BenchState& state)
+{
+    std::size_t i = 0;
+    VehicleStatus status{};
+    while (state.keepRunning())
+    {
+        doNotOptimize(parseVehicleStatus(kVehicleStatusNames[i++ % kVehicleStatusCount], status));
+        doNotOptimize(status);
+    }
+}
+VEHICLE_CLIENT_BENCHMARK(parseVehicleStatusName);
+
+void classifySuccessResponse(BenchState& state)
+{
+    constexpr std::string_view body = R"({"status":"success","content":"ok"})";
+    while (state.keepRunning())
+    {
+        doNotOptimize(isSuccessResponse(200, body));
+    }
+    state.setBytesPerIteration(body.size());
+}
+VEHICLE_CLIENT_BENCHMARK(classifySuccessResponse);
+
+// Extracting the content takes the lexer path instead of the prefix check
+void classifyStatusResponse(BenchState& state)
+{
+    constexpr std::string_view body = R"({"status": "success", "content": "maintenance"})";
+    std::string content;
+    while (state.keepRunning())
+    {
+        doNotOptimize(isSuccessResponse(200, body, &content));
+        doNotOptimize(content.data());
+    }
+    state.setBytesPerIteration(body.size());
+}
+VEHICLE_CLIENT_BENCHMARK(classifyStatusResponse);
+
+void ringBufferPushPop(BenchState& state)
+{
+    RingBuffer<SensorReading> queue(8192);
+    SensorReading reading{SensorType::FUEL, 41.0f, 1700000000000000ULL};
+    SensorReading popped;
+    while (state.keepRunning())
+    {
+        doNotOptimize(queue.push(reading));
+        doNotOptimize(queue.tryPop(popped));
+        clobberMemory();
+    }
+}
+VEHICLE_CLIENT_BENCHMARK(ringBufferPushPop);
+
+// Fills the queue to its capacity and drains it, so the index wrap-around is covered
+void ringBufferBurst(BenchState& state)
+{
+    constexpr std::size_t kBurst = 1024;
+    RingBuffer<SensorReading> queue(kBurst);
+    SensorReading reading{SensorType::WEIGHT, 1200.0f, 1700000000000000ULL};
+    SensorReading popped;
+    while (state.keepRunning())
+    {
+        for (std::size_t i = 0; i < kBurst; ++i)
+        {
+            queue.push(reading);
+        }
+        for (std::size_t i = 0; i < kBurst; ++i)
+        {
+            queue.tryPop(popped);
+        }
+        clobberMemory();
+    }
+    state.setBytesPerIteration(kBurst * sizeof(SensorReading));
+}
+VEHICLE_CLIENT_BENCHMARK(ringBufferBurst);
+
+void workStealingDequePushPop(BenchState& state)
+{
+    WorkStealingDeque<std::uintptr_t> deque(1024);
+    std::uintptr_t item = 0;
+    while (state.keepRunning())
+    {
+        doNotOptimize(deque.push(item + 1));
+        doNotOptimize(deque.pop(item));
+    }
+}
+VEHICLE_CLIENT_BENCHMARK(workStealingDequePushPop);
+
+void windowStatistics(BenchState& state)
+{
+    std::vector<float> values;
+    for (const SensorReading& reading : makeReadings(kBatchReadings))
+    {
+        values.push_back(reading.value);
+    }
+    while (state.keepRunning())
+    {
+        MinMaxSum stats = minMaxSum(values);
+        doNotOptimize(stats.sum);
+    }
+    state.setBytesPerIteration(std::span<const float>(values).size_bytes());
+}
+VEHICLE_CLIENT_BENCHMARK(windowStatistics);
+
+}  // unnamed namespace
+
+int main(int argc, char** argv)
+{
+    return benchMain(argc, argv);
+}
@@ -0,0 +1,465 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Logger.hpp"
+#include "MockServer.hpp"
+#include "TimestampFormatter.hpp"
+#include "VehicleClient.hpp"
+#include "VehicleGateway.hpp"
+
+namespace
+{
+enum class LoadMode
+{
+    SINGLE,  ///< addSensorData, one reading per request.
+    BATCH,   ///< addSensorDataBatch with batchSize readings.
+    STATUS,  ///< getVehicleStatus.
+    UPDATE,  ///< updateVehicleStatus.
+    GATEWAY  ///< Readings of many vehicles pushed into a VehicleGateway.
+};
+
+struct LoadConfig
+{
+    std::string url;                             ///< Empty to start an embedded MockServer.
+    LoadMode mode = LoadMode::SINGLE;            ///< The request type sent.
+    std::size_t concurrency = 4;                 ///< Workers, one request in flight each.
+    double rate = 0.0;                           ///< Total requests/s, 0 for closed loop.
+    double durationSeconds = 10.0;               ///< Length of the measured run.
+    std::size_t batchSize = 256;                 ///< Readings per request in BATCH mode.
+    WireFormat format = WireFormat::JSON;        ///< Encoding of batch bodies.
+    std::chrono::microseconds serverLatency{0};  ///< Embedded server only.
+    std::size_t serverCapacity = 0;              ///< Embedded server only, 0 for no limit.
+    std::size_t vehicles = 64;                   ///< Vehicles fed in GATEWAY mode.
+    bool adaptive = false;                       ///< FlushScheduler tuning in GATEWAY mode.
+};
+
+struct WorkerResult
+{
+    std::vector<std::uint64_t> latenciesNs;
+    std::uint64_t errors = 0;
+};
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::string_view kSerial = "loadgen1";
+
+// How often gateway producers push the readings that became due
+constexpr auto kProducerTick = std::chrono::milliseconds(1);
+
+// How long the gateway may take to upload what was pushed before the run counts as stuck
+constexpr auto kDrainTimeout = std::chrono::seconds(60);
+
+template <typename T>
+struct NamedValue
+{
+    std::string_view name;
+    T value;
+};
+
+constexpr NamedValue<LoadMode> kModes[] = {
+    {"single", LoadMode::SINGLE},
+    {"batch", LoadMode::BATCH},
+    {"status", LoadMode::STATUS},
+    {"update", LoadMode::UPDATE},
+    {"gateway", LoadMode::GATEWAY},
+};
+
+constexpr NamedValue<WireFormat> kFormats[] = {
+    {"json", WireFormat::JSON},
+    {"cbor", WireFormat::CBOR},
+    {"msgpack", WireFormat::MSGPACK},
+    {"columnar", WireFormat::COLUMNAR},
+};
+
+template <typename T, std::size_t N>
+bool lookup(const NamedValue<T> (&table)[N], std::string_view name, T& value)
+{
+    for (const NamedValue<T>& entry : table)
+    {
+        if (entry.name == name)
+        {
+            value = entry.value;
+            return true;
+        }
+    }
+    return false;
+}
+
+void printUsage(const char* program)
+{
+    std::fprintf(stderr,
+                 "usage: %s [options]\n"
+                 "  --url=<base url>          server to load, default an embedded mock server\n"
+                 "  --mode=<mode>             single, batch, status, update or gateway\n"
+                 "                            (default single)\n"
+                 "  --concurrency=<threads>   concurrent requests, producers in gateway mode\n"
+                 "                            (default 4)\n"
+                 "  --rate=<requests/s>       total offered load, 0 for closed loop (default 0);\n"
+                 "                            readings/s in gateway mode\n"
+                 "  --duration=<seconds>      length of the run (default 10)\n"
+                 "  --batch-size=<readings>   readings per request in batch mode, initial\n"
+                 "                            batch size in gateway mode (default 256)\n"
+                 "  --format=<format>         json, cbor, msgpack or columnar (default json)\n"
+                 "  --vehicles=<count>        vehicles in gateway mode (default 64)\n"
+                 "  --adaptive=<0|1>          adaptive flush scheduling in gateway mode\n"
+                 "  --server-latency-us=<us>  delay of the embedded server (default 0)\n"
+                 "  --server-capacity=<n>     POSTs the embedded server processes at once,\n"
+                 "                            503 beyond that, 0 for no limit (default 0)\n",
+                 program);
+}
+
+bool parseArguments(int argc, char** argv, LoadConfig& config)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg = argv[i];
+        std::size_t equals = arg.find('=');
+        if (!arg.starts_with("--") || equals == std::string_view::npos)
+        {
+            return false;
+        }
+        std::string_view name = arg.substr(2, equals - 2);
+        std::string value(arg.substr(equals + 1));
+
+        if (name == "url")
+        {
+            config.url = value;
+        }
+        else if (name == "mode")
+        {
+            if (!lookup(kModes, value, config.mode))
+            {
+                return false;
+            }
+        }
+        else if (name == "format")
+        {
+            if (!lookup(kFormats, value, config.format))
+            {
+                return false;
+            }
+        }
+        else if (name == "concurrency")
+        {
+            config.concurrency = std::max<std::size_t>(1, std::stoul(value));
+        }
+        else if (name == "rate")
+        {
+            config.rate = std::stod(value);
+        }
+        else if (name == "duration")
+        {
+            config.durationSeconds = std::stod(value);
+        }
+        else if (name == "batch-size")
+        {
+            config.batchSize = std::max<std::size_t>(1, std::stoul(value));
+        }
+        else if (name == "server-latency-us")
+        {
+            config.serverLatency = std::chrono::microseconds(std::stol(value));
+        }
+        else if (name == "server-capacity")
+        {
+            config.serverCapacity = std::stoul(value);
+        }
+        else if (name == "vehicles")
+        {
+            config.vehicles = std::max<std::size_t>(1, std::stoul(value));
+        }
+        else if (name == "adaptive")
+        {
+            config.adaptive = value == "1";
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sendOne(VehicleClient& client, const LoadConfig& config,
+             std::vector<SensorReading>& readings, std::uint64_t sequence)
+{
+    std::string serial(kSerial);
+    switch (config.mode)
+    {
+        case LoadMode::SINGLE:
+            return client.addSensorData(SensorType::TEMPERATURE,
+                                        50.0f + static_cast<float>(sequence % 40), serial);
+        case LoadMode::BATCH:
+        {
+            std::uint64_t now = currentTimeMicros();
+            for (std::size_t i = 0; i < readings.size(); ++i)
+            {
+                readings[i].timestampUs = now - (readings.size() - i) * 1000;
+            }
+            return client.addSensorDataBatch(readings, serial);
+        }
+        case LoadMode::STATUS:
+            return client.getVehicleStatus(serial).first;
+        case LoadMode::UPDATE:
+            return client.updateVehicleStatus(
+                serial, static_cast<VehicleStatus>(sequence % kVehicleStatusCount));
+        case LoadMode::GATEWAY:
+            break;
+    }
+    return false;
+}
+
+/**
+ * Worker @p index of @p workers sends requests until @p end.
+ *
+ * With a target rate the requests follow a fixed schedule and latency is taken
+ * from the scheduled start, so time spent waiting behind a slow request is
+ * counted instead of hidden (coordinated omission). Without a rate each worker
+ * sends its next request as soon as the previous one returns.
+ */
+void runWorker(VehicleClient& client, const LoadConfig& config, std::size_t index,
+               std::size_t workers, Clock::time_point start, Clock::time_point end,
+               WorkerResult& result)
+{
+    std::vector<SensorReading> readings;
+    for (std::size_t i = 0; i < config.batchSize; ++i)
+    {
+        readings.push_back({static_cast<SensorType>(i % kSensorTypeCount),
+                            static_cast<float>(i % 100), 0});
+    }
+
+    std::chrono::duration<double> interval(config.rate > 0 ? workers / config.rate : 0.0);
+    // Workers are staggered over one interval so their requests do not arrive in bursts
+    auto offset = std::chrono::duration_cast<Clock::duration>(interval * index / workers);
+    for (std::uint64_t sequence = 0;; ++sequence)
+    {
+        Clock::time_point scheduled = Clock::now();
+        if (config.rate > 0)
+        {
+            scheduled = start + offset +
+                        std::chrono::duration_cast<Clock::duration>(interval * sequence);
+        }
+        if (scheduled >= end)
+        {
+            break;
+        }
+        std::this_thread::sleep_until(scheduled);
+
+        if (!sendOne(client, config, readings, sequence))
+        {
+            ++result.errors;
+        }
+        auto latency = Clock::now() - scheduled;
+        result.latenciesNs.push_back(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+    }
+}
+
+/**
+ * Producer @p index of @p producers pushes its share of the readings into @p gateway
+ * until @p end, round-robin over @p vehicles.
+ */
+void runProducer(VehicleGateway& gateway, const std::vector<VehicleId>& vehicles,
+                 const LoadConfig& config, std::size_t index, std::size_t producers,
+                 Clock::time_point start, Clock::time_point end, std::uint64_t& pushed)
+{
+    double rate = config.rate / static_cast<double>(producers);
+    for (Clock::time_point tick = start; tick < end; tick += kProducerTick)
+    {
+        std::this_thread::sleep_until(tick);
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        // Without a rate the producer only yields between ticks
+        auto due = config.rate > 0 ? static_cast<std::uint64_t>(rate * elapsed.count())
+                                   : pushed + 1024;
+        for (; pushed < due; ++pushed)
+        {
+            VehicleId vehicle = vehicles[(pushed * producers + index) % vehicles.size()];
+            gateway.push(vehicle, SensorType::TEMPERATURE, static_cast<float>(pushed % 100));
+        }
+    }
+}
+
+/**
+ * Runs GATEWAY mode: pushes readings for the configured time, waits until the
+ * gateway has uploaded them and reports readings/s and how the scheduler reacted.
+ */
+int runGateway(VehicleClient& client, const LoadConfig& config, const MockServer* server)
+{
+    GatewayConfig gatewayConfig;
+    gatewayConfig.maxBatchReadings = config.batchSize;
+    gatewayConfig.adaptive = config.adaptive;
+    VehicleGateway gateway(client, gatewayConfig);
+
+    std::vector<VehicleId> vehicles;
+    for (std::size_t i = 0; i < config.vehicles; ++i)
+    {
+        vehicles.push_back(gateway.registerVehicle("loadgen" + std::to_string(i + 1)));
+    }
+
+    std::vector<std::uint64_t> pushed(config.concurrency);
+    std::vector<std::thread> producers;
+    Clock::time_point start = Clock::now();
+    Clock::time_point end =
+        start + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(config.durationSeconds));
+    for (std::size_t i = 0; i < config.concurrency; ++i)
+    {
+        producers.emplace_back(runProducer, std::ref(gateway), std::cref(vehicles),
+                               std::cref(config), i, config.concurrency, start, end,
+                               std::ref(pushed[i]));
+    }
+    for (std::thread& producer : producers)
+    {
+        producer.join();
+    }
+    FlushSchedule schedule = gateway.schedule(0);
+
+    std::uint64_t total = 0;
+    for (std::uint64_t count : pushed)
+    {
+        total += count;
+    }
+    auto settled = [&]
+    { return gateway.uploaded() + gateway.failed() + gateway.dropped() >= total; };
+    while (!settled() && Clock::now() < end + kDrainTimeout)
+    {
+        std::this_thread::sleep_for(kProducerTick);
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    MetricsSnapshot metrics = client.metrics();
+    std::printf("target       %s\n", config.url.c_str());
+    std::printf("readings     %" PRIu64 " pushed, %" PRIu64 " uploaded, %" PRIu64
+                " failed, %" PRIu64 " dropped in %.2f s\n",
+                total, gateway.uploaded(), gateway.failed(), gateway.dropped(), elapsed);
+    std::printf("throughput   %.1f readings/s over %zu vehicles\n",
+                static_cast<double>(gateway.uploaded()) / elapsed, config.vehicles);
+    std::printf("scheduler    %s, %" PRIu64 " congestion events; worker 0 at batch %zu,"
+                " linger %lld ms, %zu in flight\n",
+                config.adaptive ? "adaptive" : "fixed", gateway.congestionEvents(),
+                schedule.batchReadings, static_cast<long long>(schedule.linger.count()),
+                schedule.maxInFlight);
+    std::printf("requests     %" PRIu64 ", %" PRIu64 " retries\n",
+                metrics.count(MetricCounter::REQUESTS), metrics.count(MetricCounter::RETRIES));
+    if (server)
+    {
+        std::printf("server       %" PRIu64 " requests, %" PRIu64 " rejected with 503\n",
+                    server->requests(), server->rejected());
+    }
+    return settled() && gateway.failed() == 0 ? 0 : 2;
+}
+
+double percentileMicros(const std::vector<std::uint64_t>& sorted, double fraction)
+{
+    if (sorted.empty())
+    {
+        return 0.0;
+    }
+    auto rank = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1));
+    return static_cast<double>(sorted[rank]) / 1e3;
+}
+
+}  // unnamed namespace
+
+int main(int argc, char** argv)
+{
+    LoadConfig config;
+    if (!parseArguments(argc, argv, config))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // The client logs every status update, which would bury the report
+    LoggerConfig logging;
+    logging.minLevel = LogLevel::WARNING;
+    Logger::instance().configure(logging);
+
+    std::unique_ptr<MockServer> server;
+    if (config.url.empty())
+    {
+        server = std::make_unique<MockServer>(
+            MockServerConfig{0, config.serverLatency, config.serverCapacity});
+        config.url = server->url();
+    }
+
+    VehicleClient client(config.url);
+    client.setWireFormat(config.format);
+    if (config.mode == LoadMode::GATEWAY)
+    {
+        return runGateway(client, config, server.get());
+    }
+
+    std::vector<WorkerResult> results(config.concurrency);
+    std::vector<std::thread> workers;
+    Clock::time_point start = Clock::now();
+    Clock::time_point end =
+        start + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(config.durationSeconds));
+    for (std::size_t i = 0; i < config.concurrency; ++i)
+    {
+        workers.emplace_back(runWorker, std::ref(client), std::cref(config), i,
+                             config.concurrency, start, end, std::ref(results[i]));
+    }
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<std::uint64_t> latencies;
+    std::uint64_t errors = 0;
+    for (const WorkerResult& result : results)
+    {
+        latencies.insert(latencies.end(), result.latenciesNs.begin(), result.latenciesNs.end());
+        errors += result.errors;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    double throughput = static_cast<double>(latencies.size()) / elapsed;
+    std::printf("target       %s\n", config.url.c_str());
+    std::printf("requests     %zu in %.2f s, %llu failed\n", latencies.size(), elapsed,
+                static_cast<unsigned long long>(errors));
+    std::printf("throughput   %.1f requests/s", throughput);
+    if (config.mode == LoadMode::BATCH)
+    {
+        std::printf(", %.1f readings/s", throughput * static_cast<double>(config.batchSize));
+    }
+    std::printf("\n");
+    std::printf("latency us   p50 %.1f  p99 %.1f  p999 %.1f  max %.1f\n",
+                percentileMicros(latencies, 0.50), percentileMicros(latencies, 0.99),
+                percentileMicros(latencies, 0.999), percentileMicros(latencies, 1.0));
+
+    // Per-attempt phases as the client itself measured them
+    MetricsSnapshot metrics = client.metrics();
+    constexpr std::pair<RequestPhase, const char*> kPhases[] = {
+        {RequestPhase::DNS, "dns"},   {RequestPhase::CONNECT, "connect"},
+        {RequestPhase::TLS, "tls"},   {RequestPhase::TTFB, "ttfb"},
+        {RequestPhase::TOTAL, "total"},
+    };
+    for (auto [phase, name] : kPhases)
+    {
+        const HistogramSnapshot& histogram = metrics.latency(phase);
+        if (histogram.count > 0)
+        {
+            std::printf("  %-10s p50 %" PRIu64 "  p99 %" PRIu64 "  p999 %" PRIu64 "  (%" PRIu64
+                        " samples)\n",
+                        name, histogram.percentile(0.5), histogram.percentile(0.99),
+                        histogram.percentile(0.999), histogram.count);
+        }
+    }
+    std::printf("retries      %" PRIu64 ", %" PRIu64 " bytes sent, %" PRIu64 " received\n",
+                metrics.count(MetricCounter::RETRIES), metrics.count(MetricCounter::BYTES_SENT),
+                metrics.count(MetricCounter::BYTES_RECEIVED));
+    return errors == 0 ? 0 : 2;
+}
@@ -0,0 +1,299 @@
+#include "MockServer.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <stdexcept>
+#include <string_view>
+
+namespace
+{
+constexpr std::string_view kPostResponse =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/json\r\n"
+    "Content-Length: 35\r\n"
+    "\r\n"
+    R"({"status":"success","content":"ok"})";
+
+// The status never changes, so any conditional GET is answered with 304
+constexpr std::string_view kStatusResponse =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/json\r\n"
+    "ETag: \"mock-active\"\r\n"
+    "Content-Length: 8\r\n"
+    "\r\n"
+    "\"active\"";
+
+constexpr std::string_view kNotModifiedResponse =
+    "HTTP/1.1 304 Not Modified\r\n"
+    "ETag: \"mock-active\"\r\n"
+    "\r\n";
+
+constexpr std::string_view kUnavailableResponse =
+    "HTTP/1.1 503 Service Unavailable\r\n"
+    "Content-Type: application/json\r\n"
+    "Content-Length: 32\r\n"
+    "\r\n"
+    R"({"detail":"Service Unavailable"})";
+
+constexpr std::string_view kNotFoundResponse =
+    "HTTP/1.1 404 Not Found\r\n"
+    "Content-Type: application/json\r\n"
+    "Content-Length: 22\r\n"
+    "\r\n"
+    R"({"detail":"Not Found"})";
+
+constexpr std::size_t kReadChunk = 64 * 1024;
+
+bool startsWithIgnoreCase(std::string_view text, std::string_view prefix)
+{
+    if (text.size() < prefix.size())
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < prefix.size(); ++i)
+    {
+        char c = text[i];
+        if (c >= 'A' && c <= 'Z')
+        {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+        if (c != prefix[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The header line starting with the lowercase name and colon, empty if absent
+std::string_view findHeader(std::string_view head, std::string_view name)
+{
+    std::size_t lineStart = head.find("\r\n");
+    while (lineStart != std::string_view::npos && lineStart + 2 < head.size())
+    {
+        std::string_view line = head.substr(lineStart + 2);
+        if (startsWithIgnoreCase(line, name))
+        {
+            return line.substr(0, line.find("\r\n"));
+        }
+        lineStart = head.find("\r\n", lineStart + 2);
+    }
+    return {};
+}
+
+std::size_t contentLength(std::string_view head)
+{
+    constexpr std::string_view kName = "content-length:";
+    std::string_view header = findHeader(head, kName);
+    return header.empty() ? 0 : std::strtoul(header.data() + kName.size(), nullptr, 10);
+}
+
+// Length of a chunked body at the start of data, npos while it is incomplete
+std::size_t chunkedLength(std::string_view data)
+{
+    std::size_t offset = 0;
+    for (;;)
+    {
+        std::size_t lineEnd = data.find("\r\n", offset);
+        if (lineEnd == std::string_view::npos)
+        {
+            return std::string_view::npos;
+        }
+        std::size_t size = std::strtoul(data.data() + offset, nullptr, 16);
+        offset = lineEnd + 2 + size + 2;
+        if (offset > data.size())
+        {
+            return std::string_view::npos;
+        }
+        if (size == 0)
+        {
+            return offset;
+        }
+    }
+}
+
+// Length of the body following head at the start of data, npos while it is incomplete
+std::size_t bodyLength(std::string_view head, std::string_view data)
+{
+    if (!findHeader(head, "transfer-encoding:").empty())
+    {
+        return chunkedLength(data);
+    }
+    std::size_t length = contentLength(head);
+    return data.size() >= length ? length : std::string_view::npos;
+}
+
+bool sendAll(int fd, std::string_view data)
+{
+    while (!data.empty())
+    {
+        ssize_t sent = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (sent <= 0)
+        {
+            return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(sent));
+    }
+    return true;
+}
+
+}  // unnamed namespace
+
+MockServer::MockServer(const MockServerConfig& config) : config(config)
+{
+    listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0)
+    {
+        throw std::runtime_error("MockServer: cannot create socket");
+    }
+
+    int enable = 1;
+    ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(config.port);
+    socklen_t length = sizeof(address);
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listenFd, SOMAXCONN) != 0 ||
+        ::getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+    {
+        ::close(listenFd);
+        throw std::runtime_error("MockServer: cannot listen on port " +
+                                 std::to_string(config.port));
+    }
+    port = ntohs(address.sin_port);
+
+    acceptor = std::thread(&MockServer::acceptLoop, this);
+}
+
+MockServer::~MockServer()
+{
+    stopping.store(true);
+    // Wakes the blocked accept() and recv() calls
+    ::shutdown(listenFd, SHUT_RDWR);
+    acceptor.join();
+    ::close(listenFd);
+
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    for (int fd : connectionFds)
+    {
+        ::shutdown(fd, SHUT_RDWR);
+    }
+    for (std::thread& connection : connections)
+    {
+        connection.join();
+    }
+    for (int fd : connectionFds)
+    {
+        ::close(fd);
+    }
+}
+
+std::string MockServer::url() const
+{
+    return "http://127.0.0.1:" + std::to_string(port);
+}
+
+void MockServer::acceptLoop()
+{
+    while (!stopping.load())
+    {
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        int enable = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        if (stopping.load())
+        {
+            ::close(fd);
+            break;
+        }
+        connectionFds.push_back(fd);
+        connections.emplace_back(&MockServer::serve, this, fd);
+    }
+}
+
+void MockServer::serve(int fd)
+{
+    std::string buffer;
+    std::size_t parsed = 0;  // Start of the first unanswered request in buffer
+    char chunk[kReadChunk];
+    for (;;)
+    {
+        std::string_view pending = std::string_view(buffer).substr(parsed);
+        std::size_t headEnd = pending.find("\r\n\r\n");
+        if (headEnd != std::string_view::npos)
+        {
+            std::string_view head = pending.substr(0, headEnd);
+            std::size_t length = bodyLength(head, pending.substr(headEnd + 4));
+            if (length != std::string_view::npos)
+            {
+                std::size_t requestLength = headEnd + 4 + length;
+                std::string_view response = kNotFoundResponse;
+                bool post = head.starts_with("POST ");
+                if (post)
+                {
+                    response = kPostResponse;
+                }
+                else if (head.starts_with("GET /get-vehicle-status/"))
+                {
+                    bool conditional = !findHeader(head, "if-none-match:").empty();
+                    response = conditional ? kNotModifiedResponse : kStatusResponse;
+                }
+
+                // Requests over capacity are turned away without being processed
+                bool admitted = true;
+                if (post && config.capacity > 0)
+                {
+                    admitted = processing.fetch_add(1, std::memory_order_acq_rel) <
+                               config.capacity;
+                    if (!admitted)
+                    {
+                        response = kUnavailableResponse;
+                        rejectedCount.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                if (admitted && config.latency.count() > 0)
+                {
+                    std::this_thread::sleep_for(config.latency);
+                }
+                if (post && config.capacity > 0)
+                {
+                    processing.fetch_sub(1, std::memory_order_acq_rel);
+                }
+                if (!sendAll(fd, response))
+                {
+                    return;
+                }
+                requestCount.fetch_add(1, std::memory_order_relaxed);
+
+                parsed += requestLength;
+                if (parsed == buffer.size())
+                {
+                    buffer.clear();
+                    parsed = 0;
+                }
+                continue;
+            }
+        }
+
+        ssize_t received = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (received <= 0)
+        {
+            return;
+        }
+        buffer.append(chunk, static_cast<std::size_t>(received));
+    }
+}
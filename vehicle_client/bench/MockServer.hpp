@@ -0,0 +1,102 @@
+#ifndef MOCK_SERVER_HPP
+#define MOCK_SERVER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @struct MockServerConfig
+ * @brief Listening port, simulated processing time and capacity of a MockServer.
+ */
+struct MockServerConfig
+{
+    std::uint16_t port = 0;                ///< 0 picks a free port.
+    std::chrono::microseconds latency{0};  ///< Delay before each response.
+    std::size_t capacity = 0;              ///< POSTs processed at once, 0 for no limit.
+};
+
+/**
+ * @class MockServer
+ * @brief Minimal HTTP/1.1 server on the loopback interface that answers like the API.
+ *
+ * Every POST is answered with {"status": "success"} and GET /get-vehicle-status/
+ * with the status "active" and an ETag, or 304 Not Modified when revalidated.
+ * Connections are kept alive, so the client's connection reuse is exercised as
+ * against the real server. Each connection is served by its
+ * own thread. The server does no work besides framing, so load results measure
+ * the client side and the loopback stack.
+ *
+ * With a capacity, a POST arriving while that many are being processed is
+ * answered right away with 503 Service Unavailable, like an overloaded server.
+ */
+class MockServer
+{
+   public:
+    /**
+     * @brief Binds the port and starts accepting connections.
+     *
+     * @throws std::runtime_error If the socket cannot be bound.
+     */
+    explicit MockServer(const MockServerConfig& config = {});
+
+    /**
+     * @brief Closes the listening socket and all connections.
+     */
+    ~MockServer();
+
+    MockServer(const MockServer&) = delete;
+    MockServer& operator=(const MockServer&) = delete;
+
+    /**
+     * @brief Returns the base URL of the server, e.g. "http://127.0.0.1:40123".
+     */
+    std::string url() const;
+
+    /**
+     * @brief Returns the number of requests answered so far.
+     */
+    std::uint64_t requests() const
+    {
+        return requestCount.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the number of POSTs answered with 503 for lack of capacity.
+     */
+    std::uint64_t rejected() const
+    {
+        return rejectedCount.load(std::memory_order_relaxed);
+    }
+
+   private:
+    MockServerConfig config;
+    int listenFd = -1;
+    std::uint16_t port = 0;                       ///< The bound port.
+    std::atomic<bool> stopping{false};            ///< Set by the destructor.
+    std::atomic<std::uint64_t> requestCount{0};   ///< Answered requests.
+    std::atomic<std::uint64_t> rejectedCount{0};  ///< POSTs turned away over capacity.
+    std::atomic<std::size_t> processing{0};       ///< POSTs being processed.
+    std::thread acceptor;                         ///< Runs acceptLoop().
+
+    std::mutex connectionsMutex;           ///< Guards the two vectors below.
+    std::vector<int> connectionFds;        ///< Open client sockets, shut down on stop.
+    std::vector<std::thread> connections;  ///< One thread per client socket.
+
+    /**
+     * @brief Accepts connections until the server stops.
+     */
+    void acceptLoop();
+
+    /**
+     * @brief Answers the requests of one connection until the client closes it.
+     */
+    void serve(int fd);
+};
+
+#endif  // MOCK_SERVER_HPP
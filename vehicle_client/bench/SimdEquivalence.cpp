@@ -0,0 +1,189 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "SimdKernels.hpp"
+
+/*
+ * Runs every batch kernel on SCALAR and on each SIMD level this CPU supports
+ * and checks that the results match bit for bit. The inputs cover NaN (also in
+ * the first position), signed zeros and infinities, and lengths around every
+ * multiple of the eight-lane block so that the scalar tails are exercised too.
+ */
+
+namespace
+{
+// Every length up to this is checked, then a few long arrays with ragged tails
+constexpr std::size_t kMaxShortLength = 64;
+constexpr std::size_t kLongLengths[] = {1000, 1001, 1007, 4099};
+
+// Input variants per length
+constexpr int kRounds = 8;
+
+template <typename T>
+std::uint64_t bitsOf(T value)
+{
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(value));
+    return bits;
+}
+
+// Random values with a sprinkling of the special ones; the first value is special in some rounds
+std::vector<float> makeValues(std::size_t length, int round, std::mt19937& gen)
+{
+    static constexpr float kSpecial[] = {std::numeric_limits<float>::quiet_NaN(),
+                                         -0.0f,
+                                         0.0f,
+                                         std::numeric_limits<float>::infinity(),
+                                         -std::numeric_limits<float>::infinity(),
+                                         std::numeric_limits<float>::denorm_min(),
+                                         std::numeric_limits<float>::max()};
+    std::uniform_real_distribution<float> values(-1000.0f, 1000.0f);
+    std::uniform_int_distribution<std::size_t> special(0, std::size(kSpecial) - 1);
+    std::vector<float> out(length);
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        bool useSpecial = round > 0 && (i == 0 ? round % 2 == 0 : gen() % 8 == 0);
+        out[i] = useSpecial ? kSpecial[special(gen)] : values(gen);
+    }
+    return out;
+}
+
+// Mostly evenly spaced capture times with jitter, gaps and the occasional step backwards
+std::vector<std::uint64_t> makeTimestamps(std::size_t length, std::mt19937& gen)
+{
+    std::vector<std::uint64_t> out(length);
+    std::uint64_t timestamp = 1700000000000000ULL;
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        out[i] = timestamp;
+        switch (gen() % 8)
+        {
+            case 0:
+                timestamp -= gen() % 5000;
+                break;
+            case 1:
+                timestamp += std::uint64_t{gen()} << 20;
+                break;
+            default:
+                timestamp += 1000 + gen() % 3;
+        }
+    }
+    return out;
+}
+
+struct Results
+{
+    MinMaxSum reduced;
+    std::vector<std::uint32_t> xored;
+    std::vector<std::uint64_t> deltas;
+};
+
+Results run(const std::vector<float>& values, const std::vector<std::uint64_t>& timestamps)
+{
+    Results results;
+    results.reduced = minMaxSum(values);
+
+    std::vector<std::uint32_t> words(values.size());
+    std::memcpy(words.data(), values.data(), values.size() * sizeof(float));
+    results.xored.resize(words.size());
+    xorWithPrevious(words, results.xored.data());
+
+    if (!timestamps.empty())
+    {
+        results.deltas.resize(timestamps.size() - 1);
+        zigzagDeltaOfDeltas(timestamps, results.deltas.data());
+    }
+    return results;
+}
+
+// Reports the first difference between the two results, returns whether there was none
+bool same(const Results& expected, const Results& actual, std::size_t length, int round)
+{
+    const char* kernel = nullptr;
+    if (bitsOf(expected.reduced.min) != bitsOf(actual.reduced.min) ||
+        bitsOf(expected.reduced.max) != bitsOf(actual.reduced.max) ||
+        bitsOf(expected.reduced.sum) != bitsOf(actual.reduced.sum))
+    {
+        kernel = "minMaxSum";
+    }
+    else if (expected.xored != actual.xored)
+    {
+        kernel = "xorWithPrevious";
+    }
+    else if (expected.deltas != actual.deltas)
+    {
+        kernel = "zigzagDeltaOfDeltas";
+    }
+    if (kernel)
+    {
+        std::printf("  %s differs at length %zu, round %d\n", kernel, length, round);
+    }
+    return !kernel;
+}
+
+// Checks one level against SCALAR on every input, returns the number of mismatches
+int compare(SimdLevel level)
+{
+    std::mt19937 gen(7);
+    std::vector<std::size_t> lengths;
+    for (std::size_t length = 0; length <= kMaxShortLength; ++length)
+    {
+        lengths.push_back(length);
+    }
+    lengths.insert(lengths.end(), std::begin(kLongLengths), std::end(kLongLengths));
+
+    int mismatches = 0;
+    int checked = 0;
+    for (std::size_t length : lengths)
+    {
+        for (int round = 0; round < kRounds; ++round)
+        {
+            std::vector<float> values = makeValues(length, round, gen);
+            std::vector<std::uint64_t> timestamps = makeTimestamps(length, gen);
+
+            setSimdLevel(SimdLevel::SCALAR);
+            Results expected = run(values, timestamps);
+            setSimdLevel(level);
+            Results actual = run(values, timestamps);
+
+            ++checked;
+            if (!same(expected, actual, length, round))
+            {
+                ++mismatches;
+            }
+        }
+    }
+    std::printf("%-6s %d inputs, %d mismatches\n", simdLevelToString(level), checked, mismatches);
+    return mismatches;
+}
+
+}  // unnamed namespace
+
+int main()
+{
+    SimdLevel selected = simdLevel();
+    int mismatches = 0;
+    int compared = 0;
+    for (SimdLevel level : {SimdLevel::AVX2, SimdLevel::NEON})
+    {
+        if (!setSimdLevel(level))
+        {
+            std::printf("%-6s not supported here, skipped\n", simdLevelToString(level));
+            continue;
+        }
+        ++compared;
+        mismatches += compare(level);
+    }
+    setSimdLevel(selected);
+
+    if (compared == 0)
+    {
+        std::printf("Only the scalar kernels are available, nothing to compare\n");
+    }
+    return mismatches == 0 ? 0 : 1;
+}
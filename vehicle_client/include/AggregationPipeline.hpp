@@ -0,0 +1,155 @@
+#ifndef AGGREGATION_PIPELINE_HPP
+#define AGGREGATION_PIPELINE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "DataTypes.hpp"
+
+/**
+ * @enum AggregationMode
+ * @brief How the readings of one sensor type are reduced before upload.
+ */
+enum class AggregationMode
+{
+    RAW,             ///< Every reading is uploaded unchanged.
+    WINDOW_MEAN,     ///< One reading per window: the mean, at the mean capture time.
+    WINDOW_MIN_MAX,  ///< The window's minimum and maximum, at their own capture times.
+    DEADBAND,        ///< Only readings that moved more than deadband since the last upload.
+    LTTB,            ///< Largest-Triangle-Three-Buckets, outputPoints readings per window.
+};
+
+/**
+ * @struct AggregationPolicy
+ * @brief Reduction applied to the readings of one sensor type.
+ */
+struct AggregationPolicy
+{
+    AggregationMode mode = AggregationMode::RAW;
+    std::size_t windowSize = 64;   ///< Readings per window of the windowed modes.
+    float deadband = 0.0f;         ///< DEADBAND threshold, in the sensor's unit.
+    std::size_t outputPoints = 8;  ///< Readings LTTB keeps per full window, at least 3.
+};
+
+/**
+ * @struct AggregationConfig
+ * @brief Per-sensor-type policies of an AggregationPipeline.
+ */
+struct AggregationConfig
+{
+    AggregationPolicy defaultPolicy;                             ///< For types without a policy.
+    std::unordered_map<SensorType, AggregationPolicy> policies;  ///< Policies by sensor type.
+    std::chrono::milliseconds maxWindowAge{10000};               ///< Partial window lifetime.
+};
+
+/**
+ * @struct WindowStats
+ * @brief Summary of the values of one window.
+ */
+struct WindowStats
+{
+    float min = 0.0f;
+    float max = 0.0f;
+    float mean = 0.0f;
+    std::size_t count = 0;
+};
+
+/**
+ * @class AggregationPipeline
+ * @brief Pre-upload stage that reduces each vehicle's sensor streams at the edge.
+ *
+ * Readings are collected per vehicle and sensor type into fixed-size windows kept
+ * as struct-of-arrays (one contiguous array of values, one of timestamps), so the
+ * reductions run over plain float arrays with the SIMD kernels of SimdKernels.hpp.
+ * A window is reduced once it is full or, via takeDue(), once its first reading
+ * is older than maxWindowAge. NaN and infinite values are left out of the
+ * reduction, and a window without a finite value yields no reading. RAW and
+ * DEADBAND readings are not windowed and pass (or are dropped) immediately. All
+ * methods are thread-safe.
+ */
+class AggregationPipeline
+{
+   public:
+    /// A vehicle serial together with readings that are ready for upload.
+    using Batch = std::pair<std::string, std::vector<SensorReading>>;
+
+    /**
+     * @brief Constructs a pipeline with the given policies.
+     */
+    explicit AggregationPipeline(const AggregationConfig& config);
+
+    /**
+     * @brief Feeds one reading through the policy of its sensor type.
+     *
+     * @param vehicleSerial The serial number of the vehicle.
+     * @param reading The captured reading.
+     * @param ready Receives the readings that are ready for upload, if any.
+     */
+    void process(const std::string& vehicleSerial, const SensorReading& reading,
+                 std::vector<SensorReading>& ready);
+
+    /**
+     * @brief Reduces and takes every window that has been open for too long.
+     *
+     * @param force If true, every non-empty window is closed regardless of its age.
+     * @return The reduced readings, grouped by vehicle.
+     */
+    std::vector<Batch> takeDue(bool force = false);
+
+    /**
+     * @brief Computes min, max, mean and count of a window's values.
+     */
+    static WindowStats summarize(std::span<const float> values);
+
+    /**
+     * @brief Selects the points of a series that Largest-Triangle-Three-Buckets keeps.
+     *
+     * The first and last points are always kept; every bucket in between
+     * contributes the point spanning the largest triangle with its neighbours.
+     *
+     * @param timestamps Capture times of the series, ascending.
+     * @param values Values of the series, same length as timestamps.
+     * @param points Number of points to keep, at least 3.
+     * @param keep Receives the indices of the kept points, ascending.
+     */
+    static void downsample(std::span<const std::uint64_t> timestamps,
+                           std::span<const float> values, std::size_t points,
+                           std::vector<std::size_t>& keep);
+
+   private:
+    struct SensorWindow
+    {
+        std::vector<std::uint64_t> timestamps;         ///< Capture times of pending readings.
+        std::vector<float> values;                     ///< Values of pending readings.
+        std::chrono::steady_clock::time_point opened;  ///< When the first reading arrived.
+        float lastSent = 0.0f;                         ///< Last value DEADBAND let through.
+        bool sentAny = false;                          ///< Whether lastSent is set.
+    };
+
+    /// Windows of one vehicle, indexed by SensorType.
+    using VehicleWindows = std::vector<SensorWindow>;
+
+    const AggregationPolicy& policyFor(SensorType sensorType) const;
+
+    /**
+     * @brief Appends the reduced readings of a window's finite values to @p out and empties it.
+     */
+    void closeWindow(SensorType sensorType, SensorWindow& window, std::vector<SensorReading>& out);
+
+    std::vector<AggregationPolicy> policies;  ///< Policies indexed by SensorType.
+    AggregationPolicy defaultPolicy;
+    std::chrono::milliseconds maxWindowAge;
+
+    std::mutex mutex;                                          ///< Guards vehicles and keepScratch.
+    std::unordered_map<std::string, VehicleWindows> vehicles;  ///< Open windows by serial.
+    std::vector<std::size_t> keepScratch;                      ///< Reused LTTB output.
+};
+
+#endif  // AGGREGATION_PIPELINE_HPP
@@ -0,0 +1,167 @@
+#ifndef ASYNC_TRANSPORT_HPP
+#define ASYNC_TRANSPORT_HPP
+
+#include <curl/curl.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ClientMetrics.hpp"
+#include "ConnectionPool.hpp"
+#include "RetryPolicy.hpp"
+
+/**
+ * @struct HttpRequest
+ * @brief Description of a single HTTP request handed to the AsyncTransport.
+ */
+struct HttpRequest
+{
+    std::string url;                           ///< Absolute request URL.
+    std::string body;                          ///< Request body, only sent for POST requests.
+    bool post = false;                         ///< True for POST, false for GET.
+    std::vector<std::string> headers;          ///< Extra request headers ("Name: value").
+    curl_slist* sharedHeaders = nullptr;       ///< Prebuilt headers sent after headers, not owned.
+    bool idempotent = false;                   ///< Safe to send again after a transient failure.
+    std::shared_ptr<RetryPolicy> retryPolicy;  ///< Retries and circuit breaker, null to send once.
+};
+
+/**
+ * @struct HttpResponse
+ * @brief Outcome of a request completed by the AsyncTransport.
+ */
+struct HttpResponse
+{
+    CURLcode curlCode = CURLE_OK;  ///< Transport-level result of the transfer.
+    long statusCode = 0;           ///< HTTP status code, 0 if no response was received.
+    std::string_view body;         ///< Raw response body, only valid during the callback.
+    std::string_view etag;         ///< ETag header, empty if absent; valid during the callback.
+};
+
+/**
+ * @class AsyncTransport
+ * @brief Non-blocking HTTP transport driven by a background curl_multi event loop.
+ *
+ * Requests are queued from any thread and run concurrently on a single event
+ * loop thread, which waits with curl_multi_poll and is woken up whenever new work
+ * is submitted. Completion callbacks are invoked on the event loop thread, so they
+ * must be short and must not block. Response bodies are received into the leased
+ * handle's reusable buffer and are only valid while the callback runs.
+ *
+ * Requests that carry a RetryPolicy are resent after transient failures once
+ * their backoff has elapsed, without blocking the loop, and the callback only
+ * sees the final outcome. While the policy's circuit breaker is open they fail
+ * right away with CURLE_COULDNT_CONNECT.
+ */
+class AsyncTransport
+{
+   public:
+    /// Invoked on the event loop thread once a request has completed or failed.
+    using Callback = std::function<void(const HttpResponse&)>;
+
+    /**
+     * @brief Starts the event loop thread.
+     *
+     * @param pool The pool used to lease easy handles for each transfer. It must
+     *        outlive the transport.
+     * @param metrics Receives the timings and outcome of every transfer; must
+     *        outlive the transport.
+     */
+    AsyncTransport(ConnectionPool& pool, ClientMetrics& metrics);
+
+    /**
+     * @brief Stops accepting requests, waits for in-flight transfers and joins the loop.
+     */
+    ~AsyncTransport();
+
+    AsyncTransport(const AsyncTransport&) = delete;
+    AsyncTransport& operator=(const AsyncTransport&) = delete;
+
+    /**
+     * @brief Queues a request for asynchronous execution.
+     *
+     * If the transport is shutting down, the callback is invoked immediately
+     * with CURLE_FAILED_INIT.
+     *
+     * @param request The request to perform.
+     * @param callback Completion callback, invoked exactly once.
+     */
+    void submit(HttpRequest request, Callback callback);
+
+    /**
+     * @brief Fails every request still outstanding at a deadline, instead of waiting for it.
+     *
+     * From the deadline on, running transfers, backed-off retries and new
+     * submissions complete with CURLE_OPERATION_TIMEDOUT, so a shutdown waits
+     * at most until then.
+     */
+    void abortAt(std::chrono::steady_clock::time_point deadline);
+
+   private:
+    struct Transfer
+    {
+        ConnectionPool::Handle handle;
+        HttpRequest request;
+        Callback callback;
+        std::vector<curl_slist> headerNodes;  ///< Link request.headers in front of sharedHeaders.
+        HttpResponse response;
+        int attempts = 0;                               ///< Times the request was sent.
+        std::chrono::steady_clock::time_point retryAt;  ///< When a backed-off retry is due.
+    };
+
+    ConnectionPool& pool;
+    ClientMetrics& metrics;
+    CURLM* multi;
+
+    std::mutex submitMutex;                            ///< Guards submitted, stopping, deadline.
+    std::vector<std::unique_ptr<Transfer>> submitted;  ///< Requests not yet added to multi.
+    bool stopping = false;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+    std::vector<Transfer*> running;  ///< Transfers owned by multi, loop thread only.
+
+    std::vector<std::unique_ptr<Transfer>> backingOff;  ///< Retries not yet due, loop thread only.
+
+    std::thread loopThread;
+
+    /**
+     * @brief Event loop: adds submitted transfers, drives them and reports completions.
+     */
+    void run();
+
+    /**
+     * @brief Sets the per-request options on a transfer's easy handle and adds it to multi.
+     */
+    void start(std::unique_ptr<Transfer> transfer);
+
+    /**
+     * @brief Removes a finished transfer from multi and either schedules a retry or
+     *        invokes its callback.
+     */
+    void finish(CURL* curl, CURLcode result);
+
+    /**
+     * @brief Removes every running transfer from multi and fails it as timed out.
+     */
+    void abortRunning();
+
+    /**
+     * @brief Counts a transfer as done and invokes its callback.
+     */
+    void complete(Transfer& transfer);
+
+    /**
+     * @brief Starts the retries that are due. When shutting down, pending retries are
+     *        abandoned and their callbacks get the last failed response instead.
+     *
+     * @return How long the loop may wait before the next retry is due.
+     */
+    std::chrono::milliseconds startDueRetries(bool shuttingDown);
+};
+
+#endif  // ASYNC_TRANSPORT_HPP
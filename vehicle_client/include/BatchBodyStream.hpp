@@ -0,0 +1,92 @@
+#ifndef BATCH_BODY_STREAM_HPP
+#define BATCH_BODY_STREAM_HPP
+
+#include <curl/curl.h>
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+#include "DataTypes.hpp"
+#include "PayloadSerializer.hpp"
+
+/**
+ * @class BatchBodyStream
+ * @brief Streams a sensor batch request body to libcurl while encoding it.
+ *
+ * The readings are given as a list of spans, e.g. consecutive records of a
+ * memory-mapped spool segment, and are read in place. libcurl pulls the body
+ * through CURLOPT_READFUNCTION; each call encodes the next slice of at most
+ * kSliceReadings readings into the serializer's buffer, so memory stays flat
+ * however large the batch is and the upload starts before the body is complete.
+ * The size is not known in advance, so HTTP/1.1 requests are sent with chunked
+ * transfer encoding.
+ *
+ * libcurl rewinds the body through CURLOPT_SEEKFUNCTION when it has to resend
+ * it on a new connection; before a retried attempt, call rewind().
+ */
+class BatchBodyStream
+{
+   public:
+    /// Readings encoded per read callback at most.
+    static constexpr std::size_t kSliceReadings = 256;
+
+    /**
+     * @brief Prepares a body without encoding anything yet.
+     *
+     * @param pieces The readings in order; the spans and the readings must
+     *        outlive the stream.
+     * @param vehicleSerial The serial number of the vehicle, must outlive the stream.
+     * @param format A streamable encoding, see PayloadSerializer::isStreamable.
+     * @param serializer Encodes the slices; must not be used by anything else
+     *        while a transfer reads from the stream.
+     */
+    BatchBodyStream(std::span<const std::span<const SensorReading>> pieces,
+                    std::string_view vehicleSerial, WireFormat format,
+                    PayloadSerializer& serializer);
+
+    BatchBodyStream(const BatchBodyStream&) = delete;
+    BatchBodyStream& operator=(const BatchBodyStream&) = delete;
+
+    /**
+     * @brief Makes an easy handle POST this stream as its body.
+     */
+    void attach(CURL* curl);
+
+    /**
+     * @brief Restarts the body from its first byte.
+     */
+    void rewind();
+
+   private:
+    enum class Stage
+    {
+        HEAD,
+        READINGS,
+        TAIL,
+        DONE
+    };
+
+    std::span<const std::span<const SensorReading>> pieces;
+    std::string_view vehicleSerial;
+    WireFormat format;
+    PayloadSerializer& serializer;
+    std::size_t count = 0;  ///< Readings in all pieces.
+
+    Stage stage = Stage::HEAD;
+    std::size_t piece = 0;     ///< Piece the next slice is taken from.
+    std::size_t offset = 0;    ///< Readings of that piece already encoded.
+    std::string_view pending;  ///< Encoded bytes not yet handed to libcurl.
+
+    /**
+     * @brief Encodes the next part of the body into pending.
+     *
+     * @return False once the whole body has been encoded.
+     */
+    bool encodeNext();
+
+    static std::size_t read(char* buffer, std::size_t size, std::size_t items, void* userdata);
+    static int seek(void* userdata, curl_off_t offset, int origin);
+};
+
+#endif  // BATCH_BODY_STREAM_HPP
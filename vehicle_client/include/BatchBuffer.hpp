@@ -0,0 +1,99 @@
+#ifndef BATCH_BUFFER_HPP
+#define BATCH_BUFFER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "DataTypes.hpp"
+
+/**
+ * @struct BatchConfig
+ * @brief Flush thresholds for the client-side coalescing buffer.
+ *
+ * A vehicle's pending batch is flushed as soon as any one of the thresholds is reached.
+ */
+struct BatchConfig
+{
+    std::size_t maxReadings = 256;           ///< Flush after this many readings.
+    std::size_t maxBytes = 32 * 1024;        ///< Flush once the estimated body reaches this size.
+    std::chrono::milliseconds maxAge{1000};  ///< Flush once the oldest reading is this old.
+};
+
+/**
+ * @class BatchBuffer
+ * @brief Coalesces individual sensor readings into per-vehicle batches.
+ *
+ * The buffer only decides when a batch is due; sending it is left to the owner
+ * (normally VehicleClient). All methods are thread-safe.
+ */
+class BatchBuffer
+{
+   public:
+    /// A vehicle serial together with the readings taken out of the buffer for it.
+    using Batch = std::pair<std::string, std::vector<SensorReading>>;
+
+    /**
+     * @brief Constructs an empty buffer with the given flush thresholds.
+     *
+     * @param config The size, byte and age thresholds.
+     */
+    explicit BatchBuffer(const BatchConfig& config);
+
+    /**
+     * @brief Appends a reading to the pending batch of a vehicle.
+     *
+     * @param vehicleSerial The serial number of the vehicle.
+     * @param reading The sensor reading to buffer.
+     * @return True if the vehicle's batch reached its size or byte threshold and
+     *         should be flushed now, false otherwise.
+     */
+    bool add(const std::string& vehicleSerial, const SensorReading& reading);
+
+    /**
+     * @brief Takes the pending readings of one vehicle out of the buffer.
+     *
+     * @param vehicleSerial The serial number of the vehicle.
+     * @return The buffered readings, empty if there were none.
+     */
+    std::vector<SensorReading> take(const std::string& vehicleSerial);
+
+    /**
+     * @brief Takes every batch that is due out of the buffer.
+     *
+     * @param force If true, every non-empty batch is returned regardless of its age.
+     * @return The batches whose oldest reading exceeded the age threshold.
+     */
+    std::vector<Batch> takeDue(bool force = false);
+
+    /**
+     * @brief Returns the number of readings buffered across all vehicles.
+     */
+    std::size_t pendingReadings();
+
+    /**
+     * @brief Returns the configured thresholds.
+     */
+    const BatchConfig& config() const
+    {
+        return batchConfig;
+    }
+
+   private:
+    struct PendingBatch
+    {
+        std::vector<SensorReading> readings;
+        std::size_t estimatedBytes = 0;
+        std::chrono::steady_clock::time_point firstAdded;
+    };
+
+    BatchConfig batchConfig;
+    std::mutex mutex;
+    std::unordered_map<std::string, PendingBatch> pending;
+};
+
+#endif  // BATCH_BUFFER_HPP
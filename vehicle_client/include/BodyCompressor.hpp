@@ -0,0 +1,98 @@
+#ifndef BODY_COMPRESSOR_HPP
+#define BODY_COMPRESSOR_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+struct ZSTD_CDict_s;
+
+/**
+ * @brief Content-Encoding applied to request bodies.
+ */
+enum class Compression
+{
+    NONE,  ///< Bodies are sent as is.
+    GZIP,  ///< RFC 1952 gzip via zlib.
+    ZSTD   ///< Zstandard, optionally with a dictionary; needs a build with zstd.
+};
+
+/**
+ * @struct CompressionConfig
+ * @brief Request body compression settings of a VehicleClient.
+ */
+struct CompressionConfig
+{
+    Compression algorithm = Compression::NONE;  ///< Content-Encoding of request bodies.
+    std::size_t minBytes = 1024;                ///< Smaller bodies are sent uncompressed.
+    int level = 0;                              ///< Codec level, 0 selects the codec default.
+    std::string dictionary;                     ///< zstd dictionary shared with the server.
+};
+
+/**
+ * @class BodyCompressor
+ * @brief Compresses request bodies above a size threshold.
+ *
+ * The codec state (z_stream or ZSTD_CCtx) and the output buffer are kept per
+ * thread and reused, so after warm-up compressing a body allocates nothing and
+ * needs no lock. A zstd dictionary is digested once into a shared, read-only
+ * ZSTD_CDict. Small bodies are left alone because the codec framing would
+ * outweigh the savings; bodies that do not shrink are sent uncompressed too.
+ */
+class BodyCompressor
+{
+   public:
+    /**
+     * @brief Prepares a compressor; check isSupported before enabling ZSTD.
+     *
+     * @param config The algorithm, size threshold, level and dictionary.
+     */
+    explicit BodyCompressor(const CompressionConfig& config);
+
+    ~BodyCompressor();
+
+    BodyCompressor(const BodyCompressor&) = delete;
+    BodyCompressor& operator=(const BodyCompressor&) = delete;
+
+    /**
+     * @brief Returns whether this build can compress with an algorithm.
+     */
+    static bool isSupported(Compression algorithm);
+
+    /**
+     * @brief Compresses a body if it is large enough and actually shrinks.
+     *
+     * @param body The encoded request body.
+     * @param compressed Receives the compressed body, valid until the next call
+     *        on the same thread.
+     * @return True if compressed was set, false if the body should be sent as is.
+     */
+    bool compress(std::string_view body, std::string_view& compressed) const;
+
+    /**
+     * @brief Returns the complete Content-Encoding request header for compressed bodies.
+     */
+    const char* contentEncodingHeader() const;
+
+    /**
+     * @brief Returns the complete Content-Encoding request header of an algorithm.
+     */
+    static const char* contentEncodingHeader(Compression algorithm);
+
+    /**
+     * @brief Returns the algorithm compressed bodies are encoded with.
+     */
+    Compression algorithm() const
+    {
+        return config.algorithm;
+    }
+
+   private:
+    CompressionConfig config;
+    ZSTD_CDict_s* zstdDictionary = nullptr;  ///< Digested dictionary, null if none.
+
+    bool compressGzip(std::string_view body, std::string& out) const;
+    bool compressZstd(std::string_view body, std::string& out) const;
+};
+
+#endif  // BODY_COMPRESSOR_HPP
@@ -0,0 +1,242 @@
+#ifndef CLIENT_METRICS_HPP
+#define CLIENT_METRICS_HPP
+
+#include <curl/curl.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Every client counter as X(enumerator, Prometheus name, help text). The
+ * exported name is prefixed with "vehicle_client_".
+ */
+#define VEHICLE_CLIENT_METRIC_COUNTERS(X)                                                       \
+    X(REQUESTS, "requests_total", "Requests completed, successfully or not.")                   \
+    X(REQUEST_FAILURES, "request_failures_total",                                               \
+      "Requests that failed after all retries or were rejected by the server.")                 \
+    X(RETRIES, "retries_total", "Attempts resent after a transient failure.")                   \
+    X(BREAKER_REJECTIONS, "breaker_rejections_total",                                           \
+      "Attempts failed fast by the open circuit breaker.")                                      \
+    X(BYTES_SENT, "sent_bytes_total", "Request body bytes sent, after compression.")            \
+    X(BYTES_RECEIVED, "received_bytes_total", "Response body bytes received.")                  \
+    X(READINGS_SPOOLED, "readings_spooled_total", "Readings kept in the spool after a failure.") \
+    X(READINGS_DROPPED, "readings_dropped_total",                                               \
+      "Readings lost after a transient failure, or dropped from a full spool.")                 \
+    X(READINGS_INVALID, "readings_invalid_total", "NaN or infinite readings discarded unsent.")
+
+/**
+ * Every timed phase of a request attempt as X(enumerator, label value).
+ */
+#define VEHICLE_CLIENT_REQUEST_PHASES(X) \
+    X(DNS, "dns")                        \
+    X(CONNECT, "connect")                \
+    X(TLS, "tls")                        \
+    X(TTFB, "ttfb")                      \
+    X(TOTAL, "total")
+
+#define VEHICLE_CLIENT_ENUMERATOR(name, ...) name,
+
+/**
+ * @brief Client counters, see VEHICLE_CLIENT_METRIC_COUNTERS.
+ */
+enum class MetricCounter
+{
+    VEHICLE_CLIENT_METRIC_COUNTERS(VEHICLE_CLIENT_ENUMERATOR)
+};
+
+/**
+ * @brief Phases of a request attempt, as reported by libcurl.
+ *
+ * DNS, CONNECT and TLS are only recorded for attempts that opened a new
+ * connection; TTFB and TOTAL are measured from the start of the attempt.
+ */
+enum class RequestPhase
+{
+    VEHICLE_CLIENT_REQUEST_PHASES(VEHICLE_CLIENT_ENUMERATOR)
+};
+
+#undef VEHICLE_CLIENT_ENUMERATOR
+
+#define VEHICLE_CLIENT_COUNT(...) +1
+inline constexpr std::size_t kMetricCounterCount =
+    0 VEHICLE_CLIENT_METRIC_COUNTERS(VEHICLE_CLIENT_COUNT);
+inline constexpr std::size_t kRequestPhaseCount =
+    0 VEHICLE_CLIENT_REQUEST_PHASES(VEHICLE_CLIENT_COUNT);
+#undef VEHICLE_CLIENT_COUNT
+
+/**
+ * @class LatencyHistogram
+ * @brief Log-linear (HDR-style) histogram of durations in microseconds.
+ *
+ * Values below 32 us get a bucket each; every power of two above is split into
+ * 32 buckets, so any recorded value is known to within about 3 % up to 2^36 us.
+ * Recording is a handful of relaxed atomic increments and never allocates or
+ * locks, so any number of threads may record concurrently.
+ */
+class LatencyHistogram
+{
+   public:
+    /// Number of buckets; values above the last one are clamped into it.
+    static constexpr std::size_t kBuckets = 1024;
+
+    /**
+     * @brief Counts one duration.
+     */
+    void record(std::uint64_t micros);
+
+    /**
+     * @brief Returns the bucket a value falls into.
+     */
+    static std::size_t bucketIndex(std::uint64_t micros);
+
+    /**
+     * @brief Returns the largest value that falls into a bucket.
+     */
+    static std::uint64_t bucketUpperBound(std::size_t index);
+
+   private:
+    friend class ClientMetrics;
+
+    std::atomic<std::uint64_t> buckets[kBuckets] = {};
+    std::atomic<std::uint64_t> sumUs{0};  ///< Sum of recorded values.
+    std::atomic<std::uint64_t> maxUs{0};  ///< Largest recorded value.
+};
+
+/**
+ * @struct HistogramSnapshot
+ * @brief A point-in-time copy of a LatencyHistogram.
+ */
+struct HistogramSnapshot
+{
+    std::uint64_t count = 0;             ///< Number of recorded values.
+    std::uint64_t sumUs = 0;             ///< Sum of recorded values in microseconds.
+    std::uint64_t maxUs = 0;             ///< Largest recorded value in microseconds.
+    std::vector<std::uint64_t> buckets;  ///< Counts by LatencyHistogram bucket.
+
+    /**
+     * @brief Returns the value below which the given fraction of values fall.
+     *
+     * @param fraction Between 0 and 1, e.g. 0.99 for p99.
+     * @return The upper bound of the bucket holding that rank, in microseconds,
+     *         never more than maxUs; 0 if nothing was recorded.
+     */
+    std::uint64_t percentile(double fraction) const;
+};
+
+/**
+ * @struct MetricsSnapshot
+ * @brief Counters, queue depths and latency histograms of a VehicleClient.
+ */
+struct MetricsSnapshot
+{
+    std::uint64_t counters[kMetricCounterCount] = {};  ///< Indexed by MetricCounter.
+    HistogramSnapshot phases[kRequestPhaseCount];      ///< Indexed by RequestPhase.
+
+    std::size_t asyncInFlight = 0;     ///< Async requests submitted and not yet completed.
+    std::size_t uploadQueueDepth = 0;  ///< Tasks waiting for an upload pool worker.
+    std::size_t batchedReadings = 0;   ///< Readings waiting in the batch buffer.
+    std::uint64_t spoolBacklog = 0;    ///< Readings in the spool awaiting replay.
+
+    std::uint64_t count(MetricCounter counter) const
+    {
+        return counters[static_cast<std::size_t>(counter)];
+    }
+
+    const HistogramSnapshot& latency(RequestPhase phase) const
+    {
+        return phases[static_cast<std::size_t>(phase)];
+    }
+
+    /**
+     * @brief Renders the snapshot in the Prometheus text exposition format.
+     *
+     * Latencies are exported as summaries with the 0.5, 0.9, 0.99 and 0.999
+     * quantiles, labelled by phase.
+     */
+    std::string toPrometheus() const;
+};
+
+/**
+ * @class ClientMetrics
+ * @brief Lock-free request counters and per-phase latency histograms.
+ *
+ * Counters are striped over cache-line sized shards, and each thread increments
+ * the shard it was assigned on first use, so upload threads do not contend on a
+ * shared cache line. A snapshot sums the shards; it is consistent per counter
+ * but not across counters.
+ */
+class ClientMetrics
+{
+   public:
+    ClientMetrics() = default;
+
+    ClientMetrics(const ClientMetrics&) = delete;
+    ClientMetrics& operator=(const ClientMetrics&) = delete;
+
+    /**
+     * @brief Adds to a counter.
+     */
+    void add(MetricCounter counter, std::uint64_t amount = 1)
+    {
+        localShard().values[static_cast<std::size_t>(counter)].fetch_add(
+            amount, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Records the phase timings and body sizes of a finished attempt.
+     *
+     * @param curl The handle the attempt was performed on.
+     */
+    void recordAttempt(CURL* curl);
+
+    /**
+     * @brief Counts a completed request and whether it failed.
+     */
+    void recordRequest(bool success)
+    {
+        add(MetricCounter::REQUESTS);
+        if (!success)
+        {
+            add(MetricCounter::REQUEST_FAILURES);
+        }
+    }
+
+    /**
+     * @brief Tracks the async requests in flight, reported as MetricsSnapshot::asyncInFlight.
+     */
+    void asyncSubmitted()
+    {
+        asyncInFlight.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void asyncCompleted()
+    {
+        asyncInFlight.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Copies the counters, histograms and async requests in flight into a snapshot.
+     *
+     * The depths of queues owned by others are left 0 for the owner to fill in.
+     */
+    MetricsSnapshot snapshot() const;
+
+   private:
+    static constexpr std::size_t kShards = 16;
+
+    struct alignas(64) Shard
+    {
+        std::atomic<std::uint64_t> values[kMetricCounterCount] = {};
+    };
+
+    Shard shards[kShards];
+    LatencyHistogram phases[kRequestPhaseCount];
+    std::atomic<std::size_t> asyncInFlight{0};
+
+    Shard& localShard();
+};
+
+#endif  // CLIENT_METRICS_HPP
@@ -0,0 +1,35 @@
+#ifndef COLUMNAR_BATCH_HPP
+#define COLUMNAR_BATCH_HPP
+
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "DataTypes.hpp"
+
+/**
+ * @brief Appends a columnar encoding of a sensor batch for /add-sensor-data-columnar/.
+ *
+ * Instead of repeating the serial and sensor type in every record, the readings
+ * are grouped into one column per sensor type. Each column stores its base
+ * timestamp and the zigzag varint delta-of-deltas of the following timestamps,
+ * which is a single byte per reading for evenly sampled streams, and its values
+ * either as packed little-endian float32 or, when smaller, as a Gorilla XOR
+ * bitstream in which unchanged values take one bit.
+ *
+ * Layout (varints are unsigned LEB128):
+ * @code
+ * "VSC" version:u8(1) serialLength:varint serial columnCount:varint
+ * column: typeLength:varint type count:varint encoding:u8 baseTimestampUs:varint
+ *         (count - 1) x zigzag varint delta-of-delta
+ *         values: encoding 0 = count x float32 LE, 1 = Gorilla XOR bitstream (MSB first)
+ * @endcode
+ *
+ * @param readings The sensor readings to encode, in capture order per sensor type.
+ * @param vehicleSerial The serial number of the vehicle.
+ * @param out Buffer the encoded bytes are appended to.
+ */
+void appendColumnarBatch(std::span<const SensorReading> readings, std::string_view vehicleSerial,
+                         std::string& out);
+
+#endif  // COLUMNAR_BATCH_HPP
@@ -0,0 +1,157 @@
+#ifndef CONNECTION_POOL_HPP
+#define CONNECTION_POOL_HPP
+
+#include <curl/curl.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @class ConnectionPool
+ * @brief Keeps long-lived CURL easy handles warm between requests.
+ *
+ * Each handle is configured for TCP keep-alive and HTTP/2 negotiation and is
+ * attached to a shared CURLSH object, so DNS results, TLS sessions and open
+ * connections are reused by every handle handed out by the pool. Handles are
+ * reset (not destroyed) when returned, which keeps their connection cache alive.
+ * Every handle also owns a response buffer that keeps its capacity across leases.
+ */
+class ConnectionPool
+{
+    /// A pooled easy handle together with its reusable response buffer.
+    struct Connection
+    {
+        CURL* curl = nullptr;
+        std::string responseBuffer;
+    };
+
+   public:
+    /**
+     * @class Handle
+     * @brief RAII lease of a pooled easy handle, returned to the pool on destruction.
+     */
+    class Handle
+    {
+       public:
+        Handle(ConnectionPool& pool, std::unique_ptr<Connection> connection);
+        ~Handle();
+
+        Handle(Handle&& other) noexcept;
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+
+        /**
+         * @brief Returns the leased easy handle, or nullptr if the lease failed.
+         */
+        CURL* get() const
+        {
+            return connection ? connection->curl : nullptr;
+        }
+
+        /**
+         * @brief Returns the handle's response buffer, empty at the start of each lease.
+         */
+        std::string& responseBuffer()
+        {
+            return connection->responseBuffer;
+        }
+
+        explicit operator bool() const
+        {
+            return get() != nullptr;
+        }
+
+       private:
+        ConnectionPool* pool;
+        std::unique_ptr<Connection> connection;
+    };
+
+    /**
+     * @brief Constructs a pool with a shared DNS/TLS-session/connection cache.
+     *
+     * @param maxIdleHandles Maximum number of idle handles kept for reuse. Handles
+     *        released while the pool is full are cleaned up instead.
+     */
+    explicit ConnectionPool(std::size_t maxIdleHandles = 8);
+
+    /**
+     * @brief Cleans up all idle handles and the shared cache.
+     *
+     * All leased handles must have been returned before the pool is destroyed.
+     */
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    /**
+     * @brief Leases a configured easy handle, reusing an idle one when available.
+     *
+     * @return A handle lease; evaluates to false if CURL initialization failed.
+     */
+    Handle acquire();
+
+    /**
+     * @brief Sets the connect and total timeouts applied to every handle leased afterwards.
+     *
+     * @param connectTimeout Limit for establishing a connection.
+     * @param requestTimeout Limit for a whole transfer, zero for none.
+     */
+    void setTimeouts(std::chrono::milliseconds connectTimeout,
+                     std::chrono::milliseconds requestTimeout);
+
+    /**
+     * @brief Aborts the transfers of all handles, leased now or later, still running at a deadline.
+     *
+     * Handles leased afterwards time out at the deadline. Running transfers fail
+     * with CURLE_ABORTED_BY_CALLBACK; libcurl checks at least once a second, so
+     * they may end up to a second late.
+     */
+    void abortTransfersAt(std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * @brief Returns the deadline set by abortTransfersAt, time_point::max() if none.
+     */
+    std::chrono::steady_clock::time_point abortDeadline() const
+    {
+        return std::chrono::steady_clock::time_point(
+            std::chrono::steady_clock::duration(abortAfter.load(std::memory_order_relaxed)));
+    }
+
+   private:
+    std::size_t maxIdleHandles;  ///< Upper bound on cached idle handles.
+    CURLSH* share;               ///< Shared DNS, TLS session and connection cache.
+
+    std::atomic<long> connectTimeoutMs{0};  ///< CURLOPT_CONNECTTIMEOUT_MS of leased handles.
+    std::atomic<long> requestTimeoutMs{0};  ///< CURLOPT_TIMEOUT_MS of leased handles.
+
+    /// Steady clock ticks after which transfers are aborted.
+    std::atomic<std::chrono::steady_clock::rep> abortAfter{
+        std::chrono::steady_clock::time_point::max().time_since_epoch().count()};
+
+    std::mutex shareLocks[CURL_LOCK_DATA_LAST];                ///< One lock per shared data kind.
+    std::mutex idleMutex;                                      ///< Guards idleConnections.
+    std::vector<std::unique_ptr<Connection>> idleConnections;  ///< Handles ready for reuse.
+
+    /**
+     * @brief Applies the pool-wide defaults (share, keep-alive, HTTP/2, timeouts) to a handle.
+     */
+    void configure(CURL* curl);
+
+    /**
+     * @brief Resets a handle and puts it back into the idle list.
+     */
+    void release(std::unique_ptr<Connection> connection);
+
+    static int onProgress(void* userptr, curl_off_t downloadTotal, curl_off_t downloaded,
+                          curl_off_t uploadTotal, curl_off_t uploaded);
+    static void lockShare(CURL* curl, curl_lock_data data, curl_lock_access access, void* userptr);
+    static void unlockShare(CURL* curl, curl_lock_data data, void* userptr);
+};
+
+#endif  // CONNECTION_POOL_HPP
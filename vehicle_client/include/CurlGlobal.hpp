@@ -0,0 +1,36 @@
+#ifndef CURL_GLOBAL_HPP
+#define CURL_GLOBAL_HPP
+
+/**
+ * @class CurlGlobal
+ * @brief Reference-counted lease of libcurl's process-wide state.
+ *
+ * curl_global_init is expensive (it loads the TLS library and its CA store)
+ * and, like curl_global_cleanup, must not run while another thread uses
+ * libcurl. The first lease in the process initializes libcurl and the last
+ * one to go cleans it up, under a lock, so any number of clients can be
+ * created and destroyed from any thread without tearing down each other's
+ * state. Every other libcurl call must happen while a lease is held.
+ */
+class CurlGlobal
+{
+   public:
+    CurlGlobal();
+    ~CurlGlobal();
+
+    CurlGlobal(const CurlGlobal&) = delete;
+    CurlGlobal& operator=(const CurlGlobal&) = delete;
+
+    /**
+     * @brief Returns false if curl_global_init failed; requests will then fail too.
+     */
+    bool initialized() const
+    {
+        return success;
+    }
+
+   private:
+    bool success;
+};
+
+#endif  // CURL_GLOBAL_HPP
@@ -1,54 +1,138 @@
 #ifndef DATA_TYPE_HPP
 #define DATA_TYPE_HPP
 
-#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+/**
+ * Every sensor type as X(enumerator, wire name). New types are added here only:
+ * the enum, the name tables and the serializers' fragments are generated from it.
+ */
+#define VEHICLE_CLIENT_SENSOR_TYPES(X) \
+    X(TEMPERATURE, "temperature")      \
+    X(WEIGHT, "weight")                \
+    X(FUEL, "fuel")
+
+/**
+ * Every vehicle status as X(enumerator, wire name), in the same form.
+ */
+#define VEHICLE_CLIENT_VEHICLE_STATUSES(X) \
+    X(ACTIVE, "active")                    \
+    X(INACTIVE, "inactive")                \
+    X(MAINTENANCE, "maintenance")          \
+    X(ERROR, "error")
+
+#define VEHICLE_CLIENT_ENUMERATOR(name, text) name,
+#define VEHICLE_CLIENT_WIRE_NAME(name, text) text,
 
 enum class SensorType
 {
-    TEMPERATURE,
-    WEIGHT,
-    FUEL
+    VEHICLE_CLIENT_SENSOR_TYPES(VEHICLE_CLIENT_ENUMERATOR)
+};
 
+enum class VehicleStatus
+{
+    VEHICLE_CLIENT_VEHICLE_STATUSES(VEHICLE_CLIENT_ENUMERATOR)
 };
 
-inline std::string sensorTypeToString(SensorType type)
+/// Wire names indexed by SensorType.
+inline constexpr std::string_view kSensorTypeNames[] = {
+    VEHICLE_CLIENT_SENSOR_TYPES(VEHICLE_CLIENT_WIRE_NAME)};
+
+/// Wire names indexed by VehicleStatus.
+inline constexpr std::string_view kVehicleStatusNames[] = {
+    VEHICLE_CLIENT_VEHICLE_STATUSES(VEHICLE_CLIENT_WIRE_NAME)};
+
+#undef VEHICLE_CLIENT_ENUMERATOR
+#undef VEHICLE_CLIENT_WIRE_NAME
+
+inline constexpr std::size_t kSensorTypeCount = std::size(kSensorTypeNames);
+inline constexpr std::size_t kVehicleStatusCount = std::size(kVehicleStatusNames);
+
+constexpr std::string_view sensorTypeToString(SensorType type)
 {
-    switch (type)
-    {
-        case SensorType::TEMPERATURE:
-            return "temperature";
-        case SensorType::WEIGHT:
-            return "weight";
-        case SensorType::FUEL:
-            return "fuel";
-        default:
-            return "unknown";
-    }
+    auto index = static_cast<std::size_t>(type);
+    return index < kSensorTypeCount ? kSensorTypeNames[index] : "unknown";
 }
 
-enum class VehicleStatus
+constexpr std::string_view vehicleStatusToString(VehicleStatus status)
 {
-    ACTIVE,
-    INACTIVE,
-    MAINTENANCE,
-    ERROR
-};
+    auto index = static_cast<std::size_t>(status);
+    return index < kVehicleStatusCount ? kVehicleStatusNames[index] : "unknown";
+}
+
+/**
+ * @brief Parses a sensor type wire name, e.g. from a server response.
+ *
+ * @return False, leaving type unchanged, if the name is not known.
+ */
+constexpr bool parseSensorType(std::string_view text, SensorType& type)
+{
+    for (std::size_t i = 0; i < kSensorTypeCount; ++i)
+    {
+        if (kSensorTypeNames[i] == text)
+        {
+            type = static_cast<SensorType>(i);
+            return true;
+        }
+    }
+    return false;
+}
 
-inline std::string vehicleStatusToString(VehicleStatus status)
+/**
+ * @brief Parses a vehicle status wire name, e.g. from a server response.
+ *
+ * @return False, leaving status unchanged, if the name is not known.
+ */
+constexpr bool parseVehicleStatus(std::string_view text, VehicleStatus& status)
 {
-    switch (status)
+    for (std::size_t i = 0; i < kVehicleStatusCount; ++i)
     {
-        case VehicleStatus::ACTIVE:
-            return "active";
-        case VehicleStatus::INACTIVE:
-            return "inactive";
-        case VehicleStatus::MAINTENANCE:
-            return "maintenance";
-        case VehicleStatus::ERROR:
-            return "error";
-        default:
-            return "unknown";
+        if (kVehicleStatusNames[i] == text)
+        {
+            status = static_cast<VehicleStatus>(i);
+            return true;
+        }
     }
+    return false;
 }
 
+// Duplicate wire names would make parsing ambiguous
+static_assert(
+    []
+    {
+        for (std::size_t i = 0; i < kSensorTypeCount; ++i)
+        {
+            SensorType type{};
+            if (!parseSensorType(kSensorTypeNames[i], type) || static_cast<std::size_t>(type) != i)
+            {
+                return false;
+            }
+        }
+        for (std::size_t i = 0; i < kVehicleStatusCount; ++i)
+        {
+            VehicleStatus status{};
+            if (!parseVehicleStatus(kVehicleStatusNames[i], status) ||
+                static_cast<std::size_t>(status) != i)
+            {
+                return false;
+            }
+        }
+        return true;
+    }(),
+    "wire names must be unique");
+
+/**
+ * @struct SensorReading
+ * @brief A single sensor sample as captured on the vehicle.
+ */
+struct SensorReading
+{
+    SensorType sensorType;      ///< The type of sensor that produced the sample.
+    float value;                ///< The sensor's data reading.
+    std::uint64_t timestampUs;  ///< Capture time in microseconds since the Unix epoch (UTC).
+};
+
 #endif  // DATA_TYPE_HPP
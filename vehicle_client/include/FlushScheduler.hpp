@@ -0,0 +1,172 @@
+#ifndef FLUSH_SCHEDULER_HPP
+#define FLUSH_SCHEDULER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "OfflineSpool.hpp"
+
+/**
+ * @struct UploadFeedback
+ * @brief What a finished upload tells the scheduler about the link and the server.
+ */
+struct UploadFeedback
+{
+    Delivery delivery = Delivery::DELIVERED;  ///< RETRY for timeouts, 429, 503 and the like.
+    std::chrono::microseconds latency{0};     ///< From submission to the final answer.
+};
+
+/**
+ * @struct FlushSchedulerConfig
+ * @brief Bounds and reaction strength of a FlushScheduler.
+ */
+struct FlushSchedulerConfig
+{
+    std::size_t minBatchReadings = 32;          ///< Smallest batch a vehicle is flushed at.
+    std::size_t maxBatchReadings = 4096;        ///< Largest batch sent in one request.
+    std::chrono::milliseconds minLinger{10};    ///< Shortest wait for a batch to fill.
+    std::chrono::milliseconds maxLinger{2000};  ///< Longest wait for a batch to fill.
+    std::size_t minInFlight = 1;                ///< Concurrent uploads never go below this.
+    std::size_t maxInFlight = 64;               ///< Concurrent uploads never go above this.
+    double backoffFactor = 0.5;                 ///< Window multiplier on congestion.
+    double rttTolerance = 2.0;                  ///< Latency over this multiple of the floor...
+    std::chrono::milliseconds rttSlack{5};      ///< ...plus this slack counts as congestion.
+};
+
+/**
+ * @struct FlushSchedule
+ * @brief The limits a FlushScheduler currently hands out.
+ */
+struct FlushSchedule
+{
+    std::size_t batchReadings = 0;        ///< Readings at which a batch is due, and per request.
+    std::chrono::milliseconds linger{0};  ///< How long a batch may wait to fill.
+    std::size_t maxInFlight = 0;          ///< Concurrent uploads allowed.
+};
+
+/**
+ * @class FlushScheduler
+ * @brief Tunes batch size, linger time and in-flight uploads like TCP congestion control.
+ *
+ * The number of concurrent uploads is a congestion window. It grows by one per
+ * delivered upload until the first congestion event (slow start), then by one
+ * per window of delivered uploads (additive increase). A transient failure, which
+ * includes 429 and 503 answers, timeouts and an open circuit, or a latency well
+ * above the lowest one recently seen multiplies the window by backoffFactor
+ * (multiplicative decrease), at most once per round of uploads. Linger time moves
+ * the opposite way: it doubles on congestion and shrinks back toward the smoothed
+ * round trip time while uploads go through.
+ *
+ * Batch size follows from the queue depth: the backlog is split over the window,
+ * so a shrinking window sends the same readings in fewer, larger requests and a
+ * healthy link gets small batches with low delay.
+ *
+ * One owner thread drives the scheduler; current() may be read from any thread.
+ * With every minimum equal to its maximum the limits stay fixed.
+ */
+class FlushScheduler
+{
+   public:
+    /**
+     * @brief Starts from the linger time and window of initial, clamped to the bounds.
+     *
+     * The batch size is derived from the backlog, see setBacklog.
+     */
+    FlushScheduler(const FlushSchedulerConfig& config, const FlushSchedule& initial);
+
+    /**
+     * @brief Records how many readings are waiting to be uploaded, sets the batch size.
+     */
+    void setBacklog(std::size_t readings);
+
+    /**
+     * @brief Returns the readings at which a batch is due and that go into one request.
+     */
+    std::size_t batchReadings() const
+    {
+        return batch;
+    }
+
+    /**
+     * @brief Returns how long a batch that is not full may wait.
+     */
+    std::chrono::milliseconds linger() const
+    {
+        return std::chrono::milliseconds(static_cast<std::int64_t>(lingerMs));
+    }
+
+    /**
+     * @brief Returns how many uploads may be in flight.
+     */
+    std::size_t maxInFlight() const
+    {
+        return static_cast<std::size_t>(window);
+    }
+
+    /**
+     * @brief Registers an upload that is about to be sent.
+     *
+     * @return The ticket to hand to onComplete.
+     */
+    std::uint64_t onSubmit()
+    {
+        return nextTicket++;
+    }
+
+    /**
+     * @brief Adjusts the limits to the outcome of an upload.
+     *
+     * @param ticket The value onSubmit returned for the upload.
+     * @param feedback Its delivery and latency.
+     */
+    void onComplete(std::uint64_t ticket, const UploadFeedback& feedback);
+
+    /**
+     * @brief Returns the limits last published by the owner thread.
+     */
+    FlushSchedule current() const;
+
+    /**
+     * @brief Returns how many congestion events were detected.
+     */
+    std::uint64_t congestionEvents() const
+    {
+        return congestionCount.load(std::memory_order_relaxed);
+    }
+
+   private:
+    FlushSchedulerConfig config;
+
+    double window;              ///< Congestion window, in uploads.
+    double slowStartThreshold;  ///< Window at which growth turns additive.
+    double lingerMs;
+    std::size_t batch = 0;
+    std::size_t backlog = 0;
+
+    std::uint64_t nextTicket = 0;
+    std::uint64_t recoveryTicket = 0;  ///< Uploads sent before the last cut are ignored.
+
+    std::chrono::microseconds smoothedRtt{0};
+    std::chrono::microseconds rttFloor{0};    ///< Lowest latency of the last epochs.
+    std::chrono::microseconds epochFloor{0};  ///< Lowest latency of the running epoch.
+    std::size_t epochSamples = 0;
+
+    std::atomic<std::size_t> publishedBatch{0};
+    std::atomic<std::int64_t> publishedLinger{0};
+    std::atomic<std::size_t> publishedInFlight{0};
+    std::atomic<std::uint64_t> congestionCount{0};
+
+    /**
+     * @brief Folds a latency sample into the smoothed RTT and the RTT floor.
+     */
+    void sampleRtt(std::chrono::microseconds latency);
+
+    /**
+     * @brief Recomputes the batch size and makes the limits visible to current().
+     */
+    void publish();
+};
+
+#endif  // FLUSH_SCHEDULER_HPP
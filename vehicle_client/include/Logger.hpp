@@ -0,0 +1,302 @@
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "RingBuffer.hpp"
+#include "TimestampFormatter.hpp"
+
+/**
+ * @brief Severity of a log message.
+ */
+enum class LogLevel
+{
+    DEBUG,
+    INFO,
+    WARNING,
+    ERROR
+};
+
+/**
+ * @struct LogEntry
+ * @brief A message as handed to a LogSink.
+ */
+struct LogEntry
+{
+    std::uint64_t timestampUs;  ///< When the message was logged, or its repeats were summarized.
+    LogLevel level;             ///< The severity of the message.
+    std::string message;        ///< The text, with a repeat count appended to summaries.
+};
+
+/**
+ * @class LogSink
+ * @brief Destination of log messages, called on the logger's writer thread only.
+ */
+class LogSink
+{
+   public:
+    virtual ~LogSink() = default;
+
+    /**
+     * @brief Delivers the messages collected since the previous call, oldest first.
+     */
+    virtual void write(std::span<const LogEntry> entries) = 0;
+};
+
+/**
+ * @class StderrLogSink
+ * @brief Writes each batch to stderr as "timestamp LEVEL message" lines with one write call.
+ */
+class StderrLogSink : public LogSink
+{
+   public:
+    void write(std::span<const LogEntry> entries) override;
+
+   private:
+    TimestampFormatter formatter;
+    std::string buffer;  ///< Reused for the formatted lines of a batch.
+};
+
+/**
+ * @struct LoggerConfig
+ * @brief Filtering and delivery settings of the Logger.
+ */
+struct LoggerConfig
+{
+    LogLevel minLevel = LogLevel::INFO;           ///< Less severe messages are discarded.
+    std::chrono::seconds dedupWindow{10};         ///< Repeats within it are folded into a count.
+    std::chrono::milliseconds flushInterval{50};  ///< Maximum delay before a message is written.
+    std::shared_ptr<LogSink> sink;                ///< Destination, stderr if null.
+};
+
+/**
+ * @class Logger
+ * @brief Process-wide asynchronous logger.
+ *
+ * Logging threads copy a fixed-size record into a lock-free RingBuffer and
+ * return; they never format timestamps, lock, allocate or block on the
+ * output. A background writer drains the queue every flushInterval and hands
+ * the messages to the sink in one batch, so a storm of errors during an
+ * outage costs the producers a memcpy each.
+ *
+ * The writer deduplicates: the first occurrence of a message is written
+ * right away, identical messages within dedupWindow are only counted, and
+ * when the window closes a single summary such as
+ * "Request failed: Couldn't connect to server (x1532 in last 10s)" follows.
+ * Messages that arrive while the queue is full are dropped and reported in
+ * the same way.
+ */
+class Logger
+{
+   public:
+    /// Longest message kept; longer ones are truncated.
+    static constexpr std::size_t kMaxMessageLength = 240;
+
+    /**
+     * @brief Returns the logger, starting its writer thread on first use.
+     *
+     * The logger is never destroyed, so it can be used from static destructors.
+     * An exit handler stops the writer and writes what is still queued; later
+     * messages are written synchronously.
+     */
+    static Logger& instance();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    /**
+     * @brief Applies new settings. Safe to call at any time from any thread.
+     */
+    void configure(const LoggerConfig& config);
+
+    /**
+     * @brief Returns true if messages of this level are kept.
+     */
+    bool enabled(LogLevel level) const
+    {
+        return level >= minLevel.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Queues a message; truncated to kMaxMessageLength.
+     */
+    void log(LogLevel level, std::string_view message);
+
+    /**
+     * @brief Writes everything queued so far and returns once the sink has it.
+     *
+     * Summaries of open dedup windows are written as well.
+     */
+    void flush();
+
+    /**
+     * @brief Returns how many messages were dropped because the queue was full.
+     */
+    std::uint64_t dropped() const
+    {
+        return queue.dropped();
+    }
+
+   private:
+    struct Record
+    {
+        std::uint64_t timestampUs;
+        LogLevel level;
+        std::uint16_t length;
+        char text[kMaxMessageLength];
+    };
+
+    /// Repeats of one message within its dedup window.
+    struct Repeats
+    {
+        LogLevel level;
+        std::chrono::steady_clock::time_point windowStart;
+        std::uint64_t suppressed = 0;  ///< Occurrences after the first, not yet reported.
+    };
+
+    static constexpr std::size_t kQueueCapacity = 4096;
+    /// Distinct messages with an open dedup window; more are written without dedup.
+    static constexpr std::size_t kMaxTracked = 1024;
+
+    RingBuffer<Record> queue{kQueueCapacity, OverflowPolicy::DROP_NEWEST};
+    std::atomic<LogLevel> minLevel{LogLevel::INFO};
+
+    std::mutex writerMutex;  ///< Held by whoever drains; guards everything below.
+    std::chrono::seconds dedupWindow{10};
+    std::chrono::milliseconds flushInterval{50};
+    std::shared_ptr<LogSink> sink;
+    std::unordered_map<std::string, Repeats> recent;  ///< Messages with an open dedup window.
+    std::vector<LogEntry> batch;                      ///< Entries for the next sink call.
+    std::uint64_t reportedDrops = 0;                  ///< Value of dropped() last reported.
+    std::chrono::steady_clock::time_point lastDropReport;
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;  ///< Cuts the writer's sleep short on shutdown.
+    std::atomic<bool> stopped{false};
+    std::thread writer;
+
+    Logger();
+
+    /**
+     * @brief Writer loop: drains the queue every flushInterval until shutdown.
+     */
+    void run();
+
+    /**
+     * @brief Stops the writer thread and writes everything left; runs at exit.
+     */
+    void shutdown();
+
+    /**
+     * @brief Moves queued records into batch, closes due dedup windows and calls the sink.
+     *
+     * @param closeAll Close every dedup window regardless of its age.
+     */
+    void drain(bool closeAll);
+};
+
+/**
+ * @class LogLine
+ * @brief Builds one message with operator<< and queues it when the statement ends.
+ *
+ * Text is appended to a fixed buffer, numbers are converted with std::to_chars,
+ * and nothing is allocated. Use through logError(), logWarning(), logInfo() and
+ * logDebug(); if the level is disabled, every operator<< is a no-op:
+ *
+ * @code
+ * logError() << "Spool is full, dropped " << lost << " readings";
+ * @endcode
+ */
+class LogLine
+{
+   public:
+    explicit LogLine(LogLevel level) : level(level), active(Logger::instance().enabled(level))
+    {
+    }
+
+    ~LogLine()
+    {
+        if (active)
+        {
+            Logger::instance().log(level, {text, length});
+        }
+    }
+
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    LogLine& operator<<(std::string_view value)
+    {
+        if (active)
+        {
+            std::size_t count = std::min(value.size(), Logger::kMaxMessageLength - length);
+            value.copy(text + length, count);
+            length += count;
+        }
+        return *this;
+    }
+
+    LogLine& operator<<(char value)
+    {
+        return *this << std::string_view(&value, 1);
+    }
+
+    template <typename T>
+        requires(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+    LogLine& operator<<(T value)
+    {
+        if (active)
+        {
+            char* limit = text + Logger::kMaxMessageLength;
+            auto [end, error] = std::to_chars(text + length, limit, value);
+            if (error == std::errc())
+            {
+                length = static_cast<std::size_t>(end - text);
+            }
+        }
+        return *this;
+    }
+
+   private:
+    LogLevel level;
+    bool active;  ///< False if the level is filtered out.
+    std::size_t length = 0;
+    char text[Logger::kMaxMessageLength];
+};
+
+inline LogLine logError()
+{
+    return LogLine(LogLevel::ERROR);
+}
+
+inline LogLine logWarning()
+{
+    return LogLine(LogLevel::WARNING);
+}
+
+inline LogLine logInfo()
+{
+    return LogLine(LogLevel::INFO);
+}
+
+inline LogLine logDebug()
+{
+    return LogLine(LogLevel::DEBUG);
+}
+
+#endif  // LOGGER_HPP
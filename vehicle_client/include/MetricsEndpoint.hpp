@@ -0,0 +1,77 @@
+#ifndef METRICS_ENDPOINT_HPP
+#define METRICS_ENDPOINT_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+/**
+ * @struct MetricsEndpointConfig
+ * @brief Listening address of a MetricsEndpoint.
+ */
+struct MetricsEndpointConfig
+{
+    std::string address = "127.0.0.1";  ///< IPv4 address to bind, "0.0.0.0" for all interfaces.
+    std::uint16_t port = 9464;          ///< TCP port, 0 picks a free one.
+};
+
+/**
+ * @class MetricsEndpoint
+ * @brief Serves the client's metrics at GET /metrics for a Prometheus scraper.
+ *
+ * A background thread accepts one connection at a time, renders the metrics
+ * when a request arrives and closes the connection after the response. Scrapes
+ * are rare, so nothing is rendered in between.
+ */
+class MetricsEndpoint
+{
+   public:
+    /// Produces the response body in the Prometheus text format.
+    using Renderer = std::function<std::string()>;
+
+    /**
+     * @brief Binds the socket and starts the accept thread.
+     *
+     * @param config The address and port to listen on.
+     * @param render Called on the endpoint's thread for every scrape.
+     * @throws std::runtime_error If the address cannot be bound.
+     */
+    MetricsEndpoint(const MetricsEndpointConfig& config, Renderer render);
+
+    /**
+     * @brief Closes the socket and joins the thread.
+     */
+    ~MetricsEndpoint();
+
+    MetricsEndpoint(const MetricsEndpoint&) = delete;
+    MetricsEndpoint& operator=(const MetricsEndpoint&) = delete;
+
+    /**
+     * @brief Returns the bound port, useful when the configured port was 0.
+     */
+    std::uint16_t port() const
+    {
+        return boundPort;
+    }
+
+   private:
+    Renderer render;
+    int listenFd = -1;
+    std::uint16_t boundPort = 0;
+    std::atomic<bool> stopping{false};
+    std::thread acceptThread;
+
+    /**
+     * @brief Accepts and answers scrapes until the endpoint is destroyed.
+     */
+    void run();
+
+    /**
+     * @brief Reads one request from a connection and answers it.
+     */
+    void answer(int fd);
+};
+
+#endif  // METRICS_ENDPOINT_HPP
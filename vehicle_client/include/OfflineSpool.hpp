@@ -0,0 +1,191 @@
+#ifndef OFFLINE_SPOOL_HPP
+#define OFFLINE_SPOOL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "DataTypes.hpp"
+
+/**
+ * @brief When appended spool records are forced to disk.
+ */
+enum class SpoolSync
+{
+    NONE,     ///< Leave write-back to the kernel; survives process crashes only.
+    SEGMENT,  ///< msync a segment when it is sealed.
+    APPEND    ///< msync every appended record before append returns.
+};
+
+/**
+ * @struct SpoolConfig
+ * @brief Storage and replay settings of an OfflineSpool.
+ */
+struct SpoolConfig
+{
+    std::string directory = "spool";                ///< Directory holding the segment files.
+    std::size_t segmentBytes = 4 * 1024 * 1024;     ///< Size of a memory-mapped segment file.
+    std::size_t maxSegments = 1024;                 ///< Oldest segments are dropped beyond this.
+    SpoolSync sync = SpoolSync::SEGMENT;            ///< When records are flushed to disk.
+    std::size_t replayBatchReadings = 4096;         ///< Readings merged into one replay request.
+    std::chrono::milliseconds retryInterval{2000};  ///< Pause after a failed replay.
+};
+
+/**
+ * @brief Outcome of replaying spooled readings.
+ */
+enum class Delivery
+{
+    DELIVERED,  ///< The server recorded the readings.
+    RETRY,      ///< Transient failure, keep the readings and try again later.
+    REJECTED    ///< The server refused the readings, retrying would not help.
+};
+
+/**
+ * @class OfflineSpool
+ * @brief Durable store-and-forward queue for readings that could not be sent.
+ *
+ * Readings are appended as CRC-protected binary records to fixed-size segment
+ * files that are memory-mapped, so an append is a memcpy into the page cache
+ * and RSS stays bounded by the two segments mapped at any time (the one being
+ * written and the one being replayed). Segments are append-only; a background
+ * drainer replays them oldest first in large batches and deletes each segment
+ * once it has been delivered. Replay progress is stored in the segment header,
+ * so after a restart delivery resumes where it stopped (at-least-once). A record
+ * that fails its CRC is logged, counted as dropped and skipped; replay resumes at
+ * the next intact record instead of abandoning the rest of the segment.
+ *
+ * Records hold the readings in their in-memory layout at 8-byte aligned offsets,
+ * which lets a record be handed to the sender straight from the mapping.
+ */
+class OfflineSpool
+{
+   public:
+    /// Sends replayed readings of one vehicle, called on the drainer thread. The
+    /// readings of consecutive records arrive as one span each, still in the mapping.
+    using Sender = std::function<Delivery(std::span<const std::span<const SensorReading>>,
+                                          const std::string& vehicleSerial)>;
+
+    /**
+     * @brief Opens the spool directory, adopts existing segments and starts the drainer.
+     *
+     * @param config Storage and replay settings.
+     * @param sender Callback that delivers replayed readings.
+     * @throws std::runtime_error If the spool directory cannot be created or read.
+     */
+    OfflineSpool(const SpoolConfig& config, Sender sender);
+
+    /**
+     * @brief Stops the drainer and seals the active segment; undelivered records stay on disk.
+     */
+    ~OfflineSpool();
+
+    OfflineSpool(const OfflineSpool&) = delete;
+    OfflineSpool& operator=(const OfflineSpool&) = delete;
+
+    /**
+     * @brief Appends readings of one vehicle to the spool. Safe to call from any thread.
+     *
+     * @param readings The readings to keep for later delivery.
+     * @param vehicleSerial The serial number of the vehicle.
+     * @return False if no segment could be created, in which case the readings are lost.
+     */
+    bool append(std::span<const SensorReading> readings, std::string_view vehicleSerial);
+
+    /**
+     * @brief Returns how many readings were appended since construction.
+     */
+    std::uint64_t spooled() const
+    {
+        return spooledCount.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns how many readings were replayed (delivered or rejected) since construction.
+     */
+    std::uint64_t replayed() const
+    {
+        return replayedCount.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns how many readings were lost to the segment cap or corrupt records.
+     */
+    std::uint64_t dropped() const
+    {
+        return droppedCount.load(std::memory_order_relaxed);
+    }
+
+   private:
+    /// A memory-mapped segment file.
+    struct Segment
+    {
+        std::uint64_t sequence = 0;
+        int fd = -1;
+        char* data = nullptr;
+        std::size_t size = 0;
+        std::size_t writeOffset = 0;  ///< End of the appended records.
+    };
+
+    SpoolConfig config;
+    Sender sender;
+
+    std::mutex mutex;                              ///< Guards everything up to stopping.
+    std::condition_variable wakeUp;                ///< Signalled on appends and shutdown.
+    Segment active;                                ///< Segment appended to, unmapped if none.
+    std::deque<std::uint64_t> sealed;              ///< Segments awaiting replay, oldest first.
+    std::uint64_t nextSequence = 0;                ///< Sequence number of the next segment.
+    std::uint64_t replayingSequence = UINT64_MAX;  ///< Segment the drainer is reading.
+    bool stopping = false;
+
+    std::atomic<std::uint64_t> spooledCount{0};
+    std::atomic<std::uint64_t> replayedCount{0};
+    std::atomic<std::uint64_t> droppedCount{0};
+
+    std::thread drainerThread;
+
+    /**
+     * @brief Returns the file path of a segment.
+     */
+    std::string segmentPath(std::uint64_t sequence) const;
+
+    /**
+     * @brief Creates, preallocates and maps a new active segment. Requires mutex.
+     */
+    bool openActive();
+
+    /**
+     * @brief Flushes, shrinks to its content and unmaps the active segment. Requires mutex.
+     */
+    void sealActive();
+
+    /**
+     * @brief Deletes the oldest segments beyond maxSegments. Requires mutex.
+     */
+    void enforceSegmentLimit();
+
+    /**
+     * @brief Drainer loop: replays sealed segments, sealing the active one when it runs dry.
+     */
+    void run();
+
+    /**
+     * @brief Replays one sealed segment from its stored progress offset.
+     *
+     * @return True if the segment was fully replayed and can be deleted,
+     *         false if delivery has to be retried later.
+     */
+    bool replaySegment(std::uint64_t sequence);
+};
+
+#endif  // OFFLINE_SPOOL_HPP
@@ -0,0 +1,198 @@
+#ifndef PAYLOAD_SERIALIZER_HPP
+#define PAYLOAD_SERIALIZER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "DataTypes.hpp"
+#include "TimestampFormatter.hpp"
+
+/**
+ * @brief Encoding of sensor batch request bodies.
+ *
+ * CBOR and MessagePack carry the same keys as the JSON body, but encode the
+ * timestamp as unsigned microseconds since the Unix epoch and the reading as a
+ * 32-bit float. COLUMNAR bodies use their own layout and endpoint (see
+ * appendColumnarBatch).
+ */
+enum class WireFormat
+{
+    JSON,     ///< Text JSON, application/json.
+    CBOR,     ///< RFC 8949 CBOR, application/cbor.
+    MSGPACK,  ///< MessagePack, application/msgpack.
+    COLUMNAR  ///< Delta/XOR-compressed columns, application/x-sensor-columns.
+};
+
+/**
+ * @brief Returns the complete Content-Type request header for a wire format.
+ */
+inline const char* contentTypeHeader(WireFormat format)
+{
+    switch (format)
+    {
+        case WireFormat::CBOR:
+            return "Content-Type: application/cbor";
+        case WireFormat::MSGPACK:
+            return "Content-Type: application/msgpack";
+        case WireFormat::COLUMNAR:
+            return "Content-Type: application/x-sensor-columns";
+        case WireFormat::JSON:
+        default:
+            return "Content-Type: application/json";
+    }
+}
+
+/**
+ * @class PayloadSerializer
+ * @brief Writes request bodies straight into a reusable buffer.
+ *
+ * The serializer appends precomputed key fragments, std::to_chars numbers and
+ * escaped strings to one internal buffer that keeps its capacity between calls,
+ * so once the buffer has grown to the largest payload no call allocates. The
+ * returned views stay valid until the next call on the same serializer. Batches
+ * can also be encoded as CBOR, MessagePack or columns (see WireFormat).
+ *
+ * A serializer is not thread-safe; use one per thread.
+ */
+class PayloadSerializer
+{
+   public:
+    /**
+     * @brief Constructs a serializer with an initial buffer capacity.
+     *
+     * @param initialCapacity Bytes reserved up front for the payload buffer.
+     */
+    explicit PayloadSerializer(std::size_t initialCapacity = 4096);
+
+    /**
+     * @brief Serializes a single reading for /add-sensor-data/.
+     *
+     * @param reading The sensor reading, stamped with its capture time.
+     * @param vehicleSerial The serial number of the vehicle.
+     * @return View of the JSON body.
+     */
+    std::string_view sensorData(const SensorReading& reading, std::string_view vehicleSerial);
+
+    /**
+     * @brief Serializes a batch of readings for /add-sensor-data-batch/, or for
+     *        /add-sensor-data-columnar/ with WireFormat::COLUMNAR.
+     *
+     * @param readings The sensor readings to send.
+     * @param vehicleSerial The serial number of the vehicle.
+     * @param format The body encoding; binary formats yield non-text bytes.
+     * @return View of the encoded body.
+     */
+    std::string_view batch(std::span<const SensorReading> readings, std::string_view vehicleSerial,
+                           WireFormat format = WireFormat::JSON);
+
+    /**
+     * @brief Returns whether batches of a format can be encoded in slices with batchHead(),
+     *        batchReadings() and batchTail(). Columnar batches cannot.
+     */
+    static bool isStreamable(WireFormat format)
+    {
+        return format != WireFormat::COLUMNAR;
+    }
+
+    /**
+     * @brief Serializes the start of a batch body, up to its first reading.
+     *
+     * The head, the readings in consecutive slices and the tail concatenate to
+     * the body batch() returns, so a large body can be produced while it is sent.
+     *
+     * @param vehicleSerial The serial number of the vehicle.
+     * @param count The number of readings in the whole batch.
+     * @param format A streamable body encoding.
+     * @return View of the encoded bytes.
+     */
+    std::string_view batchHead(std::string_view vehicleSerial, std::size_t count,
+                               WireFormat format);
+
+    /**
+     * @brief Serializes a slice of a batch's readings, see batchHead().
+     *
+     * @param readings The next readings of the batch.
+     * @param first True for the slice starting with the batch's first reading.
+     * @param format The encoding passed to batchHead().
+     * @return View of the encoded bytes.
+     */
+    std::string_view batchReadings(std::span<const SensorReading> readings, bool first,
+                                   WireFormat format);
+
+    /**
+     * @brief Serializes the end of a batch body, see batchHead().
+     */
+    std::string_view batchTail(WireFormat format);
+
+    /**
+     * @brief Serializes a status update for /update-vehicle-status/.
+     *
+     * @param vehicleSerial The serial number of the vehicle.
+     * @param status The new status of the vehicle.
+     * @return View of the JSON body.
+     */
+    std::string_view status(std::string_view vehicleSerial, VehicleStatus status);
+
+    /**
+     * @brief Serializes a list of vehicles for /get-vehicle-statuses/.
+     *
+     * @param vehicleSerials The serial numbers of the vehicles.
+     * @return View of the JSON body.
+     */
+    std::string_view vehicleSerials(std::span<const std::string> vehicleSerials);
+
+    /**
+     * @brief Serializes status updates of many vehicles for /update-vehicle-statuses/.
+     *
+     * @param updates Pairs of vehicle serial number and new status.
+     * @return View of the JSON body.
+     */
+    std::string_view statusBatch(std::span<const std::pair<std::string, VehicleStatus>> updates);
+
+   private:
+    std::string buffer;                     ///< Reused output buffer, cleared but never shrunk.
+    TimestampFormatter timestampFormatter;  ///< Per-second cached timestamp prefix.
+
+    /**
+     * @brief Appends the part of a streamable batch body before its readings.
+     */
+    void appendBatchHead(std::string_view vehicleSerial, std::size_t count, WireFormat format);
+
+    /**
+     * @brief Appends readings of a streamable batch body.
+     */
+    void appendBatchReadings(std::span<const SensorReading> readings, bool first,
+                             WireFormat format);
+
+    /**
+     * @brief Encodes the readings of a batch with a binary writer (CBOR or MessagePack).
+     */
+    template <typename Writer>
+    void appendBinaryReadings(std::span<const SensorReading> readings);
+
+    /**
+     * @brief Appends the fields of one reading without the surrounding braces.
+     */
+    void appendReadingFields(const SensorReading& reading);
+
+    /**
+     * @brief Appends a JSON string literal, escaping quotes, backslashes and control characters.
+     */
+    void appendEscaped(std::string_view value);
+
+    /**
+     * @brief Appends the shortest decimal form that round-trips the float, or null if not finite.
+     */
+    void appendFloat(float value);
+
+    /**
+     * @brief Appends a quoted ISO 8601 timestamp (YYYY-MM-DDTHH:MM:SS.ffffffZ).
+     */
+    void appendTimestamp(std::uint64_t timestampUs);
+};
+
+#endif  // PAYLOAD_SERIALIZER_HPP
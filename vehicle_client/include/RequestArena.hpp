@@ -0,0 +1,82 @@
+#ifndef REQUEST_ARENA_HPP
+#define REQUEST_ARENA_HPP
+
+#include <curl/curl.h>
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory_resource>
+#include <string_view>
+
+/**
+ * @class RequestArena
+ * @brief Per-thread monotonic arena for the short-lived strings and header nodes of a request.
+ *
+ * URLs with query parameters, per-request headers and the curl_slist nodes that
+ * put them in front of a prebuilt header list are bump-allocated from a fixed
+ * buffer and dropped together when the outermost Scope of the thread ends, so a
+ * steady stream of requests does not touch the heap. A request that outgrows the
+ * buffer spills to the heap until its scope ends. Each thread, and so each upload
+ * worker, has its own arena, which needs no locking.
+ */
+class RequestArena
+{
+   public:
+    /**
+     * @class Scope
+     * @brief Marks the lifetime of a request; everything allocated meanwhile is freed at its end.
+     *
+     * Scopes nest, the arena is only reset when the outermost one ends.
+     */
+    class Scope
+    {
+       public:
+        explicit Scope(RequestArena& arena);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+       private:
+        RequestArena& arena;
+    };
+
+    /**
+     * @brief Returns the calling thread's arena.
+     */
+    static RequestArena& local();
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    /**
+     * @brief Concatenates strings into a NUL-terminated string owned by the arena.
+     *
+     * @return The string, valid until the current scope ends.
+     */
+    const char* concat(std::initializer_list<std::string_view> parts);
+
+    /**
+     * @brief Links a header in front of a header list without copying or modifying the list.
+     *
+     * The returned node can be passed as CURLOPT_HTTPHEADER and must not be freed
+     * with curl_slist_free_all.
+     *
+     * @param header The complete header line; must stay valid until the scope ends.
+     * @param list The list the header is prepended to, e.g. a shared prebuilt one, or null.
+     * @return The new head of the list, valid until the current scope ends.
+     */
+    curl_slist* prepend(const char* header, curl_slist* list);
+
+   private:
+    /// Covers the URL and extra headers of any regular request.
+    static constexpr std::size_t kBufferBytes = 4096;
+
+    RequestArena();
+
+    alignas(std::max_align_t) std::byte buffer[kBufferBytes];
+    std::pmr::monotonic_buffer_resource resource;  ///< Bump allocator over buffer.
+    int depth = 0;                                 ///< Open scopes on this thread.
+};
+
+#endif  // REQUEST_ARENA_HPP
@@ -0,0 +1,73 @@
+#ifndef REQUEST_TEMPLATES_HPP
+#define REQUEST_TEMPLATES_HPP
+
+#include <curl/curl.h>
+
+#include <cstddef>
+#include <string>
+
+#include "BodyCompressor.hpp"
+#include "PayloadSerializer.hpp"
+
+/**
+ * @enum Endpoint
+ * @brief API endpoints the client sends requests to.
+ */
+enum class Endpoint
+{
+    ADD_SENSOR_DATA,           ///< POST /add-sensor-data/
+    ADD_SENSOR_DATA_BATCH,     ///< POST /add-sensor-data-batch/
+    ADD_SENSOR_DATA_COLUMNAR,  ///< POST /add-sensor-data-columnar/
+    GET_VEHICLE_STATUS,        ///< GET /get-vehicle-status/, the URL ends in "?vehicle_serial=".
+    UPDATE_VEHICLE_STATUS,     ///< POST /update-vehicle-status/
+    GET_VEHICLE_STATUSES,      ///< POST /get-vehicle-statuses/
+    UPDATE_VEHICLE_STATUSES,   ///< POST /update-vehicle-statuses/
+    QUERY_SENSOR_DATA,         ///< GET /query-sensor-data/, followed by "<serial>/<sensor>".
+};
+
+/**
+ * @class RequestTemplates
+ * @brief Absolute endpoint URLs and request header lists, built once per client.
+ *
+ * Every combination of Content-Type and Content-Encoding is kept as a ready
+ * curl_slist, so requests pass a shared list instead of building and freeing one
+ * each time. Headers that differ per request are linked in front of it from a
+ * RequestArena. The lists are never modified after construction and can be used
+ * from any thread.
+ */
+class RequestTemplates
+{
+   public:
+    /**
+     * @param baseUrl The API base URL, without a trailing slash.
+     */
+    explicit RequestTemplates(const std::string& baseUrl);
+    ~RequestTemplates();
+
+    RequestTemplates(const RequestTemplates&) = delete;
+    RequestTemplates& operator=(const RequestTemplates&) = delete;
+
+    /**
+     * @brief Returns the absolute URL of an endpoint.
+     */
+    const std::string& url(Endpoint endpoint) const;
+
+    /**
+     * @brief Returns the prebuilt headers of a request body.
+     *
+     * @param format The encoding of the body, selects Content-Type.
+     * @param encoding The compression applied to the body, NONE for no Content-Encoding.
+     * @return A list owned by the templates; must not be freed or modified.
+     */
+    curl_slist* headers(WireFormat format, Compression encoding = Compression::NONE) const;
+
+   private:
+    static constexpr std::size_t kEndpoints = 8;
+    static constexpr std::size_t kFormats = 4;
+    static constexpr std::size_t kEncodings = 3;
+
+    std::string urls[kEndpoints];                        ///< Indexed by Endpoint.
+    curl_slist* headerLists[kFormats][kEncodings] = {};  ///< By WireFormat and Compression.
+};
+
+#endif  // REQUEST_TEMPLATES_HPP
@@ -0,0 +1,44 @@
+#ifndef RESPONSE_CLASSIFIER_HPP
+#define RESPONSE_CLASSIFIER_HPP
+
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Returns true if the HTTP status code is in the 2xx range.
+ */
+inline bool isHttpSuccess(long statusCode)
+{
+    return statusCode >= 200 && statusCode < 300;
+}
+
+/**
+ * @brief Returns true if a request that failed with this HTTP status code may succeed later.
+ *
+ * Covers responses that never arrived (0), timeouts, rate limiting and server errors;
+ * other 4xx responses are permanent rejections.
+ */
+inline bool isTransientHttpStatus(long statusCode)
+{
+    return statusCode == 0 || statusCode == 408 || statusCode == 425 || statusCode == 429 ||
+           statusCode >= 500;
+}
+
+/**
+ * @brief Decides whether a record-style response ({"status": "success", ...}) succeeded.
+ *
+ * The decision is made from the HTTP status code first; only 2xx responses are
+ * scanned, with a SAX pass that stops as soon as the top-level "status" (and,
+ * if requested, "content") value has been seen. No JSON DOM is built, so the
+ * success path does not allocate beyond the scanned key and value strings, and
+ * a body that opens with "status": "success" is recognised without parsing.
+ *
+ * @param statusCode The HTTP status code of the response.
+ * @param body The raw response body.
+ * @param content If not null, receives the top-level "content" string of a
+ *        successful response.
+ * @return True if the status code is 2xx and the body's "status" is "success".
+ */
+bool isSuccessResponse(long statusCode, std::string_view body, std::string* content = nullptr);
+
+#endif  // RESPONSE_CLASSIFIER_HPP
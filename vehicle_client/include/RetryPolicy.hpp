@@ -0,0 +1,154 @@
+#ifndef RETRY_POLICY_HPP
+#define RETRY_POLICY_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+
+/**
+ * @struct RetryConfig
+ * @brief Timeouts, backoff and circuit breaker settings of a RetryPolicy.
+ */
+struct RetryConfig
+{
+    std::chrono::milliseconds connectTimeout{5000};   ///< Limit for establishing a connection.
+    std::chrono::milliseconds requestTimeout{30000};  ///< Limit for a whole request.
+    int maxAttempts = 3;                              ///< Attempts per request, 1 disables retries.
+    std::chrono::milliseconds initialBackoff{250};    ///< Backoff cap before the first retry.
+    std::chrono::milliseconds maxBackoff{8000};       ///< Upper bound of any backoff.
+    bool idempotencyKeys = true;                      ///< Dedupe key on uploads, allows retries.
+    int failureThreshold = 5;                         ///< Failures in a row that open the circuit.
+    std::chrono::milliseconds openDuration{30000};    ///< How long an open circuit fails fast.
+};
+
+/**
+ * @class CircuitBreaker
+ * @brief Stops sending requests to a server that keeps failing.
+ *
+ * After failureThreshold consecutive transient failures the circuit opens and
+ * every request fails fast without touching the network. Once the (jittered)
+ * open duration has passed, a single probe request is let through: its success
+ * closes the circuit, its failure opens it again. Safe to use from any thread.
+ */
+class CircuitBreaker
+{
+   public:
+    CircuitBreaker(int failureThreshold, std::chrono::milliseconds openDuration);
+
+    /**
+     * @brief Returns whether a request may be sent now.
+     *
+     * Every request that was allowed must be followed by recordSuccess or recordFailure.
+     */
+    bool allowRequest();
+
+    /**
+     * @brief Records a request that reached the server and got a non-transient answer.
+     */
+    void recordSuccess();
+
+    /**
+     * @brief Records a transport error or transient HTTP status.
+     */
+    void recordFailure();
+
+    /**
+     * @brief Replaces the threshold and open duration, keeping the current state.
+     *
+     * An open circuit keeps its reopen time; the new duration applies the next time it opens.
+     */
+    void setLimits(int failureThreshold, std::chrono::milliseconds openDuration);
+
+   private:
+    enum class State
+    {
+        CLOSED,
+        OPEN,
+        HALF_OPEN
+    };
+
+    std::mutex mutex;  ///< Guards the members below.
+    int failureThreshold;
+    std::chrono::milliseconds openDuration;
+    State state = State::CLOSED;
+    int consecutiveFailures = 0;
+    std::chrono::steady_clock::time_point reopenAt;  ///< End of the open period.
+    bool probeInFlight = false;                      ///< A half-open probe is being sent.
+};
+
+/**
+ * @class RetryPolicy
+ * @brief Decides whether and when a failed request is sent again.
+ *
+ * Only transient failures of idempotent requests are retried, waiting a capped
+ * exponential backoff with full jitter in between, so a fleet that lost the
+ * server at the same moment does not come back in lockstep. A Retry-After hint
+ * from the server extends the wait; if it exceeds maxBackoff the request is not
+ * retried at all. The policy also holds the circuit breaker shared by all requests,
+ * which a replacement policy can take over so a reload does not reset it.
+ */
+class RetryPolicy
+{
+   public:
+    explicit RetryPolicy(const RetryConfig& config = RetryConfig{});
+
+    /**
+     * @brief Constructs a policy that shares the circuit breaker of previous.
+     *
+     * The breaker keeps its state and takes the threshold and open duration of config.
+     */
+    RetryPolicy(const RetryConfig& config, const RetryPolicy& previous);
+
+    RetryPolicy(const RetryPolicy&) = delete;
+    RetryPolicy& operator=(const RetryPolicy&) = delete;
+
+    /**
+     * @brief Returns the timeouts, backoff and breaker settings.
+     */
+    const RetryConfig& config() const
+    {
+        return settings;
+    }
+
+    /**
+     * @brief Returns the circuit breaker guarding the server.
+     */
+    CircuitBreaker& breaker()
+    {
+        return *circuitBreaker;
+    }
+
+    /**
+     * @brief Decides whether a transiently failed request is retried.
+     *
+     * @param attempt The number of attempts made so far, starting at 1.
+     * @param idempotent Whether sending the request twice is harmless.
+     * @param retryAfter The server's Retry-After hint, zero if none was sent.
+     * @param delay Receives how long to wait before the next attempt.
+     * @return True if the request should be sent again after delay.
+     */
+    bool retryDelay(int attempt, bool idempotent, std::chrono::seconds retryAfter,
+                    std::chrono::milliseconds& delay) const;
+
+    /// Length of an idempotency key, in hex digits.
+    static constexpr std::size_t kIdempotencyKeyLength = 32;
+
+    /**
+     * @brief Generates a random key that lets the server drop duplicate uploads.
+     */
+    static std::string newIdempotencyKey();
+
+    /**
+     * @brief Writes a new idempotency key into a caller-provided buffer, without allocating.
+     */
+    static void newIdempotencyKey(std::span<char, kIdempotencyKeyLength> key);
+
+   private:
+    RetryConfig settings;
+    std::shared_ptr<CircuitBreaker> circuitBreaker;  ///< Shared with the policies it replaced.
+};
+
+#endif  // RETRY_POLICY_HPP
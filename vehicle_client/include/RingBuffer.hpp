@@ -0,0 +1,229 @@
+#ifndef RING_BUFFER_HPP
+#define RING_BUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+/**
+ * @brief What a RingBuffer does with a new item when it is full.
+ */
+enum class OverflowPolicy
+{
+    DROP_OLDEST,  ///< Evict the oldest queued item to make room.
+    DROP_NEWEST,  ///< Reject the new item.
+    BLOCK         ///< Spin (yielding) until the consumer frees a slot.
+};
+
+/**
+ * @class RingBuffer
+ * @brief Bounded lock-free multi-producer/multi-consumer queue of fixed-size records.
+ *
+ * Each slot carries a sequence number that tells producers and consumers whether
+ * it is free or filled, so push and pop only need a single compare-and-swap on
+ * the hot path. All memory is allocated once at construction; push and pop never
+ * allocate nor take a lock, which makes the queue safe to feed from sensor threads.
+ *
+ * @tparam T A trivially copyable record type.
+ */
+template <typename T>
+class RingBuffer
+{
+    static_assert(std::is_trivially_copyable_v<T>, "RingBuffer stores raw records");
+
+   public:
+    /**
+     * @brief Constructs a queue with room for at least @p capacity items.
+     *
+     * @param capacity Requested capacity, rounded up to the next power of two.
+     * @param policy Behaviour of push when the queue is full.
+     */
+    explicit RingBuffer(std::size_t capacity, OverflowPolicy policy = OverflowPolicy::DROP_NEWEST)
+        : mask(roundUpToPowerOfTwo(capacity) - 1),
+          cells(std::make_unique<Cell[]>(mask + 1)),
+          policy(policy)
+    {
+        for (std::size_t i = 0; i <= mask; ++i)
+        {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    /**
+     * @brief Enqueues an item, applying the overflow policy if the queue is full.
+     *
+     * @param item The item to enqueue.
+     * @return True if the item was queued, false if it was rejected (DROP_NEWEST).
+     *         With DROP_OLDEST the new item is always queued, but an older one
+     *         may have been dropped to make room.
+     */
+    bool push(const T& item)
+    {
+        if (tryPush(item))
+        {
+            return true;
+        }
+
+        switch (policy)
+        {
+            case OverflowPolicy::DROP_NEWEST:
+                droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+
+            case OverflowPolicy::DROP_OLDEST:
+            {
+                T evicted;
+                do
+                {
+                    if (tryPop(evicted))
+                    {
+                        droppedCount.fetch_add(1, std::memory_order_relaxed);
+                    }
+                } while (!tryPush(item));
+                return true;
+            }
+
+            case OverflowPolicy::BLOCK:
+            default:
+                while (!tryPush(item))
+                {
+                    std::this_thread::yield();
+                }
+                return true;
+        }
+    }
+
+    /**
+     * @brief Enqueues an item if there is a free slot, ignoring the overflow policy.
+     *
+     * @param item The item to enqueue.
+     * @return True if the item was queued, false if the queue was full.
+     */
+    bool tryPush(const T& item)
+    {
+        std::size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell& cell = cells[position & mask];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto difference =
+                static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+            if (difference == 0)
+            {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1,
+                                                          std::memory_order_relaxed))
+                {
+                    cell.data = item;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Dequeues the oldest item.
+     *
+     * @param item Receives the dequeued item.
+     * @return True if an item was dequeued, false if the queue was empty.
+     */
+    bool tryPop(T& item)
+    {
+        std::size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell& cell = cells[position & mask];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto difference =
+                static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+
+            if (difference == 0)
+            {
+                if (dequeuePosition.compare_exchange_weak(position, position + 1,
+                                                          std::memory_order_relaxed))
+                {
+                    item = cell.data;
+                    cell.sequence.store(position + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Returns an approximation of the number of queued items.
+     */
+    std::size_t size() const
+    {
+        std::size_t enqueued = enqueuePosition.load(std::memory_order_relaxed);
+        std::size_t dequeued = dequeuePosition.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    /**
+     * @brief Returns the number of slots in the queue.
+     */
+    std::size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+    /**
+     * @brief Returns how many items were lost to the overflow policy so far.
+     */
+    std::uint64_t dropped() const
+    {
+        return droppedCount.load(std::memory_order_relaxed);
+    }
+
+   private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T data;
+    };
+
+    static std::size_t roundUpToPowerOfTwo(std::size_t value)
+    {
+        std::size_t result = 2;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    // Producer and consumer positions live on separate cache lines to avoid false sharing
+    alignas(64) std::atomic<std::size_t> enqueuePosition{0};
+    alignas(64) std::atomic<std::size_t> dequeuePosition{0};
+    alignas(64) std::atomic<std::uint64_t> droppedCount{0};
+
+    const std::size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    const OverflowPolicy policy;
+};
+
+#endif  // RING_BUFFER_HPP
@@ -0,0 +1,124 @@
+#ifndef RUNTIME_CONFIG_HPP
+#define RUNTIME_CONFIG_HPP
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BodyCompressor.hpp"
+#include "DataTypes.hpp"
+#include "Logger.hpp"
+#include "MetricsEndpoint.hpp"
+#include "OfflineSpool.hpp"
+#include "PayloadSerializer.hpp"
+#include "RetryPolicy.hpp"
+#include "UploadPool.hpp"
+#include "VehicleGateway.hpp"
+
+/**
+ * @struct SensorSchedule
+ * @brief A simulated sensor that every configured vehicle samples at a fixed rate.
+ */
+struct SensorSchedule
+{
+    SensorType sensorType = SensorType::TEMPERATURE;  ///< The sensor to sample.
+    double rateHz = 0.1;                              ///< Readings per second and vehicle.
+    float minValue = 30.0f;                           ///< Readings are uniform in [min, max].
+    float maxValue = 90.0f;
+};
+
+/**
+ * @struct RuntimeConfig
+ * @brief Everything the vehicle_client executable is run with.
+ *
+ * The defaults reproduce the original fixed setup: one vehicle, one
+ * temperature sensor sampled every 10 seconds and a status report as often.
+ * Sensors, the status interval, the log level, the retry policy and the
+ * shutdown timeout take effect on reload; the other settings are applied at
+ * startup only.
+ */
+struct RuntimeConfig
+{
+    std::string apiUrl = "https://restful-infrastructure.onrender.com";  ///< Server base URL.
+    std::vector<std::string> vehicles{"enginius1"};                      ///< Vehicles simulated.
+    std::vector<SensorSchedule> sensors{SensorSchedule{}};               ///< Sampled per vehicle.
+
+    std::chrono::milliseconds statusInterval{10000};  ///< Status report period, 0 disables it.
+    bool statusNotifications = true;                  ///< Watch the vehicles' status events.
+    WireFormat wireFormat = WireFormat::JSON;         ///< Encoding of batched uploads.
+    LogLevel logLevel = LogLevel::INFO;               ///< Less severe messages are discarded.
+    std::chrono::milliseconds shutdownTimeout{2000};  ///< Drain time on exit, then spool.
+
+    GatewayConfig gateway;  ///< Batching, shards and in-flight uploads.
+
+    bool uploadPoolEnabled = false;  ///< Serialize and send uploads on an UploadPool.
+    UploadPoolConfig uploadPool;
+
+    bool spoolEnabled = true;  ///< Keep readings of failed uploads for replay.
+    SpoolConfig spool;
+
+    CompressionConfig compression;  ///< The dictionary is read from compression.dictionary_path.
+    RetryConfig retry;
+
+    bool metricsEnabled = false;  ///< Serve the client metrics for Prometheus.
+    MetricsEndpointConfig metrics;
+
+    /// The startup-only settings as loaded, compared on reload to spot ignored changes.
+    std::string restartSettings;
+};
+
+/**
+ * @class RuntimeConfigLoader
+ * @brief Builds a RuntimeConfig from a JSON file, the environment and command line flags.
+ *
+ * Later sources override earlier ones, key by key:
+ *  1. the defaults of RuntimeConfig,
+ *  2. the JSON file named by --config=<path> or VEHICLE_CLIENT_CONFIG,
+ *  3. environment variables VEHICLE_CLIENT__<SECTION>__<KEY>=<value>, e.g.
+ *     VEHICLE_CLIENT__GATEWAY__LINGER_MS=50,
+ *  4. flags --<section>.<key>=<value>, e.g. --gateway.linger_ms=50.
+ *
+ * Keys are the snake_case names of the example file config/vehicle_client.json,
+ * and unknown keys are errors, so a typo cannot silently fall back to a default.
+ * Values from the environment and flags are text and converted to the type of
+ * the key; lists take comma-separated items and sensors a JSON array.
+ *
+ * Loading again re-reads every source, which is how a running client reloads.
+ */
+class RuntimeConfigLoader
+{
+   public:
+    RuntimeConfigLoader(int argc, char** argv);
+
+    /**
+     * @brief Returns whether --help was given.
+     */
+    bool helpRequested() const
+    {
+        return help;
+    }
+
+    /**
+     * @brief Writes the command line usage to stderr.
+     */
+    void printUsage() const;
+
+    /**
+     * @brief Reads all sources into config.
+     *
+     * @param config Replaced only if every source is valid.
+     * @param error Receives the reason loading failed.
+     * @return False if a source could not be read or holds an invalid setting.
+     */
+    bool load(RuntimeConfig& config, std::string& error) const;
+
+   private:
+    std::string program;
+    std::string configPath;                                      ///< From --config, else the env.
+    std::vector<std::pair<std::string, std::string>> overrides;  ///< Flags as key and value.
+    std::string argumentError;
+    bool help = false;
+};
+
+#endif  // RUNTIME_CONFIG_HPP
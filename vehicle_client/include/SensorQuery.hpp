@@ -0,0 +1,34 @@
+#ifndef SENSOR_QUERY_HPP
+#define SENSOR_QUERY_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "DataTypes.hpp"
+
+/**
+ * @struct SensorQuery
+ * @brief The time range of one sensor that VehicleClient::querySensorData reads.
+ */
+struct SensorQuery
+{
+    SensorType sensorType = SensorType::TEMPERATURE;  ///< The sensor to read.
+    std::uint64_t fromUs = 0;                         ///< First capture time included, 0 for none.
+    std::uint64_t untilUs = 0;                        ///< First capture time excluded, 0 for none.
+    std::size_t pageReadings = 1000;                  ///< Readings per request, at most 10,000.
+};
+
+/**
+ * @struct SensorBucket
+ * @brief Summary of a sensor's readings in one bucket of a downsampled query.
+ */
+struct SensorBucket
+{
+    std::uint64_t startUs = 0;  ///< Start of the bucket in microseconds since the Unix epoch.
+    std::uint64_t count = 0;    ///< Readings in the bucket, never 0.
+    float minimum = 0.0f;
+    float maximum = 0.0f;
+    float average = 0.0f;
+};
+
+#endif  // SENSOR_QUERY_HPP
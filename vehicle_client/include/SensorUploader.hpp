@@ -0,0 +1,118 @@
+#ifndef SENSOR_UPLOADER_HPP
+#define SENSOR_UPLOADER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "DataTypes.hpp"
+#include "RingBuffer.hpp"
+
+class VehicleClient;
+
+/**
+ * @struct UploaderConfig
+ * @brief Queue and batching settings of a SensorUploader.
+ */
+struct UploaderConfig
+{
+    std::size_t queueCapacity = 8192;                             ///< Queue slots.
+    OverflowPolicy overflowPolicy = OverflowPolicy::DROP_OLDEST;  ///< When the queue is full.
+    std::size_t maxBatchReadings = 256;                           ///< Readings per request.
+    std::chrono::milliseconds linger{200};                        ///< Max wait to fill a batch.
+};
+
+/**
+ * @class SensorUploader
+ * @brief Decouples sensor producer threads from the network.
+ *
+ * Producers push fixed-size SensorReading records into a lock-free RingBuffer
+ * without locking or allocating. A dedicated uploader thread drains the queue
+ * and sends the readings of one vehicle in batches through
+ * VehicleClient::addSensorDataBatch.
+ */
+class SensorUploader
+{
+   public:
+    /**
+     * @brief Creates the ingestion queue and starts the uploader thread.
+     *
+     * @param client The client used for uploads. It must outlive the uploader.
+     * @param vehicleSerial The serial number of the vehicle the readings belong to.
+     * @param config Queue and batching settings.
+     */
+    SensorUploader(VehicleClient& client, std::string vehicleSerial,
+                   const UploaderConfig& config = {});
+
+    /**
+     * @brief Stops the uploader thread after uploading everything still queued.
+     */
+    ~SensorUploader();
+
+    SensorUploader(const SensorUploader&) = delete;
+    SensorUploader& operator=(const SensorUploader&) = delete;
+
+    /**
+     * @brief Queues a reading for upload. Safe to call from any number of threads.
+     *
+     * @param reading The sensor reading, stamped with its capture time.
+     * @return False if the reading was rejected by the DROP_NEWEST policy.
+     */
+    bool push(const SensorReading& reading)
+    {
+        return queue.push(reading);
+    }
+
+    /**
+     * @brief Queues a reading captured now. Safe to call from any number of threads.
+     *
+     * @param sensorType The type of sensor that produced the reading.
+     * @param value The sensor's data reading.
+     * @return False if the reading was rejected by the DROP_NEWEST policy.
+     */
+    bool push(SensorType sensorType, float value);
+
+    /**
+     * @brief Returns how many readings were lost because the queue was full.
+     */
+    std::uint64_t dropped() const
+    {
+        return queue.dropped();
+    }
+
+    /**
+     * @brief Returns how many readings were lost because their upload failed.
+     */
+    std::uint64_t failed() const
+    {
+        return failedCount.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the approximate number of readings waiting in the queue.
+     */
+    std::size_t queueDepth() const
+    {
+        return queue.size();
+    }
+
+   private:
+    VehicleClient& client;
+    std::string vehicleSerial;
+    UploaderConfig config;
+    RingBuffer<SensorReading> queue;
+
+    std::atomic<bool> running{true};
+    std::atomic<std::uint64_t> failedCount{0};
+    std::thread uploaderThread;
+
+    /**
+     * @brief Uploader loop: collects up to maxBatchReadings or waits at most linger, then sends.
+     */
+    void run();
+};
+
+#endif  // SENSOR_UPLOADER_HPP
@@ -0,0 +1,69 @@
+#ifndef SERIAL_REGISTRY_HPP
+#define SERIAL_REGISTRY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/// Compact, dense identifier of an interned vehicle serial.
+using VehicleId = std::uint32_t;
+
+/**
+ * @class SerialRegistry
+ * @brief Interns vehicle serial strings into dense VehicleIds.
+ *
+ * Ids are assigned in registration order starting at 0, so they can index
+ * plain arrays. Each serial is stored once; the references returned by serial()
+ * stay valid for the lifetime of the registry. All methods are thread-safe.
+ */
+class SerialRegistry
+{
+   public:
+    SerialRegistry() = default;
+
+    SerialRegistry(const SerialRegistry&) = delete;
+    SerialRegistry& operator=(const SerialRegistry&) = delete;
+
+    /**
+     * @brief Returns the id of a serial, registering it if it is new.
+     *
+     * @param serial The vehicle serial number.
+     * @return The serial's id.
+     */
+    VehicleId intern(std::string_view serial);
+
+    /**
+     * @brief Looks up the id of an already registered serial.
+     *
+     * @param serial The vehicle serial number.
+     * @param id Receives the serial's id if it is registered.
+     * @return False if the serial has not been registered.
+     */
+    bool find(std::string_view serial, VehicleId& id) const;
+
+    /**
+     * @brief Returns the serial of a registered id.
+     */
+    const std::string& serial(VehicleId id) const;
+
+    /**
+     * @brief Returns the number of registered serials, which is also the next id.
+     */
+    std::size_t size() const
+    {
+        return registered.load(std::memory_order_acquire);
+    }
+
+   private:
+    mutable std::shared_mutex mutex;                      ///< Guards serials and ids.
+    std::deque<std::string> serials;                      ///< Serials by id, never moved.
+    std::unordered_map<std::string_view, VehicleId> ids;  ///< Views into serials.
+    std::atomic<std::size_t> registered{0};               ///< serials.size(), readable lock-free.
+};
+
+#endif  // SERIAL_REGISTRY_HPP
@@ -0,0 +1,78 @@
+#ifndef SIMD_KERNELS_HPP
+#define SIMD_KERNELS_HPP
+
+#include <cstdint>
+#include <span>
+
+/**
+ * @enum SimdLevel
+ * @brief Instruction set the batch kernels run on.
+ */
+enum class SimdLevel
+{
+    SCALAR,  ///< Portable C++, the reference the other levels must match bit for bit.
+    AVX2,    ///< x86-64 with AVX2, selected at runtime if the CPU supports it.
+    NEON,    ///< ARM Advanced SIMD, always present on AArch64.
+};
+
+/**
+ * @struct MinMaxSum
+ * @brief Extremes and total of a float array.
+ */
+struct MinMaxSum
+{
+    float min = 0.0f;
+    float max = 0.0f;
+    double sum = 0.0;
+};
+
+/**
+ * @brief Returns the level the kernels currently run on.
+ *
+ * The fastest level the CPU supports is selected the first time a kernel runs.
+ */
+SimdLevel simdLevel();
+
+/**
+ * @brief Forces the kernels onto a level, e.g. to compare a SIMD path against SCALAR.
+ *
+ * @param level The level to use.
+ * @return False, leaving the current level in place, if this CPU or build lacks it.
+ */
+bool setSimdLevel(SimdLevel level);
+
+/**
+ * @brief Returns the name of a level, e.g. for logging.
+ */
+const char* simdLevelToString(SimdLevel level);
+
+/**
+ * @brief Computes the minimum, maximum and sum of an array.
+ *
+ * Values are accumulated in eight interleaved float lanes that are only combined
+ * at the end, so every level adds in the same order and returns identical
+ * results. min and max skip NaNs unless the first value is one; an empty array
+ * returns zeros.
+ */
+MinMaxSum minMaxSum(std::span<const float> values);
+
+/**
+ * @brief XORs every word with its predecessor, the first one with zero.
+ *
+ * @param words The input words.
+ * @param out Receives words.size() results; may not overlap words.
+ */
+void xorWithPrevious(std::span<const std::uint32_t> words, std::uint32_t* out);
+
+/**
+ * @brief Computes the zigzag-encoded delta-of-deltas of a timestamp series.
+ *
+ * out[i - 1] holds the zigzag of (t[i] - t[i-1]) - (t[i-1] - t[i-2]) for i >= 1,
+ * with the delta before the first one taken as zero. Arithmetic wraps modulo 2^64.
+ *
+ * @param timestamps The series, at least one.
+ * @param out Receives timestamps.size() - 1 results; may not overlap timestamps.
+ */
+void zigzagDeltaOfDeltas(std::span<const std::uint64_t> timestamps, std::uint64_t* out);
+
+#endif  // SIMD_KERNELS_HPP
@@ -0,0 +1,107 @@
+#ifndef STATUS_CACHE_HPP
+#define STATUS_CACHE_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @class StatusCache
+ * @brief Last known status and ETag of each vehicle, kept current by conditional GETs
+ *        and, while subscribed, by pushed status events.
+ *
+ * Without a live subscription every cached entry has to be revalidated with a
+ * conditional GET (If-None-Match), which the server answers with an empty 304 as
+ * long as the status is unchanged. While a status event stream is live, entries
+ * of watched vehicles are confirmed: any later change would have been pushed, so
+ * they are served without a request. Confirmation is dropped with the stream, and
+ * responses that raced with an event or a stream transition are stored
+ * unconfirmed. All methods are thread-safe.
+ */
+class StatusCache
+{
+   public:
+    /**
+     * @struct Entry
+     * @brief A cached status and the ETag the server sent with it.
+     */
+    struct Entry
+    {
+        std::string status;
+        std::string etag;
+    };
+
+    /**
+     * @brief Returns a confirmed status, which needs no request to the server.
+     *
+     * @param vehicleSerial The vehicle serial number.
+     * @param status Receives the status.
+     * @return False if there is no confirmed entry.
+     */
+    bool confirmed(const std::string& vehicleSerial, std::string& status) const;
+
+    /**
+     * @brief Returns the cached entry of a vehicle, confirmed or not.
+     *
+     * @param vehicleSerial The vehicle serial number.
+     * @param entry Receives the entry.
+     * @return False if nothing is cached for the vehicle.
+     */
+    bool lookup(const std::string& vehicleSerial, Entry& entry) const;
+
+    /**
+     * @brief Returns a token to pass to storeResponse() for a request that starts now.
+     */
+    std::uint64_t beginRequest() const;
+
+    /**
+     * @brief Stores a status received in a GET response.
+     *
+     * The entry is confirmed only if a stream covering the vehicle was live for the
+     * whole request and no event arrived meanwhile.
+     *
+     * @param token The value beginRequest() returned before the request was sent.
+     */
+    void storeResponse(const std::string& vehicleSerial, Entry entry, std::uint64_t token);
+
+    /**
+     * @brief Stores a status pushed by the event stream.
+     */
+    void storeEvent(const std::string& vehicleSerial, Entry entry);
+
+    /**
+     * @brief Drops the entry of a vehicle, e.g. after updating its status.
+     */
+    void invalidate(const std::string& vehicleSerial);
+
+    /**
+     * @brief Records that an event stream for the given vehicles became live or went down.
+     *
+     * Both transitions unconfirm every entry; while live, entries are confirmed
+     * again as they are revalidated or pushed.
+     *
+     * @param isLive True once the stream is established, false when it is lost.
+     * @param watchedSerials The vehicles the stream covers, all vehicles if empty.
+     */
+    void setLive(bool isLive, const std::vector<std::string>& watchedSerials = {});
+
+   private:
+    struct Slot
+    {
+        Entry entry;
+        bool confirmed = false;  ///< Kept current by the live stream.
+    };
+
+    bool covers(const std::string& vehicleSerial) const;
+
+    mutable std::mutex mutex;                     ///< Guards all members below.
+    std::unordered_map<std::string, Slot> slots;  ///< Entries by vehicle serial.
+    std::unordered_set<std::string> watched;      ///< Vehicles of the stream, all if empty.
+    bool live = false;                            ///< An event stream is established.
+    std::uint64_t changes = 0;                    ///< Events and stream transitions so far.
+};
+
+#endif  // STATUS_CACHE_HPP
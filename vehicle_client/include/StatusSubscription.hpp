@@ -0,0 +1,100 @@
+#ifndef STATUS_SUBSCRIPTION_HPP
+#define STATUS_SUBSCRIPTION_HPP
+
+#include <curl/curl.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "RetryPolicy.hpp"
+#include "StatusCache.hpp"
+
+/**
+ * @class StatusSubscription
+ * @brief Keeps a StatusCache current from the server's status event stream.
+ *
+ * A background thread holds a Server-Sent Events connection to
+ * /vehicle-status-events/ open and stores every pushed status change in the
+ * cache. While the stream is live the cache answers status queries of the
+ * watched vehicles without any request. A lost stream is reopened with
+ * jittered exponential backoff; until then the cache falls back to
+ * conditional GETs.
+ */
+class StatusSubscription
+{
+   public:
+    /**
+     * @brief Starts the subscription thread.
+     *
+     * @param baseUrl The API base URL, without a trailing slash.
+     * @param vehicleSerials The vehicles to watch, all vehicles if empty.
+     * @param cache The cache to keep current; must outlive the subscription.
+     * @param retry Connect timeout and reconnect backoff bounds.
+     */
+    StatusSubscription(const std::string& baseUrl, std::vector<std::string> vehicleSerials,
+                       StatusCache& cache, const RetryConfig& retry);
+
+    /**
+     * @brief Closes the stream and joins the thread, which takes up to a second.
+     */
+    ~StatusSubscription();
+
+    StatusSubscription(const StatusSubscription&) = delete;
+    StatusSubscription& operator=(const StatusSubscription&) = delete;
+
+    /**
+     * @brief Returns true while the event stream is established.
+     */
+    bool live() const
+    {
+        return isLive.load(std::memory_order_acquire);
+    }
+
+   private:
+    /**
+     * @brief Thread loop: opens the stream and reopens it after a backoff when it is lost.
+     */
+    void run();
+
+    /**
+     * @brief Reads one connection until it fails or the subscription stops.
+     *
+     * @return True if the stream became live before it ended.
+     */
+    bool readStream(CURL* curl);
+
+    /**
+     * @brief Splits received bytes into lines and dispatches complete events.
+     */
+    void consume(std::string_view data);
+
+    /**
+     * @brief Applies the event collected so far and resets it.
+     */
+    void dispatch();
+
+    static size_t onData(char* data, size_t size, size_t count, void* self);
+    static int onProgress(void* self, curl_off_t, curl_off_t, curl_off_t, curl_off_t);
+
+    std::string url;                   ///< Stream URL including the vehicle filter.
+    std::vector<std::string> serials;  ///< Watched vehicles, all if empty.
+    StatusCache& cache;
+    RetryConfig retry;
+
+    std::string line;       ///< Incomplete line of the current connection.
+    std::string eventName;  ///< "event" field of the event being received.
+    std::string eventData;  ///< "data" field of the event being received.
+
+    std::atomic<bool> running{true};
+    std::atomic<bool> isLive{false};
+    std::mutex sleepMutex;           ///< Pairs with wakeUp.
+    std::condition_variable wakeUp;  ///< Cuts a reconnect backoff short on shutdown.
+    std::thread worker;
+};
+
+#endif  // STATUS_SUBSCRIPTION_HPP
@@ -0,0 +1,450 @@
+#ifndef TASK_HPP
+#define TASK_HPP
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <semaphore>
+#include <type_traits>
+#include <utility>
+
+/// Receives the outcome of an asynchronous operation, on the thread that completed it.
+template <typename T>
+using Completion = std::function<void(T)>;
+
+template <typename T>
+class Task;
+
+/**
+ * @class TaskPromiseBase
+ * @brief State shared by every Task promise: the awaiting coroutine and a pending exception.
+ */
+class TaskPromiseBase
+{
+   public:
+    /// Tasks are lazy: the body starts when the task is first awaited.
+    std::suspend_always initial_suspend() noexcept
+    {
+        return {};
+    }
+
+    /// Hands control straight to the awaiting coroutine, without growing the stack.
+    struct FinalAwaiter
+    {
+        bool await_ready() noexcept
+        {
+            return false;
+        }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> finished) noexcept
+        {
+            std::coroutine_handle<> continuation = finished.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() noexcept
+        {
+        }
+    };
+
+    FinalAwaiter final_suspend() noexcept
+    {
+        return {};
+    }
+
+    void unhandled_exception() noexcept
+    {
+        error = std::current_exception();
+    }
+
+    std::coroutine_handle<> continuation;  ///< Resumed once the task's body has finished.
+
+   protected:
+    std::exception_ptr error;  ///< Thrown by the body, rethrown to the awaiter.
+
+    void rethrowIfFailed()
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+/**
+ * @brief Promise of a Task returning a value.
+ */
+template <typename T>
+class TaskPromise : public TaskPromiseBase
+{
+   public:
+    Task<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U&& result)
+    {
+        value.emplace(std::forward<U>(result));
+    }
+
+    T result()
+    {
+        rethrowIfFailed();
+        return std::move(*value);
+    }
+
+   private:
+    std::optional<T> value;
+};
+
+/**
+ * @brief Promise of a Task returning nothing.
+ */
+template <>
+class TaskPromise<void> : public TaskPromiseBase
+{
+   public:
+    Task<void> get_return_object() noexcept;
+
+    void return_void() noexcept
+    {
+    }
+
+    void result()
+    {
+        rethrowIfFailed();
+    }
+};
+
+/**
+ * @class Task
+ * @brief Lazily started coroutine producing a T, awaited with co_await.
+ *
+ * A Task does nothing until it is awaited; the awaiting coroutine is then
+ * suspended until the task's body finishes and resumed with its result, or with
+ * the exception the body threw. A task is awaited at most once. Use syncWait()
+ * to run a task from ordinary code and spawn() to start one without waiting.
+ *
+ * @code
+ * Task<bool> session(VehicleClient& client, std::string serial)
+ * {
+ *     co_await client.updateVehicleStatusTask(serial, VehicleStatus::ACTIVE);
+ *     bool sent = co_await client.addSensorDataTask(SensorType::FUEL, 42.0f, serial);
+ *     auto [ok, status] = co_await client.getVehicleStatusTask(serial);
+ *     co_return sent && ok;
+ * }
+ * @endcode
+ */
+template <typename T>
+class Task
+{
+   public:
+    using promise_type = TaskPromise<T>;
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr))
+    {
+    }
+
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other)
+        {
+            destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task()
+    {
+        destroy();
+    }
+
+    /**
+     * @brief Starts the task and suspends the caller until it has finished.
+     */
+    auto operator co_await() && noexcept
+    {
+        struct Awaiter
+        {
+            std::coroutine_handle<promise_type> task;
+
+            bool await_ready() noexcept
+            {
+                return task.done();
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                task.promise().continuation = awaiting;
+                return task;
+            }
+
+            T await_resume()
+            {
+                return task.promise().result();
+            }
+        };
+        return Awaiter{handle};
+    }
+
+   private:
+    friend class TaskPromise<T>;
+
+    std::coroutine_handle<promise_type> handle;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle)
+    {
+    }
+
+    void destroy()
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+    }
+};
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept
+{
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept
+{
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+/**
+ * @class CompletionAwaiter
+ * @brief Suspends a coroutine until a callback-based operation delivers its result.
+ *
+ * The start function is called with a Completion when the coroutine suspends.
+ * The coroutine resumes on whichever thread invokes the completion, or does not
+ * suspend at all if the completion is invoked before start returns.
+ *
+ * @tparam T The result type.
+ * @tparam Start Callable taking a Completion<T>, invoked exactly once.
+ */
+template <typename T, typename Start>
+class CompletionAwaiter
+{
+   public:
+    explicit CompletionAwaiter(Start start) : start(std::move(start))
+    {
+    }
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    bool await_suspend(std::coroutine_handle<> awaiting)
+    {
+        this->awaiting = awaiting;
+        start(
+            [this](T value)
+            {
+                result.emplace(std::move(value));
+                // The second of the completion and await_suspend to get here resumes
+                if (completed.exchange(true, std::memory_order_acq_rel))
+                {
+                    this->awaiting.resume();
+                }
+            });
+        return !completed.exchange(true, std::memory_order_acq_rel);
+    }
+
+    T await_resume()
+    {
+        return std::move(*result);
+    }
+
+   private:
+    Start start;
+    std::coroutine_handle<> awaiting;
+    std::optional<T> result;
+    std::atomic<bool> completed{false};
+};
+
+/**
+ * @brief Returns an awaiter for a callback-based operation, see CompletionAwaiter.
+ */
+template <typename T, typename Start>
+CompletionAwaiter<T, Start> awaitCompletion(Start start)
+{
+    return CompletionAwaiter<T, Start>(std::move(start));
+}
+
+/**
+ * @class DetachedTask
+ * @brief Coroutine started right away whose frame frees itself when it finishes.
+ */
+class DetachedTask
+{
+   public:
+    struct promise_type
+    {
+        DetachedTask get_return_object() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void() noexcept
+        {
+        }
+
+        void unhandled_exception() noexcept
+        {
+            std::terminate();
+        }
+    };
+};
+
+/**
+ * @brief Starts a task without waiting for it.
+ *
+ * The task runs on the calling thread until its first suspension and continues
+ * wherever it is resumed. An exception escaping the task terminates the program.
+ */
+inline DetachedTask spawn(Task<void> task)
+{
+    co_await std::move(task);
+}
+
+/**
+ * @class SyncWaitTask
+ * @brief Coroutine that wakes a blocked thread once it has finished, used by syncWait().
+ */
+class SyncWaitTask
+{
+   public:
+    struct promise_type
+    {
+        std::binary_semaphore finished{0};
+
+        SyncWaitTask get_return_object() noexcept
+        {
+            return SyncWaitTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        // Signalled once suspended for good, so the waiter may destroy the frame
+        auto final_suspend() noexcept
+        {
+            struct Signal
+            {
+                bool await_ready() noexcept
+                {
+                    return false;
+                }
+
+                void await_suspend(std::coroutine_handle<promise_type> finished) noexcept
+                {
+                    finished.promise().finished.release();
+                }
+
+                void await_resume() noexcept
+                {
+                }
+            };
+            return Signal{};
+        }
+
+        void return_void() noexcept
+        {
+        }
+
+        // The awaited task's exception is caught in syncWait()
+        void unhandled_exception() noexcept
+        {
+            std::terminate();
+        }
+    };
+
+    explicit SyncWaitTask(std::coroutine_handle<promise_type> handle) : handle(handle)
+    {
+    }
+
+    SyncWaitTask(const SyncWaitTask&) = delete;
+    SyncWaitTask& operator=(const SyncWaitTask&) = delete;
+
+    /**
+     * @brief Blocks until the coroutine has finished, then frees it.
+     */
+    ~SyncWaitTask()
+    {
+        handle.promise().finished.acquire();
+        handle.destroy();
+    }
+
+   private:
+    std::coroutine_handle<promise_type> handle;
+};
+
+/**
+ * @brief Runs a task and blocks the calling thread until it has finished.
+ *
+ * Must not be called on the thread the task resumes on, e.g. from a completion
+ * callback of the async transport.
+ *
+ * @return The task's result; its exception is rethrown.
+ */
+template <typename T>
+T syncWait(Task<T> task)
+{
+    std::exception_ptr error;
+    std::conditional_t<std::is_void_v<T>, bool, std::optional<T>> result{};
+    {
+        auto waiter = [](Task<T>& task, auto& result, std::exception_ptr& error) -> SyncWaitTask
+        {
+            try
+            {
+                if constexpr (std::is_void_v<T>)
+                {
+                    co_await std::move(task);
+                }
+                else
+                {
+                    result.emplace(co_await std::move(task));
+                }
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+        };
+        SyncWaitTask wait = waiter(task, result, error);
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+    if constexpr (!std::is_void_v<T>)
+    {
+        return std::move(*result);
+    }
+}
+
+#endif  // TASK_HPP
@@ -0,0 +1,118 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class TimerWheel
+ * @brief Hashed timing wheel of periodic timers on the steady clock.
+ *
+ * Time is cut into ticks and each timer sits in the slot of the tick its next
+ * deadline falls into, so adding, rescheduling and expiring a timer cost O(1)
+ * however many timers there are; a timer due more than one rotation ahead
+ * stays in its slot until the wheel comes round to its tick.
+ *
+ * Deadlines are absolute: a timer's next deadline is its previous deadline
+ * plus its period, never the time it was serviced plus its period, so a timer
+ * keeps its phase and rate over days of running however late advance is
+ * called. If a timer fell more than a period behind, the deadlines it missed
+ * are skipped and counted instead of fired in a burst.
+ *
+ * Not thread-safe; one thread owns the wheel.
+ */
+class TimerWheel
+{
+   public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = std::size_t;
+
+    /**
+     * @param tick Resolution of the wheel; timers never fire early, and at most a tick late.
+     * @param slots Ticks per rotation.
+     * @param start The time of tick 0.
+     */
+    TimerWheel(Clock::duration tick, std::size_t slots, Clock::time_point start = Clock::now());
+
+    /**
+     * @brief Adds a periodic timer.
+     *
+     * @param period Time between deadlines, raised to one tick if shorter.
+     * @param firstDue The first deadline.
+     * @return The id to pass to setPeriod and cancel; ids of cancelled timers are reused.
+     */
+    TimerId add(Clock::duration period, Clock::time_point firstDue);
+
+    /**
+     * @brief Changes the period of a timer, counted from its last deadline.
+     *
+     * A timer that would have been due by now under the new period fires at the
+     * next advance.
+     *
+     * @param now The current time.
+     */
+    void setPeriod(TimerId timer, Clock::duration period, Clock::time_point now);
+
+    /**
+     * @brief Stops a timer and frees its id.
+     */
+    void cancel(TimerId timer);
+
+    /**
+     * @brief Fires the timers that are due by now.
+     *
+     * @param now The current time.
+     * @param due Receives the id of every timer that fired, once per timer.
+     */
+    void advance(Clock::time_point now, std::vector<TimerId>& due);
+
+    /**
+     * @brief Returns the earliest deadline within one rotation, or the end of the rotation.
+     *
+     * Meant for sleeping until there is work, so a wheel of slow timers does not
+     * wake up every tick.
+     */
+    Clock::time_point nextExpiry() const;
+
+    /**
+     * @brief Returns how many deadlines were skipped because advance came too late.
+     */
+    std::uint64_t missed() const
+    {
+        return missedCount;
+    }
+
+   private:
+    struct Timer
+    {
+        Clock::duration period{0};
+        Clock::time_point deadline;
+        std::uint64_t deadlineTick = 0;
+        std::uint32_t generation = 0;  ///< Bumped on reschedule, older slot entries are stale.
+        bool active = false;
+    };
+
+    struct Entry
+    {
+        TimerId timer;
+        std::uint32_t generation;
+    };
+
+    Clock::duration tick;
+    Clock::time_point start;
+    std::uint64_t currentTick = 0;  ///< Last tick that was processed.
+    std::vector<std::vector<Entry>> slots;
+    std::vector<Entry> scratch;  ///< Holds the slot advance works on, keeps its capacity.
+    std::vector<Timer> timers;
+    std::vector<TimerId> freeIds;
+    std::uint64_t missedCount = 0;
+
+    /**
+     * @brief Puts a timer into the slot of its deadline, after a new deadline was set.
+     */
+    void schedule(TimerId id);
+};
+
+#endif  // TIMER_WHEEL_HPP
@@ -0,0 +1,51 @@
+#ifndef TIMESTAMP_FORMATTER_HPP
+#define TIMESTAMP_FORMATTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Returns the current wall-clock time in microseconds since the Unix epoch (UTC).
+ */
+std::uint64_t currentTimeMicros();
+
+/**
+ * @class TimestampFormatter
+ * @brief Formats capture times as ISO 8601 UTC timestamps (YYYY-MM-DDTHH:MM:SS.ffffffZ).
+ *
+ * The date and time-of-day prefix is computed with a civil-from-days conversion
+ * (no gmtime, no locale) and cached per second, so consecutive samples only
+ * rewrite the six microsecond digits. Output goes to a caller-supplied buffer
+ * and nothing is allocated.
+ *
+ * A formatter is not thread-safe; use one per thread.
+ */
+class TimestampFormatter
+{
+   public:
+    /// Number of characters written by format().
+    static constexpr std::size_t kLength = 27;
+
+    /**
+     * @brief Writes the timestamp for a capture time.
+     *
+     * @param timestampUs Microseconds since the Unix epoch (UTC).
+     * @param out Destination with room for at least kLength characters. No
+     *        terminating null character is written.
+     * @return Pointer one past the last character written.
+     */
+    char* format(std::uint64_t timestampUs, char* out);
+
+   private:
+    static constexpr std::size_t kPrefixLength = 19;  ///< "YYYY-MM-DDTHH:MM:SS"
+
+    std::uint64_t cachedSecond = UINT64_MAX;  ///< Second the prefix was built for.
+    char cachedPrefix[kPrefixLength] = {};    ///< Formatted date and time of day.
+
+    /**
+     * @brief Rebuilds the cached prefix for the given second since the epoch.
+     */
+    void updatePrefix(std::uint64_t second);
+};
+
+#endif  // TIMESTAMP_FORMATTER_HPP
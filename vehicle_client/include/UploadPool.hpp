@@ -0,0 +1,153 @@
+#ifndef UPLOAD_POOL_HPP
+#define UPLOAD_POOL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ConnectionPool.hpp"
+#include "RingBuffer.hpp"
+#include "WorkStealingDeque.hpp"
+
+/**
+ * @struct UploadPoolConfig
+ * @brief Size, affinity and queue settings of an UploadPool.
+ */
+struct UploadPoolConfig
+{
+    std::size_t threads = 0;           ///< Worker threads, 0 for one per core.
+    bool pinThreads = false;           ///< Pin worker i to CPU i (Linux only).
+    std::size_t queueCapacity = 1024;  ///< Tasks per worker deque and per inbox.
+};
+
+/**
+ * @class UploadPool
+ * @brief Work-stealing thread pool that runs uploads with per-worker resources.
+ *
+ * Every worker owns a Chase-Lev deque for tasks it spawns itself, a lock-free
+ * inbox for tasks submitted from other threads (spread round-robin) and its own
+ * ConnectionPool, so serializing, compressing and sending a request touches no
+ * state shared with other workers. A worker that runs dry steals from the
+ * others, which keeps all cores busy when the load is uneven. Idle workers
+ * sleep on a condition variable and are woken by submissions.
+ */
+class UploadPool
+{
+   public:
+    /// A unit of work, run exactly once on one of the workers.
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Starts the worker threads.
+     *
+     * @param config Size, affinity and queue settings.
+     */
+    explicit UploadPool(const UploadPoolConfig& config = {});
+
+    /**
+     * @brief Runs every task still queued, then joins the workers.
+     */
+    ~UploadPool();
+
+    UploadPool(const UploadPool&) = delete;
+    UploadPool& operator=(const UploadPool&) = delete;
+
+    /**
+     * @brief Queues a task. Safe to call from any thread, including the workers.
+     *
+     * Tasks submitted by a worker go to its own deque; if it is full the task runs
+     * inline. Other threads wait for inbox space when all inboxes are full.
+     *
+     * @param task The task to run.
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Forwards connect and total timeouts to every worker's connection pool.
+     */
+    void setTimeouts(std::chrono::milliseconds connectTimeout,
+                     std::chrono::milliseconds requestTimeout);
+
+    /**
+     * @brief Forwards an abort deadline to every worker's connection pool.
+     */
+    void abortTransfersAt(std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * @brief Returns the number of worker threads.
+     */
+    std::size_t size() const
+    {
+        return workers.size();
+    }
+
+    /**
+     * @brief Returns the number of submitted tasks no worker has picked up yet.
+     */
+    std::size_t queued() const
+    {
+        return queuedCount.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns how many tasks were taken from another worker so far.
+     */
+    std::uint64_t stolen() const
+    {
+        return stolenCount.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the calling worker's own connection pool, or nullptr if the
+     *        caller is not a worker of any UploadPool.
+     */
+    static ConnectionPool* currentConnectionPool();
+
+   private:
+    struct Worker
+    {
+        explicit Worker(std::size_t capacity)
+            : deque(capacity), inbox(capacity, OverflowPolicy::DROP_NEWEST), connections(2)
+        {
+        }
+
+        WorkStealingDeque<Task*> deque;  ///< Tasks spawned by this worker.
+        RingBuffer<Task*> inbox;         ///< Tasks submitted from other threads.
+        ConnectionPool connections;      ///< Handles used by this worker only.
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<std::size_t> nextInbox{0};  ///< Round-robin cursor of external submissions.
+    std::atomic<std::uint64_t> stolenCount{0};
+    std::atomic<std::size_t> queuedCount{0};  ///< Tasks in deques and inboxes.
+
+    std::mutex sleepMutex;                 ///< Pairs with wakeUp.
+    std::condition_variable wakeUp;        ///< Signalled on submissions and shutdown.
+    std::atomic<std::size_t> sleepers{0};  ///< Workers waiting on wakeUp.
+    std::atomic<bool> stopping{false};
+
+    /**
+     * @brief Worker loop: own tasks first, then stolen ones, sleeping when there are none.
+     */
+    void run(std::size_t index);
+
+    /**
+     * @brief Takes the next task for worker @p index from its own queues or another worker.
+     */
+    Task* findTask(std::size_t index);
+
+    /**
+     * @brief Wakes one sleeping worker, if any.
+     */
+    void notifySleeper();
+};
+
+#endif  // UPLOAD_POOL_HPP
@@ -1,9 +1,39 @@
 #ifndef VEHICLE_CLIENT_HPP
 #define VEHICLE_CLIENT_HPP
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
+#include "AggregationPipeline.hpp"
+#include "AsyncTransport.hpp"
+#include "BatchBodyStream.hpp"
+#include "BatchBuffer.hpp"
+#include "BodyCompressor.hpp"
+#include "ClientMetrics.hpp"
+#include "ConnectionPool.hpp"
+#include "CurlGlobal.hpp"
+#include "FlushScheduler.hpp"
 #include "DataTypes.hpp"
+#include "MetricsEndpoint.hpp"
+#include "OfflineSpool.hpp"
+#include "PayloadSerializer.hpp"
+#include "RequestTemplates.hpp"
+#include "RetryPolicy.hpp"
+#include "SensorQuery.hpp"
+#include "StatusCache.hpp"
+#include "StatusSubscription.hpp"
+#include "Task.hpp"
+#include "UploadPool.hpp"
 
 /**
  * @class VehicleClient
@@ -11,7 +41,27 @@
  *
  * This class provides functions for sending sensor data to a remote server.
  * It manages API requests and processes server responses to ensure data
- * is correctly recorded.
+ * is correctly recorded. Connections to the server are kept alive and reused
+ * across calls through an internal ConnectionPool.
+ *
+ * Every operation also has a non-blocking *Async variant that returns a
+ * std::future and runs on a background curl_multi event loop, so many requests
+ * can be in flight at once without stalling the caller. The *Task variants are
+ * coroutines on the same loop, so that sequences of requests read as straight-line
+ * code and each waiting sequence costs a coroutine frame instead of a thread.
+ *
+ * All requests are bounded by the timeouts of a RetryPolicy, which also retries
+ * transient failures of idempotent requests with jittered backoff and fails fast
+ * through a circuit breaker while the server is down.
+ *
+ * The server only records finite values, so NaN and infinite readings are
+ * discarded (and counted) before they reach a batch; one bad sample cannot get
+ * the good ones of its batch rejected.
+ *
+ * Vehicle statuses are cached with their ETags, so repeated status queries are
+ * conditional GETs that the server answers with an empty 304 while nothing
+ * changed. With status notifications enabled, queries are answered from the
+ * cache without any request at all.
  */
 class VehicleClient
 {
@@ -24,7 +74,8 @@ class VehicleClient
     VehicleClient(const std::string& baseUrl);
 
     /**
-     * @brief Destructor for VehicleClient, cleans up any resources used by CURL.
+     * @brief Destructor for VehicleClient, flushes any buffered readings and cleans up
+     *        any resources used by CURL.
      */
     ~VehicleClient();
 
@@ -35,14 +86,196 @@ class VehicleClient
      * it to the server. It also checks the server response to confirm if the
      * data was successfully recorded.
      *
+     * When batching is enabled the reading is only appended to the coalescing
+     * buffer, and a batch is sent once one of the configured thresholds is hit.
+     *
      * @param sensorType The type of sensor (e.g., TEMPERATURE, WEIGHT, FUEL).
      * @param sensorData The sensor's data reading, as a float.
      * @param vehicleSerial The serial number of the vehicle.
-     * @return True if the server confirms data was recorded successfully,
-     *         false otherwise.
+     * @return True if the server confirms data was recorded successfully (or the
+     *         reading was buffered and no triggered flush failed), false otherwise.
      */
     bool addSensorData(SensorType sensorType, float sensorData, const std::string& vehicleSerial);
 
+    /**
+     * @brief Sends a sensor reading stamped with its own capture time.
+     *
+     * Behaves like the overload above, but keeps the time the sample was taken
+     * instead of the time it is sent, which matters once readings are batched
+     * or queued before upload.
+     *
+     * @param reading The sensor reading, including its capture time.
+     * @param vehicleSerial The serial number of the vehicle.
+     * @return True if the server confirms data was recorded successfully (or the
+     *         reading was buffered and no triggered flush failed), false otherwise.
+     */
+    bool addSensorData(const SensorReading& reading, const std::string& vehicleSerial);
+
+    /**
+     * @brief Sends several sensor readings of one vehicle in a single request.
+     *
+     * The readings are posted to the bulk endpoint, which records all of them in
+     * one transaction.
+     *
+     * @param readings The sensor readings to send.
+     * @param vehicleSerial The serial number of the vehicle.
+     * @return True if the server confirms all finite readings were recorded, false otherwise.
+     */
+    bool addSensorDataBatch(std::span<const SensorReading> readings,
+                            const std::string& vehicleSerial);
+
+    /**
+     * @brief Selects the body encoding of sensor batch uploads.
+     *
+     * Binary formats (CBOR, MessagePack) drop the text overhead of keys, numbers
+     * and ISO timestamps. COLUMNAR additionally stores the serial and sensor type
+     * once per column and compresses timestamps and values, which suits
+     * high-rate streams of smooth signals. Single readings and status updates
+     * are always sent as JSON. Safe to call while uploads are running; a batch
+     * keeps the format it started encoding with.
+     *
+     * @param format The wire format for addSensorDataBatch and batched uploads.
+     */
+    void setWireFormat(WireFormat format);
+
+    /**
+     * @brief Enables Content-Encoding compression of sensor data request bodies.
+     *
+     * Bodies below config.minBytes, such as single readings, are still sent
+     * uncompressed. The server must know the zstd dictionary, if one is used.
+     * Must be called before the first upload: workers and the spool drainer use
+     * the compressor without locking, and compressed bodies point into its buffers.
+     *
+     * @param config The algorithm, size threshold, level and dictionary.
+     * @return False if this build does not support the requested algorithm.
+     */
+    bool enableCompression(const CompressionConfig& config);
+
+    /**
+     * @brief Enables the on-disk store-and-forward spool for sensor data.
+     *
+     * Readings whose upload fails with a transport error or a transient HTTP
+     * status (timeouts, 429, 5xx) are appended to the spool instead of being
+     * lost, and a background drainer replays them in large batches once the
+     * server is reachable again. The calls still report the failed attempt by
+     * returning false. Readings the server rejects are not spooled.
+     *
+     * @param config The spool directory, segment size, sync policy and replay settings.
+     * @return False if the spool directory could not be opened.
+     */
+    bool enableSpool(const SpoolConfig& config);
+
+    /**
+     * @brief Replaces the timeouts, retry and circuit breaker settings.
+     *
+     * Status queries and updates are always retried. Sensor uploads are only
+     * retried when config.idempotencyKeys is set, in which case each upload
+     * carries an Idempotency-Key header that lets the server drop duplicates.
+     * Requests already in flight keep the previous policy. The circuit breaker
+     * is carried over with its state, so a reload neither closes an open circuit
+     * nor forgets the failures counted so far.
+     *
+     * @param config The timeouts, backoff and breaker settings.
+     */
+    void setRetryPolicy(const RetryConfig& config);
+
+    /**
+     * @brief Subscribes to the server's status change events.
+     *
+     * A background thread keeps an event stream open and updates the status cache
+     * with every change the server pushes. While the stream is live, getVehicleStatus
+     * and getVehicleStatusAsync answer for the watched vehicles from the cache;
+     * while it is down they fall back to conditional GETs.
+     *
+     * @param vehicleSerials The vehicles to watch, all vehicles if empty.
+     */
+    void enableStatusNotifications(const std::vector<std::string>& vehicleSerials = {});
+
+    /**
+     * @brief Runs async sensor uploads on a work-stealing pool of worker threads.
+     *
+     * Without the pool, addSensorDataAsync and addSensorDataBatchAsync serialize
+     * and compress on the calling thread, and all transfers share one event loop.
+     * With it, each upload is queued as a task: one of the workers serializes,
+     * compresses and sends it with its own buffers and curl handles, and spools
+     * it on a transient failure. This spreads the CPU work of high-rate batch
+     * streams across cores. Status requests stay on the event loop.
+     *
+     * @param config The number of workers, CPU pinning and queue sizes.
+     */
+    void enableUploadPool(const UploadPoolConfig& config);
+
+    /**
+     * @brief Enables the client-side coalescing buffer for addSensorData.
+     *
+     * @param config The size, byte and age thresholds that trigger a flush.
+     */
+    void enableBatching(const BatchConfig& config);
+
+    /**
+     * @brief Reduces the readings of addSensorData and addSensorDataAsync before upload.
+     *
+     * Each sensor type gets its own policy: windowed mean or min/max, a deadband, or
+     * Largest-Triangle-Three-Buckets downsampling. Reduced readings continue to the
+     * coalescing buffer if batching is enabled. Batches handed to addSensorDataBatch
+     * are sent as they are.
+     *
+     * @param config The per-sensor-type policies.
+     */
+    void enableAggregation(const AggregationConfig& config);
+
+    /**
+     * @brief Sends every reading currently held in the aggregation windows and the
+     *        coalescing buffer.
+     *
+     * @return True if all pending batches were recorded (or nothing was pending),
+     *         false if at least one batch failed.
+     */
+    bool flush();
+
+    /**
+     * @brief Returns the client's counters, queue depths and request latencies.
+     *
+     * Every request attempt, sync or async, is timed by phase (DNS lookup,
+     * connect, TLS handshake, time to first byte and total) from libcurl's own
+     * timings. Safe to call from any thread at any time.
+     */
+    MetricsSnapshot metrics() const;
+
+    /**
+     * @brief Serves metrics() in the Prometheus text format at GET /metrics.
+     *
+     * @param config The address and port to listen on, loopback only by default.
+     * @return False if the address could not be bound.
+     */
+    bool enableMetricsEndpoint(const MetricsEndpointConfig& config = {});
+
+    /**
+     * @brief Opens connections to the server in the background, ahead of the first upload.
+     *
+     * Sends GET requests for the server root through the async event loop and
+     * returns at once, so startup does not wait for DNS, TCP and TLS. The
+     * resolved address, the TLS session and the open connections land in the
+     * shared cache that sync and async requests use. Upload pool workers keep
+     * their own connections and still connect on first use.
+     *
+     * @param connections The number of requests sent at the same time.
+     */
+    void prewarm(std::size_t connections = 1);
+
+    /**
+     * @brief Bounds how long outstanding requests may take, so a shutdown cannot hang.
+     *
+     * Sync and async requests still running at the deadline are aborted, and
+     * requests sent after it fail right away. Both count as transient failures,
+     * so the readings of uploads among them go to the spool if it is enabled.
+     * Call it before destroying a VehicleGateway or the client to drain within
+     * the deadline.
+     *
+     * @param deadline When to stop waiting for the server.
+     */
+    void abortRequestsAt(std::chrono::steady_clock::time_point deadline);
+
     /**
      * @brief Retrieves the current status of a specific vehicle
      *
@@ -70,32 +303,404 @@ class VehicleClient
      */
     bool updateVehicleStatus(const std::string& vehicleSerial, VehicleStatus status);
 
-   private:
-    std::string baseUrl;  ///< The base URL for the API server.
+    /**
+     * @brief Retrieves the statuses of many vehicles with as few requests as possible.
+     *
+     * Statuses kept current by status notifications are taken from the cache; all
+     * others are fetched with one bulk request per 10,000 vehicles.
+     *
+     * @param vehicleSerials The serial numbers of the vehicles to query.
+     * @return One pair per serial, in the same order, as getVehicleStatus returns it.
+     */
+    std::vector<std::pair<bool, std::string>> getVehicleStatuses(
+        std::span<const std::string> vehicleSerials);
+
+    /**
+     * @brief Updates the statuses of many vehicles with one bulk request per 10,000 vehicles.
+     *
+     * @param updates Pairs of vehicle serial number and new status; the last status of a
+     *        repeated serial wins.
+     * @return True if every vehicle was updated, false if a request failed or a vehicle
+     *         is not registered.
+     */
+    bool updateVehicleStatuses(std::span<const std::pair<std::string, VehicleStatus>> updates);
+
+    /**
+     * @brief Reads a sensor's recorded readings in a time range, one page per request.
+     *
+     * Each page is handed to onPage as soon as it arrives and its buffer is reused
+     * for the next one, so memory stays bounded by query.pageReadings however many
+     * readings the range holds. Pages follow a server cursor, so no reading is
+     * returned twice even while new ones are recorded.
+     *
+     * @param vehicleSerial The serial number of the vehicle.
+     * @param query The sensor, time range and page size.
+     * @param onPage Receives each non-empty page, oldest readings first; returns false
+     *        to stop reading.
+     * @return True if the range was read to its end or onPage stopped it, false if a
+     *         request failed or the vehicle is not registered.
+     */
+    bool querySensorData(const std::string& vehicleSerial, const SensorQuery& query,
+                         const std::function<bool(std::span<const SensorReading>)>& onPage);
+
+    /**
+     * @brief Reads a sensor's readings in a time range downsampled by the server.
+     *
+     * The server aggregates the readings of every bucket of bucketWidth, counted
+     * from query.fromUs, into their count, minimum, maximum and average, so a long
+     * range costs one small response. At most 10,000 buckets fit in one query; an
+     * open upper bound ends at the current time. query.pageReadings is ignored.
+     *
+     * @param vehicleSerial The serial number of the vehicle.
+     * @param query The sensor and time range.
+     * @param bucketWidth The width of a bucket, at least one second.
+     * @param buckets Receives the buckets that have readings, oldest first.
+     * @return True on success, false if the request failed or was refused.
+     */
+    bool querySensorData(const std::string& vehicleSerial, const SensorQuery& query,
+                         std::chrono::seconds bucketWidth, std::vector<SensorBucket>& buckets);
+
+    /**
+     * @brief Non-blocking variant of addSensorData.
+     *
+     * The reading is sent right away and bypasses the coalescing buffer.
+     *
+     * @param sensorType The type of sensor (e.g., TEMPERATURE, WEIGHT, FUEL).
+     * @param sensorData The sensor's data reading, as a float.
+     * @param vehicleSerial The serial number of the vehicle.
+     * @return A future that becomes true once the server confirms the data was recorded.
+     */
+    std::future<bool> addSensorDataAsync(SensorType sensorType, float sensorData,
+                                         const std::string& vehicleSerial);
 
     /**
-     * @brief Retrieves the current timestamp in ISO 8601 format.
+     * @brief Non-blocking variant of addSensorData for a reading with its own capture time.
      *
-     * This function generates a string representing the current time in
-     * UTC, formatted according to ISO 8601 (YYYY-MM-DDTHH:MM:SSZ).
+     * @param reading The sensor reading, including its capture time.
+     * @param vehicleSerial The serial number of the vehicle.
+     * @return A future that becomes true once the server confirms the data was recorded.
+     */
+    std::future<bool> addSensorDataAsync(const SensorReading& reading,
+                                         const std::string& vehicleSerial);
+
+    /**
+     * @brief Non-blocking variant of addSensorDataBatch.
      *
-     * @return The current timestamp as a string.
+     * The payload is built before returning, so the readings do not need to outlive the call.
+     *
+     * @param readings The sensor readings to send.
+     * @param vehicleSerial The serial number of the vehicle.
+     * @return A future that becomes true once the server confirms all readings were recorded.
      */
-    std::string getCurrentTimestamp() const;
+    std::future<bool> addSensorDataBatchAsync(std::span<const SensorReading> readings,
+                                              const std::string& vehicleSerial);
 
     /**
-     * @brief Sends a JSON payload to a specified API endpoint.
+     * @brief Variant of addSensorDataBatchAsync for flow control, see FlushScheduler.
+     *
+     * @return A future of how the upload ended and how long it took. Transient
+     *         failures such as timeouts, 429 and 503 are reported as RETRY.
+     */
+    std::future<UploadFeedback> uploadSensorDataBatchAsync(std::span<const SensorReading> readings,
+                                                           const std::string& vehicleSerial);
+
+    /**
+     * @brief Non-blocking variant of getVehicleStatus.
+     *
+     * @param vehicleSerial The unique serial number of the vehicle to query.
+     * @return A future holding the same pair getVehicleStatus returns.
+     */
+    std::future<std::pair<bool, std::string>> getVehicleStatusAsync(
+        const std::string& vehicleSerial);
+
+    /**
+     * @brief Non-blocking variant of updateVehicleStatus.
+     *
+     * @param vehicleSerial The unique serial number of the vehicle to update.
+     * @param status The new status to be set for the vehicle.
+     * @return A future that becomes true once the server confirms the update.
+     */
+    std::future<bool> updateVehicleStatusAsync(const std::string& vehicleSerial,
+                                               VehicleStatus status);
+
+    /**
+     * @brief Coroutine variant of addSensorData, sent like addSensorDataAsync.
+     *
+     * The arguments are taken by value, as the task only starts once it is awaited.
+     * The awaiting coroutine resumes on the thread that completed the request,
+     * usually the event loop thread, and must not block there.
+     *
+     * @param sensorType The type of sensor (e.g., TEMPERATURE, WEIGHT, FUEL).
+     * @param sensorData The sensor's data reading, as a float.
+     * @param vehicleSerial The serial number of the vehicle.
+     * @return A task that yields true once the server confirms the data was recorded.
+     */
+    Task<bool> addSensorDataTask(SensorType sensorType, float sensorData,
+                                 std::string vehicleSerial);
+
+    /**
+     * @brief Coroutine variant of addSensorData for a reading with its own capture time.
+     */
+    Task<bool> addSensorDataTask(SensorReading reading, std::string vehicleSerial);
+
+    /**
+     * @brief Coroutine variant of addSensorDataBatch, sent like addSensorDataBatchAsync.
+     */
+    Task<bool> addSensorDataBatchTask(std::vector<SensorReading> readings,
+                                      std::string vehicleSerial);
+
+    /**
+     * @brief Coroutine variant of getVehicleStatus.
+     *
+     * @param vehicleSerial The unique serial number of the vehicle to query.
+     * @return A task yielding the same pair getVehicleStatus returns.
+     */
+    Task<std::pair<bool, std::string>> getVehicleStatusTask(std::string vehicleSerial);
+
+    /**
+     * @brief Coroutine variant of updateVehicleStatus.
+     *
+     * @param vehicleSerial The unique serial number of the vehicle to update.
+     * @param status The new status to be set for the vehicle.
+     * @return A task that yields true once the server confirms the update.
+     */
+    Task<bool> updateVehicleStatusTask(std::string vehicleSerial, VehicleStatus status);
+
+   private:
+    CurlGlobal curlGlobal;                             ///< Keeps libcurl initialized, goes last.
+    std::string baseUrl;                               ///< The base URL for the API server.
+    RequestTemplates templates;                        ///< Endpoint URLs and header lists.
+    ClientMetrics requestMetrics;                      ///< Counters and latency histograms.
+    std::unique_ptr<ConnectionPool> connectionPool;    ///< Warm, reusable CURL handles.
+    std::unique_ptr<BatchBuffer> batchBuffer;          ///< Coalescing buffer, null if disabled.
+    std::unique_ptr<AggregationPipeline> aggregation;  ///< Edge reduction, null if disabled.
+    /// Encoding of sensor batch bodies, read once per batch.
+    std::atomic<WireFormat> wireFormat{WireFormat::JSON};
+    std::unique_ptr<BodyCompressor> compressor;        ///< Set before uploads, null if disabled.
+    std::unique_ptr<OfflineSpool> spool;               ///< Store-and-forward, null if disabled.
+    std::shared_ptr<RetryPolicy> retryPolicy;          ///< Timeouts, retries and circuit breaker.
+    mutable std::mutex retryPolicyMutex;               ///< Guards retryPolicy, not the policy.
+    std::unique_ptr<UploadPool> uploadPool;            ///< Async upload workers, null if disabled.
+    StatusCache statusCache;                           ///< Last known statuses and their ETags.
+    std::unique_ptr<AsyncTransport> asyncTransport;    ///< Event loop, started on first async call.
+    std::once_flag asyncTransportInit;                 ///< Guards lazy creation of asyncTransport.
+
+    /// Status event stream feeding statusCache, null if disabled.
+    std::unique_ptr<StatusSubscription> statusSubscription;
+
+    /// Prometheus scrape endpoint, null if disabled.
+    std::unique_ptr<MetricsEndpoint> metricsEndpoint;
+
+    /**
+     * @brief Sends a payload to a specified API endpoint.
      *
      * This function sends an HTTP POST request to the server with the
-     * provided endpoint and JSON payload. It captures and checks the
+     * provided endpoint and payload. It captures and checks the
      * response to ensure the request was successful.
      *
-     * @param endpoint The endpoint to send the request to (relative to baseUrl).
-     * @param jsonPayload The JSON data to be sent in the request body.
+     * @param endpoint The endpoint to send the request to.
+     * @param payload The encoded data to be sent in the request body.
+     * @param format The encoding of payload, selects the Content-Type header.
+     * @param transient If not null, set to whether a failure may succeed when retried.
      * @return True if the server confirms data was recorded successfully,
      *         false otherwise.
      */
-    bool sendRequest(const std::string& endpoint, const std::string& jsonPayload);
+    bool sendRequest(Endpoint endpoint, std::string_view payload,
+                     WireFormat format = WireFormat::JSON, bool* transient = nullptr);
+
+    /**
+     * @brief Sends a batch body that is encoded while it is uploaded.
+     *
+     * @param endpoint The endpoint to send the request to.
+     * @param body The body, rewound before every attempt.
+     * @param format The encoding of body, selects the Content-Type header.
+     * @param transient If not null, set to whether a failure may succeed when retried.
+     * @return True if the server confirms data was recorded successfully.
+     */
+    bool sendRequest(Endpoint endpoint, BatchBodyStream& body, WireFormat format,
+                     bool* transient = nullptr);
+
+    /**
+     * @brief Performs a record POST whose body setBody attaches to the handle.
+     *
+     * @param setBody Called with the handle and the request arena, returns the
+     *        headers the idempotency key is prepended to.
+     */
+    template <typename SetBody>
+    bool post(Endpoint endpoint, bool* transient, BatchBodyStream* body, SetBody setBody);
+
+    /**
+     * @brief POSTs a JSON body that is safe to send more than once.
+     *
+     * @param endpoint The endpoint to send the request to.
+     * @param payload The JSON body, compressed if compression is enabled.
+     * @param statusCode Receives the HTTP status code, 0 if no response was received.
+     * @param response Receives the response body.
+     * @return The CURL result of the last attempt.
+     */
+    CURLcode postIdempotent(Endpoint endpoint, std::string_view payload, long& statusCode,
+                            std::string& response);
+
+    /**
+     * @brief GETs a URL, retrying transient failures as the policy allows.
+     *
+     * @param url The absolute URL.
+     * @param statusCode Receives the HTTP status code, 0 if no response was received.
+     * @param response Receives the response body.
+     * @return The CURL result of the last attempt.
+     */
+    CURLcode fetch(const char* url, long& statusCode, std::string& response);
+
+    /**
+     * @brief Returns the current retry policy, which a request keeps for all its attempts.
+     */
+    std::shared_ptr<RetryPolicy> currentRetryPolicy() const;
+
+    /**
+     * @brief Performs a prepared request, retrying transient failures as the policy allows.
+     *
+     * @param policy The policy snapshot of this request.
+     * @param curl The configured easy handle.
+     * @param responseBuffer The handle's response buffer, cleared before every attempt.
+     * @param idempotent Whether the request may be sent more than once.
+     * @param statusCode Receives the HTTP status code of the last attempt, 0 if none.
+     * @param body The streamed body to rewind before every attempt, null if the
+     *        body is a plain buffer.
+     * @return The CURL result of the last attempt, CURLE_COULDNT_CONNECT if the
+     *         circuit breaker refused to send it.
+     */
+    CURLcode perform(RetryPolicy& policy, CURL* curl, std::string& responseBuffer, bool idempotent,
+                     long& statusCode, BatchBodyStream* body = nullptr);
+
+    /**
+     * @brief Turns a status response into getVehicleStatus's result and updates the cache.
+     *
+     * @param vehicleSerial The vehicle that was queried.
+     * @param revalidated The cached entry sent as If-None-Match, null if none was sent.
+     * @param token The cache's beginRequest() value from before the request.
+     * @param statusCode The HTTP status code of the response.
+     * @param body The raw response body.
+     * @param etag The response's ETag header, empty if absent.
+     */
+    std::pair<bool, std::string> readStatusResponse(const std::string& vehicleSerial,
+                                                    const StatusCache::Entry* revalidated,
+                                                    std::uint64_t token, long statusCode,
+                                                    std::string_view body, std::string_view etag);
+
+    /**
+     * @brief Compresses a body if compression is enabled and returns its prebuilt headers.
+     *
+     * @param format The encoding of payload, selects the Content-Type header.
+     * @param payload The body; replaced by the compressed body if it was compressed.
+     */
+    curl_slist* bodyHeaders(WireFormat format, std::string_view& payload) const;
+
+    /**
+     * @brief Returns the calling upload worker's own connections, or the shared pool.
+     */
+    ConnectionPool& connections();
+
+    /**
+     * @brief Returns whether a reading can be recorded, counting it as invalid if not.
+     */
+    bool isUploadable(const SensorReading& reading);
+
+    /**
+     * @brief Returns the readings that can be recorded.
+     *
+     * @param readings The readings to check.
+     * @param scratch Receives the finite readings if any had to be left out.
+     * @return readings itself if all are finite, else a view of scratch.
+     */
+    std::span<const SensorReading> uploadableReadings(std::span<const SensorReading> readings,
+                                                      std::vector<SensorReading>& scratch);
+
+    /**
+     * @brief Hands readings ready for upload to the coalescing buffer, or sends them.
+     */
+    bool forwardReadings(std::span<const SensorReading> readings, const std::string& vehicleSerial);
+
+    /**
+     * @brief Sends a single reading right away and spools it on a transient failure.
+     */
+    bool sendSensorData(const SensorReading& reading, const std::string& vehicleSerial);
+
+    /**
+     * @brief Sends a batch without spooling it, classifying the outcome for the spool.
+     */
+    Delivery deliverBatch(std::span<const SensorReading> readings,
+                          const std::string& vehicleSerial);
+
+    /**
+     * @brief Sends readings split over several spans as one batch, see above.
+     *
+     * Batches of kStreamedBatchReadings or more are streamed from the spans
+     * unless compression or the columnar format needs the whole body up front.
+     */
+    Delivery deliverBatch(std::span<const std::span<const SensorReading>> pieces,
+                          const std::string& vehicleSerial);
+
+    /**
+     * @brief Sends a batch and spools it on a transient failure; backs addSensorDataBatch.
+     */
+    Delivery uploadBatch(std::span<const SensorReading> readings, const std::string& vehicleSerial);
+
+    /**
+     * @brief Appends readings to the spool, if enabled, after a transient failure.
+     */
+    void spoolReadings(std::span<const SensorReading> readings, const std::string& vehicleSerial);
+
+    /**
+     * @brief Queues a POST on the async transport.
+     *
+     * @param endpoint The endpoint to send the request to.
+     * @param payload The encoded data to be sent in the request body.
+     * @param printContent Whether to print the server's confirmation message.
+     * @param done Receives DELIVERED once the server confirms the request, RETRY
+     *        after a transient failure and REJECTED otherwise.
+     * @param format The encoding of payload, selects the Content-Type header.
+     * @param onTransientFailure Invoked on the event loop thread before done if the
+     *        request failed transiently.
+     * @param idempotent Whether the request may be resent as is. Other requests are
+     *        tagged with an Idempotency-Key if the retry policy asks for it.
+     */
+    void postAsync(Endpoint endpoint, std::string_view payload, bool printContent,
+                   Completion<Delivery> done, WireFormat format = WireFormat::JSON,
+                   std::function<void()> onTransientFailure = {}, bool idempotent = false);
+
+    /**
+     * @brief Starts the async upload of a reading; backs addSensorDataAsync and addSensorDataTask.
+     */
+    void submitSensorData(const SensorReading& reading, const std::string& vehicleSerial,
+                          Completion<bool> done);
+
+    /**
+     * @brief Starts the async upload of a batch; backs the *Async and *Task batch variants.
+     */
+    void submitSensorDataBatch(std::span<const SensorReading> readings,
+                               const std::string& vehicleSerial, Completion<UploadFeedback> done);
+
+    /**
+     * @brief Starts an async status query; backs getVehicleStatusAsync and getVehicleStatusTask.
+     */
+    void submitStatusQuery(const std::string& vehicleSerial,
+                           Completion<std::pair<bool, std::string>> done);
+
+    /**
+     * @brief Starts an async status update; backs the *Async and *Task update variants.
+     */
+    void submitStatusUpdate(const std::string& vehicleSerial, VehicleStatus status,
+                            Completion<bool> done);
+
+    /**
+     * @brief Returns the async transport, starting its event loop on first use.
+     */
+    AsyncTransport& transport();
+
+    /**
+     * @brief Returns the calling thread's reusable payload serializer.
+     */
+    static PayloadSerializer& serializer();
 };
 
 #endif  // VEHICLE_CLIENT_HPP
@@ -0,0 +1,204 @@
+#ifndef VEHICLE_GATEWAY_HPP
+#define VEHICLE_GATEWAY_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "DataTypes.hpp"
+#include "FlushScheduler.hpp"
+#include "RingBuffer.hpp"
+#include "SerialRegistry.hpp"
+
+class VehicleClient;
+
+/**
+ * @struct GatewayConfig
+ * @brief Sharding, queue and scheduling settings of a VehicleGateway.
+ */
+struct GatewayConfig
+{
+    std::size_t workerThreads = 0;                                ///< Shards, 0 for one per core.
+    std::size_t queueCapacity = 65536;                            ///< Queue slots per shard.
+    OverflowPolicy overflowPolicy = OverflowPolicy::DROP_OLDEST;  ///< When a queue is full.
+    std::size_t maxBatchReadings = 256;                           ///< Readings per request.
+    std::chrono::milliseconds linger{200};                        ///< Max wait to fill a batch.
+    std::size_t maxInFlightPerWorker = 16;                        ///< Concurrent uploads per shard.
+    bool adaptive = false;                                        ///< Tune the three above.
+    FlushSchedulerConfig adaptiveLimits;                          ///< Bounds of the tuning.
+};
+
+/**
+ * @class VehicleGateway
+ * @brief Uploads the telemetry of many vehicles from one process.
+ *
+ * Vehicle serials are interned into compact VehicleIds, and every vehicle is
+ * owned by one of several worker shards (id modulo the number of workers).
+ * Producers push readings into the owning shard's lock-free RingBuffer; the
+ * shard's worker thread coalesces them into per-vehicle batches and uploads
+ * them through the shared VehicleClient's async API, so all vehicles share one
+ * connection pool and event loop.
+ *
+ * Uploads are scheduled round-robin: a vehicle with a full or lingering batch
+ * joins the back of its shard's ready queue and sends at most one batch per
+ * turn, so a chatty vehicle cannot starve quiet ones, and each shard keeps at
+ * most maxInFlightPerWorker requests outstanding.
+ *
+ * With adaptive set, each shard tunes its batch size, linger time and in-flight
+ * limit with a FlushScheduler from the latency and outcome of its uploads and
+ * its backlog, so one configuration saturates a fast depot link and backs off a
+ * slow or overloaded server.
+ */
+class VehicleGateway
+{
+   public:
+    /**
+     * @brief Creates the shards and starts their worker threads.
+     *
+     * @param client The client used for uploads. It must outlive the gateway.
+     * @param config Sharding, queue and scheduling settings.
+     */
+    explicit VehicleGateway(VehicleClient& client, const GatewayConfig& config = {});
+
+    /**
+     * @brief Stops the workers after uploading everything still queued or buffered.
+     *
+     * Without a deadline this waits as long as the uploads take. After
+     * VehicleClient::abortRequestsAt, uploads still unfinished at the deadline
+     * fail at once and go to the client's spool, so the drain ends by then.
+     */
+    ~VehicleGateway();
+
+    VehicleGateway(const VehicleGateway&) = delete;
+    VehicleGateway& operator=(const VehicleGateway&) = delete;
+
+    /**
+     * @brief Returns the id of a vehicle, registering the serial if it is new.
+     */
+    VehicleId registerVehicle(std::string_view vehicleSerial)
+    {
+        return registry.intern(vehicleSerial);
+    }
+
+    /**
+     * @brief Returns the serial of a registered vehicle.
+     */
+    const std::string& vehicleSerial(VehicleId vehicle) const
+    {
+        return registry.serial(vehicle);
+    }
+
+    /**
+     * @brief Queues a reading of a registered vehicle. Safe to call from any thread.
+     *
+     * @param vehicle The id returned by registerVehicle.
+     * @param reading The sensor reading, stamped with its capture time.
+     * @return False if the id is unknown or the reading was rejected by DROP_NEWEST.
+     */
+    bool push(VehicleId vehicle, const SensorReading& reading);
+
+    /**
+     * @brief Queues a reading captured now. Safe to call from any thread.
+     *
+     * @param vehicle The id returned by registerVehicle.
+     * @param sensorType The type of sensor that produced the reading.
+     * @param value The sensor's data reading.
+     * @return False if the id is unknown or the reading was rejected by DROP_NEWEST.
+     */
+    bool push(VehicleId vehicle, SensorType sensorType, float value);
+
+    /**
+     * @brief Returns the number of registered vehicles.
+     */
+    std::size_t vehicles() const
+    {
+        return registry.size();
+    }
+
+    /**
+     * @brief Returns the number of worker shards.
+     */
+    std::size_t workers() const
+    {
+        return shards.size();
+    }
+
+    /**
+     * @brief Returns the batch size, linger time and in-flight limit a shard uses now.
+     */
+    FlushSchedule schedule(std::size_t worker) const
+    {
+        return shards[worker]->scheduler.current();
+    }
+
+    /**
+     * @brief Returns how often the shards saw congestion and backed off.
+     */
+    std::uint64_t congestionEvents() const;
+
+    /**
+     * @brief Returns how many readings were lost because a shard queue was full.
+     */
+    std::uint64_t dropped() const;
+
+    /**
+     * @brief Returns how many readings the server confirmed.
+     */
+    std::uint64_t uploaded() const
+    {
+        return uploadedCount.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns how many readings were lost (or spooled) because their upload failed.
+     */
+    std::uint64_t failed() const
+    {
+        return failedCount.load(std::memory_order_relaxed);
+    }
+
+   private:
+    /// A reading tagged with its vehicle, the record type of the shard queues.
+    struct Record
+    {
+        VehicleId vehicle;
+        SensorReading reading;
+    };
+
+    /// A worker thread, the queue feeding it and the limits it uploads under.
+    struct Shard
+    {
+        Shard(const GatewayConfig& config, const FlushSchedulerConfig& limits)
+            : queue(config.queueCapacity, config.overflowPolicy),
+              scheduler(limits,
+                        {config.maxBatchReadings, config.linger, config.maxInFlightPerWorker})
+        {
+        }
+
+        RingBuffer<Record> queue;
+        FlushScheduler scheduler;  ///< Only changed by the worker.
+        std::thread worker;
+    };
+
+    VehicleClient& client;
+    GatewayConfig config;
+    SerialRegistry registry;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    std::atomic<bool> running{true};
+    std::atomic<std::uint64_t> uploadedCount{0};
+    std::atomic<std::uint64_t> failedCount{0};
+
+    /**
+     * @brief Worker loop: drains the shard queue, batches per vehicle and schedules uploads.
+     */
+    void run(Shard& shard);
+};
+
+#endif  // VEHICLE_GATEWAY_HPP
@@ -0,0 +1,142 @@
+#ifndef WORK_STEALING_DEQUE_HPP
+#define WORK_STEALING_DEQUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+/**
+ * @class WorkStealingDeque
+ * @brief Bounded lock-free Chase-Lev deque with one owner and many thieves.
+ *
+ * The owning thread pushes and pops at the bottom (LIFO, which keeps recently
+ * queued work hot in its cache); any other thread steals from the top (FIFO).
+ * Owner operations only contend with thieves when a single item is left. The
+ * memory orderings follow Lê et al., "Correct and Efficient Work-Stealing for
+ * Weak Memory Models" (PPoPP 2013). The capacity is fixed at construction.
+ *
+ * @tparam T A trivially copyable item type, typically a pointer.
+ */
+template <typename T>
+class WorkStealingDeque
+{
+    static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque stores raw items");
+
+   public:
+    /**
+     * @brief Constructs a deque with room for at least @p capacity items.
+     *
+     * @param capacity Requested capacity, rounded up to the next power of two.
+     */
+    explicit WorkStealingDeque(std::size_t capacity)
+        : mask(roundUpToPowerOfTwo(capacity) - 1),
+          cells(std::make_unique<std::atomic<T>[]>(mask + 1))
+    {
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    /**
+     * @brief Pushes an item at the bottom. Owner thread only.
+     *
+     * @return False if the deque is full.
+     */
+    bool push(T item)
+    {
+        std::int64_t b = bottom.load(std::memory_order_relaxed);
+        std::int64_t t = top.load(std::memory_order_acquire);
+        if (b - t > static_cast<std::int64_t>(mask))
+        {
+            return false;
+        }
+        cells[b & mask].store(item, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Pops the most recently pushed item. Owner thread only.
+     *
+     * @param item Receives the item.
+     * @return False if the deque was empty or a thief took the last item.
+     */
+    bool pop(T& item)
+    {
+        std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        item = cells[b & mask].load(std::memory_order_relaxed);
+        if (t == b)
+        {
+            // Last item: race the thieves for it
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                   std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Steals the oldest item. Safe to call from any thread.
+     *
+     * @param item Receives the item.
+     * @return False if the deque was empty or another thread won the race.
+     */
+    bool steal(T& item)
+    {
+        std::int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b)
+        {
+            return false;
+        }
+
+        item = cells[t & mask].load(std::memory_order_relaxed);
+        return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                           std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns an approximation of the number of queued items.
+     */
+    std::size_t size() const
+    {
+        std::int64_t b = bottom.load(std::memory_order_relaxed);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<std::size_t>(b - t) : 0;
+    }
+
+   private:
+    static std::size_t roundUpToPowerOfTwo(std::size_t value)
+    {
+        std::size_t result = 2;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    // Thieves hammer top while the owner works on bottom, so they live on separate cache lines
+    alignas(64) std::atomic<std::int64_t> top{0};
+    alignas(64) std::atomic<std::int64_t> bottom{0};
+
+    const std::size_t mask;
+    std::unique_ptr<std::atomic<T>[]> cells;
+};
+
+#endif  // WORK_STEALING_DEQUE_HPP
@@ -0,0 +1,261 @@
+#include "AggregationPipeline.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "SimdKernels.hpp"
+
+namespace
+{
+std::size_t sensorIndex(SensorType sensorType)
+{
+    return static_cast<std::size_t>(sensorType);
+}
+
+}  // unnamed namespace
+
+AggregationPipeline::AggregationPipeline(const AggregationConfig& config)
+    : defaultPolicy(config.defaultPolicy), maxWindowAge(config.maxWindowAge)
+{
+    auto sanitize = [](AggregationPolicy policy)
+    {
+        policy.windowSize = std::max<std::size_t>(policy.windowSize, 1);
+        policy.outputPoints = std::max<std::size_t>(policy.outputPoints, 3);
+        return policy;
+    };
+
+    defaultPolicy = sanitize(defaultPolicy);
+    for (const auto& [sensorType, policy] : config.policies)
+    {
+        std::size_t index = sensorIndex(sensorType);
+        if (index >= policies.size())
+        {
+            policies.resize(index + 1, defaultPolicy);
+        }
+        policies[index] = sanitize(policy);
+    }
+}
+
+void AggregationPipeline::process(const std::string& vehicleSerial, const SensorReading& reading,
+                                  std::vector<SensorReading>& ready)
+{
+    const AggregationPolicy& policy = policyFor(reading.sensorType);
+    if (policy.mode == AggregationMode::RAW)
+    {
+        ready.push_back(reading);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    VehicleWindows& windows = vehicles[vehicleSerial];
+    std::size_t index = sensorIndex(reading.sensorType);
+    if (index >= windows.size())
+    {
+        windows.resize(index + 1);
+    }
+    SensorWindow& window = windows[index];
+
+    if (policy.mode == AggregationMode::DEADBAND)
+    {
+        // Written so that NaN readings pass and the stream recovers after them
+        if (!window.sentAny || !(std::fabs(reading.value - window.lastSent) <= policy.deadband))
+        {
+            window.lastSent = reading.value;
+            window.sentAny = true;
+            ready.push_back(reading);
+        }
+        return;
+    }
+
+    if (window.values.empty())
+    {
+        window.opened = std::chrono::steady_clock::now();
+        window.values.reserve(policy.windowSize);
+        window.timestamps.reserve(policy.windowSize);
+    }
+    window.values.push_back(reading.value);
+    window.timestamps.push_back(reading.timestampUs);
+    if (window.values.size() >= policy.windowSize)
+    {
+        closeWindow(reading.sensorType, window, ready);
+    }
+}
+
+std::vector<AggregationPipeline::Batch> AggregationPipeline::takeDue(bool force)
+{
+    std::vector<Batch> due;
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& [serial, windows] : vehicles)
+    {
+        std::vector<SensorReading> readings;
+        for (std::size_t index = 0; index < windows.size(); ++index)
+        {
+            SensorWindow& window = windows[index];
+            if (!window.values.empty() && (force || window.opened + maxWindowAge <= now))
+            {
+                closeWindow(static_cast<SensorType>(index), window, readings);
+            }
+        }
+        if (!readings.empty())
+        {
+            due.emplace_back(serial, std::move(readings));
+        }
+    }
+    return due;
+}
+
+WindowStats AggregationPipeline::summarize(std::span<const float> values)
+{
+    WindowStats stats;
+    stats.count = values.size();
+    if (values.empty())
+    {
+        return stats;
+    }
+
+    MinMaxSum reduced = minMaxSum(values);
+    stats.min = reduced.min;
+    stats.max = reduced.max;
+    stats.mean = static_cast<float>(reduced.sum / static_cast<double>(values.size()));
+    return stats;
+}
+
+void AggregationPipeline::downsample(std::span<const std::uint64_t> timestamps,
+                                     std::span<const float> values, std::size_t points,
+                                     std::vector<std::size_t>& keep)
+{
+    const std::size_t count = values.size();
+    keep.clear();
+    if (points < 3 || points >= count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            keep.push_back(i);
+        }
+        return;
+    }
+
+    // Times relative to the first point keep the triangle areas precise
+    auto x = [&timestamps](std::size_t i)
+    { return static_cast<double>(timestamps[i] - timestamps[0]); };
+
+    const double bucketSize = static_cast<double>(count - 2) / static_cast<double>(points - 2);
+    std::size_t selected = 0;
+    keep.push_back(0);
+
+    for (std::size_t bucket = 0; bucket + 2 < points; ++bucket)
+    {
+        std::size_t start = static_cast<std::size_t>(bucket * bucketSize) + 1;
+        std::size_t end = static_cast<std::size_t>((bucket + 1) * bucketSize) + 1;
+        std::size_t nextEnd =
+            std::min(static_cast<std::size_t>((bucket + 2) * bucketSize) + 1, count);
+
+        // The third corner of every triangle is the mean of the following bucket
+        double nextX = 0.0;
+        double nextY = 0.0;
+        for (std::size_t i = end; i < nextEnd; ++i)
+        {
+            nextX += x(i);
+            nextY += values[i];
+        }
+        nextX /= static_cast<double>(nextEnd - end);
+        nextY /= static_cast<double>(nextEnd - end);
+
+        const double ax = x(selected);
+        const double ay = values[selected];
+        double largestArea = -1.0;
+        std::size_t largest = start;
+        for (std::size_t i = start; i < end; ++i)
+        {
+            double area = std::fabs((ax - nextX) * (values[i] - ay) - (ax - x(i)) * (nextY - ay));
+            if (area > largestArea)
+            {
+                largestArea = area;
+                largest = i;
+            }
+        }
+        keep.push_back(largest);
+        selected = largest;
+    }
+    keep.push_back(count - 1);
+}
+
+const AggregationPolicy& AggregationPipeline::policyFor(SensorType sensorType) const
+{
+    std::size_t index = sensorIndex(sensorType);
+    return index < policies.size() ? policies[index] : defaultPolicy;
+}
+
+void AggregationPipeline::closeWindow(SensorType sensorType, SensorWindow& window,
+                                      std::vector<SensorReading>& out)
+{
+    const AggregationPolicy& policy = policyFor(sensorType);
+
+    // A NaN would poison the mean and the min/max search, and the server rejects it anyway
+    std::size_t finite = 0;
+    for (std::size_t i = 0; i < window.values.size(); ++i)
+    {
+        if (std::isfinite(window.values[i]))
+        {
+            window.values[finite] = window.values[i];
+            window.timestamps[finite] = window.timestamps[i];
+            ++finite;
+        }
+    }
+    window.values.resize(finite);
+    window.timestamps.resize(finite);
+    if (finite == 0)
+    {
+        return;
+    }
+
+    const std::vector<float>& values = window.values;
+    const std::vector<std::uint64_t>& timestamps = window.timestamps;
+    switch (policy.mode)
+    {
+        case AggregationMode::WINDOW_MEAN:
+        {
+            WindowStats stats = summarize(values);
+            std::uint64_t offsets = 0;
+            for (std::uint64_t timestamp : timestamps)
+            {
+                offsets += timestamp - timestamps.front();
+            }
+            out.push_back({sensorType, stats.mean, timestamps.front() + offsets / stats.count});
+            break;
+        }
+        case AggregationMode::WINDOW_MIN_MAX:
+        {
+            WindowStats stats = summarize(values);
+            auto minIndex = std::find(values.begin(), values.end(), stats.min) - values.begin();
+            auto maxIndex = std::find(values.begin(), values.end(), stats.max) - values.begin();
+            std::size_t first = static_cast<std::size_t>(std::min(minIndex, maxIndex));
+            std::size_t second = static_cast<std::size_t>(std::max(minIndex, maxIndex));
+            out.push_back({sensorType, values[first], timestamps[first]});
+            if (second != first && second < values.size())
+            {
+                out.push_back({sensorType, values[second], timestamps[second]});
+            }
+            break;
+        }
+        case AggregationMode::LTTB:
+        {
+            // A partial window keeps the same share of its points as a full one
+            std::size_t share = policy.outputPoints * values.size() + policy.windowSize - 1;
+            std::size_t points = std::max<std::size_t>(3, share / policy.windowSize);
+            downsample(timestamps, values, points, keepScratch);
+            for (std::size_t index : keepScratch)
+            {
+                out.push_back({sensorType, values[index], timestamps[index]});
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    window.values.clear();
+    window.timestamps.clear();
+}
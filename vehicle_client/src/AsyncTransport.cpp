@@ -0,0 +1,319 @@
+#include "AsyncTransport.hpp"
+
+#include <algorithm>
+
+#include "ResponseClassifier.hpp"
+
+namespace
+{
+// Function to handle CURL write callback
+size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp)
+{
+    ((std::string*)userp)->append((char*)contents, size * nmemb);
+    return size * nmemb;
+}
+
+// Upper bound for a single curl_multi_poll wait; submissions wake the loop earlier
+constexpr std::chrono::milliseconds kPollTimeout{1000};
+
+}  // unnamed namespace
+
+AsyncTransport::AsyncTransport(ConnectionPool& pool, ClientMetrics& metrics)
+    : pool(pool), metrics(metrics), multi(curl_multi_init())
+{
+    loopThread = std::thread(&AsyncTransport::run, this);
+}
+
+AsyncTransport::~AsyncTransport()
+{
+    {
+        std::lock_guard<std::mutex> lock(submitMutex);
+        stopping = true;
+    }
+    if (multi)
+    {
+        curl_multi_wakeup(multi);
+    }
+    loopThread.join();
+
+    if (multi)
+    {
+        curl_multi_cleanup(multi);
+    }
+}
+
+void AsyncTransport::submit(HttpRequest request, Callback callback)
+{
+    auto transfer = std::make_unique<Transfer>(Transfer{pool.acquire(), std::move(request),
+                                                        std::move(callback)});
+    {
+        std::lock_guard<std::mutex> lock(submitMutex);
+        if (!stopping && multi && transfer->handle)
+        {
+            metrics.asyncSubmitted();
+            submitted.push_back(std::move(transfer));
+        }
+    }
+
+    if (transfer)
+    {
+        // Not queued: shutting down or no handle available
+        transfer->response.curlCode = CURLE_FAILED_INIT;
+        metrics.recordRequest(false);
+        transfer->callback(transfer->response);
+        return;
+    }
+    curl_multi_wakeup(multi);
+}
+
+void AsyncTransport::abortAt(std::chrono::steady_clock::time_point abortDeadline)
+{
+    {
+        std::lock_guard<std::mutex> lock(submitMutex);
+        deadline = abortDeadline;
+    }
+    if (multi)
+    {
+        curl_multi_wakeup(multi);
+    }
+}
+
+void AsyncTransport::run()
+{
+    if (!multi)
+    {
+        return;
+    }
+
+    std::vector<std::unique_ptr<Transfer>> incoming;
+    int inFlight = 0;
+
+    while (true)
+    {
+        bool shuttingDown;
+        std::chrono::steady_clock::time_point abortDeadline;
+        {
+            std::lock_guard<std::mutex> lock(submitMutex);
+            incoming.swap(submitted);
+            shuttingDown = stopping;
+            abortDeadline = deadline;
+        }
+        auto now = std::chrono::steady_clock::now();
+        bool expired = now >= abortDeadline;
+
+        for (auto& transfer : incoming)
+        {
+            if (expired)
+            {
+                transfer->response.curlCode = CURLE_OPERATION_TIMEDOUT;
+                complete(*transfer);
+                continue;
+            }
+            start(std::move(transfer));
+        }
+        incoming.clear();
+        if (expired)
+        {
+            abortRunning();
+        }
+
+        curl_multi_perform(multi, &inFlight);
+
+        int messagesLeft = 0;
+        while (CURLMsg* message = curl_multi_info_read(multi, &messagesLeft))
+        {
+            if (message->msg == CURLMSG_DONE)
+            {
+                finish(message->easy_handle, message->data.result);
+            }
+        }
+
+        std::chrono::milliseconds pollTimeout = startDueRetries(shuttingDown || expired);
+        if (!expired && abortDeadline != std::chrono::steady_clock::time_point::max())
+        {
+            auto untilDeadline = std::chrono::ceil<std::chrono::milliseconds>(abortDeadline - now);
+            pollTimeout = std::min(pollTimeout, untilDeadline);
+        }
+
+        // Drain everything already accepted before leaving the loop
+        if (shuttingDown && inFlight == 0 && backingOff.empty())
+        {
+            std::lock_guard<std::mutex> lock(submitMutex);
+            if (submitted.empty())
+            {
+                break;
+            }
+            continue;
+        }
+
+        curl_multi_poll(multi, nullptr, 0, static_cast<int>(pollTimeout.count()), nullptr);
+    }
+}
+
+std::chrono::milliseconds AsyncTransport::startDueRetries(bool shuttingDown)
+{
+    std::chrono::milliseconds pollTimeout = kPollTimeout;
+    if (backingOff.empty())
+    {
+        return pollTimeout;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    std::vector<std::unique_ptr<Transfer>> waiting;
+    waiting.swap(backingOff);
+    for (auto& transfer : waiting)
+    {
+        if (shuttingDown)
+        {
+            // The body of the last failed attempt is still in the handle's buffer
+            complete(*transfer);
+        }
+        else if (transfer->retryAt <= now)
+        {
+            start(std::move(transfer));
+        }
+        else
+        {
+            pollTimeout = std::min(pollTimeout, std::chrono::ceil<std::chrono::milliseconds>(
+                                                    transfer->retryAt - now));
+            backingOff.push_back(std::move(transfer));
+        }
+    }
+
+    // Retries started above need a perform call before the loop may sleep
+    return backingOff.size() < waiting.size() && !shuttingDown ? std::chrono::milliseconds(0)
+                                                                : pollTimeout;
+}
+
+void AsyncTransport::start(std::unique_ptr<Transfer> transfer)
+{
+    CURL* curl = transfer->handle.get();
+    const HttpRequest& request = transfer->request;
+
+    transfer->response = HttpResponse{};
+    if (request.retryPolicy && !request.retryPolicy->breaker().allowRequest())
+    {
+        transfer->response.curlCode = CURLE_COULDNT_CONNECT;
+        metrics.add(MetricCounter::BREAKER_REJECTIONS);
+        complete(*transfer);
+        return;
+    }
+    transfer->handle.responseBuffer().clear();
+    ++transfer->attempts;
+
+    // The extra headers are linked in front of the shared list instead of copying both per attempt
+    curl_slist* headers = request.sharedHeaders;
+    transfer->headerNodes.resize(request.headers.size());
+    for (std::size_t i = request.headers.size(); i-- > 0;)
+    {
+        transfer->headerNodes[i] = {const_cast<char*>(request.headers[i].c_str()), headers};
+        headers = &transfer->headerNodes[i];
+    }
+
+    curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+    if (request.post)
+    {
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(request.body.size()));
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request.body.c_str());
+    }
+    else
+    {
+        curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+    }
+    if (headers)
+    {
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    }
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer->handle.responseBuffer());
+
+    // Ownership moves to the multi handle until the transfer completes
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, transfer.get());
+    if (curl_multi_add_handle(multi, curl) != CURLM_OK)
+    {
+        // The breaker let the request through, so it must hear back or a probe slot leaks
+        if (request.retryPolicy)
+        {
+            request.retryPolicy->breaker().recordFailure();
+        }
+        transfer->response.curlCode = CURLE_FAILED_INIT;
+        complete(*transfer);
+        return;
+    }
+    running.push_back(transfer.release());
+}
+
+void AsyncTransport::finish(CURL* curl, CURLcode result)
+{
+    Transfer* rawTransfer = nullptr;
+    curl_easy_getinfo(curl, CURLINFO_PRIVATE, &rawTransfer);
+    std::unique_ptr<Transfer> transfer(rawTransfer);
+    running.erase(std::find(running.begin(), running.end(), rawTransfer));
+
+    curl_multi_remove_handle(multi, curl);
+    metrics.recordAttempt(curl);
+
+    transfer->response.curlCode = result;
+    curl_off_t retryAfter = 0;
+    if (result == CURLE_OK)
+    {
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &transfer->response.statusCode);
+        curl_easy_getinfo(curl, CURLINFO_RETRY_AFTER, &retryAfter);
+        transfer->response.body = transfer->handle.responseBuffer();
+        struct curl_header* etag = nullptr;
+        if (curl_easy_header(curl, "ETag", 0, CURLH_HEADER, -1, &etag) == CURLHE_OK)
+        {
+            transfer->response.etag = etag->value;
+        }
+    }
+
+    if (const std::shared_ptr<RetryPolicy>& policy = transfer->request.retryPolicy)
+    {
+        if (result != CURLE_OK || isTransientHttpStatus(transfer->response.statusCode))
+        {
+            policy->breaker().recordFailure();
+            std::chrono::milliseconds delay;
+            if (policy->retryDelay(transfer->attempts, transfer->request.idempotent,
+                                   std::chrono::seconds(retryAfter), delay))
+            {
+                // The handle stays leased while backing off, the loop restarts it when due
+                transfer->retryAt = std::chrono::steady_clock::now() + delay;
+                metrics.add(MetricCounter::RETRIES);
+                backingOff.push_back(std::move(transfer));
+                return;
+            }
+        }
+        else
+        {
+            policy->breaker().recordSuccess();
+        }
+    }
+
+    // The handle returns to the pool once the transfer object is destroyed
+    complete(*transfer);
+}
+
+void AsyncTransport::abortRunning()
+{
+    for (Transfer* rawTransfer : running)
+    {
+        std::unique_ptr<Transfer> transfer(rawTransfer);
+        curl_multi_remove_handle(multi, transfer->handle.get());
+        if (transfer->request.retryPolicy)
+        {
+            transfer->request.retryPolicy->breaker().recordFailure();
+        }
+        transfer->response = HttpResponse{};
+        transfer->response.curlCode = CURLE_OPERATION_TIMEDOUT;
+        complete(*transfer);
+    }
+    running.clear();
+}
+
+void AsyncTransport::complete(Transfer& transfer)
+{
+    const HttpResponse& response = transfer.response;
+    metrics.recordRequest(response.curlCode == CURLE_OK && isHttpSuccess(response.statusCode));
+    metrics.asyncCompleted();
+    transfer.callback(response);
+}
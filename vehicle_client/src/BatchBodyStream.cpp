@@ -0,0 +1,105 @@
+#include "BatchBodyStream.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+BatchBodyStream::BatchBodyStream(std::span<const std::span<const SensorReading>> pieces,
+                                 std::string_view vehicleSerial, WireFormat format,
+                                 PayloadSerializer& serializer)
+    : pieces(pieces), vehicleSerial(vehicleSerial), format(format), serializer(serializer)
+{
+    for (std::span<const SensorReading> readings : pieces)
+    {
+        count += readings.size();
+    }
+}
+
+void BatchBodyStream::attach(CURL* curl)
+{
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    // An unknown size makes libcurl send the body chunked over HTTP/1.1
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(-1));
+    curl_easy_setopt(curl, CURLOPT_READFUNCTION, &BatchBodyStream::read);
+    curl_easy_setopt(curl, CURLOPT_READDATA, this);
+    curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, &BatchBodyStream::seek);
+    curl_easy_setopt(curl, CURLOPT_SEEKDATA, this);
+}
+
+void BatchBodyStream::rewind()
+{
+    stage = Stage::HEAD;
+    piece = 0;
+    offset = 0;
+    pending = {};
+}
+
+bool BatchBodyStream::encodeNext()
+{
+    switch (stage)
+    {
+        case Stage::HEAD:
+            pending = serializer.batchHead(vehicleSerial, count, format);
+            stage = Stage::READINGS;
+            return true;
+
+        case Stage::READINGS:
+        {
+            while (piece < pieces.size() && offset == pieces[piece].size())
+            {
+                ++piece;
+                offset = 0;
+            }
+            if (piece == pieces.size())
+            {
+                pending = serializer.batchTail(format);
+                stage = Stage::TAIL;
+                return true;
+            }
+            std::span<const SensorReading> readings = pieces[piece];
+            std::size_t slice = std::min(kSliceReadings, readings.size() - offset);
+            bool first = piece == 0 && offset == 0;
+            pending = serializer.batchReadings(readings.subspan(offset, slice), first, format);
+            offset += slice;
+            return true;
+        }
+
+        case Stage::TAIL:
+        case Stage::DONE:
+        default:
+            stage = Stage::DONE;
+            return false;
+    }
+}
+
+std::size_t BatchBodyStream::read(char* buffer, std::size_t size, std::size_t items,
+                                  void* userdata)
+{
+    auto* stream = static_cast<BatchBodyStream*>(userdata);
+    std::size_t capacity = size * items;
+    std::size_t written = 0;
+    while (written < capacity)
+    {
+        if (stream->pending.empty() && !stream->encodeNext())
+        {
+            break;
+        }
+        std::size_t bytes = std::min(capacity - written, stream->pending.size());
+        std::memcpy(buffer + written, stream->pending.data(), bytes);
+        stream->pending.remove_prefix(bytes);
+        written += bytes;
+    }
+    // 0 tells libcurl the body is complete
+    return written;
+}
+
+int BatchBodyStream::seek(void* userdata, curl_off_t offset, int origin)
+{
+    // Resending from the start is all libcurl needs; encoding cannot jump elsewhere
+    if (offset != 0 || origin != SEEK_SET)
+    {
+        return CURL_SEEKFUNC_CANTSEEK;
+    }
+    static_cast<BatchBodyStream*>(userdata)->rewind();
+    return CURL_SEEKFUNC_OK;
+}
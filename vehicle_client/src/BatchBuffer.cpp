@@ -0,0 +1,83 @@
+#include "BatchBuffer.hpp"
+
+namespace
+{
+// Rough size of one encoded reading in the JSON batch body
+constexpr std::size_t kEstimatedReadingBytes = 96;
+
+// Rough size of the batch envelope, excluding the vehicle serial
+constexpr std::size_t kEstimatedEnvelopeBytes = 40;
+
+}  // unnamed namespace
+
+BatchBuffer::BatchBuffer(const BatchConfig& config) : batchConfig(config)
+{
+}
+
+bool BatchBuffer::add(const std::string& vehicleSerial, const SensorReading& reading)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    PendingBatch& batch = pending[vehicleSerial];
+
+    if (batch.readings.empty())
+    {
+        batch.readings.reserve(batchConfig.maxReadings);
+        batch.estimatedBytes = kEstimatedEnvelopeBytes + vehicleSerial.size();
+        batch.firstAdded = std::chrono::steady_clock::now();
+    }
+
+    batch.readings.push_back(reading);
+    batch.estimatedBytes += kEstimatedReadingBytes;
+
+    return batch.readings.size() >= batchConfig.maxReadings ||
+           batch.estimatedBytes >= batchConfig.maxBytes;
+}
+
+std::vector<SensorReading> BatchBuffer::take(const std::string& vehicleSerial)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = pending.find(vehicleSerial);
+    if (it == pending.end())
+    {
+        return {};
+    }
+
+    std::vector<SensorReading> readings = std::move(it->second.readings);
+    pending.erase(it);
+    return readings;
+}
+
+std::vector<BatchBuffer::Batch> BatchBuffer::takeDue(bool force)
+{
+    std::vector<Batch> due;
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = pending.begin(); it != pending.end();)
+    {
+        PendingBatch& batch = it->second;
+        bool expired = now - batch.firstAdded >= batchConfig.maxAge;
+
+        if (!batch.readings.empty() && (force || expired))
+        {
+            due.emplace_back(it->first, std::move(batch.readings));
+            it = pending.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    return due;
+}
+
+std::size_t BatchBuffer::pendingReadings()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t readings = 0;
+    for (const auto& [serial, batch] : pending)
+    {
+        readings += batch.readings.size();
+    }
+    return readings;
+}
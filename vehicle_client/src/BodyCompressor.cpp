@@ -0,0 +1,188 @@
+#include "BodyCompressor.hpp"
+
+#include <zlib.h>
+
+#ifdef VEHICLE_CLIENT_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include "Logger.hpp"
+
+namespace
+{
+// windowBits of 15 plus 16 makes deflate write a gzip header and trailer
+constexpr int kGzipWindowBits = 15 + 16;
+constexpr int kGzipMemLevel = 8;
+
+/**
+ * Per-thread deflate state, reset between bodies instead of re-initialised.
+ */
+struct GzipStream
+{
+    z_stream stream{};
+    int level = Z_DEFAULT_COMPRESSION;
+    bool initialised = false;
+
+    ~GzipStream()
+    {
+        if (initialised)
+        {
+            deflateEnd(&stream);
+        }
+    }
+
+    bool prepare(int wantedLevel)
+    {
+        if (initialised && level == wantedLevel)
+        {
+            return deflateReset(&stream) == Z_OK;
+        }
+        if (initialised)
+        {
+            deflateEnd(&stream);
+        }
+        stream = z_stream{};
+        level = wantedLevel;
+        initialised = deflateInit2(&stream, level, Z_DEFLATED, kGzipWindowBits, kGzipMemLevel,
+                                   Z_DEFAULT_STRATEGY) == Z_OK;
+        return initialised;
+    }
+};
+
+#ifdef VEHICLE_CLIENT_WITH_ZSTD
+/**
+ * Per-thread zstd compression context.
+ */
+struct ZstdContext
+{
+    ZSTD_CCtx* context = ZSTD_createCCtx();
+
+    ~ZstdContext()
+    {
+        ZSTD_freeCCtx(context);
+    }
+};
+#endif
+
+// Output buffer shared by both codecs, it keeps its capacity between bodies
+std::string& threadOutput()
+{
+    thread_local std::string output;
+    return output;
+}
+
+}  // unnamed namespace
+
+BodyCompressor::BodyCompressor(const CompressionConfig& config) : config(config)
+{
+#ifdef VEHICLE_CLIENT_WITH_ZSTD
+    if (config.algorithm == Compression::ZSTD && !config.dictionary.empty())
+    {
+        zstdDictionary = ZSTD_createCDict(config.dictionary.data(), config.dictionary.size(),
+                                          config.level);
+        if (!zstdDictionary)
+        {
+            logWarning() << "Failed to load zstd dictionary, compressing without it";
+        }
+    }
+#endif
+}
+
+BodyCompressor::~BodyCompressor()
+{
+#ifdef VEHICLE_CLIENT_WITH_ZSTD
+    ZSTD_freeCDict(zstdDictionary);
+#endif
+}
+
+bool BodyCompressor::isSupported(Compression algorithm)
+{
+#ifdef VEHICLE_CLIENT_WITH_ZSTD
+    (void)algorithm;
+    return true;
+#else
+    return algorithm != Compression::ZSTD;
+#endif
+}
+
+bool BodyCompressor::compress(std::string_view body, std::string_view& compressed) const
+{
+    if (config.algorithm == Compression::NONE || body.size() < config.minBytes)
+    {
+        return false;
+    }
+
+    std::string& out = threadOutput();
+    bool success = config.algorithm == Compression::GZIP ? compressGzip(body, out)
+                                                         : compressZstd(body, out);
+
+    // Sending the original is cheaper for the server when nothing was saved
+    if (!success || out.size() >= body.size())
+    {
+        return false;
+    }
+    compressed = out;
+    return true;
+}
+
+const char* BodyCompressor::contentEncodingHeader() const
+{
+    return contentEncodingHeader(config.algorithm);
+}
+
+const char* BodyCompressor::contentEncodingHeader(Compression algorithm)
+{
+    return algorithm == Compression::ZSTD ? "Content-Encoding: zstd" : "Content-Encoding: gzip";
+}
+
+bool BodyCompressor::compressGzip(std::string_view body, std::string& out) const
+{
+    thread_local GzipStream gzip;
+    if (!gzip.prepare(config.level == 0 ? Z_DEFAULT_COMPRESSION : config.level))
+    {
+        return false;
+    }
+
+    out.resize(deflateBound(&gzip.stream, body.size()));
+    gzip.stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+    gzip.stream.avail_in = static_cast<uInt>(body.size());
+    gzip.stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    gzip.stream.avail_out = static_cast<uInt>(out.size());
+
+    // The output is sized with deflateBound, so a single call finishes the stream
+    if (deflate(&gzip.stream, Z_FINISH) != Z_STREAM_END)
+    {
+        return false;
+    }
+    out.resize(gzip.stream.total_out);
+    return true;
+}
+
+bool BodyCompressor::compressZstd(std::string_view body, std::string& out) const
+{
+#ifdef VEHICLE_CLIENT_WITH_ZSTD
+    thread_local ZstdContext zstd;
+    if (!zstd.context)
+    {
+        return false;
+    }
+
+    out.resize(ZSTD_compressBound(body.size()));
+    std::size_t written =
+        zstdDictionary
+            ? ZSTD_compress_usingCDict(zstd.context, out.data(), out.size(), body.data(),
+                                       body.size(), zstdDictionary)
+            : ZSTD_compressCCtx(zstd.context, out.data(), out.size(), body.data(), body.size(),
+                                config.level);
+    if (ZSTD_isError(written))
+    {
+        return false;
+    }
+    out.resize(written);
+    return true;
+#else
+    (void)body;
+    (void)out;
+    return false;
+#endif
+}
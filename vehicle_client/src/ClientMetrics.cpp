@@ -0,0 +1,236 @@
+#include "ClientMetrics.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+
+namespace
+{
+// Buckets per power of two, as a power of two
+constexpr unsigned kSubBucketBits = 5;
+constexpr std::uint64_t kSubBuckets = 1ULL << kSubBucketBits;
+
+constexpr double kExportedQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+#define VEHICLE_CLIENT_COUNTER_NAME(name, text, help) text,
+#define VEHICLE_CLIENT_COUNTER_HELP(name, text, help) help,
+#define VEHICLE_CLIENT_PHASE_NAME(name, text) text,
+
+constexpr const char* kCounterNames[] = {
+    VEHICLE_CLIENT_METRIC_COUNTERS(VEHICLE_CLIENT_COUNTER_NAME)};
+constexpr const char* kCounterHelp[] = {
+    VEHICLE_CLIENT_METRIC_COUNTERS(VEHICLE_CLIENT_COUNTER_HELP)};
+constexpr const char* kPhaseNames[] = {VEHICLE_CLIENT_REQUEST_PHASES(VEHICLE_CLIENT_PHASE_NAME)};
+
+#undef VEHICLE_CLIENT_COUNTER_NAME
+#undef VEHICLE_CLIENT_COUNTER_HELP
+#undef VEHICLE_CLIENT_PHASE_NAME
+
+std::atomic<std::size_t> nextShard{0};
+
+// Cumulative time from the start of the attempt, 0 if the phase did not happen
+std::uint64_t elapsedAt(CURL* curl, CURLINFO info)
+{
+    curl_off_t micros = 0;
+    if (curl_easy_getinfo(curl, info, &micros) != CURLE_OK || micros < 0)
+    {
+        return 0;
+    }
+    return static_cast<std::uint64_t>(micros);
+}
+
+void appendLine(std::string& out, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+void appendLine(std::string& out, const char* format, ...)
+{
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    int length = std::vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (length > 0)
+    {
+        out.append(line, std::min<std::size_t>(static_cast<std::size_t>(length), sizeof(line) - 1));
+    }
+}
+
+void appendGauge(std::string& out, const char* name, const char* help, std::uint64_t value)
+{
+    appendLine(out, "# HELP vehicle_client_%s %s\n# TYPE vehicle_client_%s gauge\n", name, help,
+               name);
+    appendLine(out, "vehicle_client_%s %" PRIu64 "\n", name, value);
+}
+
+}  // unnamed namespace
+
+std::size_t LatencyHistogram::bucketIndex(std::uint64_t micros)
+{
+    if (micros < kSubBuckets)
+    {
+        return static_cast<std::size_t>(micros);
+    }
+    // The top kSubBucketBits + 1 bits select the bucket within the value's power of two
+    unsigned shift = static_cast<unsigned>(std::bit_width(micros)) - kSubBucketBits - 1;
+    std::uint64_t index = shift * kSubBuckets + (micros >> shift);
+    return static_cast<std::size_t>(std::min<std::uint64_t>(index, kBuckets - 1));
+}
+
+std::uint64_t LatencyHistogram::bucketUpperBound(std::size_t index)
+{
+    if (index < 2 * kSubBuckets)
+    {
+        return index;
+    }
+    std::uint64_t shift = index / kSubBuckets - 1;
+    std::uint64_t top = index - shift * kSubBuckets;
+    return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(std::uint64_t micros)
+{
+    buckets[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    sumUs.fetch_add(micros, std::memory_order_relaxed);
+
+    std::uint64_t largest = maxUs.load(std::memory_order_relaxed);
+    while (micros > largest &&
+           !maxUs.compare_exchange_weak(largest, micros, std::memory_order_relaxed))
+    {
+    }
+}
+
+std::uint64_t HistogramSnapshot::percentile(double fraction) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    // Rank of the value, 1-based, so p100 is the largest and p0 the smallest
+    auto rank = static_cast<std::uint64_t>(fraction * static_cast<double>(count - 1)) + 1;
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < buckets.size(); ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+        {
+            return std::min(LatencyHistogram::bucketUpperBound(i), maxUs);
+        }
+    }
+    return maxUs;
+}
+
+std::string MetricsSnapshot::toPrometheus() const
+{
+    std::string out;
+    for (std::size_t i = 0; i < kMetricCounterCount; ++i)
+    {
+        appendLine(out, "# HELP vehicle_client_%s %s\n# TYPE vehicle_client_%s counter\n",
+                   kCounterNames[i], kCounterHelp[i], kCounterNames[i]);
+        appendLine(out, "vehicle_client_%s %" PRIu64 "\n", kCounterNames[i], counters[i]);
+    }
+
+    appendGauge(out, "async_in_flight", "Async requests submitted and not yet completed.",
+                asyncInFlight);
+    appendGauge(out, "upload_queue_depth", "Tasks waiting for an upload pool worker.",
+                uploadQueueDepth);
+    appendGauge(out, "batched_readings", "Readings waiting in the batch buffer.",
+                batchedReadings);
+    appendGauge(out, "spool_backlog_readings", "Readings in the spool awaiting replay.",
+                spoolBacklog);
+
+    out += "# HELP vehicle_client_request_phase_seconds Duration of request attempt phases.\n"
+           "# TYPE vehicle_client_request_phase_seconds summary\n";
+    for (std::size_t i = 0; i < kRequestPhaseCount; ++i)
+    {
+        const HistogramSnapshot& phase = phases[i];
+        for (double quantile : kExportedQuantiles)
+        {
+            appendLine(out,
+                       "vehicle_client_request_phase_seconds{phase=\"%s\",quantile=\"%g\"} %.6f\n",
+                       kPhaseNames[i], quantile, phase.percentile(quantile) / 1e6);
+        }
+        appendLine(out, "vehicle_client_request_phase_seconds_sum{phase=\"%s\"} %.6f\n",
+                   kPhaseNames[i], phase.sumUs / 1e6);
+        appendLine(out, "vehicle_client_request_phase_seconds_count{phase=\"%s\"} %" PRIu64 "\n",
+                   kPhaseNames[i], phase.count);
+    }
+    return out;
+}
+
+ClientMetrics::Shard& ClientMetrics::localShard()
+{
+    // Threads are dealt shards round-robin once, shared by every ClientMetrics instance
+    thread_local std::size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return shards[shard];
+}
+
+void ClientMetrics::recordAttempt(CURL* curl)
+{
+    auto record = [this](RequestPhase phase, std::uint64_t micros)
+    { phases[static_cast<std::size_t>(phase)].record(micros); };
+
+    std::uint64_t connected = elapsedAt(curl, CURLINFO_CONNECT_TIME_T);
+    long newConnections = 0;
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &newConnections);
+    if (newConnections > 0)
+    {
+        std::uint64_t resolved = elapsedAt(curl, CURLINFO_NAMELOOKUP_TIME_T);
+        record(RequestPhase::DNS, resolved);
+        record(RequestPhase::CONNECT, connected - std::min(resolved, connected));
+
+        // Plain HTTP connections have no handshake
+        std::uint64_t handshaken = elapsedAt(curl, CURLINFO_APPCONNECT_TIME_T);
+        if (handshaken > 0)
+        {
+            record(RequestPhase::TLS, handshaken - std::min(connected, handshaken));
+        }
+    }
+
+    // A transfer that failed before any response byte has no first-byte time
+    std::uint64_t firstByte = elapsedAt(curl, CURLINFO_STARTTRANSFER_TIME_T);
+    if (firstByte > 0)
+    {
+        record(RequestPhase::TTFB, firstByte);
+    }
+    record(RequestPhase::TOTAL, elapsedAt(curl, CURLINFO_TOTAL_TIME_T));
+
+    curl_off_t bytes = 0;
+    if (curl_easy_getinfo(curl, CURLINFO_SIZE_UPLOAD_T, &bytes) == CURLE_OK && bytes > 0)
+    {
+        add(MetricCounter::BYTES_SENT, static_cast<std::uint64_t>(bytes));
+    }
+    if (curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &bytes) == CURLE_OK && bytes > 0)
+    {
+        add(MetricCounter::BYTES_RECEIVED, static_cast<std::uint64_t>(bytes));
+    }
+}
+
+MetricsSnapshot ClientMetrics::snapshot() const
+{
+    MetricsSnapshot result;
+    for (const Shard& shard : shards)
+    {
+        for (std::size_t i = 0; i < kMetricCounterCount; ++i)
+        {
+            result.counters[i] += shard.values[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    for (std::size_t i = 0; i < kRequestPhaseCount; ++i)
+    {
+        const LatencyHistogram& histogram = phases[i];
+        HistogramSnapshot& phase = result.phases[i];
+        // Counted from the buckets rather than kept apart, so percentile ranks always add up
+        phase.buckets.resize(LatencyHistogram::kBuckets);
+        for (std::size_t bucket = 0; bucket < LatencyHistogram::kBuckets; ++bucket)
+        {
+            phase.buckets[bucket] = histogram.buckets[bucket].load(std::memory_order_relaxed);
+            phase.count += phase.buckets[bucket];
+        }
+        phase.sumUs = histogram.sumUs.load(std::memory_order_relaxed);
+        phase.maxUs = histogram.maxUs.load(std::memory_order_relaxed);
+    }
+    result.asyncInFlight = asyncInFlight.load(std::memory_order_relaxed);
+    return result;
+}
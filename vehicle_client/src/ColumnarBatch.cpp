@@ -0,0 +1,210 @@
+#include "ColumnarBatch.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "SimdKernels.hpp"
+
+namespace
+{
+constexpr std::string_view kMagic = "VSC";
+constexpr std::uint8_t kVersion = 1;
+
+constexpr std::uint8_t kRawValues = 0;
+constexpr std::uint8_t kXorValues = 1;
+
+// Columns are written in SensorType order; readings of other types are not expected
+#define COLUMN(name, text) SensorType::name,
+constexpr SensorType kColumnOrder[] = {VEHICLE_CLIENT_SENSOR_TYPES(COLUMN)};
+#undef COLUMN
+
+void appendVarint(std::string& out, std::uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+/**
+ * Appends bits most-significant first, padding the last byte with zeros.
+ */
+struct BitWriter
+{
+    std::string& out;
+    int freeBits = 0;  // Unused low bits of the last byte in out
+
+    void write(std::uint32_t value, int bits)
+    {
+        while (bits > 0)
+        {
+            if (freeBits == 0)
+            {
+                out += '\0';
+                freeBits = 8;
+            }
+            int chunk = bits < freeBits ? bits : freeBits;
+            std::uint32_t part = (value >> (bits - chunk)) & ((1u << chunk) - 1);
+            out.back() = static_cast<char>(static_cast<std::uint8_t>(out.back()) |
+                                           (part << (freeBits - chunk)));
+            bits -= chunk;
+            freeBits -= chunk;
+        }
+    }
+};
+
+/**
+ * One column gathered into contiguous arrays, so the delta and XOR passes run as SIMD kernels.
+ */
+struct Column
+{
+    std::vector<std::uint64_t> timestamps;
+    std::vector<std::uint32_t> bits;    // Values as IEEE 754 bit patterns
+    std::vector<std::uint64_t> deltas;  // Zigzag delta-of-deltas of timestamps[1..]
+    std::vector<std::uint32_t> xors;    // Each value XOR its predecessor, the first one as is
+
+    void clear()
+    {
+        timestamps.clear();
+        bits.clear();
+    }
+
+    void add(const SensorReading& reading)
+    {
+        timestamps.push_back(reading.timestampUs);
+        bits.push_back(std::bit_cast<std::uint32_t>(reading.value));
+    }
+
+    void encode()
+    {
+        deltas.resize(timestamps.size() - 1);
+        zigzagDeltaOfDeltas(timestamps, deltas.data());
+        xors.resize(bits.size());
+        xorWithPrevious(bits, xors.data());
+    }
+};
+
+// Gorilla (Pelkonen et al., 2015) value compression adapted to 32-bit floats
+void appendXorValues(std::string& out, const Column& column)
+{
+    BitWriter writer{out};
+    writer.write(column.xors[0], 32);
+    int previousLeading = -1;
+    int previousTrailing = 0;
+
+    for (std::size_t i = 1; i < column.xors.size(); ++i)
+    {
+        std::uint32_t delta = column.xors[i];
+        if (delta == 0)
+        {
+            writer.write(0, 1);
+            continue;
+        }
+
+        int leading = std::countl_zero(delta);
+        int trailing = std::countr_zero(delta);
+        if (previousLeading >= 0 && leading >= previousLeading && trailing >= previousTrailing)
+        {
+            // The meaningful bits fit into the previous window
+            writer.write(0b10, 2);
+            writer.write(delta >> previousTrailing, 32 - previousLeading - previousTrailing);
+            continue;
+        }
+
+        int meaningful = 32 - leading - trailing;
+        writer.write(0b11, 2);
+        writer.write(leading, 5);
+        writer.write(meaningful - 1, 5);
+        writer.write(delta >> trailing, meaningful);
+        previousLeading = leading;
+        previousTrailing = trailing;
+    }
+}
+
+void appendRawValues(std::string& out, const Column& column)
+{
+    for (std::uint32_t bits : column.bits)
+    {
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            out += static_cast<char>((bits >> shift) & 0xFF);
+        }
+    }
+}
+
+void appendColumn(std::string& out, SensorType type, const Column& column)
+{
+    std::string_view typeName = sensorTypeToString(type);
+    appendVarint(out, typeName.size());
+    out += typeName;
+    appendVarint(out, column.bits.size());
+
+    std::size_t encodingOffset = out.size();
+    out += static_cast<char>(kXorValues);
+
+    appendVarint(out, column.timestamps.front());
+    for (std::uint64_t delta : column.deltas)
+    {
+        appendVarint(out, delta);
+    }
+
+    // Noisy signals can make the XOR stream larger than the packed floats
+    std::size_t valuesOffset = out.size();
+    appendXorValues(out, column);
+    if (out.size() - valuesOffset > column.bits.size() * sizeof(float))
+    {
+        out.resize(valuesOffset);
+        out[encodingOffset] = static_cast<char>(kRawValues);
+        appendRawValues(out, column);
+    }
+}
+
+}  // unnamed namespace
+
+void appendColumnarBatch(std::span<const SensorReading> readings, std::string_view vehicleSerial,
+                         std::string& out)
+{
+    // Reused across batches, so steady-state encoding does not allocate
+    thread_local Column columns[std::size(kColumnOrder)];
+    for (Column& column : columns)
+    {
+        column.clear();
+    }
+    for (const SensorReading& reading : readings)
+    {
+        for (std::size_t i = 0; i < std::size(kColumnOrder); ++i)
+        {
+            if (reading.sensorType == kColumnOrder[i])
+            {
+                columns[i].add(reading);
+                break;
+            }
+        }
+    }
+
+    std::size_t columnCount = 0;
+    for (const Column& column : columns)
+    {
+        columnCount += !column.bits.empty();
+    }
+
+    out += kMagic;
+    out += static_cast<char>(kVersion);
+    appendVarint(out, vehicleSerial.size());
+    out += vehicleSerial;
+    appendVarint(out, columnCount);
+
+    for (std::size_t i = 0; i < std::size(kColumnOrder); ++i)
+    {
+        if (!columns[i].bits.empty())
+        {
+            columns[i].encode();
+            appendColumn(out, kColumnOrder[i], columns[i]);
+        }
+    }
+}
@@ -0,0 +1,171 @@
+#include "ConnectionPool.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+// Response buffers that grew beyond this are released instead of being kept for reuse
+constexpr std::size_t kMaxRetainedResponseBytes = 64 * 1024;
+
+}  // unnamed namespace
+
+ConnectionPool::Handle::Handle(ConnectionPool& pool, std::unique_ptr<Connection> connection)
+    : pool(&pool), connection(std::move(connection))
+{
+}
+
+ConnectionPool::Handle::Handle(Handle&& other) noexcept
+    : pool(other.pool), connection(std::move(other.connection))
+{
+}
+
+ConnectionPool::Handle::~Handle()
+{
+    if (connection)
+    {
+        pool->release(std::move(connection));
+    }
+}
+
+ConnectionPool::ConnectionPool(std::size_t maxIdleHandles)
+    : maxIdleHandles(maxIdleHandles), share(curl_share_init())
+{
+    if (share)
+    {
+        curl_share_setopt(share, CURLSHOPT_LOCKFUNC, &ConnectionPool::lockShare);
+        curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, &ConnectionPool::unlockShare);
+        curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    }
+    idleConnections.reserve(maxIdleHandles);
+}
+
+ConnectionPool::~ConnectionPool()
+{
+    for (auto& connection : idleConnections)
+    {
+        curl_easy_cleanup(connection->curl);
+    }
+    idleConnections.clear();
+
+    if (share)
+    {
+        curl_share_cleanup(share);
+    }
+}
+
+ConnectionPool::Handle ConnectionPool::acquire()
+{
+    std::unique_ptr<Connection> connection;
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        if (!idleConnections.empty())
+        {
+            connection = std::move(idleConnections.back());
+            idleConnections.pop_back();
+        }
+    }
+
+    if (!connection)
+    {
+        CURL* curl = curl_easy_init();
+        if (!curl)
+        {
+            return Handle(*this, nullptr);
+        }
+        connection = std::make_unique<Connection>();
+        connection->curl = curl;
+    }
+
+    configure(connection->curl);
+    connection->responseBuffer.clear();
+    return Handle(*this, std::move(connection));
+}
+
+void ConnectionPool::configure(CURL* curl)
+{
+    if (share)
+    {
+        curl_easy_setopt(curl, CURLOPT_SHARE, share);
+    }
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    // Handles may be used from several threads, so never rely on signals for timeouts
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS,
+                     connectTimeoutMs.load(std::memory_order_relaxed));
+
+    // Handles leased after an abort deadline was set time out on it precisely, running ones
+    // are stopped by the progress callback
+    long timeoutMs = requestTimeoutMs.load(std::memory_order_relaxed);
+    std::chrono::steady_clock::time_point deadline = abortDeadline();
+    if (deadline != std::chrono::steady_clock::time_point::max())
+    {
+        auto remaining = deadline - std::chrono::steady_clock::now();
+        auto remainingMs = std::chrono::duration_cast<std::chrono::milliseconds>(remaining).count();
+        // 0 would disable the timeout, so a passed deadline still leaves a millisecond
+        remainingMs = std::clamp<decltype(remainingMs)>(remainingMs, 1,
+                                                        std::numeric_limits<long>::max());
+        if (timeoutMs == 0 || remainingMs < timeoutMs)
+        {
+            timeoutMs = static_cast<long>(remainingMs);
+        }
+    }
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeoutMs);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, &ConnectionPool::onProgress);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, this);
+}
+
+void ConnectionPool::setTimeouts(std::chrono::milliseconds connectTimeout,
+                                 std::chrono::milliseconds requestTimeout)
+{
+    connectTimeoutMs.store(static_cast<long>(connectTimeout.count()), std::memory_order_relaxed);
+    requestTimeoutMs.store(static_cast<long>(requestTimeout.count()), std::memory_order_relaxed);
+}
+
+void ConnectionPool::abortTransfersAt(std::chrono::steady_clock::time_point deadline)
+{
+    abortAfter.store(deadline.time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+int ConnectionPool::onProgress(void* userptr, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
+{
+    auto* pool = static_cast<ConnectionPool*>(userptr);
+    auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    return now >= pool->abortAfter.load(std::memory_order_relaxed) ? 1 : 0;
+}
+
+void ConnectionPool::release(std::unique_ptr<Connection> connection)
+{
+    // Reset clears per-request options but keeps the live connection and caches
+    curl_easy_reset(connection->curl);
+    if (connection->responseBuffer.capacity() > kMaxRetainedResponseBytes)
+    {
+        std::string().swap(connection->responseBuffer);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        if (idleConnections.size() < maxIdleHandles)
+        {
+            idleConnections.push_back(std::move(connection));
+            return;
+        }
+    }
+    curl_easy_cleanup(connection->curl);
+}
+
+void ConnectionPool::lockShare(CURL* /*curl*/, curl_lock_data data, curl_lock_access /*access*/,
+                               void* userptr)
+{
+    static_cast<ConnectionPool*>(userptr)->shareLocks[data].lock();
+}
+
+void ConnectionPool::unlockShare(CURL* /*curl*/, curl_lock_data data, void* userptr)
+{
+    static_cast<ConnectionPool*>(userptr)->shareLocks[data].unlock();
+}
@@ -0,0 +1,40 @@
+#include "CurlGlobal.hpp"
+
+#include <curl/curl.h>
+
+#include <cstddef>
+#include <mutex>
+
+#include "Logger.hpp"
+
+namespace
+{
+std::mutex leaseMutex;
+std::size_t leases = 0;  ///< Leases alive, guarded by leaseMutex.
+bool globalInitialized = false;
+
+}  // unnamed namespace
+
+CurlGlobal::CurlGlobal()
+{
+    std::lock_guard<std::mutex> lock(leaseMutex);
+    if (leases++ == 0)
+    {
+        globalInitialized = curl_global_init(CURL_GLOBAL_DEFAULT) == CURLE_OK;
+        if (!globalInitialized)
+        {
+            logError() << "libcurl initialization failed";
+        }
+    }
+    success = globalInitialized;
+}
+
+CurlGlobal::~CurlGlobal()
+{
+    std::lock_guard<std::mutex> lock(leaseMutex);
+    if (--leases == 0 && globalInitialized)
+    {
+        curl_global_cleanup();
+        globalInitialized = false;
+    }
+}
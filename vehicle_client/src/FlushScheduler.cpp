@@ -0,0 +1,126 @@
+#include "FlushScheduler.hpp"
+
+#include <algorithm>
+
+namespace
+{
+// Latency samples after which the RTT floor forgets older minimums, so a route change that
+// made the link slower is not mistaken for lasting congestion
+constexpr std::size_t kRttEpochSamples = 256;
+
+// Weight of a new sample in the smoothed RTT, as in TCP's SRTT
+constexpr double kRttGain = 0.125;
+
+}  // unnamed namespace
+
+FlushScheduler::FlushScheduler(const FlushSchedulerConfig& config, const FlushSchedule& initial)
+    : config(config)
+{
+    this->config.minInFlight = std::max<std::size_t>(config.minInFlight, 1);
+    this->config.maxInFlight = std::max(config.maxInFlight, this->config.minInFlight);
+    this->config.minBatchReadings = std::max<std::size_t>(config.minBatchReadings, 1);
+    this->config.maxBatchReadings = std::max(config.maxBatchReadings,
+                                             this->config.minBatchReadings);
+    this->config.maxLinger = std::max(config.maxLinger, config.minLinger);
+
+    window = std::clamp<double>(initial.maxInFlight, this->config.minInFlight,
+                                this->config.maxInFlight);
+    slowStartThreshold = this->config.maxInFlight;
+    lingerMs = std::clamp<double>(initial.linger.count(), this->config.minLinger.count(),
+                                  this->config.maxLinger.count());
+    publish();
+}
+
+void FlushScheduler::setBacklog(std::size_t readings)
+{
+    backlog = readings;
+    publish();
+}
+
+void FlushScheduler::onComplete(std::uint64_t ticket, const UploadFeedback& feedback)
+{
+    // A rejected batch says nothing about the link, the server looked at it and refused
+    if (feedback.delivery == Delivery::REJECTED)
+    {
+        return;
+    }
+
+    bool congested = feedback.delivery == Delivery::RETRY;
+    if (!congested)
+    {
+        sampleRtt(feedback.latency);
+        auto limit = std::chrono::duration_cast<std::chrono::microseconds>(
+            rttFloor * config.rttTolerance + config.rttSlack);
+        congested = feedback.latency > limit;
+    }
+
+    if (congested)
+    {
+        // Uploads already in flight at the cut were sent under the old window
+        if (ticket < recoveryTicket)
+        {
+            return;
+        }
+        window = std::max<double>(window * config.backoffFactor, config.minInFlight);
+        slowStartThreshold = window;
+        lingerMs = std::min<double>(lingerMs * 2, config.maxLinger.count());
+        recoveryTicket = nextTicket;
+        congestionCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        window += window < slowStartThreshold ? 1.0 : 1.0 / window;
+        window = std::min<double>(window, config.maxInFlight);
+
+        // Waiting about one round trip for a batch to fill costs no more than the request
+        double target = std::clamp<double>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(smoothedRtt).count(),
+            config.minLinger.count(), config.maxLinger.count());
+        if (lingerMs > target)
+        {
+            lingerMs = std::max<double>(lingerMs - config.minLinger.count(), target);
+        }
+    }
+    publish();
+}
+
+FlushSchedule FlushScheduler::current() const
+{
+    return {publishedBatch.load(std::memory_order_relaxed),
+            std::chrono::milliseconds(publishedLinger.load(std::memory_order_relaxed)),
+            publishedInFlight.load(std::memory_order_relaxed)};
+}
+
+void FlushScheduler::sampleRtt(std::chrono::microseconds latency)
+{
+    if (smoothedRtt.count() == 0)
+    {
+        smoothedRtt = latency;
+        rttFloor = latency;
+        epochFloor = latency;
+        return;
+    }
+
+    smoothedRtt += std::chrono::microseconds(
+        static_cast<std::int64_t>((latency - smoothedRtt).count() * kRttGain));
+    rttFloor = std::min(rttFloor, latency);
+    epochFloor = std::min(epochFloor, latency);
+    if (++epochSamples == kRttEpochSamples)
+    {
+        rttFloor = epochFloor;
+        epochFloor = latency;
+        epochSamples = 0;
+    }
+}
+
+void FlushScheduler::publish()
+{
+    // The backlog split over every upload the window allows
+    std::size_t uploads = static_cast<std::size_t>(window);
+    batch = std::clamp((backlog + uploads - 1) / uploads, config.minBatchReadings,
+                       config.maxBatchReadings);
+
+    publishedBatch.store(batch, std::memory_order_relaxed);
+    publishedLinger.store(linger().count(), std::memory_order_relaxed);
+    publishedInFlight.store(uploads, std::memory_order_relaxed);
+}
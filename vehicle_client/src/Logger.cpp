@@ -0,0 +1,170 @@
+#include "Logger.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+constexpr const char* kLevelNames[] = {"DEBUG", "INFO", "WARNING", "ERROR"};
+
+std::string repeatSummary(const std::string& message, std::uint64_t occurrences,
+                          std::chrono::seconds window)
+{
+    return message + " (x" + std::to_string(occurrences) + " in last " +
+           std::to_string(window.count()) + "s)";
+}
+
+}  // unnamed namespace
+
+void StderrLogSink::write(std::span<const LogEntry> entries)
+{
+    buffer.clear();
+    for (const LogEntry& entry : entries)
+    {
+        char timestamp[TimestampFormatter::kLength];
+        formatter.format(entry.timestampUs, timestamp);
+        buffer.append(timestamp, sizeof(timestamp));
+        buffer += ' ';
+        buffer += kLevelNames[static_cast<std::size_t>(entry.level)];
+        buffer += ' ';
+        buffer += entry.message;
+        buffer += '\n';
+    }
+    std::fwrite(buffer.data(), 1, buffer.size(), stderr);
+    std::fflush(stderr);
+}
+
+Logger& Logger::instance()
+{
+    // Leaked on purpose: threads and static destructors may log during shutdown
+    static Logger* logger = []
+    {
+        auto* created = new Logger();
+        std::atexit([] { Logger::instance().shutdown(); });
+        return created;
+    }();
+    return *logger;
+}
+
+Logger::Logger() : sink(std::make_shared<StderrLogSink>())
+{
+    writer = std::thread(&Logger::run, this);
+}
+
+void Logger::configure(const LoggerConfig& config)
+{
+    minLevel.store(config.minLevel, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(writerMutex);
+    // Messages queued so far belong to the old sink and windows
+    drain(true);
+    dedupWindow = config.dedupWindow;
+    flushInterval = config.flushInterval;
+    sink = config.sink ? config.sink : std::make_shared<StderrLogSink>();
+}
+
+void Logger::log(LogLevel level, std::string_view message)
+{
+    Record record;
+    record.timestampUs = currentTimeMicros();
+    record.level = level;
+    record.length = static_cast<std::uint16_t>(std::min(message.size(), kMaxMessageLength));
+    std::memcpy(record.text, message.data(), record.length);
+    queue.push(record);
+
+    if (stopped.load(std::memory_order_acquire))
+    {
+        flush();
+    }
+}
+
+void Logger::flush()
+{
+    std::lock_guard<std::mutex> lock(writerMutex);
+    drain(true);
+}
+
+void Logger::run()
+{
+    while (!stopped.load(std::memory_order_acquire))
+    {
+        std::chrono::milliseconds interval;
+        {
+            std::lock_guard<std::mutex> lock(writerMutex);
+            drain(false);
+            interval = flushInterval;
+        }
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wake.wait_for(lock, interval, [this] { return stopped.load(std::memory_order_acquire); });
+    }
+}
+
+void Logger::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopped.store(true, std::memory_order_release);
+    }
+    wake.notify_one();
+    writer.join();
+    flush();
+}
+
+void Logger::drain(bool closeAll)
+{
+    auto now = std::chrono::steady_clock::now();
+    bool dedup = dedupWindow.count() > 0;
+
+    Record record;
+    while (queue.tryPop(record))
+    {
+        std::string message(record.text, record.length);
+        if (dedup)
+        {
+            auto found = recent.find(message);
+            if (found != recent.end())
+            {
+                ++found->second.suppressed;
+                continue;
+            }
+            if (recent.size() < kMaxTracked)
+            {
+                recent.emplace(message, Repeats{record.level, now});
+            }
+        }
+        batch.push_back({record.timestampUs, record.level, std::move(message)});
+    }
+
+    for (auto it = recent.begin(); it != recent.end();)
+    {
+        if (!closeAll && now - it->second.windowStart < dedupWindow)
+        {
+            ++it;
+            continue;
+        }
+        if (it->second.suppressed > 0)
+        {
+            batch.push_back({currentTimeMicros(), it->second.level,
+                             repeatSummary(it->first, it->second.suppressed + 1, dedupWindow)});
+        }
+        it = recent.erase(it);
+    }
+
+    // Reported at most once per window, a full queue is a storm by definition
+    std::uint64_t drops = queue.dropped();
+    if (drops > reportedDrops && (closeAll || now - lastDropReport >= dedupWindow))
+    {
+        batch.push_back({currentTimeMicros(), LogLevel::WARNING,
+                         "Log queue full, dropped " + std::to_string(drops - reportedDrops) +
+                             " messages"});
+        reportedDrops = drops;
+        lastDropReport = now;
+    }
+
+    if (!batch.empty())
+    {
+        sink->write(batch);
+        batch.clear();
+    }
+}
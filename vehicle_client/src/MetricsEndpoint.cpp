@@ -0,0 +1,124 @@
+#include "MetricsEndpoint.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <stdexcept>
+#include <string_view>
+
+namespace
+{
+// A scraper that stalls mid-request cannot block the endpoint for longer than this
+constexpr timeval kReceiveTimeout{2, 0};
+
+constexpr std::size_t kMaxRequestBytes = 8192;
+
+constexpr std::string_view kNotFound =
+    "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+bool sendAll(int fd, std::string_view data)
+{
+    while (!data.empty())
+    {
+        ssize_t sent = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (sent <= 0)
+        {
+            return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(sent));
+    }
+    return true;
+}
+
+}  // unnamed namespace
+
+MetricsEndpoint::MetricsEndpoint(const MetricsEndpointConfig& config, Renderer render)
+    : render(std::move(render))
+{
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(config.port);
+    if (::inet_pton(AF_INET, config.address.c_str(), &address.sin_addr) != 1)
+    {
+        throw std::runtime_error("Invalid metrics endpoint address: " + config.address);
+    }
+
+    listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int enable = 1;
+    socklen_t length = sizeof(address);
+    if (listenFd < 0 ||
+        ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) != 0 ||
+        ::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listenFd, 16) != 0 ||
+        ::getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+    {
+        if (listenFd >= 0)
+        {
+            ::close(listenFd);
+        }
+        throw std::runtime_error("Failed to listen for metrics scrapes on " + config.address + ":" +
+                                 std::to_string(config.port));
+    }
+    boundPort = ntohs(address.sin_port);
+
+    acceptThread = std::thread(&MetricsEndpoint::run, this);
+}
+
+MetricsEndpoint::~MetricsEndpoint()
+{
+    stopping.store(true);
+    // Wakes the blocked accept()
+    ::shutdown(listenFd, SHUT_RDWR);
+    acceptThread.join();
+    ::close(listenFd);
+}
+
+void MetricsEndpoint::run()
+{
+    while (!stopping.load())
+    {
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0)
+        {
+            continue;
+        }
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &kReceiveTimeout, sizeof(kReceiveTimeout));
+        answer(fd);
+        ::close(fd);
+    }
+}
+
+void MetricsEndpoint::answer(int fd)
+{
+    std::string request;
+    char chunk[1024];
+    while (request.find("\r\n\r\n") == std::string::npos)
+    {
+        ssize_t received = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (received <= 0 || request.size() > kMaxRequestBytes)
+        {
+            return;
+        }
+        request.append(chunk, static_cast<std::size_t>(received));
+    }
+
+    std::string_view line = std::string_view(request).substr(0, request.find("\r\n"));
+    if (!line.starts_with("GET /metrics ") && !line.starts_with("GET /metrics?"))
+    {
+        sendAll(fd, kNotFound);
+        return;
+    }
+
+    std::string body = render();
+    std::string response = "HTTP/1.1 200 OK\r\n"
+                           "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                           "Content-Length: " +
+                           std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n";
+    if (sendAll(fd, response))
+    {
+        sendAll(fd, body);
+    }
+}
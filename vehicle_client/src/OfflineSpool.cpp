@@ -0,0 +1,526 @@
+#include "OfflineSpool.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#include "Logger.hpp"
+
+namespace
+{
+constexpr std::uint32_t kSegmentMagic = 0x4C505356;  // "VSPL" in little-endian byte order
+constexpr std::uint32_t kSegmentVersion = 1;
+constexpr std::string_view kSegmentPrefix = "segment-";
+constexpr std::string_view kSegmentSuffix = ".spool";
+
+/**
+ * Start of every segment file; records follow at 8-byte aligned offsets.
+ */
+struct SegmentHeader
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t sequence;
+    std::uint64_t consumedOffset;  // First record not yet replayed
+    std::uint64_t reserved;
+};
+
+/**
+ * Precedes the vehicle serial (padded to 8 bytes) and the readings of a record.
+ */
+struct RecordHeader
+{
+    std::uint32_t recordBytes;  // Whole record including this header, 0 where nothing was written
+    std::uint32_t crc;          // CRC-32 of everything after this field
+    std::uint32_t serialLength;
+    std::uint32_t count;
+};
+
+static_assert(sizeof(SegmentHeader) % 8 == 0 && sizeof(RecordHeader) % 8 == 0);
+static_assert(sizeof(SensorReading) % 8 == 0, "records keep readings 8-byte aligned");
+
+std::size_t alignUp(std::size_t value)
+{
+    return (value + 7) & ~static_cast<std::size_t>(7);
+}
+
+std::uint32_t recordCrc(const char* record, std::size_t recordBytes)
+{
+    constexpr std::size_t kSkipped = offsetof(RecordHeader, serialLength);
+    return static_cast<std::uint32_t>(crc32(0, reinterpret_cast<const Bytef*>(record + kSkipped),
+                                            static_cast<uInt>(recordBytes - kSkipped)));
+}
+
+// Returns the record at offset, or nullptr at the end of the data or at a torn or corrupt record
+const RecordHeader* recordAt(const char* data, std::size_t size, std::size_t offset)
+{
+    if (offset + sizeof(RecordHeader) > size)
+    {
+        return nullptr;
+    }
+    const auto* record = reinterpret_cast<const RecordHeader*>(data + offset);
+    std::size_t expected = sizeof(RecordHeader) + alignUp(record->serialLength) +
+                           std::size_t{record->count} * sizeof(SensorReading);
+    if (record->recordBytes == 0 || record->recordBytes != expected ||
+        offset + record->recordBytes > size ||
+        record->crc != recordCrc(data + offset, record->recordBytes))
+    {
+        return nullptr;
+    }
+    return record;
+}
+
+// Returns whether offset is past the last record; a torn append has no length and ends the data too
+bool endOfData(const char* data, std::size_t size, std::size_t offset)
+{
+    return offset + sizeof(RecordHeader) > size ||
+           reinterpret_cast<const RecordHeader*>(data + offset)->recordBytes == 0;
+}
+
+// Returns the offset of the first intact record after a corrupt one at offset, or size if none
+// follows, and about how many readings the corrupt record held
+std::size_t skipCorruptRecord(const char* data, std::size_t size, std::size_t offset,
+                              std::uint64_t& lost)
+{
+    std::size_t next = offset + 8;
+    while (next + sizeof(RecordHeader) <= size && !recordAt(data, size, next))
+    {
+        next += 8;
+    }
+    next = std::min(next, size);
+
+    // The count is trusted if the record it describes fits into the gap, else the readings are
+    // estimated from the claimed length
+    const auto* record = reinterpret_cast<const RecordHeader*>(data + offset);
+    std::size_t expected = sizeof(RecordHeader) + alignUp(record->serialLength) +
+                           std::size_t{record->count} * sizeof(SensorReading);
+    std::size_t end = std::min<std::size_t>(next, offset + record->recordBytes);
+    if (offset + expected <= next)
+    {
+        lost = record->count;
+    }
+    else if (end > offset + sizeof(RecordHeader))
+    {
+        lost = (end - offset - sizeof(RecordHeader)) / sizeof(SensorReading);
+    }
+    else
+    {
+        lost = 0;
+    }
+    return next;
+}
+
+// Maps a whole segment file read-write, the file descriptor is not kept open
+char* mapSegment(const std::string& path, std::size_t& size)
+{
+    int fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    struct stat status;
+    char* data = nullptr;
+    if (fstat(fd, &status) == 0 && status.st_size >= static_cast<off_t>(sizeof(SegmentHeader)))
+    {
+        size = static_cast<std::size_t>(status.st_size);
+        void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        data = mapping == MAP_FAILED ? nullptr : static_cast<char*>(mapping);
+    }
+    close(fd);
+
+    if (data && reinterpret_cast<SegmentHeader*>(data)->magic != kSegmentMagic)
+    {
+        munmap(data, size);
+        data = nullptr;
+    }
+    return data;
+}
+
+// Sums the readings a segment still holds for replay
+std::uint64_t countPendingReadings(const std::string& path)
+{
+    std::size_t size = 0;
+    char* data = mapSegment(path, size);
+    if (!data)
+    {
+        return 0;
+    }
+
+    std::uint64_t pending = 0;
+    std::size_t offset = std::max<std::size_t>(
+        reinterpret_cast<SegmentHeader*>(data)->consumedOffset, sizeof(SegmentHeader));
+    while (!endOfData(data, size, offset))
+    {
+        if (const RecordHeader* record = recordAt(data, size, offset))
+        {
+            pending += record->count;
+            offset += record->recordBytes;
+            continue;
+        }
+        std::uint64_t lost = 0;
+        offset = skipCorruptRecord(data, size, offset, lost);
+        pending += lost;
+    }
+    munmap(data, size);
+    return pending;
+}
+
+std::size_t pageSize()
+{
+    static const std::size_t size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+}  // unnamed namespace
+
+OfflineSpool::OfflineSpool(const SpoolConfig& config, Sender sender)
+    : config(config), sender(std::move(sender))
+{
+    std::error_code error;
+    std::filesystem::create_directories(config.directory, error);
+    if (error)
+    {
+        throw std::runtime_error("Failed to create spool directory " + config.directory + ": " +
+                                 error.message());
+    }
+
+    // Segments left by an earlier run are replayed before anything appended now
+    std::vector<std::uint64_t> existing;
+    for (const auto& entry : std::filesystem::directory_iterator(config.directory, error))
+    {
+        std::string name = entry.path().filename().string();
+        if (!name.starts_with(kSegmentPrefix) || !name.ends_with(kSegmentSuffix))
+        {
+            continue;
+        }
+        std::uint64_t sequence = 0;
+        const char* first = name.data() + kSegmentPrefix.size();
+        const char* last = name.data() + name.size() - kSegmentSuffix.size();
+        if (std::from_chars(first, last, sequence).ptr == last)
+        {
+            existing.push_back(sequence);
+        }
+    }
+    if (error)
+    {
+        throw std::runtime_error("Failed to read spool directory " + config.directory + ": " +
+                                 error.message());
+    }
+
+    std::sort(existing.begin(), existing.end());
+    sealed.assign(existing.begin(), existing.end());
+    nextSequence = existing.empty() ? 0 : existing.back() + 1;
+
+    drainerThread = std::thread(&OfflineSpool::run, this);
+}
+
+OfflineSpool::~OfflineSpool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    drainerThread.join();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    sealActive();
+}
+
+bool OfflineSpool::append(std::span<const SensorReading> readings, std::string_view vehicleSerial)
+{
+    std::size_t serialBytes = alignUp(vehicleSerial.size());
+    std::size_t overhead = sizeof(SegmentHeader) + sizeof(RecordHeader) + serialBytes;
+    if (config.segmentBytes < overhead + sizeof(SensorReading))
+    {
+        logError() << "Spool segments are too small for a single reading";
+        return false;
+    }
+    std::size_t maxReadings = (config.segmentBytes - overhead) / sizeof(SensorReading);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t appended = 0;
+    while (appended < readings.size())
+    {
+        // Batches that do not fit into one segment are split across several records
+        std::size_t count = std::min(readings.size() - appended, maxReadings);
+        std::size_t recordBytes =
+            sizeof(RecordHeader) + serialBytes + count * sizeof(SensorReading);
+
+        if (active.data && active.writeOffset + recordBytes > active.size)
+        {
+            sealActive();
+        }
+        if (!active.data && !openActive())
+        {
+            break;
+        }
+
+        char* record = active.data + active.writeOffset;
+        auto* header = reinterpret_cast<RecordHeader*>(record);
+        header->serialLength = static_cast<std::uint32_t>(vehicleSerial.size());
+        header->count = static_cast<std::uint32_t>(count);
+        std::memcpy(record + sizeof(RecordHeader), vehicleSerial.data(), vehicleSerial.size());
+        std::memset(record + sizeof(RecordHeader) + vehicleSerial.size(), 0,
+                    serialBytes - vehicleSerial.size());
+        std::memcpy(record + sizeof(RecordHeader) + serialBytes, readings.data() + appended,
+                    count * sizeof(SensorReading));
+        header->crc = recordCrc(record, recordBytes);
+
+        // The length goes in last, a record torn by a crash reads as the end of the segment
+        header->recordBytes = static_cast<std::uint32_t>(recordBytes);
+
+        if (config.sync == SpoolSync::APPEND)
+        {
+            std::size_t start = active.writeOffset & ~(pageSize() - 1);
+            msync(active.data + start, active.writeOffset + recordBytes - start, MS_SYNC);
+        }
+        active.writeOffset += recordBytes;
+        appended += count;
+    }
+
+    spooledCount.fetch_add(appended, std::memory_order_relaxed);
+    wakeUp.notify_one();
+    return appended == readings.size();
+}
+
+std::string OfflineSpool::segmentPath(std::uint64_t sequence) const
+{
+    // Zero padded so that segment files list in replay order
+    char number[21];
+    std::snprintf(number, sizeof(number), "%020llu", static_cast<unsigned long long>(sequence));
+    return config.directory + "/" + std::string(kSegmentPrefix) + number +
+           std::string(kSegmentSuffix);
+}
+
+bool OfflineSpool::openActive()
+{
+    Segment segment;
+    segment.sequence = nextSequence++;
+    segment.size = config.segmentBytes;
+    std::string path = segmentPath(segment.sequence);
+
+    segment.fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (segment.fd < 0)
+    {
+        logError() << "Failed to create spool segment " << path << ": " << std::strerror(errno);
+        return false;
+    }
+
+    // Reserving the blocks up front turns a full disk into an error here instead of a
+    // SIGBUS while writing through the mapping
+    int error = posix_fallocate(segment.fd, 0, static_cast<off_t>(segment.size));
+    void* mapping = error == 0 ? mmap(nullptr, segment.size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                                      segment.fd, 0)
+                               : MAP_FAILED;
+    if (mapping == MAP_FAILED)
+    {
+        logError() << "Failed to map spool segment " << path << ": "
+                   << std::strerror(error ? error : errno);
+        close(segment.fd);
+        unlink(path.c_str());
+        return false;
+    }
+
+    segment.data = static_cast<char*>(mapping);
+    *reinterpret_cast<SegmentHeader*>(segment.data) =
+        SegmentHeader{kSegmentMagic, kSegmentVersion, segment.sequence, sizeof(SegmentHeader), 0};
+    segment.writeOffset = sizeof(SegmentHeader);
+    active = segment;
+
+    enforceSegmentLimit();
+    return true;
+}
+
+void OfflineSpool::sealActive()
+{
+    if (!active.data)
+    {
+        return;
+    }
+
+    bool empty = active.writeOffset == sizeof(SegmentHeader);
+    if (!empty && config.sync != SpoolSync::NONE)
+    {
+        msync(active.data, active.writeOffset, MS_SYNC);
+    }
+    munmap(active.data, active.size);
+
+    if (empty)
+    {
+        unlink(segmentPath(active.sequence).c_str());
+    }
+    else
+    {
+        // Give the unused tail of the preallocated file back to the file system
+        if (ftruncate(active.fd, static_cast<off_t>(active.writeOffset)) == 0 &&
+            config.sync != SpoolSync::NONE)
+        {
+            fsync(active.fd);
+        }
+        sealed.push_back(active.sequence);
+    }
+    close(active.fd);
+    active = Segment{};
+}
+
+void OfflineSpool::enforceSegmentLimit()
+{
+    while (sealed.size() + (active.data ? 1 : 0) > config.maxSegments)
+    {
+        auto victim = std::find_if(sealed.begin(), sealed.end(), [this](std::uint64_t sequence)
+                                   { return sequence != replayingSequence; });
+        if (victim == sealed.end())
+        {
+            return;
+        }
+
+        std::string path = segmentPath(*victim);
+        std::uint64_t lost = countPendingReadings(path);
+        unlink(path.c_str());
+        sealed.erase(victim);
+        droppedCount.fetch_add(lost, std::memory_order_relaxed);
+        logError() << "Spool is full, dropped " << lost << " readings";
+    }
+}
+
+void OfflineSpool::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping)
+    {
+        // Replay whatever was appended so far once the older segments are gone
+        if (sealed.empty() && active.data && active.writeOffset > sizeof(SegmentHeader))
+        {
+            sealActive();
+        }
+        if (sealed.empty())
+        {
+            wakeUp.wait(lock);
+            continue;
+        }
+
+        std::uint64_t sequence = sealed.front();
+        replayingSequence = sequence;
+        lock.unlock();
+        bool finished = replaySegment(sequence);
+        lock.lock();
+        replayingSequence = UINT64_MAX;
+
+        if (finished)
+        {
+            unlink(segmentPath(sequence).c_str());
+            sealed.erase(std::find(sealed.begin(), sealed.end(), sequence));
+        }
+        else
+        {
+            // Appends must not cut the pause short while the link is down
+            wakeUp.wait_for(lock, config.retryInterval, [this] { return stopping; });
+        }
+    }
+}
+
+bool OfflineSpool::replaySegment(std::uint64_t sequence)
+{
+    std::size_t size = 0;
+    char* data = mapSegment(segmentPath(sequence), size);
+    if (!data)
+    {
+        return true;
+    }
+    auto* header = reinterpret_cast<SegmentHeader*>(data);
+
+    std::vector<std::span<const SensorReading>> pieces;
+    std::string vehicleSerial;
+    std::size_t gathered = 0;
+    std::size_t offset = std::max<std::size_t>(header->consumedOffset, sizeof(SegmentHeader));
+    bool finished = true;
+
+    // Sends the gathered records and records the progress in the segment header
+    auto deliver = [&]
+    {
+        if (pieces.empty())
+        {
+            return true;
+        }
+        if (sender(pieces, vehicleSerial) == Delivery::RETRY)
+        {
+            return false;
+        }
+        replayedCount.fetch_add(gathered, std::memory_order_relaxed);
+        header->consumedOffset = offset;
+        if (config.sync != SpoolSync::NONE)
+        {
+            msync(data, pageSize(), MS_ASYNC);
+        }
+        pieces.clear();
+        gathered = 0;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        return !stopping;
+    };
+
+    while (!endOfData(data, size, offset))
+    {
+        const RecordHeader* record = recordAt(data, size, offset);
+        if (!record)
+        {
+            // What was gathered goes first, so the skip is stored and never counted twice
+            if (!deliver())
+            {
+                finished = false;
+                break;
+            }
+            std::uint64_t lost = 0;
+            std::size_t next = skipCorruptRecord(data, size, offset, lost);
+            droppedCount.fetch_add(lost, std::memory_order_relaxed);
+            logError() << "Spool segment " << sequence << " has a corrupt record at offset "
+                       << offset << ", dropped " << lost << " readings";
+            offset = next;
+            header->consumedOffset = offset;
+            continue;
+        }
+
+        const char* serial = reinterpret_cast<const char*>(record + 1);
+        std::string_view recordSerial(serial, record->serialLength);
+        std::span<const SensorReading> readings(
+            reinterpret_cast<const SensorReading*>(serial + alignUp(record->serialLength)),
+            record->count);
+
+        // Consecutive records of the same vehicle are merged into one request
+        if (!pieces.empty() && (recordSerial != vehicleSerial ||
+                                gathered + readings.size() > config.replayBatchReadings))
+        {
+            if (!deliver())
+            {
+                finished = false;
+                break;
+            }
+        }
+        if (pieces.empty())
+        {
+            vehicleSerial.assign(recordSerial);
+        }
+        pieces.push_back(readings);
+        gathered += readings.size();
+        offset += record->recordBytes;
+    }
+
+    if (finished && !deliver())
+    {
+        finished = false;
+    }
+    munmap(data, size);
+    return finished;
+}
@@ -0,0 +1,438 @@
+#include "PayloadSerializer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+
+#include "ColumnarBatch.hpp"
+
+namespace
+{
+// Precomputed key fragments of the request bodies
+constexpr std::string_view kSensorDataKey = ",\"sensor_data\":";
+constexpr std::string_view kVehicleSerialKey = ",\"vehicle_serial\":";
+constexpr std::string_view kBatchHead = "{\"vehicle_serial\":";
+constexpr std::string_view kReadingsKey = ",\"readings\":[";
+
+// "sensor_type":"<name>","timestamp": of every sensor type followed by the unknown type, so a
+// reading's type and the key after it take a single append
+#define READING_HEAD(name, text) "\"sensor_type\":\"" text "\",\"timestamp\":",
+constexpr std::string_view kReadingHeads[] = {
+    VEHICLE_CLIENT_SENSOR_TYPES(READING_HEAD) "\"sensor_type\":\"unknown\",\"timestamp\":"};
+#undef READING_HEAD
+
+// ,"vehicle_status":"<name>"} of every status followed by the unknown status
+#define STATUS_TAIL(name, text) ",\"vehicle_status\":\"" text "\"}",
+constexpr std::string_view kStatusTails[] = {
+    VEHICLE_CLIENT_VEHICLE_STATUSES(STATUS_TAIL) ",\"vehicle_status\":\"unknown\"}"};
+#undef STATUS_TAIL
+
+std::string_view readingHead(SensorType type)
+{
+    return kReadingHeads[std::min(static_cast<std::size_t>(type), kSensorTypeCount)];
+}
+
+std::string_view statusTail(VehicleStatus status)
+{
+    return kStatusTails[std::min(static_cast<std::size_t>(status), kVehicleStatusCount)];
+}
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+// Appends the big-endian bytes of an unsigned integer
+template <typename T>
+void appendBigEndian(std::string& out, T value)
+{
+    for (int shift = (sizeof(T) - 1) * 8; shift >= 0; shift -= 8)
+    {
+        out += static_cast<char>((value >> shift) & 0xFF);
+    }
+}
+
+/**
+ * Minimal RFC 8949 CBOR writer for the types used in request bodies.
+ */
+struct CborWriter
+{
+    std::string& out;
+
+    // Writes a major type with its argument in the shortest encoding
+    void head(std::uint8_t majorType, std::uint64_t argument)
+    {
+        std::uint8_t major = majorType << 5;
+        if (argument < 24)
+        {
+            out += static_cast<char>(major | argument);
+        }
+        else if (argument <= UINT8_MAX)
+        {
+            out += static_cast<char>(major | 24);
+            appendBigEndian(out, static_cast<std::uint8_t>(argument));
+        }
+        else if (argument <= UINT16_MAX)
+        {
+            out += static_cast<char>(major | 25);
+            appendBigEndian(out, static_cast<std::uint16_t>(argument));
+        }
+        else if (argument <= UINT32_MAX)
+        {
+            out += static_cast<char>(major | 26);
+            appendBigEndian(out, static_cast<std::uint32_t>(argument));
+        }
+        else
+        {
+            out += static_cast<char>(major | 27);
+            appendBigEndian(out, argument);
+        }
+    }
+
+    void map(std::size_t entries)
+    {
+        head(5, entries);
+    }
+
+    void array(std::size_t elements)
+    {
+        head(4, elements);
+    }
+
+    void text(std::string_view value)
+    {
+        head(3, value.size());
+        out += value;
+    }
+
+    void unsignedInteger(std::uint64_t value)
+    {
+        head(0, value);
+    }
+
+    void float32(float value)
+    {
+        if (!std::isfinite(value))
+        {
+            out += static_cast<char>(0xF6);  // null
+            return;
+        }
+        out += static_cast<char>(0xFA);
+        appendBigEndian(out, std::bit_cast<std::uint32_t>(value));
+    }
+};
+
+/**
+ * Minimal MessagePack writer for the types used in request bodies.
+ */
+struct MsgpackWriter
+{
+    std::string& out;
+
+    // Writes a container or string header using the fix/16/32 bit variants
+    void head(std::size_t length, std::uint8_t fixPrefix, std::size_t fixLimit,
+              std::uint8_t prefix8, std::uint8_t prefix16, std::uint8_t prefix32)
+    {
+        if (length < fixLimit)
+        {
+            out += static_cast<char>(fixPrefix | length);
+        }
+        else if (prefix8 != 0 && length <= UINT8_MAX)
+        {
+            out += static_cast<char>(prefix8);
+            appendBigEndian(out, static_cast<std::uint8_t>(length));
+        }
+        else if (length <= UINT16_MAX)
+        {
+            out += static_cast<char>(prefix16);
+            appendBigEndian(out, static_cast<std::uint16_t>(length));
+        }
+        else
+        {
+            out += static_cast<char>(prefix32);
+            appendBigEndian(out, static_cast<std::uint32_t>(length));
+        }
+    }
+
+    void map(std::size_t entries)
+    {
+        head(entries, 0x80, 16, 0, 0xDE, 0xDF);
+    }
+
+    void array(std::size_t elements)
+    {
+        head(elements, 0x90, 16, 0, 0xDC, 0xDD);
+    }
+
+    void text(std::string_view value)
+    {
+        head(value.size(), 0xA0, 32, 0xD9, 0xDA, 0xDB);
+        out += value;
+    }
+
+    void unsignedInteger(std::uint64_t value)
+    {
+        if (value < 128)
+        {
+            out += static_cast<char>(value);
+        }
+        else if (value <= UINT32_MAX)
+        {
+            out += static_cast<char>(0xCE);
+            appendBigEndian(out, static_cast<std::uint32_t>(value));
+        }
+        else
+        {
+            out += static_cast<char>(0xCF);
+            appendBigEndian(out, value);
+        }
+    }
+
+    void float32(float value)
+    {
+        if (!std::isfinite(value))
+        {
+            out += static_cast<char>(0xC0);  // nil
+            return;
+        }
+        out += static_cast<char>(0xCA);
+        appendBigEndian(out, std::bit_cast<std::uint32_t>(value));
+    }
+};
+
+}  // unnamed namespace
+
+PayloadSerializer::PayloadSerializer(std::size_t initialCapacity)
+{
+    buffer.reserve(initialCapacity);
+}
+
+std::string_view PayloadSerializer::sensorData(const SensorReading& reading,
+                                               std::string_view vehicleSerial)
+{
+    buffer.clear();
+    buffer += '{';
+    appendReadingFields(reading);
+    buffer += kVehicleSerialKey;
+    appendEscaped(vehicleSerial);
+    buffer += '}';
+    return buffer;
+}
+
+std::string_view PayloadSerializer::batch(std::span<const SensorReading> readings,
+                                          std::string_view vehicleSerial, WireFormat format)
+{
+    buffer.clear();
+    if (format == WireFormat::COLUMNAR)
+    {
+        appendColumnarBatch(readings, vehicleSerial, buffer);
+        return buffer;
+    }
+
+    appendBatchHead(vehicleSerial, readings.size(), format);
+    appendBatchReadings(readings, true, format);
+    buffer += batchTail(format);
+    return buffer;
+}
+
+std::string_view PayloadSerializer::batchHead(std::string_view vehicleSerial, std::size_t count,
+                                              WireFormat format)
+{
+    buffer.clear();
+    appendBatchHead(vehicleSerial, count, format);
+    return buffer;
+}
+
+std::string_view PayloadSerializer::batchReadings(std::span<const SensorReading> readings,
+                                                  bool first, WireFormat format)
+{
+    buffer.clear();
+    appendBatchReadings(readings, first, format);
+    return buffer;
+}
+
+std::string_view PayloadSerializer::batchTail(WireFormat format)
+{
+    // Binary batches announce their length up front and need no terminator
+    return format == WireFormat::JSON ? "]}" : "";
+}
+
+std::string_view PayloadSerializer::status(std::string_view vehicleSerial, VehicleStatus status)
+{
+    buffer.clear();
+    buffer += kBatchHead;
+    appendEscaped(vehicleSerial);
+    buffer += statusTail(status);
+    return buffer;
+}
+
+std::string_view PayloadSerializer::vehicleSerials(std::span<const std::string> vehicleSerials)
+{
+    buffer.clear();
+    buffer += "{\"vehicle_serials\":[";
+    for (const std::string& vehicleSerial : vehicleSerials)
+    {
+        appendEscaped(vehicleSerial);
+        buffer += ',';
+    }
+    if (!vehicleSerials.empty())
+    {
+        buffer.pop_back();
+    }
+    buffer += "]}";
+    return buffer;
+}
+
+std::string_view PayloadSerializer::statusBatch(
+    std::span<const std::pair<std::string, VehicleStatus>> updates)
+{
+    buffer.clear();
+    buffer += "{\"updates\":[";
+    for (const auto& [vehicleSerial, status] : updates)
+    {
+        buffer += kBatchHead;
+        appendEscaped(vehicleSerial);
+        buffer += statusTail(status);
+        buffer += ',';
+    }
+    if (!updates.empty())
+    {
+        buffer.pop_back();
+    }
+    buffer += "]}";
+    return buffer;
+}
+
+void PayloadSerializer::appendBatchHead(std::string_view vehicleSerial, std::size_t count,
+                                        WireFormat format)
+{
+    if (format == WireFormat::JSON)
+    {
+        buffer += kBatchHead;
+        appendEscaped(vehicleSerial);
+        buffer += kReadingsKey;
+        return;
+    }
+
+    auto writeHead = [&](auto writer)
+    {
+        writer.map(2);
+        writer.text("vehicle_serial");
+        writer.text(vehicleSerial);
+        writer.text("readings");
+        writer.array(count);
+    };
+    if (format == WireFormat::CBOR)
+    {
+        writeHead(CborWriter{buffer});
+    }
+    else
+    {
+        writeHead(MsgpackWriter{buffer});
+    }
+}
+
+void PayloadSerializer::appendBatchReadings(std::span<const SensorReading> readings, bool first,
+                                            WireFormat format)
+{
+    if (format == WireFormat::CBOR)
+    {
+        appendBinaryReadings<CborWriter>(readings);
+        return;
+    }
+    if (format == WireFormat::MSGPACK)
+    {
+        appendBinaryReadings<MsgpackWriter>(readings);
+        return;
+    }
+
+    for (std::size_t i = 0; i < readings.size(); ++i)
+    {
+        buffer += first && i == 0 ? "{" : ",{";
+        appendReadingFields(readings[i]);
+        buffer += '}';
+    }
+}
+
+template <typename Writer>
+void PayloadSerializer::appendBinaryReadings(std::span<const SensorReading> readings)
+{
+    Writer writer{buffer};
+    for (const SensorReading& reading : readings)
+    {
+        writer.map(3);
+        writer.text("sensor_type");
+        writer.text(sensorTypeToString(reading.sensorType));
+        writer.text("timestamp");
+        writer.unsignedInteger(reading.timestampUs);
+        writer.text("sensor_data");
+        writer.float32(reading.value);
+    }
+}
+
+void PayloadSerializer::appendReadingFields(const SensorReading& reading)
+{
+    buffer += readingHead(reading.sensorType);
+    appendTimestamp(reading.timestampUs);
+    buffer += kSensorDataKey;
+    appendFloat(reading.value);
+}
+
+void PayloadSerializer::appendEscaped(std::string_view value)
+{
+    buffer += '"';
+    for (char c : value)
+    {
+        switch (c)
+        {
+            case '"':
+                buffer += "\\\"";
+                break;
+            case '\\':
+                buffer += "\\\\";
+                break;
+            case '\n':
+                buffer += "\\n";
+                break;
+            case '\r':
+                buffer += "\\r";
+                break;
+            case '\t':
+                buffer += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escaped[] = {'\\', 'u', '0', '0', kHexDigits[(c >> 4) & 0xF],
+                                      kHexDigits[c & 0xF]};
+                    buffer.append(escaped, sizeof(escaped));
+                }
+                else
+                {
+                    buffer += c;
+                }
+        }
+    }
+    buffer += '"';
+}
+
+void PayloadSerializer::appendFloat(float value)
+{
+    // JSON has no representation for NaN or infinity
+    if (!std::isfinite(value))
+    {
+        buffer += "null";
+        return;
+    }
+
+    char digits[32];
+    auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, end);
+}
+
+void PayloadSerializer::appendTimestamp(std::uint64_t timestampUs)
+{
+    char text[TimestampFormatter::kLength + 2];
+    text[0] = '"';
+    char* end = timestampFormatter.format(timestampUs, text + 1);
+    *end++ = '"';
+    buffer.append(text, end);
+}
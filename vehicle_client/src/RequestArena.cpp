@@ -0,0 +1,53 @@
+#include "RequestArena.hpp"
+
+#include <cstring>
+#include <new>
+
+RequestArena::Scope::Scope(RequestArena& arena) : arena(arena)
+{
+    ++arena.depth;
+}
+
+RequestArena::Scope::~Scope()
+{
+    if (--arena.depth == 0)
+    {
+        // Frees spilled chunks and rewinds to the start of the fixed buffer
+        arena.resource.release();
+    }
+}
+
+RequestArena::RequestArena() : resource(buffer, sizeof(buffer))
+{
+}
+
+RequestArena& RequestArena::local()
+{
+    thread_local RequestArena arena;
+    return arena;
+}
+
+const char* RequestArena::concat(std::initializer_list<std::string_view> parts)
+{
+    std::size_t length = 0;
+    for (std::string_view part : parts)
+    {
+        length += part.size();
+    }
+
+    char* out = static_cast<char*>(resource.allocate(length + 1, alignof(char)));
+    char* end = out;
+    for (std::string_view part : parts)
+    {
+        std::memcpy(end, part.data(), part.size());
+        end += part.size();
+    }
+    *end = '\0';
+    return out;
+}
+
+curl_slist* RequestArena::prepend(const char* header, curl_slist* list)
+{
+    void* node = resource.allocate(sizeof(curl_slist), alignof(curl_slist));
+    return new (node) curl_slist{const_cast<char*>(header), list};
+}
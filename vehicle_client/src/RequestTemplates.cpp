@@ -0,0 +1,70 @@
+#include "RequestTemplates.hpp"
+
+#include <iterator>
+
+namespace
+{
+// Paths in Endpoint order
+constexpr const char* kEndpointPaths[] = {
+    "/add-sensor-data/",
+    "/add-sensor-data-batch/",
+    "/add-sensor-data-columnar/",
+    "/get-vehicle-status/?vehicle_serial=",
+    "/update-vehicle-status/",
+    "/get-vehicle-statuses/",
+    "/update-vehicle-statuses/",
+    "/query-sensor-data/",
+};
+
+constexpr WireFormat kAllFormats[] = {WireFormat::JSON, WireFormat::CBOR, WireFormat::MSGPACK,
+                                     WireFormat::COLUMNAR};
+
+constexpr Compression kAllEncodings[] = {Compression::NONE, Compression::GZIP, Compression::ZSTD};
+
+}  // unnamed namespace
+
+RequestTemplates::RequestTemplates(const std::string& baseUrl)
+{
+    static_assert(std::size(kEndpointPaths) == kEndpoints);
+    static_assert(std::size(kAllFormats) == kFormats && std::size(kAllEncodings) == kEncodings);
+
+    for (std::size_t i = 0; i < kEndpoints; ++i)
+    {
+        urls[i] = baseUrl + kEndpointPaths[i];
+    }
+
+    for (WireFormat format : kAllFormats)
+    {
+        for (Compression encoding : kAllEncodings)
+        {
+            curl_slist*& list =
+                headerLists[static_cast<std::size_t>(format)][static_cast<std::size_t>(encoding)];
+            list = curl_slist_append(nullptr, contentTypeHeader(format));
+            if (encoding != Compression::NONE && list)
+            {
+                list = curl_slist_append(list, BodyCompressor::contentEncodingHeader(encoding));
+            }
+        }
+    }
+}
+
+RequestTemplates::~RequestTemplates()
+{
+    for (auto& lists : headerLists)
+    {
+        for (curl_slist* list : lists)
+        {
+            curl_slist_free_all(list);
+        }
+    }
+}
+
+const std::string& RequestTemplates::url(Endpoint endpoint) const
+{
+    return urls[static_cast<std::size_t>(endpoint)];
+}
+
+curl_slist* RequestTemplates::headers(WireFormat format, Compression encoding) const
+{
+    return headerLists[static_cast<std::size_t>(format)][static_cast<std::size_t>(encoding)];
+}
@@ -0,0 +1,179 @@
+#include "ResponseClassifier.hpp"
+
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+namespace
+{
+/**
+ * SAX handler that looks only at the top-level "status" and "content" keys and
+ * aborts the parse as soon as it has what it needs.
+ */
+class StatusScanner
+{
+   public:
+    explicit StatusScanner(std::string* content) : content(content)
+    {
+    }
+
+    bool succeeded() const
+    {
+        return statusSuccess;
+    }
+
+    bool null()
+    {
+        return valueSeen();
+    }
+
+    bool boolean(bool /*value*/)
+    {
+        return valueSeen();
+    }
+
+    bool number_integer(json::number_integer_t /*value*/)
+    {
+        return valueSeen();
+    }
+
+    bool number_unsigned(json::number_unsigned_t /*value*/)
+    {
+        return valueSeen();
+    }
+
+    bool number_float(json::number_float_t /*value*/, const json::string_t& /*raw*/)
+    {
+        return valueSeen();
+    }
+
+    bool string(json::string_t& value)
+    {
+        if (depth == 1)
+        {
+            if (currentKey == Key::STATUS)
+            {
+                statusSeen = true;
+                statusSuccess = value == "success";
+            }
+            else if (currentKey == Key::CONTENT && content)
+            {
+                *content = std::move(value);
+                contentSeen = true;
+            }
+        }
+        return valueSeen();
+    }
+
+    bool binary(json::binary_t& /*value*/)
+    {
+        return valueSeen();
+    }
+
+    bool start_object(std::size_t /*elements*/)
+    {
+        ++depth;
+        return true;
+    }
+
+    bool key(json::string_t& value)
+    {
+        if (depth == 1)
+        {
+            currentKey = value == "status"    ? Key::STATUS
+                         : value == "content" ? Key::CONTENT
+                                              : Key::OTHER;
+        }
+        return true;
+    }
+
+    bool end_object()
+    {
+        --depth;
+        return valueSeen();
+    }
+
+    bool start_array(std::size_t /*elements*/)
+    {
+        ++depth;
+        // A top-level array can never carry the keys we look for
+        return depth > 1;
+    }
+
+    bool end_array()
+    {
+        --depth;
+        return valueSeen();
+    }
+
+    bool parse_error(std::size_t /*position*/, const std::string& /*token*/,
+                     const nlohmann::detail::exception& /*error*/)
+    {
+        statusSuccess = false;
+        return false;
+    }
+
+   private:
+    enum class Key
+    {
+        OTHER,
+        STATUS,
+        CONTENT
+    };
+
+    // Returns false (stop parsing) once every wanted top-level value has been seen
+    bool valueSeen()
+    {
+        if (depth == 1)
+        {
+            currentKey = Key::OTHER;
+        }
+        return !(statusSeen && (!content || contentSeen));
+    }
+
+    std::string* content;
+    int depth = 0;
+    Key currentKey = Key::OTHER;
+    bool statusSeen = false;
+    bool statusSuccess = false;
+    bool contentSeen = false;
+};
+
+// Skips JSON whitespace and then the expected token, returning false if it is not there
+bool consume(std::string_view& body, std::string_view token)
+{
+    std::size_t start = body.find_first_not_of(" \t\r\n");
+    if (start == std::string_view::npos || body.substr(start, token.size()) != token)
+    {
+        return false;
+    }
+    body.remove_prefix(start + token.size());
+    return true;
+}
+
+// Matches bodies that open with "status": "success", which is where the scanner would stop too
+bool startsWithSuccess(std::string_view body)
+{
+    return consume(body, "{") && consume(body, "\"status\"") && consume(body, ":") &&
+           consume(body, "\"success\"");
+}
+
+}  // unnamed namespace
+
+bool isSuccessResponse(long statusCode, std::string_view body, std::string* content)
+{
+    if (!isHttpSuccess(statusCode))
+    {
+        return false;
+    }
+
+    // The server puts "status" first, so the common case needs neither a lexer nor its buffers
+    if (!content && startsWithSuccess(body))
+    {
+        return true;
+    }
+
+    StatusScanner scanner(content);
+    json::sax_parse(body.begin(), body.end(), &scanner, json::input_format_t::json, false);
+    return scanner.succeeded();
+}
@@ -0,0 +1,142 @@
+#include "RetryPolicy.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+
+#include "Logger.hpp"
+
+namespace
+{
+// Open periods are stretched by up to this fraction so probes of a fleet do not line up
+constexpr double kOpenDurationJitter = 0.2;
+
+std::mt19937_64& randomEngine()
+{
+    thread_local std::mt19937_64 engine(std::random_device{}());
+    return engine;
+}
+
+}  // unnamed namespace
+
+CircuitBreaker::CircuitBreaker(int failureThreshold, std::chrono::milliseconds openDuration)
+    : failureThreshold(std::max(failureThreshold, 1)), openDuration(openDuration)
+{
+}
+
+bool CircuitBreaker::allowRequest()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    switch (state)
+    {
+        case State::CLOSED:
+            return true;
+        case State::OPEN:
+            if (std::chrono::steady_clock::now() < reopenAt)
+            {
+                return false;
+            }
+            state = State::HALF_OPEN;
+            probeInFlight = true;
+            return true;
+        case State::HALF_OPEN:
+            // Only one probe at a time, everything else keeps failing fast until it answers
+            if (probeInFlight)
+            {
+                return false;
+            }
+            probeInFlight = true;
+            return true;
+    }
+    return true;
+}
+
+void CircuitBreaker::recordSuccess()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (state != State::CLOSED)
+    {
+        logInfo() << "Server reachable again, circuit closed";
+    }
+    state = State::CLOSED;
+    consecutiveFailures = 0;
+    probeInFlight = false;
+}
+
+void CircuitBreaker::recordFailure()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    probeInFlight = false;
+    bool belowThreshold = state == State::CLOSED && ++consecutiveFailures < failureThreshold;
+    if (state == State::OPEN || belowThreshold)
+    {
+        return;
+    }
+
+    std::uniform_real_distribution<double> stretch(1.0, 1.0 + kOpenDurationJitter);
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(openDuration *
+                                                                          stretch(randomEngine()));
+    state = State::OPEN;
+    reopenAt = std::chrono::steady_clock::now() + duration;
+    logWarning() << "Server unreachable, failing fast for " << duration.count() << " ms";
+}
+
+void CircuitBreaker::setLimits(int failureThreshold, std::chrono::milliseconds openDuration)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->failureThreshold = std::max(failureThreshold, 1);
+    this->openDuration = openDuration;
+}
+
+RetryPolicy::RetryPolicy(const RetryConfig& config)
+    : settings(config),
+      circuitBreaker(std::make_shared<CircuitBreaker>(config.failureThreshold, config.openDuration))
+{
+}
+
+RetryPolicy::RetryPolicy(const RetryConfig& config, const RetryPolicy& previous)
+    : settings(config), circuitBreaker(previous.circuitBreaker)
+{
+    circuitBreaker->setLimits(config.failureThreshold, config.openDuration);
+}
+
+bool RetryPolicy::retryDelay(int attempt, bool idempotent, std::chrono::seconds retryAfter,
+                             std::chrono::milliseconds& delay) const
+{
+    if (!idempotent || attempt >= settings.maxAttempts || retryAfter > settings.maxBackoff)
+    {
+        return false;
+    }
+
+    // Full jitter: a uniform wait up to the capped exponential backoff of this attempt
+    std::chrono::milliseconds cap = settings.initialBackoff;
+    for (int i = 1; i < attempt && cap < settings.maxBackoff; ++i)
+    {
+        cap *= 2;
+    }
+    cap = std::min(cap, settings.maxBackoff);
+    std::uniform_int_distribution<std::int64_t> jitter(0, cap.count());
+    delay = std::max<std::chrono::milliseconds>(std::chrono::milliseconds(jitter(randomEngine())),
+                                                retryAfter);
+    return true;
+}
+
+std::string RetryPolicy::newIdempotencyKey()
+{
+    std::string key(kIdempotencyKeyLength, '0');
+    newIdempotencyKey(std::span<char, kIdempotencyKeyLength>(key.data(), kIdempotencyKeyLength));
+    return key;
+}
+
+void RetryPolicy::newIdempotencyKey(std::span<char, kIdempotencyKeyLength> key)
+{
+    static constexpr char kHexDigits[] = "0123456789abcdef";
+
+    std::uint64_t high = randomEngine()();
+    std::uint64_t low = randomEngine()();
+    for (int i = 0; i < 16; ++i)
+    {
+        key[i] = kHexDigits[(high >> (60 - 4 * i)) & 0xF];
+        key[16 + i] = kHexDigits[(low >> (60 - 4 * i)) & 0xF];
+    }
+}
@@ -0,0 +1,658 @@
+#include "RuntimeConfig.hpp"
+
+#include <unistd.h>
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+namespace
+{
+// Environment variable naming the config file, and the prefix of per-key overrides
+constexpr std::string_view kConfigFileVariable = "VEHICLE_CLIENT_CONFIG";
+constexpr std::string_view kOverridePrefix = "VEHICLE_CLIENT__";
+
+// Upper bound of a sensor's sample rate, at the 1 ms resolution of the sampling timers
+constexpr double kMaxSensorRateHz = 1000.0;
+
+// Settings applied on reload; everything else needs a restart
+constexpr std::string_view kReloadableKeys[] = {"sensors", "status_interval_ms", "log_level",
+                                                "retry", "shutdown_timeout_ms"};
+
+template <typename T>
+struct NamedValue
+{
+    std::string_view name;
+    T value;
+};
+
+constexpr NamedValue<WireFormat> kWireFormats[] = {
+    {"json", WireFormat::JSON},
+    {"cbor", WireFormat::CBOR},
+    {"msgpack", WireFormat::MSGPACK},
+    {"columnar", WireFormat::COLUMNAR},
+};
+
+constexpr NamedValue<LogLevel> kLogLevels[] = {
+    {"debug", LogLevel::DEBUG},
+    {"info", LogLevel::INFO},
+    {"warning", LogLevel::WARNING},
+    {"error", LogLevel::ERROR},
+};
+
+constexpr NamedValue<OverflowPolicy> kOverflowPolicies[] = {
+    {"drop_oldest", OverflowPolicy::DROP_OLDEST},
+    {"drop_newest", OverflowPolicy::DROP_NEWEST},
+    {"block", OverflowPolicy::BLOCK},
+};
+
+constexpr NamedValue<SpoolSync> kSpoolSyncs[] = {
+    {"none", SpoolSync::NONE},
+    {"segment", SpoolSync::SEGMENT},
+    {"append", SpoolSync::APPEND},
+};
+
+constexpr NamedValue<Compression> kCompressions[] = {
+    {"none", Compression::NONE},
+    {"gzip", Compression::GZIP},
+    {"zstd", Compression::ZSTD},
+};
+
+template <typename T, std::size_t N>
+bool lookup(const NamedValue<T> (&table)[N], std::string_view name, T& value)
+{
+    for (const NamedValue<T>& entry : table)
+    {
+        if (entry.name == name)
+        {
+            value = entry.value;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Parses all of text as a number, as from_chars does for the number types
+template <typename T>
+bool parseNumber(std::string_view text, T& value)
+{
+    const char* end = text.data() + text.size();
+    auto [next, status] = std::from_chars(text.data(), end, value);
+    return status == std::errc() && next == end && !text.empty();
+}
+
+/**
+ * @brief Converts a setting to the type of its field.
+ *
+ * Settings from the environment and flags arrive as strings, so every scalar
+ * type also accepts its text form.
+ */
+template <typename T>
+bool convert(const json& value, T& field)
+{
+    if constexpr (std::is_same_v<T, bool>)
+    {
+        if (value.is_boolean())
+        {
+            field = value.get<bool>();
+            return true;
+        }
+        if (value.is_string())
+        {
+            const auto& text = value.get_ref<const std::string&>();
+            if (text == "true" || text == "1")
+            {
+                field = true;
+                return true;
+            }
+            if (text == "false" || text == "0")
+            {
+                field = false;
+                return true;
+            }
+        }
+        return false;
+    }
+    else if constexpr (std::is_same_v<T, std::string>)
+    {
+        if (!value.is_string())
+        {
+            return false;
+        }
+        field = value.get<std::string>();
+        return true;
+    }
+    else if constexpr (std::is_integral_v<T>)
+    {
+        std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t> number;
+        if (value.is_number_integer() && (std::is_signed_v<T> || value.is_number_unsigned()))
+        {
+            number = value.get<decltype(number)>();
+        }
+        else if (!value.is_string() || !parseNumber(value.get_ref<const std::string&>(), number))
+        {
+            return false;
+        }
+        if (number < std::numeric_limits<T>::min() || number > std::numeric_limits<T>::max())
+        {
+            return false;
+        }
+        field = static_cast<T>(number);
+        return true;
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+        double number;
+        if (value.is_number())
+        {
+            number = value.get<double>();
+        }
+        else if (!value.is_string() || !parseNumber(value.get_ref<const std::string&>(), number))
+        {
+            return false;
+        }
+        field = static_cast<T>(number);
+        return true;
+    }
+    else if constexpr (std::is_same_v<T, std::chrono::milliseconds>)
+    {
+        std::uint32_t milliseconds;
+        if (!convert(value, milliseconds))
+        {
+            return false;
+        }
+        field = std::chrono::milliseconds(milliseconds);
+        return true;
+    }
+    else if constexpr (std::is_same_v<T, std::vector<std::string>>)
+    {
+        std::vector<std::string> items;
+        if (value.is_array())
+        {
+            for (const json& item : value)
+            {
+                if (!item.is_string())
+                {
+                    return false;
+                }
+                items.push_back(item.get<std::string>());
+            }
+        }
+        else if (value.is_string())
+        {
+            std::istringstream list(value.get<std::string>());
+            for (std::string item; std::getline(list, item, ',');)
+            {
+                items.push_back(item);
+            }
+        }
+        else
+        {
+            return false;
+        }
+        field = std::move(items);
+        return true;
+    }
+    else
+    {
+        static_assert(!sizeof(T*), "unsupported setting type");
+    }
+}
+
+/**
+ * @brief Reads the keys of one JSON object into fields and rejects the keys nobody read.
+ */
+class Section
+{
+   public:
+    Section(const json& object, std::string path, std::string& error)
+        : object(object), path(std::move(path)), error(error)
+    {
+        if (!object.is_object())
+        {
+            fail("expected an object");
+        }
+    }
+
+    template <typename T>
+    void read(std::string_view key, T& field)
+    {
+        const json* value = find(key);
+        if (value != nullptr && !convert(*value, field))
+        {
+            fail(key, *value);
+        }
+    }
+
+    template <typename T, std::size_t N>
+    void read(std::string_view key, const NamedValue<T> (&table)[N], T& field)
+    {
+        const json* value = find(key);
+        if (value != nullptr &&
+            (!value->is_string() || !lookup(table, value->get<std::string>(), field)))
+        {
+            fail(key, *value);
+        }
+    }
+
+    /**
+     * @brief Hands a nested object to reader, as a Section of its own.
+     */
+    void section(std::string_view key, const std::function<void(Section&)>& reader)
+    {
+        const json* value = find(key);
+        if (value != nullptr)
+        {
+            Section nested(*value, path + std::string(key) + ".", error);
+            if (error.empty())
+            {
+                reader(nested);
+                nested.finish();
+            }
+        }
+    }
+
+    /**
+     * @brief Returns the raw value of a key, or null if it is not set.
+     */
+    const json* find(std::string_view key)
+    {
+        if (!error.empty() || !object.is_object())
+        {
+            return nullptr;
+        }
+        seen.emplace(key);
+        auto it = object.find(key);
+        return it == object.end() ? nullptr : &*it;
+    }
+
+    /**
+     * @brief Reports the first key that was not read.
+     */
+    void finish()
+    {
+        if (!error.empty())
+        {
+            return;
+        }
+        for (const auto& [key, value] : object.items())
+        {
+            if (seen.count(key) == 0)
+            {
+                error = "unknown setting " + path + key;
+                return;
+            }
+        }
+    }
+
+    void fail(std::string_view key, const json& value)
+    {
+        if (error.empty())
+        {
+            error = "invalid value " + value.dump() + " for " + path + std::string(key);
+        }
+    }
+
+    void fail(std::string_view message)
+    {
+        if (error.empty())
+        {
+            error = (path.empty() ? std::string("settings") : path.substr(0, path.size() - 1)) +
+                    ": " + std::string(message);
+        }
+    }
+
+   private:
+    const json& object;
+    std::string path;  ///< Prefix of the keys in errors, e.g. "gateway.".
+    std::string& error;
+    std::set<std::string, std::less<>> seen;
+};
+
+void readSensors(Section& settings, std::vector<SensorSchedule>& sensors, std::string& error)
+{
+    const json* value = settings.find("sensors");
+    if (value == nullptr)
+    {
+        return;
+    }
+
+    // Overrides carry the list as JSON text
+    json list = *value;
+    if (list.is_string())
+    {
+        list = json::parse(value->get<std::string>(), nullptr, false);
+    }
+    if (!list.is_array())
+    {
+        settings.fail("sensors", *value);
+        return;
+    }
+
+    std::vector<SensorSchedule> loaded;
+    for (std::size_t i = 0; i < list.size() && error.empty(); ++i)
+    {
+        SensorSchedule sensor;
+        Section entry(list[i], "sensors[" + std::to_string(i) + "].", error);
+        if (const json* type = entry.find("type"))
+        {
+            if (!type->is_string() || !parseSensorType(type->get<std::string>(), sensor.sensorType))
+            {
+                entry.fail("type", *type);
+            }
+        }
+        entry.read("rate_hz", sensor.rateHz);
+        entry.read("min", sensor.minValue);
+        entry.read("max", sensor.maxValue);
+        entry.finish();
+
+        if (error.empty() && !(sensor.rateHz > 0.0 && sensor.rateHz <= kMaxSensorRateHz))
+        {
+            entry.fail("rate_hz must be above 0 and at most 1000");
+        }
+        if (error.empty() && !(sensor.minValue <= sensor.maxValue))
+        {
+            entry.fail("min must not exceed max");
+        }
+        loaded.push_back(sensor);
+    }
+    sensors = std::move(loaded);
+}
+
+bool readDictionary(const std::string& path, std::string& dictionary, std::string& error)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        error = "cannot open compression dictionary " + path;
+        return false;
+    }
+    dictionary.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool readConfig(const json& settings, RuntimeConfig& config, std::string& error)
+{
+    Section root(settings, "", error);
+    root.read("api_url", config.apiUrl);
+    root.read("vehicles", config.vehicles);
+    readSensors(root, config.sensors, error);
+    root.read("status_interval_ms", config.statusInterval);
+    root.read("status_notifications", config.statusNotifications);
+    root.read("wire_format", kWireFormats, config.wireFormat);
+    root.read("log_level", kLogLevels, config.logLevel);
+    root.read("shutdown_timeout_ms", config.shutdownTimeout);
+
+    root.section("gateway", [&config](Section& gateway) {
+        GatewayConfig& c = config.gateway;
+        gateway.read("worker_threads", c.workerThreads);
+        gateway.read("queue_capacity", c.queueCapacity);
+        gateway.read("overflow_policy", kOverflowPolicies, c.overflowPolicy);
+        gateway.read("max_batch_readings", c.maxBatchReadings);
+        gateway.read("linger_ms", c.linger);
+        gateway.read("max_in_flight_per_worker", c.maxInFlightPerWorker);
+        gateway.read("adaptive", c.adaptive);
+        gateway.section("adaptive_limits", [&c](Section& limits) {
+            FlushSchedulerConfig& l = c.adaptiveLimits;
+            limits.read("min_batch_readings", l.minBatchReadings);
+            limits.read("max_batch_readings", l.maxBatchReadings);
+            limits.read("min_linger_ms", l.minLinger);
+            limits.read("max_linger_ms", l.maxLinger);
+            limits.read("min_in_flight", l.minInFlight);
+            limits.read("max_in_flight", l.maxInFlight);
+            limits.read("backoff_factor", l.backoffFactor);
+            limits.read("rtt_tolerance", l.rttTolerance);
+            limits.read("rtt_slack_ms", l.rttSlack);
+        });
+    });
+
+    root.section("upload_pool", [&config](Section& pool) {
+        pool.read("enabled", config.uploadPoolEnabled);
+        pool.read("threads", config.uploadPool.threads);
+        pool.read("pin_threads", config.uploadPool.pinThreads);
+        pool.read("queue_capacity", config.uploadPool.queueCapacity);
+    });
+
+    root.section("spool", [&config](Section& spool) {
+        SpoolConfig& c = config.spool;
+        spool.read("enabled", config.spoolEnabled);
+        spool.read("directory", c.directory);
+        spool.read("segment_bytes", c.segmentBytes);
+        spool.read("max_segments", c.maxSegments);
+        spool.read("sync", kSpoolSyncs, c.sync);
+        spool.read("replay_batch_readings", c.replayBatchReadings);
+        spool.read("retry_interval_ms", c.retryInterval);
+    });
+
+    std::string dictionaryPath;
+    root.section("compression", [&config, &dictionaryPath](Section& compression) {
+        CompressionConfig& c = config.compression;
+        compression.read("algorithm", kCompressions, c.algorithm);
+        compression.read("min_bytes", c.minBytes);
+        compression.read("level", c.level);
+        compression.read("dictionary_path", dictionaryPath);
+    });
+
+    root.section("retry", [&config](Section& retry) {
+        RetryConfig& c = config.retry;
+        retry.read("connect_timeout_ms", c.connectTimeout);
+        retry.read("request_timeout_ms", c.requestTimeout);
+        retry.read("max_attempts", c.maxAttempts);
+        retry.read("initial_backoff_ms", c.initialBackoff);
+        retry.read("max_backoff_ms", c.maxBackoff);
+        retry.read("idempotency_keys", c.idempotencyKeys);
+        retry.read("failure_threshold", c.failureThreshold);
+        retry.read("open_duration_ms", c.openDuration);
+    });
+
+    root.section("metrics", [&config](Section& metrics) {
+        metrics.read("enabled", config.metricsEnabled);
+        metrics.read("address", config.metrics.address);
+        metrics.read("port", config.metrics.port);
+    });
+    root.finish();
+
+    if (error.empty() && config.apiUrl.empty())
+    {
+        error = "api_url must not be empty";
+    }
+    if (error.empty() && config.vehicles.empty())
+    {
+        error = "vehicles must name at least one vehicle";
+    }
+    for (const std::string& vehicle : config.vehicles)
+    {
+        if (error.empty() && vehicle.empty())
+        {
+            error = "vehicles must not contain an empty serial";
+        }
+    }
+    if (error.empty() && !dictionaryPath.empty())
+    {
+        readDictionary(dictionaryPath, config.compression.dictionary, error);
+    }
+    return error.empty();
+}
+
+// Returns the key path of an override variable, e.g. "gateway.linger_ms", or "" for other variables
+std::string overrideKey(std::string_view variable)
+{
+    if (!variable.starts_with(kOverridePrefix))
+    {
+        return "";
+    }
+
+    std::string key;
+    std::string_view name = variable.substr(kOverridePrefix.size());
+    for (std::size_t i = 0; i < name.size(); ++i)
+    {
+        if (name.compare(i, 2, "__") == 0)
+        {
+            key += '.';
+            ++i;
+        }
+        else
+        {
+            char c = name[i];
+            key += (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+    }
+    return key;
+}
+
+// Stores a value under a dotted key path, creating the sections on the way
+bool setOverride(json& settings, const std::string& key, const std::string& value,
+                 std::string& error)
+{
+    json* node = &settings;
+    std::size_t begin = 0;
+    while (true)
+    {
+        std::size_t dot = key.find('.', begin);
+        std::string name = key.substr(begin, dot - begin);
+        if (name.empty())
+        {
+            error = "invalid setting name " + key;
+            return false;
+        }
+        if (!node->is_object())
+        {
+            *node = json::object();
+        }
+        node = &(*node)[name];
+        if (dot == std::string::npos)
+        {
+            *node = value;
+            return true;
+        }
+        begin = dot + 1;
+    }
+}
+
+}  // unnamed namespace
+
+RuntimeConfigLoader::RuntimeConfigLoader(int argc, char** argv)
+    : program(argc > 0 ? argv[0] : "vehicle_client")
+{
+    if (const char* path = std::getenv(kConfigFileVariable.data()))
+    {
+        configPath = path;
+    }
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+        {
+            help = true;
+            continue;
+        }
+
+        std::size_t equals = arg.find('=');
+        if (!arg.starts_with("--") || equals == std::string_view::npos)
+        {
+            argumentError = "unexpected argument " + std::string(arg);
+            continue;
+        }
+        std::string name(arg.substr(2, equals - 2));
+        std::string value(arg.substr(equals + 1));
+        if (name == "config")
+        {
+            configPath = value;
+        }
+        else
+        {
+            overrides.emplace_back(std::move(name), std::move(value));
+        }
+    }
+}
+
+void RuntimeConfigLoader::printUsage() const
+{
+    std::fprintf(stderr,
+                 "usage: %s [--config=<file>] [--<section>.<key>=<value> ...]\n"
+                 "  --config=<file>           JSON settings, default $VEHICLE_CLIENT_CONFIG\n"
+                 "  --<key>=<value>           overrides a setting of the file, e.g.\n"
+                 "                            --api_url=http://localhost:8000\n"
+                 "                            --vehicles=truck1,truck2\n"
+                 "                            --gateway.linger_ms=50\n"
+                 "                            --sensors='[{\"type\":\"fuel\",\"rate_hz\":5}]'\n"
+                 "  VEHICLE_CLIENT__<SECTION>__<KEY>=<value> in the environment does the same,\n"
+                 "  flags take precedence. SIGHUP reloads the file, environment and flags.\n"
+                 "  See config/vehicle_client.json for every setting.\n",
+                 program.c_str());
+}
+
+bool RuntimeConfigLoader::load(RuntimeConfig& config, std::string& error) const
+{
+    error.clear();
+    if (!argumentError.empty())
+    {
+        error = argumentError;
+        return false;
+    }
+
+    json settings = json::object();
+    if (!configPath.empty())
+    {
+        std::ifstream file(configPath);
+        if (!file)
+        {
+            error = "cannot open config file " + configPath;
+            return false;
+        }
+        settings = json::parse(file, nullptr, false);
+        if (settings.is_discarded() || !settings.is_object())
+        {
+            error = "config file " + configPath + " is not a JSON object";
+            return false;
+        }
+    }
+
+    for (char** variable = environ; *variable != nullptr; ++variable)
+    {
+        std::string_view entry = *variable;
+        std::size_t equals = entry.find('=');
+        std::string key = overrideKey(entry.substr(0, equals));
+        if (!key.empty() && equals != std::string_view::npos &&
+            !setOverride(settings, key, std::string(entry.substr(equals + 1)), error))
+        {
+            return false;
+        }
+    }
+    for (const auto& [key, value] : overrides)
+    {
+        if (!setOverride(settings, key, value, error))
+        {
+            return false;
+        }
+    }
+
+    RuntimeConfig loaded;
+    if (!readConfig(settings, loaded, error))
+    {
+        return false;
+    }
+
+    for (std::string_view key : kReloadableKeys)
+    {
+        settings.erase(std::string(key));
+    }
+    loaded.restartSettings = settings.dump();
+    config = std::move(loaded);
+    return true;
+}
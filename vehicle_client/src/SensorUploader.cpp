@@ -0,0 +1,78 @@
+#include "SensorUploader.hpp"
+
+#include <vector>
+
+#include "TimestampFormatter.hpp"
+#include "VehicleClient.hpp"
+
+namespace
+{
+// How long the uploader sleeps when it finds the queue empty
+constexpr auto kIdleSleep = std::chrono::milliseconds(1);
+
+}  // unnamed namespace
+
+SensorUploader::SensorUploader(VehicleClient& client, std::string vehicleSerial,
+                               const UploaderConfig& config)
+    : client(client),
+      vehicleSerial(std::move(vehicleSerial)),
+      config(config),
+      queue(config.queueCapacity, config.overflowPolicy)
+{
+    uploaderThread = std::thread(&SensorUploader::run, this);
+}
+
+SensorUploader::~SensorUploader()
+{
+    running.store(false, std::memory_order_release);
+    uploaderThread.join();
+}
+
+bool SensorUploader::push(SensorType sensorType, float value)
+{
+    return queue.push({sensorType, value, currentTimeMicros()});
+}
+
+void SensorUploader::run()
+{
+    std::vector<SensorReading> batch;
+    batch.reserve(config.maxBatchReadings);
+    auto batchStarted = std::chrono::steady_clock::now();
+
+    while (true)
+    {
+        bool stopping = !running.load(std::memory_order_acquire);
+
+        SensorReading reading;
+        while (batch.size() < config.maxBatchReadings && queue.tryPop(reading))
+        {
+            if (batch.empty())
+            {
+                batchStarted = std::chrono::steady_clock::now();
+            }
+            batch.push_back(reading);
+        }
+
+        bool full = batch.size() >= config.maxBatchReadings;
+        bool lingered = std::chrono::steady_clock::now() - batchStarted >= config.linger;
+        if (!batch.empty() && (full || lingered || stopping))
+        {
+            if (!client.addSensorDataBatch(batch, vehicleSerial))
+            {
+                failedCount.fetch_add(batch.size(), std::memory_order_relaxed);
+            }
+            batch.clear();
+            continue;
+        }
+
+        // Leave only once everything queued before the stop request has been sent
+        if (stopping && queue.size() == 0)
+        {
+            break;
+        }
+        if (!full)
+        {
+            std::this_thread::sleep_for(kIdleSleep);
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#include "SerialRegistry.hpp"
+
+#include <mutex>
+
+VehicleId SerialRegistry::intern(std::string_view serial)
+{
+    VehicleId id;
+    if (find(serial, id))
+    {
+        return id;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto existing = ids.find(serial);
+    if (existing != ids.end())
+    {
+        // Registered by another thread between the two lookups
+        return existing->second;
+    }
+
+    id = static_cast<VehicleId>(serials.size());
+    const std::string& stored = serials.emplace_back(serial);
+    ids.emplace(stored, id);
+    registered.store(serials.size(), std::memory_order_release);
+    return id;
+}
+
+bool SerialRegistry::find(std::string_view serial, VehicleId& id) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto existing = ids.find(serial);
+    if (existing == ids.end())
+    {
+        return false;
+    }
+    id = existing->second;
+    return true;
+}
+
+const std::string& SerialRegistry::serial(VehicleId id) const
+{
+    // deque::emplace_back keeps element references valid, but not the index structure
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return serials[id];
+}
@@ -0,0 +1,322 @@
+#include "SimdKernels.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define VEHICLE_CLIENT_SIMD_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON)
+#define VEHICLE_CLIENT_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+// One AVX2 register or two NEON registers of floats; every level uses the same lanes
+constexpr std::size_t kLanes = 8;
+
+struct Lanes
+{
+    float lo[kLanes];
+    float hi[kLanes];
+    float sum[kLanes];
+};
+
+struct KernelTable
+{
+    SimdLevel level;
+    // Folds count values, a multiple of kLanes, into the lanes
+    void (*reduceBlocks)(const float* values, std::size_t count, Lanes& lanes);
+    void (*xorWords)(const std::uint32_t* words, std::size_t count, std::uint32_t* out);
+    void (*deltas)(const std::uint64_t* timestamps, std::size_t count, std::uint64_t* out);
+};
+
+std::uint64_t zigzag(std::uint64_t value)
+{
+    return (value << 1) ^ (0 - (value >> 63));
+}
+
+// Shared by every level for the elements left over after the last full vector
+void xorTail(const std::uint32_t* words, std::size_t from, std::size_t count, std::uint32_t* out)
+{
+    for (std::size_t i = from; i < count; ++i)
+    {
+        out[i] = words[i] ^ words[i - 1];
+    }
+}
+
+void deltaTail(const std::uint64_t* timestamps, std::size_t from, std::size_t count,
+               std::uint64_t* out)
+{
+    for (std::size_t i = from; i < count; ++i)
+    {
+        std::uint64_t delta = timestamps[i] - timestamps[i - 1];
+        out[i - 1] = zigzag(delta - (timestamps[i - 1] - timestamps[i - 2]));
+    }
+}
+
+// The ternaries match the argument order of the minps/maxps instructions, NaNs included
+void reduceBlocksScalar(const float* values, std::size_t count, Lanes& lanes)
+{
+    for (std::size_t i = 0; i < count; i += kLanes)
+    {
+        for (std::size_t lane = 0; lane < kLanes; ++lane)
+        {
+            float value = values[i + lane];
+            lanes.lo[lane] = value < lanes.lo[lane] ? value : lanes.lo[lane];
+            lanes.hi[lane] = value > lanes.hi[lane] ? value : lanes.hi[lane];
+            lanes.sum[lane] += value;
+        }
+    }
+}
+
+void xorWordsScalar(const std::uint32_t* words, std::size_t count, std::uint32_t* out)
+{
+    out[0] = words[0];
+    xorTail(words, 1, count, out);
+}
+
+void deltasScalar(const std::uint64_t* timestamps, std::size_t count, std::uint64_t* out)
+{
+    out[0] = zigzag(timestamps[1] - timestamps[0]);
+    deltaTail(timestamps, 2, count, out);
+}
+
+constexpr KernelTable kScalar{SimdLevel::SCALAR, reduceBlocksScalar, xorWordsScalar, deltasScalar};
+
+#ifdef VEHICLE_CLIENT_SIMD_AVX2
+__attribute__((target("avx2"))) __m256i loadAvx2(const void* address)
+{
+    return _mm256_loadu_si256(static_cast<const __m256i*>(address));
+}
+
+__attribute__((target("avx2"))) void reduceBlocksAvx2(const float* values, std::size_t count,
+                                                      Lanes& lanes)
+{
+    __m256 lo = _mm256_loadu_ps(lanes.lo);
+    __m256 hi = _mm256_loadu_ps(lanes.hi);
+    __m256 sum = _mm256_loadu_ps(lanes.sum);
+    for (std::size_t i = 0; i < count; i += kLanes)
+    {
+        __m256 value = _mm256_loadu_ps(values + i);
+        lo = _mm256_min_ps(value, lo);
+        hi = _mm256_max_ps(value, hi);
+        sum = _mm256_add_ps(sum, value);
+    }
+    _mm256_storeu_ps(lanes.lo, lo);
+    _mm256_storeu_ps(lanes.hi, hi);
+    _mm256_storeu_ps(lanes.sum, sum);
+}
+
+__attribute__((target("avx2"))) void xorWordsAvx2(const std::uint32_t* words, std::size_t count,
+                                                  std::uint32_t* out)
+{
+    out[0] = words[0];
+    std::size_t i = 1;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i current = loadAvx2(words + i);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                            _mm256_xor_si256(current, loadAvx2(words + i - 1)));
+    }
+    xorTail(words, i, count, out);
+}
+
+__attribute__((target("avx2"))) void deltasAvx2(const std::uint64_t* timestamps,
+                                                std::size_t count, std::uint64_t* out)
+{
+    out[0] = zigzag(timestamps[1] - timestamps[0]);
+    std::size_t i = 2;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256i previous = loadAvx2(timestamps + i - 1);
+        __m256i delta = _mm256_sub_epi64(_mm256_sub_epi64(loadAvx2(timestamps + i), previous),
+                                         _mm256_sub_epi64(previous, loadAvx2(timestamps + i - 2)));
+        // AVX2 has no 64-bit arithmetic shift, the sign mask comes from a compare instead
+        __m256i sign = _mm256_cmpgt_epi64(_mm256_setzero_si256(), delta);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i - 1),
+                            _mm256_xor_si256(_mm256_slli_epi64(delta, 1), sign));
+    }
+    deltaTail(timestamps, i, count, out);
+}
+
+constexpr KernelTable kAvx2{SimdLevel::AVX2, reduceBlocksAvx2, xorWordsAvx2, deltasAvx2};
+#endif
+
+#ifdef VEHICLE_CLIENT_SIMD_NEON
+void reduceBlocksNeon(const float* values, std::size_t count, Lanes& lanes)
+{
+    float32x4_t lo[2] = {vld1q_f32(lanes.lo), vld1q_f32(lanes.lo + 4)};
+    float32x4_t hi[2] = {vld1q_f32(lanes.hi), vld1q_f32(lanes.hi + 4)};
+    float32x4_t sum[2] = {vld1q_f32(lanes.sum), vld1q_f32(lanes.sum + 4)};
+    for (std::size_t i = 0; i < count; i += kLanes)
+    {
+        for (int half = 0; half < 2; ++half)
+        {
+            // vminq/vmaxq propagate NaNs, selecting on the compares keeps the scalar semantics
+            float32x4_t value = vld1q_f32(values + i + 4 * half);
+            lo[half] = vbslq_f32(vcltq_f32(value, lo[half]), value, lo[half]);
+            hi[half] = vbslq_f32(vcgtq_f32(value, hi[half]), value, hi[half]);
+            sum[half] = vaddq_f32(sum[half], value);
+        }
+    }
+    for (int half = 0; half < 2; ++half)
+    {
+        vst1q_f32(lanes.lo + 4 * half, lo[half]);
+        vst1q_f32(lanes.hi + 4 * half, hi[half]);
+        vst1q_f32(lanes.sum + 4 * half, sum[half]);
+    }
+}
+
+void xorWordsNeon(const std::uint32_t* words, std::size_t count, std::uint32_t* out)
+{
+    out[0] = words[0];
+    std::size_t i = 1;
+    for (; i + 4 <= count; i += 4)
+    {
+        vst1q_u32(out + i, veorq_u32(vld1q_u32(words + i), vld1q_u32(words + i - 1)));
+    }
+    xorTail(words, i, count, out);
+}
+
+void deltasNeon(const std::uint64_t* timestamps, std::size_t count, std::uint64_t* out)
+{
+    out[0] = zigzag(timestamps[1] - timestamps[0]);
+    std::size_t i = 2;
+    for (; i + 2 <= count; i += 2)
+    {
+        uint64x2_t previous = vld1q_u64(timestamps + i - 1);
+        uint64x2_t delta = vsubq_u64(vsubq_u64(vld1q_u64(timestamps + i), previous),
+                                     vsubq_u64(previous, vld1q_u64(timestamps + i - 2)));
+        uint64x2_t sign = vreinterpretq_u64_s64(vshrq_n_s64(vreinterpretq_s64_u64(delta), 63));
+        vst1q_u64(out + i - 1, veorq_u64(vshlq_n_u64(delta, 1), sign));
+    }
+    deltaTail(timestamps, i, count, out);
+}
+
+constexpr KernelTable kNeon{SimdLevel::NEON, reduceBlocksNeon, xorWordsNeon, deltasNeon};
+#endif
+
+const KernelTable* supportedKernels(SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::SCALAR:
+            return &kScalar;
+#ifdef VEHICLE_CLIENT_SIMD_AVX2
+        case SimdLevel::AVX2:
+            return __builtin_cpu_supports("avx2") ? &kAvx2 : nullptr;
+#endif
+#ifdef VEHICLE_CLIENT_SIMD_NEON
+        case SimdLevel::NEON:
+            return &kNeon;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+std::atomic<const KernelTable*>& activeKernels()
+{
+    static std::atomic<const KernelTable*> active = []
+    {
+        for (SimdLevel level : {SimdLevel::AVX2, SimdLevel::NEON})
+        {
+            if (const KernelTable* kernels = supportedKernels(level))
+            {
+                return kernels;
+            }
+        }
+        return &kScalar;
+    }();
+    return active;
+}
+
+const KernelTable& kernels()
+{
+    return *activeKernels().load(std::memory_order_acquire);
+}
+
+}  // unnamed namespace
+
+SimdLevel simdLevel()
+{
+    return kernels().level;
+}
+
+bool setSimdLevel(SimdLevel level)
+{
+    const KernelTable* kernels = supportedKernels(level);
+    if (!kernels)
+    {
+        return false;
+    }
+    activeKernels().store(kernels, std::memory_order_release);
+    return true;
+}
+
+const char* simdLevelToString(SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::AVX2:
+            return "avx2";
+        case SimdLevel::NEON:
+            return "neon";
+        default:
+            return "scalar";
+    }
+}
+
+MinMaxSum minMaxSum(std::span<const float> values)
+{
+    MinMaxSum result;
+    if (values.empty())
+    {
+        return result;
+    }
+
+    Lanes lanes;
+    std::fill(std::begin(lanes.lo), std::end(lanes.lo), values[0]);
+    std::fill(std::begin(lanes.hi), std::end(lanes.hi), values[0]);
+    std::fill(std::begin(lanes.sum), std::end(lanes.sum), 0.0f);
+    std::size_t blocked = values.size() - values.size() % kLanes;
+    kernels().reduceBlocks(values.data(), blocked, lanes);
+
+    result.min = lanes.lo[0];
+    result.max = lanes.hi[0];
+    for (std::size_t lane = 0; lane < kLanes; ++lane)
+    {
+        result.min = std::min(result.min, lanes.lo[lane]);
+        result.max = std::max(result.max, lanes.hi[lane]);
+        result.sum += lanes.sum[lane];
+    }
+    for (std::size_t i = blocked; i < values.size(); ++i)
+    {
+        result.min = std::min(result.min, values[i]);
+        result.max = std::max(result.max, values[i]);
+        result.sum += values[i];
+    }
+    return result;
+}
+
+void xorWithPrevious(std::span<const std::uint32_t> words, std::uint32_t* out)
+{
+    if (!words.empty())
+    {
+        kernels().xorWords(words.data(), words.size(), out);
+    }
+}
+
+void zigzagDeltaOfDeltas(std::span<const std::uint64_t> timestamps, std::uint64_t* out)
+{
+    if (timestamps.size() >= 2)
+    {
+        kernels().deltas(timestamps.data(), timestamps.size(), out);
+    }
+}
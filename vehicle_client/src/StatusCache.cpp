@@ -0,0 +1,76 @@
+#include "StatusCache.hpp"
+
+#include <utility>
+
+bool StatusCache::confirmed(const std::string& vehicleSerial, std::string& status) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto slot = slots.find(vehicleSerial);
+    if (slot == slots.end() || !slot->second.confirmed)
+    {
+        return false;
+    }
+    status = slot->second.entry.status;
+    return true;
+}
+
+bool StatusCache::lookup(const std::string& vehicleSerial, Entry& entry) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto slot = slots.find(vehicleSerial);
+    if (slot == slots.end())
+    {
+        return false;
+    }
+    entry = slot->second.entry;
+    return true;
+}
+
+std::uint64_t StatusCache::beginRequest() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return changes;
+}
+
+void StatusCache::storeResponse(const std::string& vehicleSerial, Entry entry, std::uint64_t token)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    // A newer event may have been stored while the response was on its way
+    bool current = changes == token;
+    if (!current && slots.count(vehicleSerial) != 0)
+    {
+        return;
+    }
+    slots[vehicleSerial] = {std::move(entry), current && live && covers(vehicleSerial)};
+}
+
+void StatusCache::storeEvent(const std::string& vehicleSerial, Entry entry)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ++changes;
+    slots[vehicleSerial] = {std::move(entry), live && covers(vehicleSerial)};
+}
+
+void StatusCache::invalidate(const std::string& vehicleSerial)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ++changes;
+    slots.erase(vehicleSerial);
+}
+
+void StatusCache::setLive(bool isLive, const std::vector<std::string>& watchedSerials)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ++changes;
+    live = isLive;
+    watched = {watchedSerials.begin(), watchedSerials.end()};
+    for (auto& [serial, slot] : slots)
+    {
+        slot.confirmed = false;
+    }
+}
+
+bool StatusCache::covers(const std::string& vehicleSerial) const
+{
+    return watched.empty() || watched.count(vehicleSerial) != 0;
+}
@@ -0,0 +1,191 @@
+#include "StatusSubscription.hpp"
+
+#include <algorithm>
+#include <random>
+
+#include "Logger.hpp"
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+namespace
+{
+// The server sends a keep-alive comment every 15 s, a stream silent for longer is dead
+constexpr long kStallTimeoutSeconds = 45;
+
+}  // unnamed namespace
+
+StatusSubscription::StatusSubscription(const std::string& baseUrl,
+                                       std::vector<std::string> vehicleSerials,
+                                       StatusCache& cache, const RetryConfig& retry)
+    : url(baseUrl + "/vehicle-status-events/"),
+      serials(std::move(vehicleSerials)),
+      cache(cache),
+      retry(retry)
+{
+    char separator = '?';
+    for (const std::string& serial : serials)
+    {
+        char* escaped = curl_easy_escape(nullptr, serial.c_str(), static_cast<int>(serial.size()));
+        url += separator;
+        url += "vehicle_serial=";
+        url += escaped;
+        curl_free(escaped);
+        separator = '&';
+    }
+    worker = std::thread(&StatusSubscription::run, this);
+}
+
+StatusSubscription::~StatusSubscription()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        running.store(false, std::memory_order_release);
+    }
+    wakeUp.notify_all();
+    worker.join();
+}
+
+void StatusSubscription::run()
+{
+    std::mt19937_64 random(std::random_device{}());
+    int failures = 0;
+
+    while (running.load(std::memory_order_acquire))
+    {
+        CURL* curl = curl_easy_init();
+        bool wasLive = curl && readStream(curl);
+        if (curl)
+        {
+            curl_easy_cleanup(curl);
+        }
+
+        if (isLive.exchange(false, std::memory_order_acq_rel))
+        {
+            cache.setLive(false);
+            if (running.load(std::memory_order_acquire))
+            {
+                logWarning() << "Status event stream lost, revalidating statuses until it is back";
+            }
+        }
+        failures = wasLive ? 0 : failures + 1;
+
+        // Full jitter keeps a fleet from reconnecting in lockstep after a server restart
+        std::chrono::milliseconds ceiling = std::min<std::chrono::milliseconds>(
+            retry.maxBackoff, retry.initialBackoff * (1L << std::min(failures, 16)));
+        std::uniform_int_distribution<long long> spread(0, ceiling.count());
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeUp.wait_for(lock, std::chrono::milliseconds(spread(random)),
+                        [this] { return !running.load(std::memory_order_acquire); });
+    }
+}
+
+bool StatusSubscription::readStream(CURL* curl)
+{
+    line.clear();
+    eventName.clear();
+    eventData.clear();
+
+    struct curl_slist* headers = curl_slist_append(nullptr, "Accept: text/event-stream");
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS,
+                     static_cast<long>(retry.connectTimeout.count()));
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, kStallTimeoutSeconds);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, onData);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, this);
+
+    // The progress callback runs about once a second even on an idle stream, to notice shutdown
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, onProgress);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, this);
+
+    curl_easy_perform(curl);
+    curl_slist_free_all(headers);
+    return isLive.load(std::memory_order_acquire);
+}
+
+size_t StatusSubscription::onData(char* data, size_t size, size_t count, void* self)
+{
+    static_cast<StatusSubscription*>(self)->consume({data, size * count});
+    return size * count;
+}
+
+int StatusSubscription::onProgress(void* self, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
+{
+    return static_cast<StatusSubscription*>(self)->running.load(std::memory_order_acquire) ? 0 : 1;
+}
+
+void StatusSubscription::consume(std::string_view data)
+{
+    line.append(data);
+    std::size_t start = 0;
+    for (std::size_t end; (end = line.find('\n', start)) != std::string::npos; start = end + 1)
+    {
+        std::string_view field(line.data() + start, end - start);
+        if (!field.empty() && field.back() == '\r')
+        {
+            field.remove_suffix(1);
+        }
+
+        if (field.empty())
+        {
+            dispatch();
+            continue;
+        }
+        if (field.front() == ':')
+        {
+            continue;  // Comment, e.g. a keep-alive
+        }
+
+        std::size_t colon = field.find(':');
+        std::string_view name = field.substr(0, colon);
+        std::string_view value = colon == std::string_view::npos ? "" : field.substr(colon + 1);
+        if (!value.empty() && value.front() == ' ')
+        {
+            value.remove_prefix(1);
+        }
+
+        if (name == "event")
+        {
+            eventName.assign(value);
+        }
+        else if (name == "data")
+        {
+            if (!eventData.empty())
+            {
+                eventData += '\n';
+            }
+            eventData.append(value);
+        }
+    }
+    line.erase(0, start);
+}
+
+void StatusSubscription::dispatch()
+{
+    if (eventName == "ready")
+    {
+        cache.setLive(true, serials);
+        isLive.store(true, std::memory_order_release);
+    }
+    else if (eventName == "status")
+    {
+        json event = json::parse(eventData, nullptr, false);
+        auto text = [&event](const char* key)
+        {
+            auto field = event.find(key);
+            return field != event.end() && field->is_string() ? field->get<std::string>()
+                                                               : std::string();
+        };
+        if (event.is_object() && !text("vehicle_serial").empty())
+        {
+            cache.storeEvent(text("vehicle_serial"), {text("vehicle_status"), text("etag")});
+        }
+    }
+    eventName.clear();
+    eventData.clear();
+}
@@ -0,0 +1,152 @@
+#include "TimerWheel.hpp"
+
+#include <algorithm>
+
+namespace
+{
+// First tick at or after a point in time, so a timer never fires before its deadline
+std::uint64_t ceilTick(TimerWheel::Clock::time_point time, TimerWheel::Clock::time_point start,
+                       TimerWheel::Clock::duration tick)
+{
+    if (time <= start)
+    {
+        return 0;
+    }
+    return static_cast<std::uint64_t>((time - start + tick - TimerWheel::Clock::duration(1)) /
+                                      tick);
+}
+
+}  // unnamed namespace
+
+TimerWheel::TimerWheel(Clock::duration tick, std::size_t slots, Clock::time_point start)
+    : tick(std::max(tick, Clock::duration(1))), start(start), slots(std::max<std::size_t>(slots, 1))
+{
+}
+
+TimerWheel::TimerId TimerWheel::add(Clock::duration period, Clock::time_point firstDue)
+{
+    TimerId id;
+    if (!freeIds.empty())
+    {
+        id = freeIds.back();
+        freeIds.pop_back();
+    }
+    else
+    {
+        id = timers.size();
+        timers.emplace_back();
+    }
+
+    Timer& timer = timers[id];
+    timer.period = std::max(period, tick);
+    timer.deadline = firstDue;
+    timer.active = true;
+    schedule(id);
+    return id;
+}
+
+void TimerWheel::setPeriod(TimerId id, Clock::duration period, Clock::time_point now)
+{
+    if (id >= timers.size() || !timers[id].active)
+    {
+        return;
+    }
+
+    Timer& timer = timers[id];
+    period = std::max(period, tick);
+    timer.deadline = std::max(timer.deadline - timer.period + period, now);
+    timer.period = period;
+    schedule(id);
+}
+
+void TimerWheel::cancel(TimerId id)
+{
+    if (id >= timers.size() || !timers[id].active)
+    {
+        return;
+    }
+
+    timers[id].active = false;
+    ++timers[id].generation;
+    freeIds.push_back(id);
+}
+
+void TimerWheel::advance(Clock::time_point now, std::vector<TimerId>& due)
+{
+    if (now < start)
+    {
+        return;
+    }
+    const auto nowTick = static_cast<std::uint64_t>((now - start) / tick);
+    if (nowTick <= currentTick)
+    {
+        return;
+    }
+
+    // After a long stall every slot is visited once, not once per elapsed tick
+    const std::uint64_t last = std::min<std::uint64_t>(nowTick, currentTick + slots.size());
+    for (std::uint64_t t = currentTick + 1; t <= last; ++t)
+    {
+        std::vector<Entry>& slot = slots[t % slots.size()];
+        if (slot.empty())
+        {
+            continue;
+        }
+
+        // Timers rescheduled below may land in this very slot again
+        scratch.swap(slot);
+        for (const Entry& entry : scratch)
+        {
+            Timer& timer = timers[entry.timer];
+            if (!timer.active || timer.generation != entry.generation)
+            {
+                continue;
+            }
+            if (timer.deadlineTick > nowTick)
+            {
+                slot.push_back(entry);
+                continue;
+            }
+
+            due.push_back(entry.timer);
+            timer.deadline += timer.period;
+            if (timer.deadline <= now)
+            {
+                const auto skipped = (now - timer.deadline) / timer.period + 1;
+                timer.deadline += skipped * timer.period;
+                missedCount += static_cast<std::uint64_t>(skipped);
+            }
+            // The new deadline lies past now, so the timer cannot fire twice in one call
+            schedule(entry.timer);
+        }
+        scratch.clear();
+    }
+    currentTick = nowTick;
+}
+
+TimerWheel::Clock::time_point TimerWheel::nextExpiry() const
+{
+    for (std::uint64_t t = currentTick + 1; t <= currentTick + slots.size(); ++t)
+    {
+        for (const Entry& entry : slots[t % slots.size()])
+        {
+            const Timer& timer = timers[entry.timer];
+            if (timer.active && timer.generation == entry.generation && timer.deadlineTick <= t)
+            {
+                return start + static_cast<Clock::rep>(t) * tick;
+            }
+        }
+    }
+    return start + static_cast<Clock::rep>(currentTick + slots.size()) * tick;
+}
+
+void TimerWheel::schedule(TimerId id)
+{
+    Timer& timer = timers[id];
+    ++timer.generation;
+    timer.deadlineTick = ceilTick(timer.deadline, start, tick);
+
+    // A deadline that already passed fires at the next advance
+    const std::uint64_t slotTick = std::max(timer.deadlineTick, currentTick + 1);
+    slots[slotTick % slots.size()].push_back(Entry{id, timer.generation});
+}
@@ -0,0 +1,87 @@
+#include "TimestampFormatter.hpp"
+
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+constexpr std::uint64_t kMicrosPerSecond = 1000000;
+constexpr std::uint64_t kSecondsPerDay = 86400;
+
+// Writes value as exactly width decimal digits, zero padded
+char* writeDigits(char* out, unsigned value, int width)
+{
+    for (int i = width - 1; i >= 0; --i)
+    {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    return out + width;
+}
+
+struct CivilDate
+{
+    int year;
+    unsigned month;
+    unsigned day;
+};
+
+// Converts days since 1970-01-01 to a proleptic Gregorian date (H. Hinnant's civil_from_days)
+CivilDate civilFromDays(std::int64_t days)
+{
+    days += 719468;
+    std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    auto dayOfEra = static_cast<unsigned>(days - era * 146097);
+    unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    unsigned monthIndex = (5 * dayOfYear + 2) / 153;
+    unsigned day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    unsigned month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    auto year = static_cast<int>(yearOfEra + era * 400 + (month <= 2 ? 1 : 0));
+    return {year, month, day};
+}
+
+}  // unnamed namespace
+
+std::uint64_t currentTimeMicros()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+char* TimestampFormatter::format(std::uint64_t timestampUs, char* out)
+{
+    std::uint64_t second = timestampUs / kMicrosPerSecond;
+    if (second != cachedSecond)
+    {
+        updatePrefix(second);
+    }
+
+    std::memcpy(out, cachedPrefix, kPrefixLength);
+    out += kPrefixLength;
+    *out++ = '.';
+    out = writeDigits(out, static_cast<unsigned>(timestampUs % kMicrosPerSecond), 6);
+    *out++ = 'Z';
+    return out;
+}
+
+void TimestampFormatter::updatePrefix(std::uint64_t second)
+{
+    CivilDate date = civilFromDays(static_cast<std::int64_t>(second / kSecondsPerDay));
+    auto secondOfDay = static_cast<unsigned>(second % kSecondsPerDay);
+
+    char* out = cachedPrefix;
+    out = writeDigits(out, static_cast<unsigned>(date.year), 4);
+    *out++ = '-';
+    out = writeDigits(out, date.month, 2);
+    *out++ = '-';
+    out = writeDigits(out, date.day, 2);
+    *out++ = 'T';
+    out = writeDigits(out, secondOfDay / 3600, 2);
+    *out++ = ':';
+    out = writeDigits(out, secondOfDay / 60 % 60, 2);
+    *out++ = ':';
+    writeDigits(out, secondOfDay % 60, 2);
+
+    cachedSecond = second;
+}
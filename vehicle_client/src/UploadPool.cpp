@@ -0,0 +1,206 @@
+#include "UploadPool.hpp"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+// Upper bound for an idle wait, a safety net in case a wake-up is missed
+constexpr auto kIdleWait = std::chrono::milliseconds(10);
+
+// The pool and worker the calling thread belongs to, if any
+struct CurrentWorker
+{
+    const void* pool = nullptr;
+    std::size_t index = 0;
+    ConnectionPool* connections = nullptr;
+};
+
+thread_local CurrentWorker currentWorker;
+
+void pinToCpu(std::thread& thread, std::size_t index)
+{
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(index % std::max(1u, std::thread::hardware_concurrency()), &cpus);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus);
+#else
+    (void)thread;
+    (void)index;
+#endif
+}
+
+}  // unnamed namespace
+
+UploadPool::UploadPool(const UploadPoolConfig& config)
+{
+    std::size_t threadCount = config.threads;
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    workers.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>(config.queueCapacity));
+    }
+    for (std::size_t i = 0; i < threadCount; ++i)
+    {
+        workers[i]->thread = std::thread(&UploadPool::run, this, i);
+        if (config.pinThreads)
+        {
+            pinToCpu(workers[i]->thread, i);
+        }
+    }
+}
+
+UploadPool::~UploadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true, std::memory_order_release);
+    }
+    wakeUp.notify_all();
+    for (auto& worker : workers)
+    {
+        worker->thread.join();
+    }
+}
+
+void UploadPool::submit(Task task)
+{
+    auto* queued = new Task(std::move(task));
+    queuedCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (currentWorker.pool == this)
+    {
+        // Spawned by a worker: keep it local, where it is cheapest to pick up again
+        if (!workers[currentWorker.index]->deque.push(queued))
+        {
+            queuedCount.fetch_sub(1, std::memory_order_relaxed);
+            (*queued)();
+            delete queued;
+            return;
+        }
+    }
+    else
+    {
+        std::size_t start = nextInbox.fetch_add(1, std::memory_order_relaxed);
+        for (std::size_t attempt = 0;; ++attempt)
+        {
+            if (workers[(start + attempt) % workers.size()]->inbox.tryPush(queued))
+            {
+                break;
+            }
+            if (attempt % workers.size() == workers.size() - 1)
+            {
+                // Every inbox is full, wait for the workers to catch up
+                notifySleeper();
+                std::this_thread::yield();
+            }
+        }
+    }
+    notifySleeper();
+}
+
+void UploadPool::setTimeouts(std::chrono::milliseconds connectTimeout,
+                             std::chrono::milliseconds requestTimeout)
+{
+    for (auto& worker : workers)
+    {
+        worker->connections.setTimeouts(connectTimeout, requestTimeout);
+    }
+}
+
+void UploadPool::abortTransfersAt(std::chrono::steady_clock::time_point deadline)
+{
+    for (auto& worker : workers)
+    {
+        worker->connections.abortTransfersAt(deadline);
+    }
+}
+
+ConnectionPool* UploadPool::currentConnectionPool()
+{
+    return currentWorker.connections;
+}
+
+void UploadPool::notifySleeper()
+{
+    // Pairs with the fence in run(): either the worker sees the task or we see the sleeper
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed) > 0)
+    {
+        // Taking the mutex orders the notify after a worker that is about to wait
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wakeUp.notify_one();
+    }
+}
+
+UploadPool::Task* UploadPool::findTask(std::size_t index)
+{
+    Worker& self = *workers[index];
+    Task* task = nullptr;
+    if (self.deque.pop(task) || self.inbox.tryPop(task))
+    {
+        return task;
+    }
+
+    // Steal oldest work, starting with the next worker so thieves spread out
+    for (std::size_t offset = 1; offset < workers.size(); ++offset)
+    {
+        Worker& victim = *workers[(index + offset) % workers.size()];
+        if (victim.deque.steal(task) || victim.inbox.tryPop(task))
+        {
+            stolenCount.fetch_add(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void UploadPool::run(std::size_t index)
+{
+    currentWorker = {this, index, &workers[index]->connections};
+
+    while (true)
+    {
+        Task* task = findTask(index);
+        if (!task)
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepers.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            // Re-check after announcing the sleep: a concurrent submission is either seen
+            // here or its notify reaches the wait below. Queues are drained before leaving.
+            task = findTask(index);
+            if (!task)
+            {
+                if (stopping.load(std::memory_order_acquire))
+                {
+                    sleepers.fetch_sub(1, std::memory_order_relaxed);
+                    break;
+                }
+                wakeUp.wait_for(lock, kIdleWait);
+            }
+            sleepers.fetch_sub(1, std::memory_order_relaxed);
+            if (!task)
+            {
+                continue;
+            }
+        }
+
+        queuedCount.fetch_sub(1, std::memory_order_relaxed);
+        (*task)();
+        delete task;
+    }
+}
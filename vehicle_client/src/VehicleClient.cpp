@@ -2,11 +2,15 @@
 
 #include <curl/curl.h>
 
-#include <chrono>
-#include <ctime>
-#include <iostream>
-#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <thread>
 
+#include "Logger.hpp"
+#include "RequestArena.hpp"
+#include "ResponseClassifier.hpp"
+#include "TimestampFormatter.hpp"
 #include "json.hpp"
 
 using json = nlohmann::json;
@@ -20,251 +24,1361 @@ size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp)
     return size * nmemb;
 }
 
+// Checks a {"status": "success", ...} style response, only building a DOM to report failures
+bool checkRecordResponse(long statusCode, std::string_view responseBody, bool printContent)
+{
+    std::string content;
+    if (isSuccessResponse(statusCode, responseBody, printContent ? &content : nullptr))
+    {
+        if (printContent)
+        {
+            logInfo() << "Status updated successfully: \"" << content << "\"";
+        }
+        return true;
+    }
+
+    try
+    {
+        // Parse the response JSON
+        auto responseJson = json::parse(responseBody);
+
+        if (responseJson.contains("detail"))
+        {
+            logError() << "Error: " << responseJson["detail"].dump();
+        }
+        else
+        {
+            logError() << "Unexpected response: " << responseBody;
+        }
+    }
+    catch (json::parse_error& e)
+    {
+        logError() << "Failed to parse JSON response: " << e.what();
+        logError() << "Raw response: " << responseBody;
+    }
+    return false;
+}
+
+// Interprets the body returned by /get-vehicle-status/
+std::pair<bool, std::string> parseStatusResponse(long statusCode, std::string_view responseBody)
+{
+    // A successful response is a plain JSON string, so no parse is needed
+    if (isHttpSuccess(statusCode) && responseBody.size() >= 2 && responseBody.front() == '"' &&
+        responseBody.back() == '"')
+    {
+        // Trim the double quotes and return the content as the vehicle status
+        return {true, std::string(responseBody.substr(1, responseBody.size() - 2))};
+    }
+
+    try
+    {
+        // Parse JSON if it's not a simple string
+        auto responseJson = json::parse(responseBody);
+
+        if (responseJson.contains("detail"))
+        {
+            return {false, responseJson["detail"].get<std::string>()};
+        }
+        else
+        {
+            return {false, "Unexpected response format"};
+        }
+    }
+    catch (json::parse_error& e)
+    {
+        return {false, std::string("Failed to parse response: ") + e.what()};
+    }
+}
+
+// The server's cap on vehicles per bulk status request (MAX_BULK_VEHICLES)
+constexpr std::size_t kMaxBulkVehicles = 10000;
+
+// Batches from this size on are encoded while they are sent instead of up front
+constexpr std::size_t kStreamedBatchReadings = 1024;
+
+// Columnar bodies have their own endpoint, every other format shares the batch endpoint
+Endpoint batchEndpoint(WireFormat format)
+{
+    return format == WireFormat::COLUMNAR ? Endpoint::ADD_SENSOR_DATA_COLUMNAR
+                                          : Endpoint::ADD_SENSOR_DATA_BATCH;
+}
+
+// Logs why a sensor data query failed
+void logQueryError(CURLcode res, long statusCode, std::string_view responseBody)
+{
+    if (res != CURLE_OK)
+    {
+        logError() << "Request failed: " << curl_easy_strerror(res);
+        return;
+    }
+    json response = json::parse(responseBody, nullptr, false);
+    if (response.is_object() && response.contains("detail"))
+    {
+        logError() << "Error " << statusCode << ": " << response["detail"].dump();
+    }
+    else
+    {
+        logError() << "Unexpected response " << statusCode << ": " << responseBody;
+    }
+}
+
+// Appends a query parameter holding a capture time in ISO 8601
+void appendTimestamp(std::string& url, std::string_view name, std::uint64_t timestampUs)
+{
+    TimestampFormatter formatter;
+    char timestamp[TimestampFormatter::kLength];
+    url.append("&").append(name).append("=");
+    url.append(timestamp, formatter.format(timestampUs, timestamp));
+}
+
+// URL of a query of one sensor of a vehicle, up to the query string
+std::string sensorQueryUrl(const std::string& endpointUrl, const std::string& vehicleSerial,
+                           SensorType sensorType, std::string_view resource)
+{
+    std::string url = endpointUrl;
+    url.append(vehicleSerial).append("/").append(sensorTypeToString(sensorType)).append(resource);
+    return url;
+}
+
+// Header that lets the server recognise a resent sensor upload
+std::string idempotencyKeyHeader()
+{
+    return "Idempotency-Key: " + RetryPolicy::newIdempotencyKey();
+}
+
+// The same header, kept in the request's arena
+const char* idempotencyKeyHeader(RequestArena& arena)
+{
+    char key[RetryPolicy::kIdempotencyKeyLength];
+    RetryPolicy::newIdempotencyKey(key);
+    return arena.concat({"Idempotency-Key: ", {key, sizeof(key)}});
+}
+
+// Checks a record-style (POST) response from the async transport and whether a failure is
+// worth retrying later
+bool checkAsyncRecordResponse(const HttpResponse& response, bool printContent, bool& transient)
+{
+    if (response.curlCode != CURLE_OK)
+    {
+        logError() << "Request failed: " << curl_easy_strerror(response.curlCode);
+        transient = true;
+        return false;
+    }
+    bool success = checkRecordResponse(response.statusCode, response.body, printContent);
+    transient = !success && isTransientHttpStatus(response.statusCode);
+    return success;
+}
+
+// Adapts a completion that only cares whether the request went through
+Completion<Delivery> onDelivered(Completion<bool> done)
+{
+    return [done = std::move(done)](Delivery delivery)
+    { done(delivery == Delivery::DELIVERED); };
+}
+
+// The same for batch uploads, which also report their latency
+Completion<UploadFeedback> onUploaded(Completion<bool> done)
+{
+    return [done = std::move(done)](UploadFeedback feedback)
+    { done(feedback.delivery == Delivery::DELIVERED); };
+}
+
+// Runs a callback-based operation and returns a future of its result
+template <typename T, typename Submit>
+std::future<T> futureOf(Submit submit)
+{
+    auto promise = std::make_shared<std::promise<T>>();
+    std::future<T> result = promise->get_future();
+    submit([promise](T value) { promise->set_value(std::move(value)); });
+    return result;
+}
+
 }  // unnamed namespace
 
-VehicleClient::VehicleClient(const std::string& baseUrl) : baseUrl(baseUrl)
+VehicleClient::VehicleClient(const std::string& baseUrl) : baseUrl(baseUrl), templates(baseUrl)
 {
-    curl_global_init(CURL_GLOBAL_DEFAULT);
+    connectionPool = std::make_unique<ConnectionPool>();
+    setRetryPolicy(RetryConfig{});
 }
 
 VehicleClient::~VehicleClient()
 {
-    curl_global_cleanup();
+    if (batchBuffer || aggregation)
+    {
+        flush();
+    }
+
+    metricsEndpoint.reset();
+    statusSubscription.reset();
+
+    // Upload workers and in-flight transfers may still spool failed readings, and the spool
+    // drainer sends through the pool, so they go in this order; curlGlobal is released last
+    uploadPool.reset();
+    asyncTransport.reset();
+    spool.reset();
+    connectionPool.reset();
+
+    // Failures of the final uploads should not wait for the writer's next round
+    Logger::instance().flush();
 }
 
 bool VehicleClient::addSensorData(SensorType sensorType, float sensorData,
                                   const std::string& vehicleSerial)
 {
-    std::string timestamp = getCurrentTimestamp();
-    std::string sensorTypeStr = sensorTypeToString(sensorType);
+    return addSensorData({sensorType, sensorData, currentTimeMicros()}, vehicleSerial);
+}
 
-    // Format JSON payload
-    std::string jsonPayload =
-        "{"
-        "\"sensor_type\": \"" +
-        sensorTypeStr +
-        "\","
-        "\"timestamp\": \"" +
-        timestamp +
-        "\","
-        "\"sensor_data\": " +
-        std::to_string(sensorData) +
-        ","
-        "\"vehicle_serial\": \"" +
-        vehicleSerial +
-        "\""
-        "}";
+bool VehicleClient::addSensorData(const SensorReading& reading, const std::string& vehicleSerial)
+{
+    if (!isUploadable(reading))
+    {
+        return false;
+    }
+    if (aggregation)
+    {
+        std::vector<SensorReading> ready;
+        aggregation->process(vehicleSerial, reading, ready);
+        bool success = forwardReadings(ready, vehicleSerial);
 
-    return sendRequest("/add-sensor-data/", jsonPayload);
+        // Windows of slow sensors are closed by age, like quiet vehicles' batches
+        for (auto& [serial, readings] : aggregation->takeDue())
+        {
+            success = forwardReadings(readings, serial) && success;
+        }
+        return success;
+    }
+
+    return forwardReadings({&reading, 1}, vehicleSerial);
 }
 
-std::string VehicleClient::getCurrentTimestamp() const
+bool VehicleClient::isUploadable(const SensorReading& reading)
 {
-    using namespace std::chrono;
-    auto now = system_clock::now();
-    auto now_time_t = system_clock::to_time_t(now);
-    auto now_us = duration_cast<microseconds>(now.time_since_epoch()) % 1000000;
+    if (std::isfinite(reading.value))
+    {
+        return true;
+    }
+    requestMetrics.add(MetricCounter::READINGS_INVALID);
+    logWarning() << "Discarded a non-finite " << sensorTypeToString(reading.sensorType)
+                 << " reading";
+    return false;
+}
 
-    std::ostringstream oss;
-    oss << std::put_time(std::gmtime(&now_time_t), "%Y-%m-%dT%H:%M:%S") << '.' << std::setfill('0')
-        << std::setw(6) << now_us.count() << 'Z';
+std::span<const SensorReading> VehicleClient::uploadableReadings(
+    std::span<const SensorReading> readings, std::vector<SensorReading>& scratch)
+{
+    auto finite = [](const SensorReading& reading) { return std::isfinite(reading.value); };
+    if (std::all_of(readings.begin(), readings.end(), finite))
+    {
+        return readings;
+    }
+    scratch.clear();
+    for (const SensorReading& reading : readings)
+    {
+        if (isUploadable(reading))
+        {
+            scratch.push_back(reading);
+        }
+    }
+    return scratch;
+}
 
-    return oss.str();
+bool VehicleClient::forwardReadings(std::span<const SensorReading> readings,
+                                    const std::string& vehicleSerial)
+{
+    if (!batchBuffer)
+    {
+        return readings.size() == 1 ? sendSensorData(readings.front(), vehicleSerial)
+                                    : addSensorDataBatch(readings, vehicleSerial);
+    }
+
+    bool success = true;
+    for (const SensorReading& reading : readings)
+    {
+        if (batchBuffer->add(vehicleSerial, reading))
+        {
+            std::vector<SensorReading> batch = batchBuffer->take(vehicleSerial);
+            success = addSensorDataBatch(batch, vehicleSerial) && success;
+        }
+    }
+
+    // Readings of quiet vehicles must not wait forever for a size threshold
+    for (auto& [serial, pending] : batchBuffer->takeDue())
+    {
+        success = addSensorDataBatch(pending, serial) && success;
+    }
+    return success;
 }
 
-bool VehicleClient::sendRequest(const std::string& endpoint, const std::string& jsonPayload)
+bool VehicleClient::sendSensorData(const SensorReading& reading, const std::string& vehicleSerial)
 {
-    CURL* curl = curl_easy_init();
-    if (!curl)
+    bool transient = false;
+    if (sendRequest(Endpoint::ADD_SENSOR_DATA, serializer().sensorData(reading, vehicleSerial),
+                    WireFormat::JSON, &transient))
+    {
+        return true;
+    }
+    if (transient)
     {
-        std::cerr << "Failed to initialize CURL" << std::endl;
+        spoolReadings({&reading, 1}, vehicleSerial);
+    }
+    return false;
+}
+
+bool VehicleClient::addSensorDataBatch(std::span<const SensorReading> readings,
+                                       const std::string& vehicleSerial)
+{
+    std::vector<SensorReading> finite;
+    readings = uploadableReadings(readings, finite);
+    if (readings.empty())
+    {
+        return true;
+    }
+    return uploadBatch(readings, vehicleSerial) == Delivery::DELIVERED;
+}
+
+Delivery VehicleClient::uploadBatch(std::span<const SensorReading> readings,
+                                    const std::string& vehicleSerial)
+{
+    Delivery delivery = deliverBatch(readings, vehicleSerial);
+    if (delivery == Delivery::RETRY)
+    {
+        spoolReadings(readings, vehicleSerial);
+    }
+    return delivery;
+}
+
+Delivery VehicleClient::deliverBatch(std::span<const SensorReading> readings,
+                                     const std::string& vehicleSerial)
+{
+    return deliverBatch(std::span<const std::span<const SensorReading>>(&readings, 1),
+                        vehicleSerial);
+}
+
+Delivery VehicleClient::deliverBatch(std::span<const std::span<const SensorReading>> pieces,
+                                     const std::string& vehicleSerial)
+{
+    std::size_t count = 0;
+    for (std::span<const SensorReading> readings : pieces)
+    {
+        count += readings.size();
+    }
+
+    WireFormat format = wireFormat.load(std::memory_order_relaxed);
+    bool transient = false;
+    bool sent;
+    // Compression needs the whole body, so compressed batches are still encoded up front
+    if (count >= kStreamedBatchReadings && !compressor && PayloadSerializer::isStreamable(format))
+    {
+        BatchBodyStream body(pieces, vehicleSerial, format, serializer());
+        sent = sendRequest(batchEndpoint(format), body, format, &transient);
+    }
+    else
+    {
+        std::span<const SensorReading> readings = pieces.empty() ? std::span<const SensorReading>()
+                                                                 : pieces.front();
+        thread_local std::vector<SensorReading> merged;
+        if (pieces.size() > 1)
+        {
+            merged.clear();
+            for (std::span<const SensorReading> piece : pieces)
+            {
+                merged.insert(merged.end(), piece.begin(), piece.end());
+            }
+            readings = merged;
+        }
+        std::string_view payload = serializer().batch(readings, vehicleSerial, format);
+        sent = sendRequest(batchEndpoint(format), payload, format, &transient);
+    }
+
+    if (sent)
+    {
+        return Delivery::DELIVERED;
+    }
+    return transient ? Delivery::RETRY : Delivery::REJECTED;
+}
+
+void VehicleClient::spoolReadings(std::span<const SensorReading> readings,
+                                  const std::string& vehicleSerial)
+{
+    bool kept = spool && spool->append(readings, vehicleSerial);
+    requestMetrics.add(kept ? MetricCounter::READINGS_SPOOLED : MetricCounter::READINGS_DROPPED,
+                       readings.size());
+}
+
+void VehicleClient::setWireFormat(WireFormat format)
+{
+    wireFormat.store(format, std::memory_order_relaxed);
+}
+
+bool VehicleClient::enableCompression(const CompressionConfig& config)
+{
+    if (!BodyCompressor::isSupported(config.algorithm))
+    {
+        logError() << "Compression algorithm not supported by this build";
         return false;
     }
+    compressor = config.algorithm == Compression::NONE ? nullptr
+                                                       : std::make_unique<BodyCompressor>(config);
+    return true;
+}
+
+bool VehicleClient::enableSpool(const SpoolConfig& config)
+{
+    spool.reset();
+    try
+    {
+        spool = std::make_unique<OfflineSpool>(
+            config,
+            [this](std::span<const std::span<const SensorReading>> pieces,
+                   const std::string& serial) { return deliverBatch(pieces, serial); });
+    }
+    catch (const std::runtime_error& e)
+    {
+        logError() << e.what();
+        return false;
+    }
+    return true;
+}
+
+void VehicleClient::setRetryPolicy(const RetryConfig& config)
+{
+    {
+        std::lock_guard<std::mutex> lock(retryPolicyMutex);
+        retryPolicy = retryPolicy ? std::make_shared<RetryPolicy>(config, *retryPolicy)
+                                  : std::make_shared<RetryPolicy>(config);
+    }
+    connectionPool->setTimeouts(config.connectTimeout, config.requestTimeout);
+    if (uploadPool)
+    {
+        uploadPool->setTimeouts(config.connectTimeout, config.requestTimeout);
+    }
+}
+
+void VehicleClient::enableStatusNotifications(const std::vector<std::string>& vehicleSerials)
+{
+    statusSubscription.reset();
+    statusSubscription = std::make_unique<StatusSubscription>(baseUrl, vehicleSerials, statusCache,
+                                                              currentRetryPolicy()->config());
+}
+
+void VehicleClient::enableUploadPool(const UploadPoolConfig& config)
+{
+    // The old workers finish their queued uploads first
+    uploadPool.reset();
+    uploadPool = std::make_unique<UploadPool>(config);
+    std::shared_ptr<RetryPolicy> policy = currentRetryPolicy();
+    uploadPool->setTimeouts(policy->config().connectTimeout, policy->config().requestTimeout);
+}
+
+void VehicleClient::enableBatching(const BatchConfig& config)
+{
+    if (batchBuffer)
+    {
+        flush();
+    }
+    batchBuffer = std::make_unique<BatchBuffer>(config);
+}
+
+void VehicleClient::enableAggregation(const AggregationConfig& config)
+{
+    if (aggregation)
+    {
+        flush();
+    }
+    aggregation = std::make_unique<AggregationPipeline>(config);
+}
+
+bool VehicleClient::flush()
+{
+    bool success = true;
+    if (aggregation)
+    {
+        // Partial windows go first, so their reductions make it into the final batches
+        for (auto& [serial, readings] : aggregation->takeDue(true))
+        {
+            success = forwardReadings(readings, serial) && success;
+        }
+    }
+    if (batchBuffer)
+    {
+        for (auto& [serial, readings] : batchBuffer->takeDue(true))
+        {
+            success = addSensorDataBatch(readings, serial) && success;
+        }
+    }
+    return success;
+}
+
+MetricsSnapshot VehicleClient::metrics() const
+{
+    MetricsSnapshot snapshot = requestMetrics.snapshot();
+    if (uploadPool)
+    {
+        snapshot.uploadQueueDepth = uploadPool->queued();
+    }
+    if (batchBuffer)
+    {
+        snapshot.batchedReadings = batchBuffer->pendingReadings();
+    }
+    if (spool)
+    {
+        // Readings lost from a full spool count as dropped
+        std::uint64_t dropped = spool->dropped();
+        std::uint64_t settled = spool->replayed() + dropped;
+        snapshot.spoolBacklog = spool->spooled() > settled ? spool->spooled() - settled : 0;
+        snapshot.counters[static_cast<std::size_t>(MetricCounter::READINGS_DROPPED)] += dropped;
+    }
+    return snapshot;
+}
+
+bool VehicleClient::enableMetricsEndpoint(const MetricsEndpointConfig& config)
+{
+    metricsEndpoint.reset();
+    try
+    {
+        metricsEndpoint =
+            std::make_unique<MetricsEndpoint>(config, [this] { return metrics().toPrometheus(); });
+    }
+    catch (const std::runtime_error& e)
+    {
+        logError() << e.what();
+        return false;
+    }
+    return true;
+}
+
+void VehicleClient::prewarm(std::size_t connections)
+{
+    for (std::size_t i = 0; i < connections; ++i)
+    {
+        HttpRequest request;
+        request.url = baseUrl + "/";
+        transport().submit(std::move(request),
+                           [](const HttpResponse& response)
+                           {
+                               if (response.curlCode != CURLE_OK)
+                               {
+                                   logWarning() << "Could not open a connection ahead of time: "
+                                                << curl_easy_strerror(response.curlCode);
+                               }
+                           });
+    }
+}
+
+void VehicleClient::abortRequestsAt(std::chrono::steady_clock::time_point deadline)
+{
+    connectionPool->abortTransfersAt(deadline);
+    if (uploadPool)
+    {
+        uploadPool->abortTransfersAt(deadline);
+    }
+    transport().abortAt(deadline);
+}
+
+bool VehicleClient::sendRequest(Endpoint endpoint, std::string_view payload, WireFormat format,
+                                bool* transient)
+{
+    return post(endpoint, transient, nullptr,
+                [&](CURL* curl, RequestArena& /*arena*/)
+                {
+                    curl_slist* headers = bodyHeaders(format, payload);
+                    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE,
+                                     static_cast<long>(payload.size()));
+                    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload.data());
+                    return headers;
+                });
+}
+
+bool VehicleClient::sendRequest(Endpoint endpoint, BatchBodyStream& body, WireFormat format,
+                                bool* transient)
+{
+    return post(endpoint, transient, &body,
+                [&](CURL* curl, RequestArena& arena)
+                {
+                    body.attach(curl);
+                    // Waiting for 100 Continue before a body of unknown size costs a round trip
+                    return arena.prepend("Expect:", templates.headers(format));
+                });
+}
+
+template <typename SetBody>
+bool VehicleClient::post(Endpoint endpoint, bool* transient, BatchBodyStream* body,
+                         SetBody setBody)
+{
+    ConnectionPool::Handle handle = connections().acquire();
+    if (!handle)
+    {
+        logError() << "Failed to initialize CURL";
+        return false;
+    }
+    CURL* curl = handle.get();
+    RequestArena& arena = RequestArena::local();
+    RequestArena::Scope scope(arena);
 
     CURLcode res;
-    std::string url = baseUrl + endpoint;
-    std::string responseString;
+    std::string& responseString = handle.responseBuffer();
 
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    struct curl_slist* headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
+    curl_easy_setopt(curl, CURLOPT_URL, templates.url(endpoint).c_str());
+    curl_slist* headers = setBody(curl, arena);
+    // Without a dedupe key a resent upload could be recorded twice, so it is sent only once
+    std::shared_ptr<RetryPolicy> policy = currentRetryPolicy();
+    bool idempotent = policy->config().idempotencyKeys;
+    if (idempotent)
+    {
+        headers = arena.prepend(idempotencyKeyHeader(arena), headers);
+    }
     curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, jsonPayload.c_str());
 
     // Set the write callback to capture response data
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseString);
 
-    res = curl_easy_perform(curl);
+    long statusCode = 0;
+    res = perform(*policy, curl, responseString, idempotent, statusCode, body);
     bool success = false;
+    bool transientFailure = true;
 
     if (res != CURLE_OK)
     {
-        std::cerr << "Request failed: " << curl_easy_strerror(res) << std::endl;
+        logError() << "Request failed: " << curl_easy_strerror(res);
     }
     else
     {
-        try
-        {
-            // Parse the response JSON
-            auto responseJson = json::parse(responseString);
-
-            if (responseJson.contains("status") && responseJson["status"] == "success")
-            {
-                success = true;
-            }
-            else if (responseJson.contains("detail"))
-            {
-                std::cerr << "Error: " << responseJson["detail"] << std::endl;
-            }
-            else
-            {
-                std::cerr << "Unexpected response: " << responseString << std::endl;
-            }
-        }
-        catch (json::parse_error& e)
-        {
-            std::cerr << "Failed to parse JSON response: " << e.what() << std::endl;
-            std::cerr << "Raw response: " << responseString << std::endl;
-        }
+        success = checkRecordResponse(statusCode, responseString, false);
+        transientFailure = !success && isTransientHttpStatus(statusCode);
+    }
+    if (transient)
+    {
+        *transient = transientFailure;
     }
 
-    // Clean up
-    curl_easy_cleanup(curl);
-    curl_slist_free_all(headers);
-
+    // The headers live in the templates and the arena, the handle goes back to the pool
     return success;
 }
 
 std::pair<bool, std::string> VehicleClient::getVehicleStatus(const std::string& vehicleSerial)
 {
-    CURL* curl = curl_easy_init();
-    if (!curl)
+    std::string status;
+    if (statusCache.confirmed(vehicleSerial, status))
+    {
+        return {true, status};
+    }
+    StatusCache::Entry cached;
+    bool revalidate = statusCache.lookup(vehicleSerial, cached) && !cached.etag.empty();
+    std::uint64_t token = statusCache.beginRequest();
+
+    ConnectionPool::Handle handle = connections().acquire();
+    if (!handle)
     {
         throw std::runtime_error("Failed to initialize CURL");
     }
+    CURL* curl = handle.get();
+    RequestArena& arena = RequestArena::local();
+    RequestArena::Scope scope(arena);
 
-    std::string responseString;
-    std::string url = baseUrl + "/get-vehicle-status/?vehicle_serial=" + vehicleSerial;
+    std::string& responseString = handle.responseBuffer();
+    const char* url = arena.concat({templates.url(Endpoint::GET_VEHICLE_STATUS), vehicleSerial});
+
+    // Ask the server to skip the body if the cached status is still current
+    curl_slist* headers = nullptr;
+    if (revalidate)
+    {
+        headers = arena.prepend(arena.concat({"If-None-Match: ", cached.etag}), nullptr);
+    }
 
     // Configure CURL
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_URL, url);
     curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseString);
 
-    // Perform request
-    CURLcode res = curl_easy_perform(curl);
+    // Perform request, a status query is always safe to repeat
+    long statusCode = 0;
+    CURLcode res = perform(*currentRetryPolicy(), curl, responseString, true, statusCode);
 
     if (res != CURLE_OK)
     {
-        curl_easy_cleanup(curl);
         return {false, std::string("Request failed: ") + curl_easy_strerror(res)};
     }
 
-    // Clean up CURL
-    curl_easy_cleanup(curl);
+    struct curl_header* etag = nullptr;
+    return readStatusResponse(
+        vehicleSerial, revalidate ? &cached : nullptr, token, statusCode, responseString,
+        curl_easy_header(curl, "ETag", 0, CURLH_HEADER, -1, &etag) == CURLHE_OK ? etag->value : "");
+}
 
-    try
+std::pair<bool, std::string> VehicleClient::readStatusResponse(
+    const std::string& vehicleSerial, const StatusCache::Entry* revalidated, std::uint64_t token,
+    long statusCode, std::string_view body, std::string_view etag)
+{
+    if (statusCode == 304 && revalidated)
+    {
+        statusCache.storeResponse(vehicleSerial, *revalidated, token);
+        return {true, revalidated->status};
+    }
+
+    std::pair<bool, std::string> result = parseStatusResponse(statusCode, body);
+    if (result.first && !etag.empty())
     {
-        // Check if responseString is a JSON object or a simple string
-        if (responseString.front() == '"' && responseString.back() == '"')
+        statusCache.storeResponse(vehicleSerial, {result.second, std::string(etag)}, token);
+    }
+    return result;
+}
+
+bool VehicleClient::updateVehicleStatus(const std::string& vehicleSerial, VehicleStatus status)
+{
+    ConnectionPool::Handle handle = connections().acquire();
+    if (!handle)
+    {
+        logError() << "Failed to initialize CURL";
+        return false;
+    }
+    CURL* curl = handle.get();
+
+    std::string& responseString = handle.responseBuffer();
+
+    std::string_view jsonPayload = serializer().status(vehicleSerial, status);
+
+    // Set CURL options
+    curl_easy_setopt(curl, CURLOPT_URL, templates.url(Endpoint::UPDATE_VEHICLE_STATUS).c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, templates.headers(WireFormat::JSON));
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(jsonPayload.size()));
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, jsonPayload.data());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseString);
+
+    // Perform the request, setting the same status twice is harmless
+    long statusCode = 0;
+    CURLcode res = perform(*currentRetryPolicy(), curl, responseString, true, statusCode);
+    bool success = false;
+
+    if (res == CURLE_OK)
+    {
+        success = checkRecordResponse(statusCode, responseString, true);
+    }
+    else
+    {
+        logError() << "Request failed: " << curl_easy_strerror(res);
+    }
+
+    // Even a failed update may have been applied, so the next query asks the server
+    statusCache.invalidate(vehicleSerial);
+    return success;
+}
+
+std::vector<std::pair<bool, std::string>> VehicleClient::getVehicleStatuses(
+    std::span<const std::string> vehicleSerials)
+{
+    std::vector<std::pair<bool, std::string>> results(vehicleSerials.size());
+    std::vector<std::size_t> missed;
+    for (std::size_t i = 0; i < vehicleSerials.size(); ++i)
+    {
+        if (statusCache.confirmed(vehicleSerials[i], results[i].second))
         {
-            // Trim the double quotes and return the content as the vehicle status
-            std::string status = responseString.substr(1, responseString.size() - 2);
-            return {true, status};
+            results[i].first = true;
         }
         else
         {
-            // Parse JSON if it's not a simple string
-            auto responseJson = json::parse(responseString);
+            missed.push_back(i);
+        }
+    }
+
+    std::vector<std::string> chunk;
+    std::string response;
+    for (std::size_t start = 0; start < missed.size(); start += kMaxBulkVehicles)
+    {
+        std::span<const std::size_t> indices(missed.data() + start,
+                                             std::min(kMaxBulkVehicles, missed.size() - start));
+        chunk.clear();
+        for (std::size_t index : indices)
+        {
+            chunk.push_back(vehicleSerials[index]);
+        }
 
-            if (responseJson.contains("detail"))
+        std::uint64_t token = statusCache.beginRequest();
+        long statusCode = 0;
+        CURLcode res = postIdempotent(Endpoint::GET_VEHICLE_STATUSES,
+                                      serializer().vehicleSerials(chunk), statusCode, response);
+
+        json statuses = res == CURLE_OK ? json::parse(response, nullptr, false) : json();
+        if (res != CURLE_OK || !isHttpSuccess(statusCode) || !statuses.is_object())
+        {
+            std::string error = res != CURLE_OK
+                                    ? std::string("Request failed: ") + curl_easy_strerror(res)
+                                    : "Unexpected response: " + response;
+            for (std::size_t index : indices)
             {
-                return {false, responseJson["detail"].get<std::string>()};
+                results[index] = {false, error};
             }
-            else
+            continue;
+        }
+
+        for (std::size_t index : indices)
+        {
+            const std::string& vehicleSerial = vehicleSerials[index];
+            auto status = statuses.find(vehicleSerial);
+            if (status == statuses.end() || !status->is_string())
             {
-                return {false, "Unexpected response format"};
+                results[index] = {false, "Vehicle " + vehicleSerial + " not registered"};
+                continue;
             }
+            results[index] = {true, status->get<std::string>()};
+            statusCache.storeResponse(vehicleSerial, {results[index].second, ""}, token);
         }
     }
-    catch (json::parse_error& e)
+    return results;
+}
+
+bool VehicleClient::updateVehicleStatuses(
+    std::span<const std::pair<std::string, VehicleStatus>> updates)
+{
+    bool success = true;
+    std::string response;
+    for (std::size_t start = 0; start < updates.size(); start += kMaxBulkVehicles)
     {
-        return {false, std::string("Failed to parse response: ") + e.what()};
+        auto chunk = updates.subspan(start, std::min(kMaxBulkVehicles, updates.size() - start));
+        long statusCode = 0;
+        CURLcode res = postIdempotent(Endpoint::UPDATE_VEHICLE_STATUSES,
+                                      serializer().statusBatch(chunk), statusCode, response);
+
+        // Even a failed update may have been applied, so the next queries ask the server
+        for (const auto& update : chunk)
+        {
+            statusCache.invalidate(update.first);
+        }
+
+        if (res != CURLE_OK)
+        {
+            logError() << "Request failed: " << curl_easy_strerror(res);
+            success = false;
+            continue;
+        }
+        if (!checkRecordResponse(statusCode, response, false))
+        {
+            success = false;
+            continue;
+        }
+
+        json result = json::parse(response, nullptr, false);
+        if (result.is_object() && result.contains("unknown_vehicles") &&
+            !result["unknown_vehicles"].empty())
+        {
+            logError() << "Vehicles not registered: " << result["unknown_vehicles"].dump();
+            success = false;
+        }
     }
+    return success;
 }
 
-bool VehicleClient::updateVehicleStatus(const std::string& vehicleSerial, VehicleStatus status)
+bool VehicleClient::querySensorData(
+    const std::string& vehicleSerial, const SensorQuery& query,
+    const std::function<bool(std::span<const SensorReading>)>& onPage)
+{
+    std::string base = sensorQueryUrl(templates.url(Endpoint::QUERY_SENSOR_DATA), vehicleSerial,
+                                      query.sensorType, "?limit=");
+    base.append(std::to_string(std::max<std::size_t>(query.pageReadings, 1)));
+    if (query.fromUs != 0)
+    {
+        appendTimestamp(base, "start", query.fromUs);
+    }
+    if (query.untilUs != 0)
+    {
+        appendTimestamp(base, "end", query.untilUs);
+    }
+
+    std::vector<SensorReading> readings;
+    std::string response;
+    std::string cursor;
+    std::string url;
+    do
+    {
+        url = base;
+        if (!cursor.empty())
+        {
+            url.append("&cursor=").append(cursor);
+        }
+
+        long statusCode = 0;
+        CURLcode res = fetch(url.c_str(), statusCode, response);
+        json page = res == CURLE_OK && isHttpSuccess(statusCode)
+                        ? json::parse(response, nullptr, false)
+                        : json();
+        if (!page.is_object() || !page["timestamps"].is_array() || !page["values"].is_array() ||
+            page["timestamps"].size() != page["values"].size())
+        {
+            logQueryError(res, statusCode, response);
+            return false;
+        }
+
+        const json& timestamps = page["timestamps"];
+        const json& values = page["values"];
+        readings.clear();
+        for (std::size_t i = 0; i < timestamps.size(); ++i)
+        {
+            if (!timestamps[i].is_number_unsigned() || !values[i].is_number())
+            {
+                logQueryError(res, statusCode, response);
+                return false;
+            }
+            readings.push_back(
+                {query.sensorType, values[i].get<float>(), timestamps[i].get<std::uint64_t>()});
+        }
+        if (!readings.empty() && !onPage(readings))
+        {
+            return true;
+        }
+
+        const json& next = page["next_cursor"];
+        cursor = next.is_string() ? next.get<std::string>() : std::string();
+    } while (!cursor.empty());
+    return true;
+}
+
+bool VehicleClient::querySensorData(const std::string& vehicleSerial, const SensorQuery& query,
+                                    std::chrono::seconds bucketWidth,
+                                    std::vector<SensorBucket>& buckets)
 {
-    CURL* curl = curl_easy_init();
-    if (!curl)
+    buckets.clear();
+    std::string url = sensorQueryUrl(templates.url(Endpoint::QUERY_SENSOR_DATA), vehicleSerial,
+                                     query.sensorType, "/buckets?bucket_seconds=");
+    url.append(std::to_string(std::max<std::int64_t>(bucketWidth.count(), 1)));
+    // The server needs both bounds
+    appendTimestamp(url, "start", query.fromUs);
+    appendTimestamp(url, "end", query.untilUs != 0 ? query.untilUs : currentTimeMicros());
+
+    std::string response;
+    long statusCode = 0;
+    CURLcode res = fetch(url.c_str(), statusCode, response);
+    json result = res == CURLE_OK && isHttpSuccess(statusCode)
+                      ? json::parse(response, nullptr, false)
+                      : json();
+    const char* columns[] = {"starts", "counts", "minimum", "maximum", "average"};
+    bool valid = result.is_object();
+    for (const char* column : columns)
     {
-        std::cerr << "Failed to initialize CURL" << std::endl;
+        valid = valid && result[column].is_array() &&
+                result[column].size() == result["starts"].size();
+    }
+    if (!valid)
+    {
+        logQueryError(res, statusCode, response);
         return false;
     }
 
-    std::string url = baseUrl + "/update-vehicle-status/";
-    std::string responseString;
+    const json& starts = result["starts"];
+    const json& counts = result["counts"];
+    const json& minimums = result["minimum"];
+    const json& maximums = result["maximum"];
+    const json& averages = result["average"];
+    buckets.reserve(starts.size());
+    for (std::size_t i = 0; i < starts.size(); ++i)
+    {
+        if (!starts[i].is_number_unsigned() || !counts[i].is_number_unsigned() ||
+            !minimums[i].is_number() || !maximums[i].is_number() || !averages[i].is_number())
+        {
+            buckets.clear();
+            logQueryError(res, statusCode, response);
+            return false;
+        }
+        buckets.push_back({starts[i].get<std::uint64_t>(), counts[i].get<std::uint64_t>(),
+                           minimums[i].get<float>(), maximums[i].get<float>(),
+                           averages[i].get<float>()});
+    }
+    return true;
+}
 
-    // Prepare the JSON payload
-    json jsonPayload;
-    jsonPayload["vehicle_serial"] = vehicleSerial;
-    jsonPayload["vehicle_status"] = vehicleStatusToString(status);
+CURLcode VehicleClient::fetch(const char* url, long& statusCode, std::string& response)
+{
+    ConnectionPool::Handle handle = connections().acquire();
+    if (!handle)
+    {
+        return CURLE_FAILED_INIT;
+    }
+    CURL* curl = handle.get();
 
-    // Convert JSON payload to string
-    std::string jsonPayloadStr = jsonPayload.dump();
+    std::string& responseString = handle.responseBuffer();
 
-    struct curl_slist* headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
+    curl_easy_setopt(curl, CURLOPT_URL, url);
+    curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, nullptr);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseString);
 
-    // Set CURL options
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, jsonPayloadStr.c_str());
+    // A query is always safe to repeat
+    CURLcode res = perform(*currentRetryPolicy(), curl, responseString, true, statusCode);
+    response = responseString;
+    return res;
+}
+
+CURLcode VehicleClient::postIdempotent(Endpoint endpoint, std::string_view payload,
+                                       long& statusCode, std::string& response)
+{
+    ConnectionPool::Handle handle = connections().acquire();
+    if (!handle)
+    {
+        return CURLE_FAILED_INIT;
+    }
+    CURL* curl = handle.get();
+
+    std::string& responseString = handle.responseBuffer();
+
+    curl_easy_setopt(curl, CURLOPT_URL, templates.url(endpoint).c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, bodyHeaders(WireFormat::JSON, payload));
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(payload.size()));
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload.data());
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseString);
 
-    // Perform the request
-    CURLcode res = curl_easy_perform(curl);
-    bool success = false;
+    CURLcode res = perform(*currentRetryPolicy(), curl, responseString, true, statusCode);
+    response = responseString;
+    return res;
+}
 
-    if (res == CURLE_OK)
+std::shared_ptr<RetryPolicy> VehicleClient::currentRetryPolicy() const
+{
+    std::lock_guard<std::mutex> lock(retryPolicyMutex);
+    return retryPolicy;
+}
+
+CURLcode VehicleClient::perform(RetryPolicy& policy, CURL* curl, std::string& responseBuffer,
+                                bool idempotent, long& statusCode, BatchBodyStream* body)
+{
+    for (int attempt = 1;; ++attempt)
     {
-        try
+        statusCode = 0;
+        if (!policy.breaker().allowRequest())
         {
-            // Parse the response JSON
-            auto responseJson = json::parse(responseString);
+            requestMetrics.add(MetricCounter::BREAKER_REJECTIONS);
+            requestMetrics.recordRequest(false);
+            return CURLE_COULDNT_CONNECT;
+        }
 
-            if (responseJson.contains("status") && responseJson["status"] == "success")
-            {
-                std::cout << "Status updated successfully: " << responseJson["content"]
-                          << std::endl;
-                success = true;
-            }
-            else if (responseJson.contains("detail"))
+        responseBuffer.clear();
+        if (body)
+        {
+            body->rewind();
+        }
+        CURLcode res = curl_easy_perform(curl);
+        requestMetrics.recordAttempt(curl);
+        curl_off_t retryAfter = 0;
+        if (res == CURLE_OK)
+        {
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &statusCode);
+            curl_easy_getinfo(curl, CURLINFO_RETRY_AFTER, &retryAfter);
+        }
+
+        if (res == CURLE_OK && !isTransientHttpStatus(statusCode))
+        {
+            policy.breaker().recordSuccess();
+            requestMetrics.recordRequest(isHttpSuccess(statusCode));
+            return res;
+        }
+        policy.breaker().recordFailure();
+
+        // A retry that cannot finish before the abort deadline is not started
+        std::chrono::milliseconds delay;
+        if (!policy.retryDelay(attempt, idempotent, std::chrono::seconds(retryAfter), delay) ||
+            std::chrono::steady_clock::now() + delay >= connections().abortDeadline())
+        {
+            requestMetrics.recordRequest(false);
+            return res;
+        }
+        requestMetrics.add(MetricCounter::RETRIES);
+        std::this_thread::sleep_for(delay);
+    }
+}
+
+curl_slist* VehicleClient::bodyHeaders(WireFormat format, std::string_view& payload) const
+{
+    if (compressor && compressor->compress(payload, payload))
+    {
+        return templates.headers(format, compressor->algorithm());
+    }
+    return templates.headers(format);
+}
+
+ConnectionPool& VehicleClient::connections()
+{
+    ConnectionPool* own = UploadPool::currentConnectionPool();
+    return own ? *own : *connectionPool;
+}
+
+PayloadSerializer& VehicleClient::serializer()
+{
+    // One reusable buffer per thread keeps serialization allocation-free and lock-free
+    thread_local PayloadSerializer threadSerializer;
+    return threadSerializer;
+}
+
+AsyncTransport& VehicleClient::transport()
+{
+    // The event loop thread is only started once the first async call is made
+    std::call_once(asyncTransportInit,
+                   [this]
+                   {
+                       asyncTransport =
+                           std::make_unique<AsyncTransport>(*connectionPool, requestMetrics);
+                   });
+    return *asyncTransport;
+}
+
+void VehicleClient::postAsync(Endpoint endpoint, std::string_view payload, bool printContent,
+                              Completion<Delivery> done, WireFormat format,
+                              std::function<void()> onTransientFailure, bool idempotent)
+{
+    HttpRequest request;
+    request.url = templates.url(endpoint);
+    request.post = true;
+    request.sharedHeaders = bodyHeaders(format, payload);
+    request.retryPolicy = currentRetryPolicy();
+    if (!idempotent && request.retryPolicy->config().idempotencyKeys)
+    {
+        request.headers.push_back(idempotencyKeyHeader());
+        idempotent = true;
+    }
+    request.body = payload;
+    request.idempotent = idempotent;
+
+    transport().submit(
+        std::move(request),
+        [done = std::move(done), printContent, onTransientFailure = std::move(onTransientFailure)](
+            const HttpResponse& response)
+        {
+            bool transient = false;
+            if (checkAsyncRecordResponse(response, printContent, transient))
             {
-                std::cerr << "Error: " << responseJson["detail"] << std::endl;
+                done(Delivery::DELIVERED);
+                return;
             }
-            else
+            if (transient && onTransientFailure)
             {
-                std::cerr << "Unexpected response: " << responseString << std::endl;
+                onTransientFailure();
             }
+            done(transient ? Delivery::RETRY : Delivery::REJECTED);
+        });
+}
+
+void VehicleClient::submitSensorData(const SensorReading& reading,
+                                     const std::string& vehicleSerial, Completion<bool> done)
+{
+    if (!isUploadable(reading))
+    {
+        done(false);
+        return;
+    }
+    if (aggregation)
+    {
+        std::vector<SensorReading> ready;
+        aggregation->process(vehicleSerial, reading, ready);
+        for (auto& [serial, readings] : aggregation->takeDue())
+        {
+            submitSensorDataBatch(readings, serial, [](UploadFeedback) {});
         }
-        catch (json::parse_error& e)
+        if (!ready.empty())
         {
-            std::cerr << "Failed to parse JSON response: " << e.what() << std::endl;
-            std::cerr << "Raw response: " << responseString << std::endl;
+            submitSensorDataBatch(ready, vehicleSerial, onUploaded(std::move(done)));
+            return;
         }
+
+        // Held in a window, it is uploaded as part of the window's reduction
+        done(true);
+        return;
+    }
+
+    if (uploadPool)
+    {
+        uploadPool->submit([this, done = std::move(done), reading, vehicleSerial]
+                           { done(sendSensorData(reading, vehicleSerial)); });
+        return;
+    }
+
+    std::function<void()> onTransientFailure;
+    if (spool)
+    {
+        onTransientFailure = [this, reading, vehicleSerial]
+        { spoolReadings({&reading, 1}, vehicleSerial); };
     }
     else
     {
-        std::cerr << "Request failed: " << curl_easy_strerror(res) << std::endl;
+        onTransientFailure = [this] { requestMetrics.add(MetricCounter::READINGS_DROPPED); };
     }
+    postAsync(Endpoint::ADD_SENSOR_DATA, serializer().sensorData(reading, vehicleSerial), false,
+              onDelivered(std::move(done)), WireFormat::JSON, std::move(onTransientFailure));
+}
 
-    // Clean up
-    curl_easy_cleanup(curl);
-    curl_slist_free_all(headers);
+void VehicleClient::submitSensorDataBatch(std::span<const SensorReading> readings,
+                                          const std::string& vehicleSerial,
+                                          Completion<UploadFeedback> done)
+{
+    auto submitted = std::chrono::steady_clock::now();
+    auto since = [submitted]
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - submitted);
+    };
+    std::vector<SensorReading> finite;
+    readings = uploadableReadings(readings, finite);
+    if (readings.empty())
+    {
+        done({Delivery::DELIVERED, since()});
+        return;
+    }
 
-    return success;
+    if (uploadPool)
+    {
+        // Serialization happens on the worker, so the readings travel with the task
+        uploadPool->submit(
+            [this, done = std::move(done),
+             pending = std::vector<SensorReading>(readings.begin(), readings.end()),
+             vehicleSerial, since]
+            {
+                Delivery delivery = uploadBatch(pending, vehicleSerial);
+                done({delivery, since()});
+            });
+        return;
+    }
+
+    // The readings only need to be kept if the upload may have to be spooled
+    std::function<void()> onTransientFailure;
+    if (spool)
+    {
+        onTransientFailure =
+            [this, pending = std::vector<SensorReading>(readings.begin(), readings.end()),
+             vehicleSerial] { spoolReadings(pending, vehicleSerial); };
+    }
+    else
+    {
+        onTransientFailure = [this, count = readings.size()]
+        { requestMetrics.add(MetricCounter::READINGS_DROPPED, count); };
+    }
+    WireFormat format = wireFormat.load(std::memory_order_relaxed);
+    postAsync(batchEndpoint(format), serializer().batch(readings, vehicleSerial, format), false,
+              [done = std::move(done), since](Delivery delivery) { done({delivery, since()}); },
+              format, std::move(onTransientFailure));
+}
+
+void VehicleClient::submitStatusQuery(const std::string& vehicleSerial,
+                                      Completion<std::pair<bool, std::string>> done)
+{
+    std::string status;
+    if (statusCache.confirmed(vehicleSerial, status))
+    {
+        done({true, std::move(status)});
+        return;
+    }
+    auto cached = std::make_shared<StatusCache::Entry>();
+    bool revalidate = statusCache.lookup(vehicleSerial, *cached) && !cached->etag.empty();
+    std::uint64_t token = statusCache.beginRequest();
+
+    HttpRequest request;
+    request.url = templates.url(Endpoint::GET_VEHICLE_STATUS) + vehicleSerial;
+    request.idempotent = true;
+    request.retryPolicy = currentRetryPolicy();
+    if (revalidate)
+    {
+        request.headers.push_back("If-None-Match: " + cached->etag);
+    }
+
+    transport().submit(
+        std::move(request),
+        [this, done = std::move(done), vehicleSerial, cached = revalidate ? cached : nullptr,
+         token](const HttpResponse& response)
+        {
+            if (response.curlCode != CURLE_OK)
+            {
+                done({false,
+                      std::string("Request failed: ") + curl_easy_strerror(response.curlCode)});
+                return;
+            }
+            done(readStatusResponse(vehicleSerial, cached.get(), token, response.statusCode,
+                                    response.body, response.etag));
+        });
+}
+
+void VehicleClient::submitStatusUpdate(const std::string& vehicleSerial, VehicleStatus status,
+                                       Completion<bool> done)
+{
+    statusCache.invalidate(vehicleSerial);
+    postAsync(Endpoint::UPDATE_VEHICLE_STATUS, serializer().status(vehicleSerial, status), true,
+              onDelivered(std::move(done)), WireFormat::JSON, {}, true);
+}
+
+std::future<bool> VehicleClient::addSensorDataAsync(SensorType sensorType, float sensorData,
+                                                    const std::string& vehicleSerial)
+{
+    return addSensorDataAsync({sensorType, sensorData, currentTimeMicros()}, vehicleSerial);
+}
+
+std::future<bool> VehicleClient::addSensorDataAsync(const SensorReading& reading,
+                                                    const std::string& vehicleSerial)
+{
+    return futureOf<bool>([&](Completion<bool> done)
+                          { submitSensorData(reading, vehicleSerial, std::move(done)); });
+}
+
+std::future<bool> VehicleClient::addSensorDataBatchAsync(std::span<const SensorReading> readings,
+                                                         const std::string& vehicleSerial)
+{
+    return futureOf<bool>(
+        [&](Completion<bool> done)
+        { submitSensorDataBatch(readings, vehicleSerial, onUploaded(std::move(done))); });
+}
+
+std::future<UploadFeedback> VehicleClient::uploadSensorDataBatchAsync(
+    std::span<const SensorReading> readings, const std::string& vehicleSerial)
+{
+    return futureOf<UploadFeedback>(
+        [&](Completion<UploadFeedback> done)
+        { submitSensorDataBatch(readings, vehicleSerial, std::move(done)); });
+}
+
+std::future<std::pair<bool, std::string>> VehicleClient::getVehicleStatusAsync(
+    const std::string& vehicleSerial)
+{
+    return futureOf<std::pair<bool, std::string>>(
+        [&](Completion<std::pair<bool, std::string>> done)
+        { submitStatusQuery(vehicleSerial, std::move(done)); });
+}
+
+std::future<bool> VehicleClient::updateVehicleStatusAsync(const std::string& vehicleSerial,
+                                                          VehicleStatus status)
+{
+    return futureOf<bool>([&](Completion<bool> done)
+                          { submitStatusUpdate(vehicleSerial, status, std::move(done)); });
+}
+
+Task<bool> VehicleClient::addSensorDataTask(SensorType sensorType, float sensorData,
+                                            std::string vehicleSerial)
+{
+    co_return co_await addSensorDataTask({sensorType, sensorData, currentTimeMicros()},
+                                         std::move(vehicleSerial));
+}
+
+Task<bool> VehicleClient::addSensorDataTask(SensorReading reading, std::string vehicleSerial)
+{
+    co_return co_await awaitCompletion<bool>(
+        [&](Completion<bool> done) { submitSensorData(reading, vehicleSerial, std::move(done)); });
+}
+
+Task<bool> VehicleClient::addSensorDataBatchTask(std::vector<SensorReading> readings,
+                                                 std::string vehicleSerial)
+{
+    co_return co_await awaitCompletion<bool>(
+        [&](Completion<bool> done)
+        { submitSensorDataBatch(readings, vehicleSerial, onUploaded(std::move(done))); });
+}
+
+Task<std::pair<bool, std::string>> VehicleClient::getVehicleStatusTask(std::string vehicleSerial)
+{
+    co_return co_await awaitCompletion<std::pair<bool, std::string>>(
+        [&](Completion<std::pair<bool, std::string>> done)
+        { submitStatusQuery(vehicleSerial, std::move(done)); });
+}
+
+Task<bool> VehicleClient::updateVehicleStatusTask(std::string vehicleSerial, VehicleStatus status)
+{
+    co_return co_await awaitCompletion<bool>(
+        [&](Completion<bool> done)
+        { submitStatusUpdate(vehicleSerial, status, std::move(done)); });
 }
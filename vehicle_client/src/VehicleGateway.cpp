@@ -0,0 +1,238 @@
+#include "VehicleGateway.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <span>
+#include <utility>
+
+#include "TimestampFormatter.hpp"
+#include "VehicleClient.hpp"
+
+namespace
+{
+// How long a worker sleeps when it found nothing to do
+constexpr auto kIdleSleep = std::chrono::milliseconds(1);
+
+// Records a worker takes from its queue before it looks at due batches and uploads again
+constexpr std::size_t kMaxDrainPerPass = 4096;
+
+using Clock = std::chrono::steady_clock;
+
+// Readings of one vehicle waiting for upload, owned by a single worker
+struct PendingBatch
+{
+    std::vector<SensorReading> readings;
+    Clock::time_point firstAdded;  ///< When the oldest pending reading arrived.
+    bool ready = false;            ///< Queued in the worker's ready list.
+};
+
+// An upload handed to the client's event loop
+struct Upload
+{
+    std::future<UploadFeedback> result;
+    std::size_t readings;
+    std::uint64_t ticket;  ///< The scheduler's ticket for the upload.
+};
+
+// Bounds that hold the fixed limits of a non-adaptive gateway in place
+FlushSchedulerConfig fixedLimits(const GatewayConfig& config)
+{
+    FlushSchedulerConfig limits;
+    limits.minBatchReadings = limits.maxBatchReadings = config.maxBatchReadings;
+    limits.minLinger = limits.maxLinger = config.linger;
+    limits.minInFlight = limits.maxInFlight = config.maxInFlightPerWorker;
+    return limits;
+}
+
+}  // unnamed namespace
+
+VehicleGateway::VehicleGateway(VehicleClient& client, const GatewayConfig& config)
+    : client(client), config(config)
+{
+    std::size_t workerCount = config.workerThreads;
+    if (workerCount == 0)
+    {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    this->config.maxBatchReadings = std::max<std::size_t>(config.maxBatchReadings, 1);
+    this->config.maxInFlightPerWorker = std::max<std::size_t>(config.maxInFlightPerWorker, 1);
+
+    FlushSchedulerConfig limits =
+        this->config.adaptive ? this->config.adaptiveLimits : fixedLimits(this->config);
+    shards.reserve(workerCount);
+    for (std::size_t i = 0; i < workerCount; ++i)
+    {
+        shards.push_back(std::make_unique<Shard>(this->config, limits));
+    }
+    for (auto& shard : shards)
+    {
+        shard->worker = std::thread(&VehicleGateway::run, this, std::ref(*shard));
+    }
+}
+
+VehicleGateway::~VehicleGateway()
+{
+    running.store(false, std::memory_order_release);
+    for (auto& shard : shards)
+    {
+        shard->worker.join();
+    }
+}
+
+bool VehicleGateway::push(VehicleId vehicle, const SensorReading& reading)
+{
+    if (vehicle >= registry.size())
+    {
+        return false;
+    }
+    return shards[vehicle % shards.size()]->queue.push({vehicle, reading});
+}
+
+bool VehicleGateway::push(VehicleId vehicle, SensorType sensorType, float value)
+{
+    return push(vehicle, {sensorType, value, currentTimeMicros()});
+}
+
+std::uint64_t VehicleGateway::congestionEvents() const
+{
+    std::uint64_t total = 0;
+    for (const auto& shard : shards)
+    {
+        total += shard->scheduler.congestionEvents();
+    }
+    return total;
+}
+
+std::uint64_t VehicleGateway::dropped() const
+{
+    std::uint64_t total = 0;
+    for (const auto& shard : shards)
+    {
+        total += shard->queue.dropped();
+    }
+    return total;
+}
+
+void VehicleGateway::run(Shard& shard)
+{
+    const std::size_t shardCount = shards.size();
+    std::vector<PendingBatch> pending;  // Indexed by vehicle / shardCount
+    std::deque<std::pair<Clock::time_point, VehicleId>> ageQueue;  // Oldest batches first
+    std::deque<VehicleId> ready;                                   // Round-robin upload order
+    std::vector<Upload> inFlight;
+    FlushScheduler& scheduler = shard.scheduler;
+    inFlight.reserve(scheduler.maxInFlight());
+    std::size_t backlog = 0;  // Readings in pending
+
+    while (true)
+    {
+        bool stopping = !running.load(std::memory_order_acquire);
+        bool busy = false;
+        auto now = Clock::now();
+        std::size_t batchReadings = scheduler.batchReadings();
+
+        Record record;
+        for (std::size_t drained = 0; drained < kMaxDrainPerPass && shard.queue.tryPop(record);
+             ++drained)
+        {
+            std::size_t slot = record.vehicle / shardCount;
+            if (slot >= pending.size())
+            {
+                pending.resize(slot + 1);
+            }
+
+            PendingBatch& batch = pending[slot];
+            if (batch.readings.empty())
+            {
+                batch.firstAdded = now;
+                ageQueue.emplace_back(now, record.vehicle);
+            }
+            batch.readings.push_back(record.reading);
+            ++backlog;
+            if (!batch.ready && batch.readings.size() >= batchReadings)
+            {
+                batch.ready = true;
+                ready.push_back(record.vehicle);
+            }
+            busy = true;
+        }
+
+        // Batches that lingered long enough are sent even if not full, all of them when stopping
+        std::chrono::milliseconds linger = scheduler.linger();
+        while (!ageQueue.empty() && (stopping || ageQueue.front().first + linger <= now))
+        {
+            auto [firstAdded, vehicle] = ageQueue.front();
+            ageQueue.pop_front();
+            PendingBatch& batch = pending[vehicle / shardCount];
+            if (!batch.ready && !batch.readings.empty() && batch.firstAdded == firstAdded)
+            {
+                batch.ready = true;
+                ready.push_back(vehicle);
+            }
+        }
+
+        // Reap finished uploads
+        for (auto upload = inFlight.begin(); upload != inFlight.end();)
+        {
+            if (upload->result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                ++upload;
+                continue;
+            }
+            UploadFeedback feedback = upload->result.get();
+            (feedback.delivery == Delivery::DELIVERED ? uploadedCount : failedCount)
+                .fetch_add(upload->readings, std::memory_order_relaxed);
+            scheduler.onComplete(upload->ticket, feedback);
+            upload = inFlight.erase(upload);
+            busy = true;
+        }
+
+        // The queue still to be drained counts too, it is where a slow link shows first
+        scheduler.setBacklog(backlog + shard.queue.size());
+        batchReadings = scheduler.batchReadings();
+
+        // One batch per vehicle and turn; vehicles with more to send go to the back
+        while (inFlight.size() < scheduler.maxInFlight() && !ready.empty())
+        {
+            VehicleId vehicle = ready.front();
+            ready.pop_front();
+            PendingBatch& batch = pending[vehicle / shardCount];
+
+            // The payload is built before the call returns, so the readings can be erased
+            std::size_t count = std::min(batch.readings.size(), batchReadings);
+            std::span<const SensorReading> readings(batch.readings.data(), count);
+            const std::string& serial = registry.serial(vehicle);
+            inFlight.push_back(
+                {client.uploadSensorDataBatchAsync(readings, serial), count, scheduler.onSubmit()});
+            batch.readings.erase(batch.readings.begin(), batch.readings.begin() + count);
+            backlog -= count;
+
+            if (batch.readings.size() >= batchReadings)
+            {
+                ready.push_back(vehicle);
+            }
+            else
+            {
+                batch.ready = false;
+                if (!batch.readings.empty())
+                {
+                    batch.firstAdded = now;
+                    ageQueue.emplace_back(now, vehicle);
+                }
+            }
+            busy = true;
+        }
+
+        // Leave only once everything queued before the stop request has been confirmed
+        if (stopping && shard.queue.size() == 0 && ageQueue.empty() && ready.empty() &&
+            inFlight.empty())
+        {
+            break;
+        }
+        if (!busy)
+        {
+            std::this_thread::sleep_for(kIdleSleep);
+        }
+    }
+}
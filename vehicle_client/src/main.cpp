@@ -1,86 +1,400 @@
+#include <algorithm>
 #include <chrono>
 #include <csignal>
-#include <iostream>
-#include <thread>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <future>
+#include <map>
 #include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "DataTypes.hpp"
+#include "Logger.hpp"
+#include "RuntimeConfig.hpp"
+#include "TimerWheel.hpp"
 #include "VehicleClient.hpp"
+#include "VehicleGateway.hpp"
+
+namespace
+{
+// Set by the signal handler, polled by the sampling loop
+volatile std::sig_atomic_t keepRunning = 1;
+volatile std::sig_atomic_t reloadRequested = 0;
 
-// Global flag to control program execution
-bool keepRunning = true;
+// Resolution and rotation of the sampling timers: 1 ms ticks, about one second per turn
+constexpr auto kTimerTick = std::chrono::milliseconds(1);
+constexpr std::size_t kTimerSlots = 1024;
 
-// Signal handler for a graceful shutdown when interrupt signal is received
+// Longest sleep of the sampling loop, bounds how late a signal is handled
+constexpr auto kMaxIdle = std::chrono::milliseconds(100);
+
+// SIGINT and SIGTERM end the program, SIGHUP reloads the configuration
 void signalHandler(int signum)
 {
-    std::cout << "\nInterrupt signal (" << signum << ") received. Exiting the program..."
-              << std::endl;
-    keepRunning = false;
+    if (signum == SIGHUP)
+    {
+        reloadRequested = 1;
+    }
+    else
+    {
+        keepRunning = 0;
+    }
+}
+
+TimerWheel::Clock::duration samplePeriod(const SensorSchedule& sensor)
+{
+    return std::chrono::duration_cast<TimerWheel::Clock::duration>(
+        std::chrono::duration<double>(1.0 / sensor.rateHz));
 }
 
-int main()
+// Registers the vehicles as active with one bulk request
+void markVehiclesActive(VehicleClient& client, const std::vector<std::string>& vehicles)
 {
-    // Define API URL and vehicle serial number
-    std::string apiUrl = "https://restful-infrastructure.onrender.com";
-    std::string vehicleSerialNumber = "enginius1";
+    std::vector<std::pair<std::string, VehicleStatus>> updates;
+    for (const std::string& serial : vehicles)
+    {
+        updates.emplace_back(serial, VehicleStatus::ACTIVE);
+    }
+    if (client.updateVehicleStatuses(updates))
+    {
+        logInfo() << "Marked " << updates.size() << " vehicles active";
+    }
+    else
+    {
+        logWarning() << "Failed to mark the vehicles active";
+    }
+}
+
+/**
+ * @class Simulation
+ * @brief Samples the configured sensors of every vehicle and reports on the uploads.
+ *
+ * Every sensor of every vehicle has its own timer on one TimerWheel, so each
+ * keeps its rate exactly however many vehicles share the loop; the timers of
+ * a sensor are spread evenly over its period, so a fleet does not sample in
+ * bursts. Readings go to the gateway, which batches and uploads them.
+ */
+class Simulation
+{
+   public:
+    Simulation(VehicleClient& client, VehicleGateway& gateway, const RuntimeConfig& config)
+        : client(client), gateway(gateway), wheel(kTimerTick, kTimerSlots),
+          generator(std::random_device{}())
+    {
+        for (const std::string& serial : config.vehicles)
+        {
+            vehicles.push_back(gateway.registerVehicle(serial));
+        }
+        apply(config);
+    }
 
-    // Register signal handler for catching SIGINT (Ctrl+C) to exit gracefully
-    signal(SIGINT, signalHandler);
+    /**
+     * @brief Takes over the sensors and the status interval of a (re)loaded configuration.
+     *
+     * Sensors whose type did not change keep their phase and only change their
+     * rate; the others are restarted.
+     */
+    void apply(const RuntimeConfig& config)
+    {
+        auto now = TimerWheel::Clock::now();
+        for (std::size_t s = 0; s < std::max(sensors.size(), config.sensors.size()); ++s)
+        {
+            if (s >= config.sensors.size())
+            {
+                stopSensor(s);
+            }
+            else if (s < sensors.size() && sensors[s].sensorType == config.sensors[s].sensorType)
+            {
+                for (TimerWheel::TimerId timer : sensorTimers[s])
+                {
+                    wheel.setPeriod(timer, samplePeriod(config.sensors[s]), now);
+                }
+            }
+            else
+            {
+                stopSensor(s);
+                startSensor(s, config.sensors[s], now);
+            }
+        }
+        sensors = config.sensors;
+        sensorTimers.resize(sensors.size());
+
+        if (config.statusInterval != statusInterval)
+        {
+            if (statusInterval.count() > 0)
+            {
+                wheel.cancel(statusTimer);
+                timerTargets[statusTimer] = kUnused;
+            }
+            statusInterval = config.statusInterval;
+            if (statusInterval.count() > 0)
+            {
+                statusTimer = wheel.add(statusInterval, now + statusInterval);
+                target(statusTimer) = kStatusTimer;
+            }
+        }
+    }
+
+    /**
+     * @brief Runs the timers until keepRunning is cleared, reloading on request.
+     */
+    void run(const RuntimeConfigLoader& loader, RuntimeConfig& config)
+    {
+        std::vector<TimerWheel::TimerId> due;
+        while (keepRunning)
+        {
+            if (reloadRequested)
+            {
+                reloadRequested = 0;
+                reload(loader, config);
+            }
+
+            due.clear();
+            wheel.advance(TimerWheel::Clock::now(), due);
+            for (TimerWheel::TimerId timer : due)
+            {
+                fire(timer);
+            }
+            collectStatuses();
+
+            std::this_thread::sleep_until(
+                std::min(wheel.nextExpiry(), TimerWheel::Clock::now() + kMaxIdle));
+        }
+    }
 
-    // Initialize the VehicleClient with the API endpoint
-    VehicleClient client(apiUrl);
+   private:
+    // Targets of timers that sample no sensor
+    static constexpr std::size_t kUnused = static_cast<std::size_t>(-1);
+    static constexpr std::size_t kStatusTimer = static_cast<std::size_t>(-2);
 
-    // Set up random number generator for temperature values between 30 and 90
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> temp_dist(30.0, 90.0);
+    VehicleClient& client;
+    VehicleGateway& gateway;
+    TimerWheel wheel;
+    std::mt19937 generator;
 
+    std::vector<VehicleId> vehicles;
+    std::vector<SensorSchedule> sensors;
+    std::vector<std::vector<TimerWheel::TimerId>> sensorTimers;  ///< Per sensor, per vehicle.
+    std::vector<std::size_t> timerTargets;  ///< Sensor index * vehicles + vehicle, per timer.
 
-    // A. Update vehicle status on the server
-    std::cout << "\n==================================" << std::endl;
-    bool status_success = client.updateVehicleStatus(vehicleSerialNumber, VehicleStatus::ACTIVE);
-    if (status_success)
+    std::chrono::milliseconds statusInterval{0};
+    TimerWheel::TimerId statusTimer = 0;
+    std::vector<std::future<std::pair<bool, std::string>>> statusQueries;
+
+    std::size_t& target(TimerWheel::TimerId timer)
     {
-        std::cout << "Vehicle status updated successfully!" << std::endl;
+        if (timer >= timerTargets.size())
+        {
+            timerTargets.resize(timer + 1, kUnused);
+        }
+        return timerTargets[timer];
     }
-    else
+
+    void startSensor(std::size_t s, const SensorSchedule& sensor, TimerWheel::Clock::time_point now)
+    {
+        if (s >= sensorTimers.size())
+        {
+            sensorTimers.resize(s + 1);
+        }
+        auto period = samplePeriod(sensor);
+        for (std::size_t v = 0; v < vehicles.size(); ++v)
+        {
+            auto offset = period * static_cast<TimerWheel::Clock::rep>(v) /
+                          static_cast<TimerWheel::Clock::rep>(vehicles.size());
+            TimerWheel::TimerId timer = wheel.add(period, now + offset);
+            target(timer) = s * vehicles.size() + v;
+            sensorTimers[s].push_back(timer);
+        }
+    }
+
+    void stopSensor(std::size_t s)
+    {
+        if (s >= sensorTimers.size())
+        {
+            return;
+        }
+        for (TimerWheel::TimerId timer : sensorTimers[s])
+        {
+            wheel.cancel(timer);
+            timerTargets[timer] = kUnused;
+        }
+        sensorTimers[s].clear();
+    }
+
+    void fire(TimerWheel::TimerId timer)
     {
-        std::cout << "Failed to update vehicle status!" << std::endl;
+        std::size_t index = timerTargets[timer];
+        if (index == kStatusTimer)
+        {
+            report();
+            return;
+        }
+        if (index == kUnused)
+        {
+            return;
+        }
+
+        const SensorSchedule& sensor = sensors[index / vehicles.size()];
+        std::uniform_real_distribution<float> values(sensor.minValue, sensor.maxValue);
+        gateway.push(vehicles[index % vehicles.size()], sensor.sensorType, values(generator));
     }
 
-    // B. Continuously send sensor data and retrieve vehicle status
-    while (keepRunning)
+    void report()
     {
-        std::cout << "\n==================================" << std::endl;
+        logInfo() << "Uploaded " << gateway.uploaded() << " readings, " << gateway.failed()
+                  << " failed, " << gateway.dropped() << " dropped, " << wheel.missed()
+                  << " samples missed";
 
-        // Send temperature sensor data to the server
-        // Generate a random temperature value
-        double temperature = temp_dist(gen);
-        bool data_sent = client.addSensorData(SensorType::TEMPERATURE, temperature, vehicleSerialNumber);
-        if (data_sent)
+        // A slow server must not stall sampling, so statuses are collected as they arrive
+        if (!statusQueries.empty())
         {
-            std::cout << "Successfully sent temperature data." << std::endl;
+            return;
         }
-        else
+        for (VehicleId vehicle : vehicles)
         {
-            std::cout << "Failed to send temperature data." << std::endl;
+            statusQueries.push_back(client.getVehicleStatusAsync(gateway.vehicleSerial(vehicle)));
         }
+    }
 
-        // Retrieve the current vehicle status using structured binding (C++17 feature)
-        auto [status_retrieved, vehicle_status] = client.getVehicleStatus(vehicleSerialNumber);
-        if (status_retrieved)
+    void collectStatuses()
+    {
+        if (statusQueries.empty() ||
+            statusQueries.back().wait_for(std::chrono::seconds(0)) != std::future_status::ready)
         {
-            std::cout << "Vehicle Status: " << vehicle_status << std::endl;
+            return;
         }
-        else
+        for (auto& query : statusQueries)
         {
-            std::cerr << "Failed to retrieve vehicle status." << std::endl;
+            if (query.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                return;
+            }
         }
 
-        // Pause for 10 seconds before the next iteration
-        std::this_thread::sleep_for(std::chrono::seconds(10));
+        std::map<std::string, std::size_t> counts;
+        for (auto& query : statusQueries)
+        {
+            auto [retrieved, status] = query.get();
+            ++counts[retrieved ? status : "unavailable"];
+        }
+        statusQueries.clear();
+
+        LogLine line(LogLevel::INFO);
+        line << "Vehicle statuses:";
+        for (const auto& [status, count] : counts)
+        {
+            line << ' ' << count << ' ' << status;
+        }
+    }
+
+    void reload(const RuntimeConfigLoader& loader, RuntimeConfig& config)
+    {
+        RuntimeConfig reloaded;
+        std::string error;
+        if (!loader.load(reloaded, error))
+        {
+            logError() << "Reload failed, keeping the running configuration: " << error;
+            return;
+        }
+        if (reloaded.restartSettings != config.restartSettings)
+        {
+            logWarning() << "Reload changed settings that only apply after a restart; applying "
+                            "sensors, status_interval_ms, log_level, retry and "
+                            "shutdown_timeout_ms only";
+        }
+
+        Logger::instance().configure(LoggerConfig{.minLevel = reloaded.logLevel});
+        client.setRetryPolicy(reloaded.retry);
+        apply(reloaded);
+
+        // Startup-only settings stay as they are running
+        reloaded.restartSettings = config.restartSettings;
+        config = std::move(reloaded);
+        logInfo() << "Configuration reloaded";
+    }
+};
+
+}  // unnamed namespace
+
+int main(int argc, char** argv)
+{
+    RuntimeConfigLoader loader(argc, argv);
+    if (loader.helpRequested())
+    {
+        loader.printUsage();
+        return 0;
+    }
+
+    RuntimeConfig config;
+    std::string error;
+    if (!loader.load(config, error))
+    {
+        std::fprintf(stderr, "Invalid configuration: %s\n", error.c_str());
+        loader.printUsage();
+        return 1;
+    }
+    Logger::instance().configure(LoggerConfig{.minLevel = config.logLevel});
+
+    // SIGINT (Ctrl+C) and SIGTERM exit gracefully, SIGHUP reloads the configuration
+    std::signal(SIGINT, signalHandler);
+    std::signal(SIGTERM, signalHandler);
+    std::signal(SIGHUP, signalHandler);
+
+    // Startup-only settings go first, before any request is sent
+    VehicleClient client(config.apiUrl);
+    client.setWireFormat(config.wireFormat);
+    client.setRetryPolicy(config.retry);
+    if (!client.enableCompression(config.compression))
+    {
+        logWarning() << "Compression unavailable in this build, sending bodies uncompressed";
+    }
+    if (config.spoolEnabled && !client.enableSpool(config.spool))
+    {
+        logWarning() << "Offline spool unavailable, unsent readings will be lost";
+    }
+    if (config.uploadPoolEnabled)
+    {
+        client.enableUploadPool(config.uploadPool);
+    }
+    if (config.metricsEnabled && !client.enableMetricsEndpoint(config.metrics))
+    {
+        logWarning() << "Metrics endpoint could not be bound to " << config.metrics.address
+                     << ':' << config.metrics.port;
+    }
+
+    // DNS, TCP and TLS are done on the event loop while the rest starts up
+    client.prewarm();
+
+    // Status changes are pushed by the server, so the status reports rarely hit the network
+    if (config.statusNotifications)
+    {
+        client.enableStatusNotifications(config.vehicles);
+    }
+
+    // Sampling starts right away; readings queue in the gateway until the link is up
+    auto activation = std::async(std::launch::async, markVehiclesActive, std::ref(client),
+                                 config.vehicles);
+
+    {
+        VehicleGateway gateway(client, config.gateway);
+        Simulation simulation(client, gateway, config);
+        logInfo() << "Sampling " << config.sensors.size() << " sensors of "
+                  << config.vehicles.size() << " vehicles through " << gateway.workers()
+                  << " gateway workers";
+        simulation.run(loader, config);
+
+        // The gateway uploads what is still queued when it goes out of scope; whatever the
+        // server has not confirmed by the deadline is spooled instead of waited for
+        logInfo() << "Draining queued readings for up to " << config.shutdownTimeout.count()
+                  << " ms";
+        client.abortRequestsAt(std::chrono::steady_clock::now() + config.shutdownTimeout);
     }
+    activation.wait();
 
-    std::cout << "Program terminated." << std::endl;
+    std::printf("Program terminated.\n");
     return 0;
 }